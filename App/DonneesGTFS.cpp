@@ -3,9 +3,28 @@
 //
 
 #include "DonneesGTFS.h"
+#include "lecteurcsv.h"
+#include "metriques.h"
+
+#include <exception>
+#include <thread>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
 
 using namespace std;
 
+namespace
+{
+    //! \brief l'histogramme des durées de la phase de chargement p_phase (une par méthode ajouter*())
+    Histogramme &dureeChargement(const char *p_phase)
+    {
+        return Metriques::globales().histogramme("gtfs_chargement_secondes",
+                                                 "Durée des phases de chargement de DonneesGTFS, en secondes",
+                                                 Histogramme::seuilsDurees(), {{"phase", p_phase}});
+    }
+}
+
 
 
 //! \brief construit un objet GTFS
@@ -14,69 +33,223 @@ using namespace std;
 //! \param[in] p_now2: l'heure de fin de l'intervalle considéré
 //! \brief Ces deux heures définissent l'intervalle de temps du GTFS; seuls les moments de [p_now1, p_now2) sont considérés
 DonneesGTFS::DonneesGTFS(const Date &p_date, const Heure &p_now1, const Heure &p_now2)
-        : m_date(p_date), m_now1(p_now1), m_now2(p_now2), m_nbArrets(0), m_tousLesArretsPresents(false)
+        : m_date(p_date), m_now1(p_now1), m_now2(p_now2), m_debutJourneeService(0), m_nbArrets(0), m_tousLesArretsPresents(false),
+          m_construitDuFlux(false), m_joursVoisins(false), m_arretsLiberes(false), m_nbThreadsChargement(std::max(1u, std::thread::hardware_concurrency()))
 {
 }
 
-//! \brief partitionne un string en un vecteur de strings
-//! \param[in] s: le string à être partitionner
-//! \param[in] delim: le caractère utilisé pour le partitionnement
-//! \return le vecteur de string sans le caractère utilisé pour le partitionnement
-vector<string> DonneesGTFS::string_to_vector(const string &s, char delim)
+//! \brief construit l'objet GTFS d'une date à partir d'un flux déjà lu, sans relire les fichiers
+//! \brief Le résultat est celui qu'on obtient en appelant, sur les fichiers du flux, ajouterAgences(), ajouterLignes(),
+//! \brief ajouterStations(), ajouterServices(), ajouterVoyagesDeLaDate(), ajouterArretsDesVoyagesDeLaDate() puis
+//! \brief ajouterTransferts().
+//! \param[in] p_flux: le flux GTFS, qui peut servir à construire les objets de plusieurs dates
+//! \param[in] p_date: la date utilisée par le GTFS, dans la période du flux
+//! \param[in] p_now1: l'heure du début de l'intervalle considéré
+//! \param[in] p_now2: l'heure de fin de l'intervalle considéré
+//! \param[in] p_joursVoisins: si vrai, l'intervalle peut déborder sur la veille et le lendemain: les voyages de la
+//! \param[in] veille sont avancés de 24 heures et ceux du lendemain retardés de 24 heures; leur trip_id est alors
+//! \param[in] suivi de '@' et de leur date (AAAA-MM-JJ) pour les distinguer des voyages de la date
+//! \throws logic_error si p_date est hors de la période du flux
+DonneesGTFS::DonneesGTFS(const FluxGTFS &p_flux, const Date &p_date, const Heure &p_now1, const Heure &p_now2,
+                         bool p_joursVoisins)
+        : DonneesGTFS(p_date, p_now1, p_now2)
 {
-    stringstream ss(s);
-    string item;
-    vector<string> elems;
-    while (getline(ss, item, delim))
+    m_construitDuFlux = true;
+    m_joursVoisins = p_joursVoisins;
+    m_fuseauHoraire = p_flux.getFuseauHoraire();
+    if (p_date < p_flux.getPremiereDate() || p_date > p_flux.getDerniereDate())
+        throw std::logic_error("DonneesGTFS::DonneesGTFS(): la date est hors de la période du flux");
+    m_debutJourneeService = p_flux.getDebutJourneeService(p_date);
+
+    for (const Ligne &ligne : p_flux.getLignes())
     {
-        elems.push_back(item);
+        m_lignes.insert({ligne.getId(), ligne});
+        m_lignes_par_numero.insert({ligne.getNumero(), ligne});
     }
-    return elems;
+    for (const Station &station : p_flux.getStations())
+        m_stations.insert({station.getId(), station});
+
+    std::vector<Arret::Ptr> ajoutes;
+    for (int jour : joursDuFlux())
+        ajouterArretsDuFlux(p_flux, jour, 0, ajoutes);
+    enleverVoyagesEtStationsSansArrets();
+    ajouterTransfertsDuFlux(p_flux);
 }
 
+//! \brief avance l'intervalle de temps à [p_now1, p_now2) sans reconstruire l'objet: les arrêts partis avant p_now1
+//! \brief sont enlevés et ceux qui arrivent dans [getTempsFin(), p_now2) sont ajoutés à partir du flux
+//! \brief Le résultat est celui de DonneesGTFS(p_flux, getDate(), p_now1, p_now2, ...), numéros internés compris.
+//! \param[in] p_flux: le flux à partir duquel l'objet a été construit
+//! \param[out] p_ajoutes: les arrêts ajoutés, dans l'ordre où ils l'ont été (voir ReseauGTFS::avancerIntervalle())
+//! \throws logic_error si l'objet n'a pas été construit à partir d'un flux, si ses arrêts ont été libérés ou si
+//! \throws l'intervalle recule
+void DonneesGTFS::avancerIntervalle(const FluxGTFS &p_flux, const Heure &p_now1, const Heure &p_now2,
+                                    std::vector<Arret::Ptr> &p_ajoutes)
+{
+    if (!m_construitDuFlux)
+        throw std::logic_error("DonneesGTFS::avancerIntervalle(): l'objet n'a pas été construit à partir d'un flux");
+    if (m_arretsLiberes)
+        throw std::logic_error("DonneesGTFS::avancerIntervalle(): les arrêts ont été libérés");
+    if (p_now1 < m_now1 || p_now2 < m_now2 || p_now2 < p_now1)
+        throw std::logic_error("DonneesGTFS::avancerIntervalle(): l'intervalle ne peut pas reculer");
+
+    for (auto &voyage : m_voyages)
+        m_nbArrets -= voyage.second.enleverArretsPartis(p_now1);
+    for (auto &station : m_stations)
+        station.second.enleverArretsPartis(p_now1);
+
+    const int ancienneFin = m_now2 - Heure(0, 0, 0);
+    m_now1 = p_now1;
+    m_now2 = p_now2;
+    p_ajoutes.clear();
+    for (int jour : joursDuFlux())
+        ajouterArretsDuFlux(p_flux, jour, ancienneFin, p_ajoutes);
+    enleverVoyagesEtStationsSansArrets();
+    m_transferts.clear();
+    ajouterTransfertsDuFlux(p_flux);
+}
 
-//! \brief ajoute les lignes dans l'objet GTFS
-//! \param[in] p_nomFichier: le nom du fichier contenant les lignes
-//! \throws logic_error si un problème survient avec la lecture du fichier
-void DonneesGTFS::ajouterLignes(const std::string &p_nomFichier)
+//! \brief les jours, relatifs à m_date, dont les voyages sont tirés du flux; la date elle-même vient en premier
+std::vector<int> DonneesGTFS::joursDuFlux() const
 {
-    //tenter l'ouverture du fichier
-    std::ifstream ifFichier(p_nomFichier);
-    if(ifFichier.is_open())
+    std::vector<int> jours(1, 0);
+    if (m_joursVoisins)
     {
-        try
+        jours.push_back(-1);
+        jours.push_back(1);
+    }
+    return jours;
+}
+
+//! \brief ajoute les arrêts du flux des voyages actifs au jour m_date + p_jour, décalés de p_jour * 24 heures, dont
+//! \brief l'arrivée est dans [p_arriveeMin, m_now2) et le départ >= m_now1 (même filtre que ajouterArretsDesVoyagesDeLaDate())
+//! \brief Les trip_id de tous les voyages actifs sont internés dans l'ordre du flux, qu'ils aient des arrêts ou non,
+//! \brief ce qui garde leur numérotation indépendante de l'intervalle.
+//! \param[in,out] p_ajoutes: les arrêts ajoutés y sont placés à la suite, dans l'ordre du fichier
+void DonneesGTFS::ajouterArretsDuFlux(const FluxGTFS &p_flux, int p_jour, int p_arriveeMin,
+                                      std::vector<Arret::Ptr> &p_ajoutes)
+{
+    Chronometre chronometre(dureeChargement("arrets_flux"));
+    Date date = m_date.add_jours(p_jour);
+    std::ostringstream suffixe;
+    if (p_jour != 0) suffixe << "@" << date;
+
+    std::vector<unsigned int> services(p_flux.getNbServices(), Identifiants::aucun);
+    for (unsigned int s = 0; s < services.size(); ++s)
+    {
+        if (!p_flux.estActif(s, date)) continue;
+        services[s] = m_idsServices.interner(p_flux.getIdsServices().getChaine(s));
+        if (p_jour == 0) m_services.insert(services[s]);
+    }
+    std::vector<unsigned int> ids(p_flux.getVoyages().size(), Identifiants::aucun);
+    for (unsigned int v = 0; v < ids.size(); ++v)
+        if (services[p_flux.getVoyages()[v].service] != Identifiants::aucun)
+            ids[v] = m_idsVoyages.interner(p_flux.getIdsVoyages().getChaine(v) + suffixe.str());
+
+    const Heure minuit(0, 0, 0);
+    const int decalage = p_jour * 86400;
+    const int debut = m_now1 - minuit;
+    const int fin = m_now2 - minuit;
+    std::vector<unsigned int> arrets;
+    p_flux.arretsArrivantDans((unsigned int) std::max(0, std::max(p_arriveeMin, 0) - decalage),
+                              (unsigned int) std::max(0, fin - decalage), arrets);
+    for (unsigned int a : arrets)
+    {
+        const FluxGTFS::ArretFlux &arretFlux = p_flux.getArrets()[a];
+        unsigned int id = ids[arretFlux.voyage];
+        int depart = (int) arretFlux.depart + decalage;
+        if (id == Identifiants::aucun || depart < debut) continue;
+
+        std::map<unsigned int, Voyage>::iterator itrVoyage = m_voyages.find(id);
+        if (itrVoyage == m_voyages.end())
+        {
+            const FluxGTFS::VoyageFlux &voyage = p_flux.getVoyages()[arretFlux.voyage];
+            itrVoyage = m_voyages.insert({id, Voyage(id, voyage.ligne, services[voyage.service],
+                                                     voyage.destination)}).first;
+        }
+        std::map<unsigned int, Station>::iterator itrStation = m_stations.find(arretFlux.station);
+        if (itrStation == m_stations.end() && p_flux.chercherStation(arretFlux.station) != nullptr)
         {
-            //sauter la ligne 1
-            std::string strLigne;
-            std::getline(ifFichier, strLigne);
+            //la station a été enlevée faute d'arrêts dans un intervalle précédent
+            itrStation = m_stations.insert({arretFlux.station, *p_flux.chercherStation(arretFlux.station)}).first;
+        }
 
-            //boucler les lignes
-            while (std::getline(ifFichier, strLigne))
-            {
-                //enlever les guillemets
-                strLigne.erase(std::remove(strLigne.begin(), strLigne.end(), '"'), strLigne.end());
-                std::vector<std::string> vObjet = string_to_vector(strLigne, ',');
+        Arret::Ptr arret = std::make_shared<Arret>(arretFlux.station,
+                                                   minuit.add_secondes((unsigned int) ((int) arretFlux.arrivee + decalage)),
+                                                   minuit.add_secondes((unsigned int) depart), arretFlux.sequence, id);
+        itrVoyage->second.ajouterArret(arret);
+        if (itrStation != m_stations.end()) itrStation->second.addArret(arret);
+        m_nbArrets++;
+        p_ajoutes.push_back(arret);
+    }
+}
+
+//! \brief ajoute les transferts du flux dont les deux stations sont présentes
+void DonneesGTFS::ajouterTransfertsDuFlux(const FluxGTFS &p_flux)
+{
+    Chronometre chronometre(dureeChargement("transferts_flux"));
+    for (const auto &transfert : p_flux.getTransferts())
+        if (m_stations.find(std::get<0>(transfert)) != m_stations.end() &&
+            m_stations.find(std::get<1>(transfert)) != m_stations.end())
+            m_transferts.push_back(transfert);
+}
 
-                //convertir vers unsigned int p_id, const std::string & p_numero, const std::string & p_description, const CategorieBus&
+//! \brief fixe le nombre de threads utilisés par ajouterArretsDesVoyagesDeLaDate()
+//! \param[in] p_nbThreads: le nombre de threads (1 pour une lecture séquentielle); 0 est traité comme 1
+//! \brief Le résultat du chargement est le même quel que soit le nombre de threads
+void DonneesGTFS::setNbThreadsChargement(unsigned int p_nbThreads)
+{
+    m_nbThreadsChargement = std::max(1u, p_nbThreads);
+}
 
-                //insérer les données dans m_lignes
-                int id = std::stoul(vObjet[0]);
-                m_lignes.insert({id, Ligne(id, vObjet[2], vObjet[4], Ligne::couleurToCategorie(vObjet[7]))});
-                m_lignes_par_numero.insert(
-                        {vObjet[2], Ligne(id, vObjet[2], vObjet[4], Ligne::couleurToCategorie(vObjet[7]))});
+unsigned int DonneesGTFS::getNbThreadsChargement() const
+{
+    return m_nbThreadsChargement;
+}
 
+//! \brief lit le fuseau horaire du réseau (agency_timezone) dans agency.txt
+//! \brief GTFS impose le même fuseau à toutes les agences d'un flux: celui de la première est gardé. Il sert à convertir
+//! \brief en heures de l'horaire les heures POSIX du temps réel (ReseauGTFS::appliquerRetards()): l'heure POSIX du
+//! \brief début de la journée de service est calculée ici, une fois, plutôt que pendant les requêtes.
+//! \param[in] p_nomFichier: le nom du fichier contenant les agences
+//! \throws logic_error si un problème survient avec la lecture du fichier ou s'il ne donne aucun fuseau
+void DonneesGTFS::ajouterAgences(const std::string &p_nomFichier)
+{
+    Chronometre chronometre(dureeChargement("agences"));
+    m_fuseauHoraire = FluxGTFS::lireFuseauHoraire(p_nomFichier);
+    m_debutJourneeService = m_date.debutJourneeService(m_fuseauHoraire);
+}
 
-            }
-            ifFichier.close();
-        }
-        catch(...)//attraper une erreur si elle survient
+//! \brief ajoute les lignes dans l'objet GTFS
+//! \param[in] p_nomFichier: le nom du fichier contenant les lignes
+//! \throws logic_error si un problème survient avec la lecture du fichier
+void DonneesGTFS::ajouterLignes(const std::string &p_nomFichier)
+{
+    Chronometre chronometre(dureeChargement("lignes"));
+    //ouvrir le fichier (lance logic_error s'il ne peut pas être ouvert)
+    LecteurCSV lecteur(p_nomFichier);
+    try
+    {
+        //sauter la ligne 1
+        std::vector<ChampCSV> champs;
+        lecteur.lireLigne(champs);
+
+        //boucler les lignes
+        while (lecteur.lireLigne(champs))
         {
-            throw std::logic_error("erreur logique");
+            //convertir vers unsigned int p_id, const std::string & p_numero, const std::string & p_description, const CategorieBus&
+            unsigned int id = champs.at(0).versEntier();
+            std::string numero = champs.at(2).versString();
+            Ligne ligne(id, numero, champs.at(4).versString(), Ligne::couleurToCategorie(champs.at(7).versString()));
+
+            //insérer les données dans m_lignes
+            m_lignes.insert({id, ligne});
+            m_lignes_par_numero.insert({numero, ligne});
         }
     }
-    else
+    catch(...)//attraper une erreur si elle survient
     {
-        throw std::logic_error("le fichier n'a pas pu ouvrir");
+        throw std::logic_error("erreur logique ajouterLignes, ligne " + std::to_string(lecteur.getNumeroLigne()));
     }
 }
 
@@ -85,42 +258,29 @@ void DonneesGTFS::ajouterLignes(const std::string &p_nomFichier)
 //! \throws logic_error si un problème survient avec la lecture du fichier
 void DonneesGTFS::ajouterStations(const std::string &p_nomFichier)
 {
-    //tenter l'ouverture du fichier
-    std::ifstream ifFichier(p_nomFichier);
-
-    if(ifFichier.is_open())
+    Chronometre chronometre(dureeChargement("stations"));
+    //ouvrir le fichier (lance logic_error s'il ne peut pas être ouvert)
+    LecteurCSV lecteur(p_nomFichier);
+    try
     {
-        try
-        {
-            //sauter la ligne 1
-            std::string strLigne;
-            std::getline(ifFichier, strLigne);
-
-            //boucler les lignes
-            while (std::getline(ifFichier, strLigne)) {
-                //enlever les guillemets
-                strLigne.erase(std::remove(strLigne.begin(), strLigne.end(), '"'), strLigne.end());
-                std::vector<std::string> vObjet = string_to_vector(strLigne, ',');
-
-                //convertir vers unsigned int p_id, const std::string & p_nom, const std::string & p_description,const Coordonnees & p_coords
-
-                //insérer les données dans m_stations
-                int id = std::stoul(vObjet[0]);
-                Coordonnees location(std::stod(vObjet[3]), std::stod(vObjet[4]));
-                m_stations.insert({id, Station(id, vObjet[1], vObjet[2], location)});
-
+        //sauter la ligne 1
+        std::vector<ChampCSV> champs;
+        lecteur.lireLigne(champs);
 
-            }
-            ifFichier.close();
-        }
-        catch(...)//attraper une erreur si elle survient
+        //boucler les lignes
+        while (lecteur.lireLigne(champs))
         {
-            throw std::logic_error("erreur logique");
+            //convertir vers unsigned int p_id, const std::string & p_nom, const std::string & p_description,const Coordonnees & p_coords
+            unsigned int id = champs.at(0).versEntier();
+            Coordonnees location(champs.at(3).versReel(), champs.at(4).versReel());
+
+            //insérer les données dans m_stations
+            m_stations.insert({id, Station(id, champs.at(1).versString(), champs.at(2).versString(), location)});
         }
     }
-    else
+    catch(...)//attraper une erreur si elle survient
     {
-        throw std::logic_error("le fichier n'a pas pu ouvrir");
+        throw std::logic_error("erreur logique ajouterStations, ligne " + std::to_string(lecteur.getNumeroLigne()));
     }
 }
 
@@ -131,81 +291,48 @@ void DonneesGTFS::ajouterStations(const std::string &p_nomFichier)
 //! \param[in] p_nomFichier: le nom du fichier contenant les station
 //! \throws logic_error si un problème survient avec la lecture du fichier
 //! \throws logic_error si tous les arrets de la date et de l'intervalle n'ont pas été ajoutés
-void DonneesGTFS::ajouterTransferts(const std::string &p_nomFichier) {
-
+void DonneesGTFS::ajouterTransferts(const std::string &p_nomFichier)
+{
+    Chronometre chronometre(dureeChargement("transferts"));
+    if (!m_tousLesArretsPresents)
+    {
+        //Il faut rouler AjouterArretDesVoyages avant.
+        throw std::logic_error("Il faut que tous les arrêts soient présents");
+    }
 
-    if(m_tousLesArretsPresents) // vérifier que tous les arrêts sont présents
+    //ouvrir le fichier (lance logic_error s'il ne peut pas être ouvert)
+    LecteurCSV lecteur(p_nomFichier);
+    try
     {
-        //tenter l'ouverture du fichier
-        std::ifstream ifFichier(p_nomFichier);
-        if (ifFichier.is_open())
+        //sauter la ligne 1
+        std::vector<ChampCSV> champs;
+        lecteur.lireLigne(champs);
+
+        //boucler les lignes
+        while (lecteur.lireLigne(champs))
         {
+            unsigned int uiFrom = champs.at(0).versEntier();
+            unsigned int uiTo = champs.at(1).versEntier();
 
-            try
+            if (uiFrom != uiTo) // empêcher le transfert d'une station a elle-meme
             {
+                unsigned int uiTime = champs.at(3).versEntier();
 
-                //sauter la ligne 1
-                std::string strLigne;
-                std::getline(ifFichier, strLigne);
+                if (uiTime == 0)//si le temps est 0, assigner a 1 seconde
+                    uiTime = 1;
 
-                //boucler les lignes
-                while (std::getline(ifFichier, strLigne))
+                //si la station de départ et la station d'arrivée existent
+                if (m_stations.find(uiFrom) != m_stations.end() && m_stations.find(uiTo) != m_stations.end())
                 {
-
-
-                    //enlever les guillemets
-                    strLigne.erase(std::remove(strLigne.begin(), strLigne.end(), '"'), strLigne.end());
-                    std::vector<std::string> vObjet = string_to_vector(strLigne, ',');
-
-                    //convertir vers unsigned int
-
-                    unsigned int uiFrom = std::stoul(vObjet[0]);
-                    unsigned int uiTo = std::stoul(vObjet[1]);
-
-                    if (uiFrom != uiTo) // empêcher le transfert d'une station a elle-meme
-                    {
-
-                        unsigned int uiTime = std::stoul(vObjet[3]);
-
-                        if (uiTime == 0)//si le temps est 0, assigner a 1 seconde
-                            uiTime = 1;
-
-                        //si les stations existent
-                        std::map<unsigned int, Station>::iterator itrFrom = m_stations.find(uiFrom);
-                        std::map<unsigned int, Station>::iterator itrTo = m_stations.find(uiTo);
-
-                        //si la station de départ et la station d'arrivée existent
-                        if (itrFrom != m_stations.end() && itrTo != m_stations.end())
-                        {
-                            //insérer les données dans m_transferts
-                            m_transferts.push_back(
-                                    std::tuple<unsigned int, unsigned int, unsigned int>(
-                                            uiFrom,
-                                            uiTo,
-                                            uiTime
-                                    )
-                            );
-                        }
-                    }
-
-
+                    //insérer les données dans m_transferts
+                    m_transferts.push_back(std::tuple<unsigned int, unsigned int, unsigned int>(uiFrom, uiTo, uiTime));
                 }
-                ifFichier.close();
-            }
-            catch (...)//attraper une erreur si elle survient
-            {
-                throw std::logic_error("erreur logique ajouterArretsDesVoyagesDeLaDate");
             }
         }
-        else
-        {
-            throw std::logic_error("le fichier n'a pas pu ouvrir");
-        }
     }
-    else
+    catch (...)//attraper une erreur si elle survient
     {
-        //Il faut rouler AjouterArretDesVoyages avant.
-        throw std::logic_error("Il faut que tous les arrêts soient présents");
+        throw std::logic_error("erreur logique ajouterTransferts, ligne " + std::to_string(lecteur.getNumeroLigne()));
     }
 }
 
@@ -215,50 +342,32 @@ void DonneesGTFS::ajouterTransferts(const std::string &p_nomFichier) {
 //! \throws logic_error si un problème survient avec la lecture du fichier
 void DonneesGTFS::ajouterServices(const std::string &p_nomFichier)
 {
-
-    //tenter l'ouverture du fichier
-    std::ifstream ifFichier(p_nomFichier);
-    if(ifFichier.is_open())
+    Chronometre chronometre(dureeChargement("services"));
+    //ouvrir le fichier (lance logic_error s'il ne peut pas être ouvert)
+    LecteurCSV lecteur(p_nomFichier);
+    try
     {
-        try
+        //sauter la ligne 1
+        std::vector<ChampCSV> champs;
+        lecteur.lireLigne(champs);
+
+        //boucler les lignes
+        while (lecteur.lireLigne(champs))
         {
-            //sauter la ligne 1
-            std::string strLigne;
-            std::getline(ifFichier, strLigne);
+            Date dateBus = champs.at(1).versDate();
+            unsigned int exception = champs.at(2).versEntier();
 
-            //boucler les lignes
-            while (std::getline(ifFichier, strLigne))
+            //si exception est de type 1 et le service est actif à la date fournie
+            if (exception == 1 && dateBus == m_date)
             {
-
-                //enlever les guillemets
-                strLigne.erase(std::remove(strLigne.begin(), strLigne.end(), '"'), strLigne.end());
-                std::vector<std::string> vObjet = string_to_vector(strLigne, ',');
-
-                //convertir vers unsigned int p_id, const std::string & p_nom, const std::string & p_description,const Coordonnees & p_coords
-
-                Date dateBus(std::stoul(vObjet[1].substr(0, 4)), std::stoul(vObjet[1].substr(4, 2)),
-                             std::stoul(vObjet[1].substr(6, 2)));
-                int exception = std::stoul(vObjet[2]);
-
-                //si exception est de type 1 et le service est actif à la date fournie
-                if (exception == 1 && dateBus == m_date)
-                {
-                    //insérer l'id du service dans m_services
-                    m_services.insert(vObjet[0]);
-                }
-
-
+                //insérer le numéro interné du service dans m_services
+                m_services.insert(m_idsServices.interner(champs.at(0)));
             }
-            ifFichier.close();
-        }
-        catch(...)//attraper une erreur si elle survient
-        {
-            throw std::logic_error("erreur logique");
         }
     }
-    else
+    catch(...)//attraper une erreur si elle survient
     {
-        throw std::logic_error("le fichier n'a pas pu ouvrir");
+        throw std::logic_error("erreur logique ajouterServices, ligne " + std::to_string(lecteur.getNumeroLigne()));
     }
 }
 
@@ -268,46 +377,32 @@ void DonneesGTFS::ajouterServices(const std::string &p_nomFichier)
 //! \throws logic_error si un problème survient avec la lecture du fichier
 void DonneesGTFS::ajouterVoyagesDeLaDate(const std::string &p_nomFichier)
 {
-    //tenter l'ouverture du fichier
-    std::ifstream ifFichier(p_nomFichier);
-    if(ifFichier.is_open())
+    Chronometre chronometre(dureeChargement("voyages"));
+    //ouvrir le fichier (lance logic_error s'il ne peut pas être ouvert)
+    LecteurCSV lecteur(p_nomFichier);
+    try
     {
-        try
-        {
-            //sauter la ligne 1
-            std::string strLigne;
-            std::getline(ifFichier, strLigne);
+        //sauter la ligne 1
+        std::vector<ChampCSV> champs;
+        lecteur.lireLigne(champs);
 
-            //boucler les lignes
-            while (std::getline(ifFichier, strLigne))
+        //boucler les lignes
+        while (lecteur.lireLigne(champs))
+        {
+            //les services existent a la m_date, donc si le voyage a un service qui existe,il est a la m_date
+            unsigned int serviceId = m_idsServices.chercher(champs.at(1));
+            if (m_services.find(serviceId) != m_services.end())// si le service existe (implique que le voyage est à m_date)
             {
-
-                //enlever les guillemets
-                strLigne.erase(std::remove(strLigne.begin(), strLigne.end(), '"'), strLigne.end());
-                std::vector<std::string> vObjet = string_to_vector(strLigne, ',');
-
-                //convertir vers const std::string & p_id, unsigned int p_ligne_id, const std::string & p_service_id, const std::string & p_destination
-
-                //les services existent a la m_date, donc si le voyage a un service qui existe,il est a la m_date
-                std::unordered_set<std::string>::iterator itrService = m_services.find(vObjet[1]);
-                if (itrService != m_services.end())// si le service existe (implique que le voyage est à m_date)
-                {
-                    //insérer les données dans m_voyages
-                    m_voyages.insert({vObjet[2], Voyage(vObjet[2], std::stoul(vObjet[0]), vObjet[1], vObjet[3])});
-                }
-
-
+                //convertir vers unsigned int p_id, unsigned int p_ligne_id, unsigned int p_service_id, const std::string & p_destination
+                unsigned int id = m_idsVoyages.interner(champs.at(2));
+                m_voyages.insert({id, Voyage(id, champs.at(0).versEntier(), serviceId, champs.at(3).versString())});
             }
-            ifFichier.close();
-        }
-        catch(...)//attraper une erreur si elle survient
-        {
-            throw std::logic_error("erreur logique");
         }
     }
-    else
+    catch(...)//attraper une erreur si elle survient
     {
-        throw std::logic_error("le fichier n'a pas pu ouvrir");
+        throw std::logic_error("erreur logique ajouterVoyagesDeLaDate, ligne " +
+                               std::to_string(lecteur.getNumeroLigne()));
     }
 }
 
@@ -315,107 +410,160 @@ void DonneesGTFS::ajouterVoyagesDeLaDate(const std::string &p_nomFichier)
 //! \brief De plus, on enlève les voyages qui n'ont pas d'arrêts dans l'intervalle de temps du GTFS
 //! \brief De plus, on enlève les stations qui n'ont pas d'arrets dans l'intervalle de temps du GTFS
 //! \param[in] p_nomFichier: le nom du fichier contenant les arrets
+//! \brief Le fichier est lu par getNbThreadsChargement() threads, chacun sur une plage de lignes complètes
 //! \post assigne m_tousLesArretsPresents à true
 //! \throws logic_error si un problème survient avec la lecture du fichier
 void DonneesGTFS::ajouterArretsDesVoyagesDeLaDate(const std::string &p_nomFichier)
 {
-    //tenter l'ouverture du fichier
-    std::ifstream ifFichier(p_nomFichier);
-    if(ifFichier.is_open())
+    Chronometre chronometre(dureeChargement("arrets"));
+    //ouvrir le fichier (lance logic_error s'il ne peut pas être ouvert)
+    LecteurCSV lecteur(p_nomFichier);
+    try
+    {
+        //sauter la ligne 1
+        std::vector<ChampCSV> champs;
+        lecteur.lireLigne(champs);
+    }
+    catch (...) //attraper une erreur si elle survient
+    {
+        throw std::logic_error("erreur logique ajouterArretsDesVoyagesDeLaDate, ligne 1");
+    }
+
+    //chaque thread lit une plage de lignes et produit ses arrêts dans l'ordre du fichier; les voyages et les stations
+    //ne sont que consultés durant la lecture, ce qui peut se faire simultanément
+    std::vector<PlageCSV> plages = lecteur.decouper(m_nbThreadsChargement);
+    std::vector<std::vector<ArretLu> > arretsLus(plages.size());
+    std::vector<std::exception_ptr> erreurs(plages.size());
+    auto lirePlage = [this, &plages, &arretsLus, &erreurs](size_t p_plage)
     {
         try
         {
-            //sauter la ligne 1
-            std::string strLigne;
-            std::getline(ifFichier, strLigne);
-
-            //boucler les lignes
-
-            while (std::getline(ifFichier, strLigne))
+            std::vector<ChampCSV> champs;
+            while (plages[p_plage].lireLigne(champs))
             {
-                //enlever les guillemets
-                strLigne.erase(std::remove(strLigne.begin(), strLigne.end(), '"'), strLigne.end());
-                std::vector<std::string> vObjet = string_to_vector(strLigne, ',');
-
-                //convertir vers unsigned int p_station_id, const Heure & p_heure_arrivee, const Heure & p_heure_depart,unsigned int p_numero_sequence, const std::string & p_voyage_id
-
-                //convertion de la partie heure du vecteur en heures
-                Heure heureArrive({
-                                          (unsigned int) std::stoul(vObjet[1].substr(0, 2)),
-                                          (unsigned int) std::stoul(vObjet[1].substr(3, 2)),
-                                          (unsigned int) std::stoul(vObjet[1].substr(6, 2))
-                                  });
-                Heure heureDepart({
-                                          (unsigned int) std::stoul(vObjet[2].substr(0, 2)),
-                                          (unsigned int) std::stoul(vObjet[2].substr(3, 2)),
-                                          (unsigned int) std::stoul(vObjet[2].substr(6, 2))
-                                  });
+                //convertir vers unsigned int p_station_id, const Heure & p_heure_arrivee, const Heure & p_heure_depart,unsigned int p_numero_sequence, unsigned int p_voyage_id
+                Heure heureArrive = champs.at(1).versHeure();
+                Heure heureDepart = champs.at(2).versHeure();
 
                 //si la bus passe avant que la personne soit partie et si la but part après l'arrivée
-                if (heureDepart >= m_now1 && heureArrive < m_now2 &&
-                    m_voyages.find(vObjet[0]) != m_voyages.end())//si service_id existe
+                if (heureDepart >= m_now1 && heureArrive < m_now2)
                 {
-                    //Ajouter les arrets aux voyages
-                    Arret::Ptr a_ptr = make_shared<Arret>(std::stoul(vObjet[3]), heureArrive, heureDepart,
-                                                          std::stoul(vObjet[4]),
-                                                          vObjet[0]);
-                    m_voyages[vObjet[0]].ajouterArret(a_ptr);
-
-                    //ajouter les arrets aux stations
-                    std::map<unsigned int, Station>::iterator itrStation = m_stations.find(std::stoul(vObjet[3]));
-                    if (m_stations.end() != itrStation)
+                    //seuls les trip_id des voyages de la date sont internés
+                    unsigned int voyageId = m_idsVoyages.chercher(champs.at(0));
+                    std::map<unsigned int, Voyage>::iterator itrVoyage = m_voyages.find(voyageId);
+                    if (itrVoyage != m_voyages.end())//si service_id existe
                     {
-                        itrStation->second.addArret(a_ptr);
+                        unsigned int stationId = champs.at(3).versEntier();
+                        arretsLus[p_plage].push_back({itrVoyage, m_stations.find(stationId),
+                                                      make_shared<Arret>(stationId, heureArrive, heureDepart,
+                                                                         champs.at(4).versEntier(), voyageId)});
                     }
-                    m_nbArrets++;
                 }
-
             }
+        }
+        catch (...) //l'erreur est relancée par le thread principal
+        {
+            erreurs[p_plage] = std::current_exception();
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < plages.size(); ++i) threads.push_back(std::thread(lirePlage, i));
+    if (!plages.empty()) lirePlage(0);
+    for (std::thread &t : threads) t.join();
 
-            //boucle les voyages pour enlever les voyages sans arrets
-            std::map<std::string, Voyage>::iterator itrVoyage = m_voyages.begin();
-            while (itrVoyage != m_voyages.end())
-            {
-                unsigned int uiArrets = itrVoyage->second.getNbArrets();
-
-                if (uiArrets > 0)// voyage ayant un arrêt; passer au suivant
-                {
-                    itrVoyage++;
-                }
-                else // voyage n'ayant pas d'arrêt; effacer
-                {
+    for (size_t i = 0; i < plages.size(); ++i)
+    {
+        if (!erreurs[i]) continue;
+        std::string message = "erreur logique ajouterArretsDesVoyagesDeLaDate, ligne " +
+                              std::to_string(plages[i].getNumeroLigne()) + " de la plage " + std::to_string(i);
+        try
+        {
+            std::rethrow_exception(erreurs[i]);
+        }
+        catch (const std::exception &e)
+        {
+            throw std::logic_error(message + ": " + e.what());
+        }
+    }
 
-                    itrVoyage = m_voyages.erase(itrVoyage);
-                }
-            }
+    //fusionner les plages dans l'ordre du fichier: voyages et stations reçoivent leurs arrêts dans le même ordre
+    //qu'avec une lecture séquentielle, ce qui donne le même résultat quel que soit le nombre de threads
+    for (const std::vector<ArretLu> &arrets : arretsLus)
+    {
+        for (const ArretLu &arretLu : arrets)
+        {
+            //Ajouter les arrets aux voyages
+            arretLu.voyage->second.ajouterArret(arretLu.arret);
 
-            //boucle dans les stations pour effacer les stations sans arrêt
-            std::map<unsigned int, Station>::iterator itrStation = m_stations.begin();
-            while (itrStation != m_stations.end())
+            //ajouter les arrets aux stations
+            if (m_stations.end() != arretLu.station)
             {
-                if (itrStation->second.getNbArrets() == 0)// station sans arrêt; effacer
-                {
-                    itrStation = m_stations.erase(itrStation);
-                }
-                else // station avec arrêt; passer au suivant
-                {
-                    ++itrStation;
-                }
+                arretLu.station->second.addArret(arretLu.arret);
             }
-            // tous les arrêts sont présents maintenant!
-            m_tousLesArretsPresents = true;
+            m_nbArrets++;
+        }
+    }
+
+    enleverVoyagesEtStationsSansArrets();
+}
 
-            ifFichier.close();
+//! \brief enlève les voyages et les stations qui n'ont pas d'arrêt dans l'intervalle de temps du GTFS
+//! \post assigne m_tousLesArretsPresents à true
+void DonneesGTFS::enleverVoyagesEtStationsSansArrets()
+{
+    //boucle les voyages pour enlever les voyages sans arrets
+    std::map<unsigned int, Voyage>::iterator itrVoyage = m_voyages.begin();
+    while (itrVoyage != m_voyages.end())
+    {
+        unsigned int uiArrets = itrVoyage->second.getNbArrets();
+
+        if (uiArrets > 0)// voyage ayant un arrêt; passer au suivant
+        {
+            itrVoyage++;
         }
-        catch (...) //attraper une erreur si elle survient
+        else // voyage n'ayant pas d'arrêt; effacer
         {
-            throw std::logic_error("erreur logique ajouterArretsDesVoyagesDeLaDate");
+
+            itrVoyage = m_voyages.erase(itrVoyage);
         }
     }
-    else
+
+    //boucle dans les stations pour effacer les stations sans arrêt
+    std::map<unsigned int, Station>::iterator itrStation = m_stations.begin();
+    while (itrStation != m_stations.end())
     {
-        throw std::logic_error("le fichier n'a pas pu ouvrir");
+        if (itrStation->second.getNbArrets() == 0)// station sans arrêt; effacer
+        {
+            itrStation = m_stations.erase(itrStation);
+        }
+        else // station avec arrêt; passer au suivant
+        {
+            ++itrStation;
+        }
     }
+    // tous les arrêts sont présents maintenant!
+    m_tousLesArretsPresents = true;
+}
+
+//! \brief libère les objets Arret des voyages et des stations, une fois construites les structures qui s'en servent
+//! \brief Un ReseauGTFS, un RouteurCSA ou un RouteurRaptor garde ses arrêts en colonnes (TableArrets): l'objet ne
+//! \brief sert ensuite qu'aux lignes, stations, voyages et transferts, et aux heures de son intervalle. Le nombre
+//! \brief d'arrêts (getNbArrets()) est conservé. Aucune de ces structures ne peut plus être construite à partir de
+//! \brief l'objet, et son intervalle ne peut plus être avancé.
+void DonneesGTFS::libererArrets()
+{
+    for (auto &voyage : m_voyages) voyage.second.viderArrets();
+    for (auto &station : m_stations) station.second.viderArrets();
+    m_arretsLiberes = true;
+#ifdef __GLIBC__
+    malloc_trim(0); //les arrêts sont de petits blocs: sans cela, glibc garde leurs pages dans le tas du processus
+#endif
+}
+
+//! \brief indique si libererArrets() a été appelée
+bool DonneesGTFS::getArretsLiberes() const
+{
+    return m_arretsLiberes;
 }
 
 unsigned int DonneesGTFS::getNbArrets() const
@@ -528,8 +676,7 @@ void DonneesGTFS::afficherArretsParStations() const
         std::cout << "Station " << stationM.second << endl;
         for ( const auto & arretM : stationM.second.getArrets())
         {
-            string voyage_id = arretM.second->getVoyageId();
-            auto v_itr = m_voyages.find(voyage_id);
+            auto v_itr = m_voyages.find(arretM.second->getVoyageId());
             unsigned int ligne_id = (v_itr->second).getLigne();
             auto l_itr = m_lignes.find(ligne_id);
             std::cout << arretM.first << " - " << (l_itr->second).getNumero() << " " << v_itr->second << std::endl;
@@ -538,11 +685,36 @@ void DonneesGTFS::afficherArretsParStations() const
     std::cout << std::endl;
 }
 
-const std::map<std::string, Voyage> &DonneesGTFS::getVoyages() const
+const std::map<unsigned int, Voyage> &DonneesGTFS::getVoyages() const
 {
     return m_voyages;
 }
 
+//! \brief la table qui donne le trip_id de chaque numéro interné (clé de getVoyages(), Voyage::getId(), Arret::getVoyageId())
+const Identifiants &DonneesGTFS::getIdsVoyages() const
+{
+    return m_idsVoyages;
+}
+
+//! \brief l'agency_timezone du réseau (vide si ajouterAgences() n'a pas été appelée)
+const std::string &DonneesGTFS::getFuseauHoraire() const
+{
+    return m_fuseauHoraire;
+}
+
+//! \brief l'heure POSIX où commencent les heures GTFS de la date, dans le fuseau de l'agence (voir
+//! \brief Date::debutJourneeService()); 0 si ajouterAgences() n'a pas été appelée
+long long DonneesGTFS::getDebutJourneeService() const
+{
+    return m_debutJourneeService;
+}
+
+//! \brief la table qui donne le service_id de chaque numéro interné (Voyage::getServiceId())
+const Identifiants &DonneesGTFS::getIdsServices() const
+{
+    return m_idsServices;
+}
+
 const std::map<unsigned int, Station> &DonneesGTFS::getStations() const
 {
     return m_stations;
@@ -553,6 +725,11 @@ const std::vector<std::tuple<unsigned int, unsigned int, unsigned int> > &Donnee
     return m_transferts;
 }
 
+const Date &DonneesGTFS::getDate() const
+{
+    return m_date;
+}
+
 Heure DonneesGTFS::getTempsFin() const
 {
     return m_now2;
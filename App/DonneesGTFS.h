@@ -20,19 +20,28 @@
 #include "voyage.h"
 #include "arret.h"
 #include "coordonnees.h"
+#include "identifiants.h"
+#include "fluxgtfs.h"
 
 class DonneesGTFS
 {
 
 public:
     DonneesGTFS(const Date&, const Heure&, const Heure&);
+    DonneesGTFS(const FluxGTFS&, const Date&, const Heure&, const Heure&, bool = false);
 
+    void ajouterAgences(const std::string &);
     void ajouterLignes(const std::string &);
     void ajouterStations(const std::string &);
     void ajouterServices(const std::string &);
     void ajouterVoyagesDeLaDate(const std::string &);
     void ajouterArretsDesVoyagesDeLaDate(const std::string&);
     void ajouterTransferts(const std::string&);
+    void avancerIntervalle(const FluxGTFS&, const Heure&, const Heure&, std::vector<Arret::Ptr>&);
+    void libererArrets();
+    bool getArretsLiberes() const;
+    void setNbThreadsChargement(unsigned int);
+    unsigned int getNbThreadsChargement() const;
 
     void afficherLignes() const;
     void afficherStations() const;
@@ -40,6 +49,9 @@ public:
     void afficherArretsParStations() const;
     void afficherTransferts() const;
 
+    const Date &getDate() const;
+    const std::string &getFuseauHoraire() const;
+    long long getDebutJourneeService() const;
     Heure getTempsDebut() const;
     Heure getTempsFin() const;
     size_t getNbLignes() const;
@@ -48,30 +60,51 @@ public:
     size_t getNbServices() const;
     size_t getNbVoyages() const;
     size_t getNbTransferts() const;
-    const std::map<std::string, Voyage> & getVoyages() const;
+    const std::map<unsigned int, Voyage> & getVoyages() const;
+    const Identifiants & getIdsVoyages() const;
+    const Identifiants & getIdsServices() const;
     const std::map<unsigned int, Station> & getStations() const;
     const std::unordered_map<unsigned int, Ligne> & getLignes() const;
     const std::vector<std::tuple<unsigned int, unsigned int, unsigned int> > & getTransferts() const;
 
 private:
 
-    std::vector<std::string> string_to_vector(const std::string &s, char delim);
+    //! \brief un arrêt lu dans stop_times.txt, en attente d'être ajouté à son voyage et à sa station
+    struct ArretLu
+    {
+        std::map<unsigned int, Voyage>::iterator voyage;
+        std::map<unsigned int, Station>::iterator station; //m_stations.end() si la station est inconnue
+        Arret::Ptr arret;
+    };
 
     Date m_date; //la date d'intérêt
     Heure m_now1;  //l'heure de début d'intérêt (à partir de laquelle on considère les arrêts)
     Heure m_now2;  //l'heure de fin d'intérêt (à partir de laquelle on ne considère plus les arrêts
+    std::string m_fuseauHoraire; //l'agency_timezone du réseau (vide si agency.txt n'a pas été lu)
+    long long m_debutJourneeService; //l'heure POSIX où commencent les heures GTFS de m_date, calculée au chargement
 
     unsigned int m_nbArrets; //le nombre d'arrets au total présents dans cet objet
     bool m_tousLesArretsPresents; //indique si tous les arrêts de la date et de l'intervalle [now1, now2) ont été ajoutés
+    bool m_construitDuFlux; //indique si l'objet a été tiré d'un FluxGTFS plutôt que lu fichier par fichier
+    bool m_joursVoisins; //indique si les voyages de la veille et du lendemain ont été tirés du flux
+    bool m_arretsLiberes; //indique si les objets Arret ont été libérés (libererArrets())
+    unsigned int m_nbThreadsChargement; //le nombre de threads qui lisent stop_times.txt
 
 
     std::unordered_map<unsigned int, Ligne> m_lignes; //la clé unsigned int est l'identifiant m_id de l'objet Ligne
     std::map<unsigned int, Station> m_stations; //la clé unsigned int est l'identifiant m_id de l'objet Station
-    std::unordered_set<std::string> m_services; //le string est l'identifiant du service (service_id)
-    std::map<std::string, Voyage> m_voyages; //le string est l'identifiant (trip_id) de l'objet Voyage
+    Identifiants m_idsServices; //les service_id internés
+    Identifiants m_idsVoyages; //les trip_id internés (seulement ceux des voyages de la date, et des jours voisins)
+    std::unordered_set<unsigned int> m_services; //les service_id internés des services de la date
+    std::map<unsigned int, Voyage> m_voyages; //la clé est le trip_id interné (m_id de l'objet Voyage)
     std::vector<std::tuple<unsigned int, unsigned int, unsigned int> > m_transferts; // <from_station_id, to_station_id, transfer_time>
     std::multimap<std::string, Ligne> m_lignes_par_numero; //le string est l'attribut m_numero de l'objet ligne
 
+    void enleverVoyagesEtStationsSansArrets();
+    std::vector<int> joursDuFlux() const;
+    void ajouterArretsDuFlux(const FluxGTFS &, int, int, std::vector<Arret::Ptr> &);
+    void ajouterTransfertsDuFlux(const FluxGTFS &);
+
 };
 
 #endif //TP1_GTFS_H
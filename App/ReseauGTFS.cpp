@@ -3,10 +3,98 @@
 //
 
 #include "ReseauGTFS.h"
+#include "reperes.h"
+#include "metriques.h"
 #include <sys/time.h>
+#include <functional>
+#include <chrono>
+#include <ctime>
 
 using namespace std;
 
+constexpr double ReseauGTFS::vitesseDeMarche;
+constexpr double ReseauGTFS::distanceMaxMarche;
+const unsigned int ReseauGTFS::stationIdOrigine;
+const unsigned int ReseauGTFS::stationIdDestination;
+
+namespace
+{
+    //! \brief l'histogramme des durées de la phase de construction p_phase du réseau
+    Histogramme &dureeConstruction(const char *p_phase)
+    {
+        return Metriques::globales().histogramme("reseau_construction_secondes",
+                                                 "Durée des phases de construction de ReseauGTFS, en secondes",
+                                                 Histogramme::seuilsDurees(), {{"phase", p_phase}});
+    }
+
+    //! \brief les arrêts d'une TableArrets, nommés par l'objet DonneesGTFS à partir duquel elle a été construite
+    class VueTable : public VueArrets
+    {
+    public:
+        VueTable(const DonneesGTFS &p_gtfs, const TableArrets &p_table) : m_gtfs(p_gtfs), m_table(p_table) {}
+
+        size_t getNbArrets() const override { return m_table.getNbArrets(); }
+        unsigned int getStation(size_t p_arret) const override { return m_table.getStation(p_arret); }
+        unsigned int getVoyage(size_t p_arret) const override { return m_table.getVoyage(p_arret); }
+        unsigned int getArrivee(size_t p_arret) const override { return m_table.getArrivee(p_arret); }
+        std::string getNumeroLigne(size_t p_arret) const override
+        {
+            return m_gtfs.getLignes().at(voyage(p_arret).getLigne()).getNumero();
+        }
+        void afficherStation(std::ostream &p_flux, size_t p_arret) const override
+        {
+            p_flux << m_gtfs.getStations().at(m_table.getStationId(m_table.getStation(p_arret)));
+        }
+        void afficherVoyage(std::ostream &p_flux, size_t p_arret) const override { p_flux << voyage(p_arret); }
+
+    private:
+        const Voyage &voyage(size_t p_arret) const
+        {
+            return m_gtfs.getVoyages().at(m_table.getIdVoyage(m_table.getVoyage(p_arret)));
+        }
+
+        const DonneesGTFS &m_gtfs;
+        const TableArrets &m_table;
+    };
+
+    //! \brief les métriques des requêtes d'itinéraire, obtenues une fois du registre
+    struct MetriquesRequetes
+    {
+        MetriquesRequetes()
+                : nbRequetes(Metriques::globales().compteur("requete_total", "Nombre de requêtes d'itinéraire")),
+                  nbSansChemin(Metriques::globales().compteur("requete_sans_chemin_total",
+                                                              "Nombre de requêtes dont la destination est inatteignable")),
+                  surcouche(Metriques::globales().histogramme(
+                          "requete_surcouche_secondes", "Durée de la construction des arcs origine et destination",
+                          Histogramme::seuilsDurees())),
+                  recherche(Metriques::globales().histogramme(
+                          "requete_recherche_secondes", "Durée de la recherche de plus court chemin",
+                          Histogramme::seuilsDurees())),
+                  sommetsFixes(Metriques::globales().histogramme(
+                          "requete_sommets_fixes", "Nombre de sommets dont la distance a été fixée",
+                          Histogramme::seuilsTailles())),
+                  arcsRelaxes(Metriques::globales().histogramme(
+                          "requete_arcs_relaxes", "Nombre d'arcs examinés", Histogramme::seuilsTailles())),
+                  insertions(Metriques::globales().histogramme(
+                          "requete_insertions_tas", "Nombre d'insertions dans la file de priorité",
+                          Histogramme::seuilsTailles())),
+                  longueurChemin(Metriques::globales().histogramme(
+                          "requete_longueur_chemin", "Nombre de sommets du chemin trouvé (origine et destination comprises)",
+                          Histogramme::seuilsTailles()))
+        {
+        }
+
+        Compteur &nbRequetes;
+        Compteur &nbSansChemin;
+        Histogramme &surcouche;
+        Histogramme &recherche;
+        Histogramme &sommetsFixes;
+        Histogramme &arcsRelaxes;
+        Histogramme &insertions;
+        Histogramme &longueurChemin;
+    };
+}
+
 //détermine le temps d'exécution (en microseconde) entre tv2 et tv2
 long tempsExecution(const timeval &tv1, const timeval &tv2)
 {
@@ -18,377 +106,794 @@ long tempsExecution(const timeval &tv1, const timeval &tv2)
     return dtms;
 }
 
-size_t ReseauGTFS::getNbArcsOrigineVersStations() const
+double ReseauGTFS::getDistMaxMarche() const
 {
-    return m_nbArcsOrigineVersStations;
+    return distanceMaxMarche;
 }
 
-size_t ReseauGTFS::getNbArcsStationsVersDestination() const
+//! \brief retourne le nombre de sommets du graphe (sans les points origine et destination d'une requête)
+size_t ReseauGTFS::getNbSommets() const
 {
-    return m_nbArcsStationsVersDestination;
+    return m_leGraphe.getNbSommets();
 }
 
-double ReseauGTFS::getDistMaxMarche() const
+//! \brief le graphe du réseau, figé et sans arcs origine/destination
+const Graphe &ReseauGTFS::getGraphe() const
 {
-    return distanceMaxMarche;
+    return m_leGraphe;
+}
+
+//! \brief le graphe transposé de getGraphe(), pour les recherches à rebours et bidirectionnelles
+const Graphe &ReseauGTFS::getGrapheInverse() const
+{
+    return m_grapheInverse;
+}
+
+//! \brief la table des arrêts; l'arrêt i de la table est le sommet i du graphe
+const TableArrets &ReseauGTFS::getTable() const
+{
+    return m_table;
 }
 
 //! \brief construit le réseau GTFS à partir des données GTFS
 //! \param[in] Un objet DonneesGTFS
 //! \post constuit un réseau GTFS représenté par un graphe orienté pondéré avec poids non négatifs
-//! \post initialise la variable m_origine_dest_ajoute à false car les points origine et destination ne font pas parti du graphe
-//! \post insère les données requises dans m_arretDuSommet et m_sommetDeArret et construit le graphe m_leGraphe
+//! \post le sommet i du graphe est l'arrêt i de m_table (voyage par voyage, selon le numéro de séquence)
+//! \post les arcs du graphe sont figés en format CSR; le graphe n'est plus modifié par la suite
 ReseauGTFS::ReseauGTFS(const DonneesGTFS &p_gtfs)
-: m_leGraphe(p_gtfs.getNbArrets()), m_origine_dest_ajoute(false)
+: m_leGraphe(p_gtfs.getNbArrets()), m_table(p_gtfs), m_retardsAppliques(false), m_vitesseMax(vitesseDeMarche)
 {
     //Le graphe possède p_gtfs.getNbArrets() sommets, mais il n'a pas encore d'arcs
-    ajouterArcsVoyages(p_gtfs);
-    ajouterArcsAttentes(p_gtfs);
-    ajouterArcsTransferts(p_gtfs);
+    auto debut = chrono::steady_clock::now();
+    auto mesurer = [&debut](double &p_duree)
+    {
+        auto fin = chrono::steady_clock::now();
+        p_duree = chrono::duration<double>(fin - debut).count();
+        debut = fin;
+    };
+    ajouterArcsVoyages();
+    mesurer(m_durees.arcsVoyages);
+    ajouterArcsAttentes();
+    mesurer(m_durees.arcsAttentes);
+    ajouterArcsTransferts();
+    mesurer(m_durees.arcsTransferts);
+    m_leGraphe.figer();
+    mesurer(m_durees.figer);
+    m_grapheInverse = m_leGraphe.inverser();
+    mesurer(m_durees.inverser);
+    calculerVitesseMax();
+
+    dureeConstruction("arcs_voyages").observer(m_durees.arcsVoyages);
+    dureeConstruction("arcs_attentes").observer(m_durees.arcsAttentes);
+    dureeConstruction("arcs_transferts").observer(m_durees.arcsTransferts);
+    dureeConstruction("figer").observer(m_durees.figer);
+    dureeConstruction("inverser").observer(m_durees.inverser);
 }
 
-//! \brief ajout des arcs dus aux voyages
-//! \brief insère les arrêts (associés aux sommets) dans m_arretDuSommet et m_sommetDeArret
-//! \throws logic_error si une incohérence est détecté lors de cette étape de construction du graphe
-void ReseauGTFS::ajouterArcsVoyages(const DonneesGTFS & p_gtfs)
+//! \brief la durée de chaque phase du constructeur (celle de la table des arrêts n'y est pas)
+const DureesConstruction &ReseauGTFS::getDureesConstruction() const
 {
-    try
-    {
-        //chercher les voyages
-        const map <string, Voyage> voyages = p_gtfs.getVoyages();
+    return m_durees;
+}
+
+//! \brief la plus grande vitesse, en km/h, à laquelle un arc du graphe fait passer d'une station à une autre (à vol
+//! \brief d'oiseau), ou la vitesse de marche si elle est plus grande; infinie si un arc de poids nul relie deux stations
+double ReseauGTFS::getVitesseMax() const
+{
+    return m_vitesseMax;
+}
 
-        //conserver une position dans le graphe du sommet
-        long position = 0;
-        for (auto itrVoyage = voyages.begin(); itrVoyage != voyages.end(); ++itrVoyage)
+//! \brief calcule m_vitesseMax à partir des arcs du graphe; une petite marge couvre les erreurs d'arrondi des distances
+void ReseauGTFS::calculerVitesseMax()
+{
+    m_vitesseMax = vitesseDeMarche;
+    const size_t *debutArcs = m_leGraphe.getDebutArcsFiges();
+    const Graphe::ArcFige *arcs = m_leGraphe.getArcsFiges();
+    for (size_t a = 0; a < m_leGraphe.getNbSommetsFiges(); ++a)
+    {
+        const unsigned int station = m_table.getStation(a);
+        for (size_t k = debutArcs[a]; k < debutArcs[a + 1]; ++k)
         {
-            //conserver un pointeur vers le precedent pour faire un lien
-            auto itrArretPrecedent = itrVoyage->second.getArrets().begin();
-            for (auto itrArret = itrVoyage->second.getArrets().begin();
-                 itrArret != itrVoyage->second.getArrets().end(); ++itrArret)
+            const unsigned int autre = m_table.getStation(arcs[k].destination);
+            if (autre == station) continue;
+            double distance = abs(m_table.getCoords(station) - m_table.getCoords(autre));
+            if (!(distance > 0)) continue;
+            if (arcs[k].poids == 0)
             {
-                //ajouter les arrets dans les tableaux de conversion du graphe
-                m_arretDuSommet.push_back(*itrArret);
-                m_sommetDeArret.insert({*itrArret, position});
-
-                //si l'arret n'est pas le premier
-                if (itrArret != itrArretPrecedent)
-                {
-                    //chercher le sommet des deux arrets
-                    auto depart = m_sommetDeArret.find(*itrArretPrecedent);
-                    auto arrivee = m_sommetDeArret.find(*itrArret);
-
-                    //calculer le temps
-                    int temps = itrArret->get()->getHeureArrivee() - itrArretPrecedent->get()->getHeureDepart();
-
-                    if(temps<0)
-                        throw logic_error("arc negatif");
-
-                    //ajouter un arc entre les deux arrets
-                    m_leGraphe.ajouterArc(depart->second,
-                                          arrivee->second,
-                                          temps);
-
-                    //inscrementer le precedent
-                    ++itrArretPrecedent;
-                }
-
-                ++position;
+                m_vitesseMax = numeric_limits<double>::infinity();
+                return;
             }
+            m_vitesseMax = max(m_vitesseMax, distance / arcs[k].poids * 3600);
         }
     }
-    catch(...)
-    {
-        throw logic_error("Une erreur s'est produite dans ajouterArcVoyages");
-    }
+    m_vitesseMax *= 1.000001;
 }
 
-//! \brief ajout des arcs dus aux attentes à chaque station
-//! \throws logic_error si une incohérence est détecté lors de cette étape de construction du graphe
-void ReseauGTFS::ajouterArcsAttentes(const DonneesGTFS & p_gtfs)
+//! \brief Recherche A* de l'origine à la destination de p_surcouche, orientée par la distance à vol d'oiseau
+//! \brief L'heuristique d'un arrêt est la distance de sa station au point destination parcourue à getVitesseMax():
+//! \brief aucun arc n'est plus rapide et la marche finale est plus lente, elle est donc cohérente et le résultat est
+//! \brief celui de Graphe::plusCourtChemin(). Elle est calculée au besoin, une fois par station et par requête.
+//! \param[in] p_surcouche: construite par construireSurcouche() avec p_pointDestination
+//! \param[in] p_pointDestination: le point destination de la requête
+//! \param[out] p_chemin: le chemin, comme pour Graphe::plusCourtChemin()
+//! \param[in,out] p_espace: l'espace de travail de la recherche; contient les compteurs au retour
+//! \return la durée du trajet en secondes (= numeric_limits<unsigned int>::max() si la destination n'est pas atteignable)
+unsigned int ReseauGTFS::plusCourtCheminGeographique(const Graphe::Surcouche &p_surcouche,
+                                                     const Coordonnees &p_pointDestination, vector<size_t> &p_chemin,
+                                                     EspaceRecherche &p_espace) const
 {
-    try
+    const unsigned int inconnue = numeric_limits<unsigned int>::max();
+    const double secondesParKm = 3600 / m_vitesseMax;
+    vector<unsigned int> bornes(m_table.getNbStations(), inconnue);
+    Graphe::Heuristique heuristique = [this, &bornes, &p_pointDestination, secondesParKm](size_t p_sommet)
     {
-        //pour toutes les stations
-        for (auto itrStation = p_gtfs.getStations().begin(); itrStation != p_gtfs.getStations().end(); ++itrStation)
+        const unsigned int station = m_table.getStation(p_sommet);
+        if (bornes[station] == inconnue)
         {
+            double distance = abs(m_table.getCoords(station) - p_pointDestination);
+            bornes[station] = distance > 0 ? (unsigned int) (distance * secondesParKm) : 0;
+        }
+        return bornes[station];
+    };
+    return m_leGraphe.plusCourtCheminAStar(p_surcouche, heuristique, p_chemin, p_espace);
+}
 
-            auto itrArretPrecedent = itrStation->second.getArrets().begin();
-            //pour tous les arrets
-            for (auto itrArret = itrStation->second.getArrets().begin();
-                 itrArret != itrStation->second.getArrets().end(); ++itrArret)
-            {
-                //si ce n'est pas le premier et si le voyage n'est pas identique
-                if (itrArret != itrArretPrecedent
-                    && itrArret->second.get()->getVoyageId()!=itrArretPrecedent->second.get()->getVoyageId())
-                {
-                    //chercher le sommet des deux arrets
-                    auto depart = m_sommetDeArret.find(itrArretPrecedent->second);
-                    auto arrivee = m_sommetDeArret.find(itrArret->second);
+//! \brief Recherche A* de l'origine à la destination de p_surcouche, orientée par les repères ALT de p_reperes
+//! \brief L'heuristique d'un arrêt est la borne de sa station vers les stations d'arrivée de p_surcouche (avec leur
+//! \brief marche); elle est cohérente et le résultat est celui de Graphe::plusCourtChemin(). Elle est calculée au
+//! \brief besoin, une fois par station et par requête.
+//! \param[in] p_reperes: calculés sur ce réseau (après ses derniers retards)
+//! \param[in] p_surcouche: construite par construireSurcouche()
+//! \param[out] p_chemin: le chemin, comme pour Graphe::plusCourtChemin()
+//! \param[in,out] p_espace: l'espace de travail de la recherche; contient les compteurs au retour
+//! \return la durée du trajet en secondes (= numeric_limits<unsigned int>::max() si la destination n'est pas atteignable)
+//! \throws logic_error si p_reperes n'a pas été calculé pour les stations de ce réseau
+unsigned int ReseauGTFS::plusCourtCheminReperes(const Reperes &p_reperes, const Graphe::Surcouche &p_surcouche,
+                                                vector<size_t> &p_chemin, EspaceRecherche &p_espace) const
+{
+    if (p_reperes.getNbStations() != m_table.getNbStations())
+        throw logic_error("ReseauGTFS::plusCourtCheminReperes(): les repères ont été calculés pour un autre réseau");
 
-                    //calculer le temps
-                    int temps = itrArret->second.get()->getHeureArrivee() - itrArretPrecedent->second.get()->getHeureArrivee();
+    //les arcs vers la destination sont regroupés par station et ont tous la marche de leur station
+    vector<pair<unsigned int, unsigned int> > arrivees;
+    for (const auto &arc : p_surcouche.arrivees)
+    {
+        const unsigned int station = m_table.getStation(arc.first);
+        if (arrivees.empty() || arrivees.back().first != station) arrivees.push_back(make_pair(station, arc.second));
+        else arrivees.back().second = min(arrivees.back().second, arc.second);
+    }
+    Reperes::Cible cible;
+    p_reperes.preparerCible(arrivees, cible);
 
-                    if(temps<0)
-                        throw logic_error("arc negatif");
+    const unsigned int inconnue = numeric_limits<unsigned int>::max();
+    vector<unsigned int> bornes(m_table.getNbStations(), inconnue);
+    Graphe::Heuristique heuristique = [this, &bornes, &p_reperes, &cible](size_t p_sommet)
+    {
+        const unsigned int station = m_table.getStation(p_sommet);
+        if (bornes[station] == inconnue) bornes[station] = p_reperes.borne(station, cible);
+        return bornes[station];
+    };
+    return m_leGraphe.plusCourtCheminAStar(p_surcouche, heuristique, p_chemin, p_espace);
+}
 
-                    //ajouter un arc entre les deux arrets
-                    m_leGraphe.ajouterArc(depart->second,
-                                          arrivee->second,
-                                          temps);
+//! \brief ajoute une requête d'itinéraire aux métriques du processus (Metriques::globales()): le compte des requêtes,
+//! \brief la durée de la construction de sa surcouche et celle de sa recherche, mesurées séparément, les compteurs
+//! \brief d'opérations de la recherche et la longueur du chemin trouvé
+//! \param[in] p_dureeSurcouche: la durée de la construction des arcs origine et destination, en secondes
+//! \param[in] p_dureeRecherche: la durée de la recherche de plus court chemin, en secondes
+//! \param[in] p_stats: les compteurs de la recherche
+//! \param[in] p_tempsDuTrajet: la durée du trajet trouvé (numeric_limits<unsigned int>::max() si inatteignable)
+//! \param[in] p_chemin: le chemin trouvé
+void ReseauGTFS::enregistrerRequete(double p_dureeSurcouche, double p_dureeRecherche,
+                                    const StatistiquesRecherche &p_stats, unsigned int p_tempsDuTrajet,
+                                    const std::vector<size_t> &p_chemin)
+{
+    static MetriquesRequetes metriques;
+    metriques.nbRequetes.ajouter();
+    metriques.surcouche.observer(p_dureeSurcouche);
+    metriques.recherche.observer(p_dureeRecherche);
+    metriques.sommetsFixes.observer((double) p_stats.nbSommetsFixes);
+    metriques.arcsRelaxes.observer((double) p_stats.nbRelaxations);
+    metriques.insertions.observer((double) p_stats.nbInsertions);
+    if (p_tempsDuTrajet == numeric_limits<unsigned int>::max()) metriques.nbSansChemin.ajouter();
+    else metriques.longueurChemin.observer((double) p_chemin.size());
+}
 
-                    //ajuster le precedent
-                    itrArretPrecedent=itrArret;
-                }
-            }
+//! \brief ajout des arcs dus aux voyages: chaque arrêt est relié au suivant de son voyage
+//! \throws logic_error si une incohérence est détecté lors de cette étape de construction du graphe
+void ReseauGTFS::ajouterArcsVoyages()
+{
+    for (unsigned int v = 0; v < m_table.getNbVoyages(); ++v)
+    {
+        for (size_t a = m_table.getDebutVoyage(v) + 1; a < m_table.getDebutVoyage(v + 1); ++a)
+        {
+            //un sommet est atteint à l'heure d'arrivée de son arret, comme pour les arcs d'attente
+            if (m_table.getArrivee(a) < m_table.getArrivee(a - 1))
+                throw logic_error("ReseauGTFS::ajouterArcsVoyages(): arc negatif");
+            m_leGraphe.ajouterArc(a - 1, a, m_table.getArrivee(a) - m_table.getArrivee(a - 1));
         }
     }
-    catch(...)
+}
+
+//! \brief ajout des arcs dus aux attentes à chaque station: chaque arrêt est relié au suivant d'un autre voyage
+//! \throws logic_error si une incohérence est détecté lors de cette étape de construction du graphe
+void ReseauGTFS::ajouterArcsAttentes()
+{
+    vector<size_t> suivants;
+    suivantsAttente(m_table, suivants);
+    for (size_t arret = 0; arret < suivants.size(); ++arret)
+        if (suivants[arret] != TableArrets::aucunArret)
+            m_leGraphe.ajouterArc(arret, suivants[arret], m_table.getArrivee(suivants[arret]) - m_table.getArrivee(arret));
+}
+
+//! \brief l'arrêt que relie l'arc d'attente de chaque arrêt: le prochain arrêt de sa station qui est d'un autre voyage
+//! \brief (les arrêts d'un même voyage qui se suivent à une station sont sautés et n'ont pas d'arc d'attente)
+//! \param[out] p_suivants: p_suivants[a] est l'arrêt suivant de a (TableArrets::aucunArret s'il n'y en a pas)
+//! \throws logic_error si un arc d'attente serait négatif
+void ReseauGTFS::suivantsAttente(const TableArrets &p_table, vector<size_t> &p_suivants)
+{
+    p_suivants.assign(p_table.getNbArrets(), TableArrets::aucunArret);
+    for (unsigned int s = 0; s < p_table.getNbStations(); ++s)
+        suivantsAttenteStation(p_table, s, p_suivants);
+}
+
+//! \brief les arcs d'attente des arrêts de la station p_station, comme suivantsAttente()
+//! \param[in,out] p_suivants: seules les cases des arrêts de p_station sont écrites (aucunArret s'il n'y a pas d'arc)
+void ReseauGTFS::suivantsAttenteStation(const TableArrets &p_table, unsigned int p_station, vector<size_t> &p_suivants)
+{
+    if (p_table.getNbArretsStation(p_station) == 0) return;
+    size_t precedent = p_table.getArretStation(p_station, 0);
+    for (unsigned int rang = 1; rang < p_table.getNbArretsStation(p_station); ++rang)
     {
-        throw logic_error("Une erreur s'est produite dans ajouterArcVoyages");
+        size_t arret = p_table.getArretStation(p_station, rang);
+        p_suivants[arret] = TableArrets::aucunArret;
+        if (p_table.getVoyage(arret) == p_table.getVoyage(precedent)) continue;
+        if (p_table.getArrivee(arret) < p_table.getArrivee(precedent))
+            throw logic_error("ReseauGTFS::ajouterArcsAttentes(): arc negatif");
+        p_suivants[precedent] = arret;
+        precedent = arret;
     }
+    p_suivants[precedent] = TableArrets::aucunArret;
 }
 
-//! \brief ajouts des arcs dus aux transferts entre stations
-//! \throws logic_error si une incohérence est détecté lors de cette étape de construction du graphe
-void ReseauGTFS::ajouterArcsTransferts(const DonneesGTFS & p_gtfs)
+//! \brief ajoute à p_arcs les arcs de transfert de l'arrêt p_arret, comme ajouterArcsTransferts(): un arc vers le premier
+//! \brief arrêt de chaque station voisine qu'on peut atteindre à pieds
+void ReseauGTFS::arcsTransferts(const TableArrets &p_table, size_t p_arret, vector<Graphe::ArcFige> &p_arcs)
 {
-    try
+    unsigned int s = p_table.getStation(p_arret);
+    for (size_t k = p_table.getDebutTransferts(s); k < p_table.getDebutTransferts(s + 1); ++k)
     {
-        auto vectorTransfert = p_gtfs.getTransferts();
+        const pair<unsigned int, unsigned int> &transfert = p_table.getTransfert(k);
+        unsigned int rangArrivee = p_table.premierRangApres(transfert.first, p_table.getArrivee(p_arret) + transfert.second);
+        if (rangArrivee == p_table.getNbArretsStation(transfert.first)) continue;
+        p_arcs.push_back({(unsigned int) p_table.getArretStation(transfert.first, rangArrivee),
+                          p_table.getArriveeStation(transfert.first, rangArrivee) - p_table.getArrivee(p_arret)});
+    }
+}
 
-        for (int i = 0; i < vectorTransfert.size(); ++i) // pour tous les transferts
+//! \brief ajouts des arcs dus aux transferts entre stations: chaque arrêt de la station de départ est relié au premier
+//! \brief arrêt de la station d'arrivée qu'on peut atteindre à pieds
+void ReseauGTFS::ajouterArcsTransferts()
+{
+    for (unsigned int s = 0; s < m_table.getNbStations(); ++s)
+    {
+        for (size_t k = m_table.getDebutTransferts(s); k < m_table.getDebutTransferts(s + 1); ++k)
         {
-            //chercher les stations
-            auto itrStationDepart = p_gtfs.getStations().find(get<0>(vectorTransfert[i]));
-            auto itrStationArrivee = p_gtfs.getStations().find(get<1>(vectorTransfert[i]));
-
-            //conserver le temps de transfert
-            int tempsTransfert = get<2>(vectorTransfert[i]);
-
-            //pour tous les arrets de la station de depart
-            for (auto itrArretDepart = itrStationDepart->second.getArrets().begin();
-                 itrArretDepart != itrStationDepart->second.getArrets().end(); ++itrArretDepart)
+            const pair<unsigned int, unsigned int> &transfert = m_table.getTransfert(k);
+            for (unsigned int rang = 0; rang < m_table.getNbArretsStation(s); ++rang)
             {
-
-                //conserver l'heure
-                Heure heureDepart = itrArretDepart->second.get()->getHeureArrivee();
-                heureDepart = heureDepart.add_secondes(tempsTransfert);
-
-                //cherche la station d'arrivee avec le temps d'attente le plus bas
-                auto itrArretArrivee = itrStationArrivee->second.getArrets().lower_bound(heureDepart);
-
-                //si la station existe creer un arc.
-                if (itrArretArrivee != itrStationArrivee->second.getArrets().end())
-                {
-                    auto itrSommetDepart = m_sommetDeArret.find(itrArretDepart->second);
-                    auto itrSommetArrivee = m_sommetDeArret.find(itrArretArrivee->second);
-
-                    //calculer le temps
-                    int temps = itrArretArrivee->second.get()->getHeureArrivee() - itrArretDepart->second.get()->getHeureArrivee();
-
-                    if(temps<0)
-                        throw logic_error("arc negatif");
-
-                    //ajouter l'arc entre les arrets
-                    m_leGraphe.ajouterArc(itrSommetDepart->second, itrSommetArrivee->second,temps);
-                }
+                size_t depart = m_table.getArretStation(s, rang);
+                unsigned int rangArrivee = m_table.premierRangApres(transfert.first,
+                                                                    m_table.getArrivee(depart) + transfert.second);
+                if (rangArrivee == m_table.getNbArretsStation(transfert.first)) continue;
+                m_leGraphe.ajouterArc(depart, m_table.getArretStation(transfert.first, rangArrivee),
+                                      m_table.getArriveeStation(transfert.first, rangArrivee) - m_table.getArrivee(depart));
             }
         }
     }
-    catch(...)
-    {
-        throw logic_error("Une erreur s'est produite dans ajouterArcTransfert");
-    }
 }
 
-//! \brief ajoute des arcs au réseau GTFS à partir des données GTFS
-//! \brief Il s'agit des arcs allant du point origine vers une station si celle-ci est accessible à pieds et des arcs allant d'une station vers le point destination
-//! \param[in] p_gtfs: un objet DonneesGTFS
-//! \param[in] p_pointOrigine: les coordonnées GPS du point origine
-//! \param[in] p_pointDestination: les coordonnées GPS du point destination
-//! \throws logic_error si une incohérence est détecté lors de la construction du graphe
-//! \post constuit un réseau GTFS représenté par un graphe orienté pondéré avec poids non négatifs
-//! \post assigne la variable m_origine_dest_ajoute à true (car les points orignine et destination font parti du graphe)
-//! \post insère dans m_sommetsVersDestination les numéros de sommets connctés au point destination
-void ReseauGTFS::ajouterArcsOrigineDestination(const DonneesGTFS &p_gtfs, const Coordonnees &p_pointOrigine,
-                                               const Coordonnees &p_pointDestination)
+//! \brief avance l'intervalle du réseau sans le reconstruire, après p_gtfs.avancerIntervalle(..., p_ajoutes)
+//! \brief Les sommets des arrêts partis sont retirés et ceux des arrêts ajoutés sont placés avec les autres arrêts de
+//! \brief leur voyage; la table des arrêts est mise à jour à partir de l'ancienne, sans relire les objets Arret des
+//! \brief arrêts conservés. Les arcs sont recalculés en un seul parcours des arrêts: arcs de voyage et d'attente,
+//! \brief puis arcs de transfert (arcsTransferts(), comme le constructeur). Le résultat est celui de ReseauGTFS(p_gtfs).
+//! \param[in] p_gtfs: l'objet DonneesGTFS du réseau, dont l'intervalle vient d'être avancé
+//! \param[in] p_ajoutes: les arrêts ajoutés par DonneesGTFS::avancerIntervalle()
+//! \note le réseau ne doit servir à aucune requête pendant l'opération
+//! \throws logic_error si une incohérence est détectée ou si des retards ont été appliqués au réseau (il faut alors
+//! \throws le reconstruire, puis réappliquer les retards)
+void ReseauGTFS::avancerIntervalle(const DonneesGTFS &p_gtfs, const vector<Arret::Ptr> &p_ajoutes)
 {
-    try
+    if (m_retardsAppliques)
+        throw logic_error("ReseauGTFS::avancerIntervalle(): les heures du réseau ne sont plus celles de l'horaire");
+    vector<size_t> ancienNumero;
+    TableArrets table(p_gtfs, m_table, p_ajoutes, ancienNumero);
+    const size_t nbArrets = table.getNbArrets();
+
+    vector<size_t> suivants;
+    suivantsAttente(table, suivants);
+
+    vector<size_t> debutArcs(nbArrets + 1, 0);
+    vector<Graphe::ArcFige> arcs;
+    arcs.reserve(m_leGraphe.getNbArcs() + 3 * p_ajoutes.size());
+    for (size_t a = 0; a < nbArrets; ++a)
     {
-        m_nbArcsOrigineVersStations=0;
-        m_nbArcsStationsVersDestination=0;
-
-        Arret::Ptr arretOrigine = make_shared<Arret>(stationIdOrigine, Heure(), Heure(), 0, "origine");
-        Arret::Ptr arretDestination = make_shared<Arret>(stationIdDestination, Heure(), Heure(), 1, "destination");
-
-        m_arretDuSommet.push_back(arretOrigine);
-        m_sommetOrigine = m_sommetDeArret.size();
-        m_sommetDeArret.insert({arretOrigine, m_sommetDeArret.size()});
+        //arcs de voyage et d'attente, dans l'ordre où le constructeur les ajoute
+        if (a + 1 < nbArrets && table.getVoyage(a + 1) == table.getVoyage(a))
+        {
+            if (table.getArrivee(a + 1) < table.getArrivee(a))
+                throw logic_error("ReseauGTFS::avancerIntervalle(): arc negatif");
+            arcs.push_back({(unsigned int) (a + 1), table.getArrivee(a + 1) - table.getArrivee(a)});
+        }
+        if (suivants[a] != TableArrets::aucunArret)
+            arcs.push_back({(unsigned int) suivants[a], table.getArrivee(suivants[a]) - table.getArrivee(a)});
 
-        m_arretDuSommet.push_back(arretDestination);
-        m_sommetDestination = m_sommetDeArret.size();
-        m_sommetDeArret.insert({arretDestination, m_sommetDeArret.size()});
+        //arcs de transfert: recalculés, comme ceux du constructeur
+        arcsTransferts(table, a, arcs);
+        debutArcs[a + 1] = arcs.size();
+    }
 
-        m_leGraphe.resize(m_arretDuSommet.size());
+    m_table = std::move(table);
+    m_leGraphe = Graphe(nbArrets, std::move(debutArcs), std::move(arcs));
+    m_grapheInverse = m_leGraphe.inverser();
+    calculerVitesseMax();
+}
 
+//! \brief applique des retards en temps réel (TripUpdate de GTFS-Realtime) aux arrêts du réseau, sans le reconstruire
+//! \brief Les heures d'un voyage mis à jour sont recalculées à partir de l'horaire: la mise à jour d'un
+//! \brief voyage remplace donc ses retards précédents, et les voyages absents de p_retards gardent les leurs. Le retard
+//! \brief d'un arrêt s'applique aussi aux arrêts suivants du voyage jusqu'au prochain arrêt mis à jour; les heures
+//! \brief sont ensuite rendues non décroissantes le long du voyage et le départ n'est jamais avant l'arrivée.
+//! \brief Seuls les sommets touchés ont leurs arcs recalculés: les arrêts dont l'heure d'arrivée change (arcs de
+//! \brief voyage, d'attente et de transfert), l'arrêt qui les précède dans leur voyage (son arc de voyage change), les arrêts de
+//! \brief leurs stations (arcs d'attente) et ceux des stations qui y mènent par un transfert (arcs de transfert). Les
+//! \brief arcs des autres sommets sont recopiés tels quels. Les sommets ne changent pas: un arrêt retardé hors de
+//! \brief l'intervalle [now1, now2) y reste, et un arrêt qui n'en faisait pas partie n'est pas ajouté.
+//! \param[in] p_gtfs: l'objet DonneesGTFS qui a servi à construire le réseau (trip_id, date et fuseau horaire); ses
+//! \param[in] objets Arret peuvent avoir été libérés
+//! \param[in] p_retards: les mises à jour, dans l'ordre de leur arrivée (la dernière d'un voyage l'emporte); les
+//! \param[in] voyages et les arrêts absents du réseau sont ignorés
+//! \return le nombre d'arrêts dont les heures ont changé
+//! \note le réseau ne doit servir à aucune requête pendant l'opération; ReseauTempsReel l'applique à une copie
+//! \throws logic_error si une mise à jour donne une heure POSIX alors que le fuseau horaire de p_gtfs est inconnu
+unsigned int ReseauGTFS::appliquerRetards(const DonneesGTFS &p_gtfs, const vector<RetardVoyage> &p_retards)
+{
+    const size_t nbArrets = m_table.getNbArrets();
+    bool heuresPosix = false;
+    for (const RetardVoyage &retard : p_retards)
+        for (const RetardArret &r : retard.arrets)
+            heuresPosix = heuresPosix || r.heureArrivee != 0 || r.heureDepart != 0;
+    if (heuresPosix && p_gtfs.getFuseauHoraire().empty())
+        throw logic_error("ReseauGTFS::appliquerRetards(): une heure POSIX exige le fuseau horaire (agency.txt)");
+    //l'heure POSIX à laquelle les heures de l'horaire commencent, dans le fuseau de l'agence (pas celui de la machine);
+    //elle a été calculée au chargement de p_gtfs, ce qui évite de changer TZ pendant que des requêtes s'exécutent
+    const int64_t origine = p_gtfs.getDebutJourneeService();
+
+    //les heures de l'horaire, tant que m_table les a encore: les objets Arret de p_gtfs ont pu être libérés
+    if (m_horaire.empty())
+    {
+        m_horaire.reserve(nbArrets);
+        for (size_t a = 0; a < nbArrets; ++a) m_horaire.push_back({m_table.getArrivee(a), m_table.getDepart(a)});
+    }
 
-        //ajout des arcs à pieds entre le point source et les arrets des stations atteignables
-        Heure tempsDebut = p_gtfs.getTempsDebut();
+    //la dernière mise à jour de chaque voyage du réseau
+    vector<const RetardVoyage *> retardVoyage(m_table.getNbVoyages(), nullptr);
+    for (const RetardVoyage &retard : p_retards)
+    {
+        unsigned int id = p_gtfs.getIdsVoyages().chercher(retard.tripId);
+        unsigned int v = id == Identifiants::aucun ? TableArrets::aucunVoyage : m_table.chercherVoyage(id);
+        if (v != TableArrets::aucunVoyage) retardVoyage[v] = &retard;
+    }
 
-        //pour toutes les stations
-        for (auto itrStation = p_gtfs.getStations().begin(); itrStation != p_gtfs.getStations().end(); ++itrStation)
+    vector<char> arriveeModifiee(nbArrets, 0);
+    vector<char> stationModifiee(m_table.getNbStations(), 0);
+    unsigned int nbModifies = 0;
+    for (unsigned int v = 0; v < m_table.getNbVoyages(); ++v)
+    {
+        if (!retardVoyage[v]) continue;
+        const vector<RetardArret> &arrets = retardVoyage[v]->arrets;
+        const size_t debut = m_table.getDebutVoyage(v), fin = m_table.getDebutVoyage(v + 1);
+        size_t k = 0;
+        int64_t retardCourant = 0, arriveePrecedente = 0;
+        for (size_t a = debut; a < fin; ++a)
         {
-            //calculer la distance a marcher
-            double distanceMarche = abs(itrStation->second.getCoords()-p_pointOrigine);
-
-            //si la station n'est pas trop loin
-            if(distanceMarche <= distanceMaxMarche)
+            const int64_t arriveePrevue = m_horaire[a].first;
+            const int64_t departPrevu = m_horaire[a].second;
+            const unsigned int sequence = m_table.getSequence(a);
+            const unsigned int stationId = m_table.getStationId(m_table.getStation(a));
+
+            //les mises à jour des arrêts qui précèdent celui-ci: seul leur retard de départ est conservé (leur
+            //horaire est hors du réseau, une heure POSIX ne peut donc pas y être convertie en retard)
+            while (k < arrets.size())
             {
-                //calculer le temps de marche vers l'arret
-                int tempsMarche = round((distanceMarche/vitesseDeMarche)*3600);
-
-                //calculer l'heure d'arrivee
-                Heure heureArrivee = tempsDebut;
-                heureArrivee=heureArrivee.add_secondes(tempsMarche);
-
-                //trouver l'arret le plus proche en temps
-                auto itrArret = itrStation->second.getArrets().lower_bound(heureArrivee);
-
-                //si l'arret existe
-                if(itrArret!= itrStation->second.getArrets().end())
+                const RetardArret &r = arrets[k];
+                bool passe;
+                if (r.sequence != RetardArret::aucun) passe = r.sequence < sequence;
+                else
                 {
-
-                    //trouver son sommet
-                    auto itrSommet = m_sommetDeArret.find(itrArret->second);
-
-                    //calculer le temps du deplacement
-                    int temps = itrArret->second.get()->getHeureArrivee() - tempsDebut;
-
-                    if(temps<0)
-                        throw logic_error("arc negatif");
-
-                    //ajouter l'arc entre l'arret et l'origine
-                    m_leGraphe.ajouterArc(m_sommetOrigine, itrSommet->second, temps);
-                    ++m_nbArcsOrigineVersStations;
+                    passe = true;
+                    for (size_t b = a; b < fin && passe; ++b)
+                        passe = m_table.getStationId(m_table.getStation(b)) != r.stationId;
                 }
+                if (!passe) break;
+                if (r.aDepart && r.heureDepart == 0) retardCourant = r.retardDepart;
+                else if (!r.aDepart && r.heureArrivee == 0) retardCourant = r.retardArrivee;
+                ++k;
             }
 
-            //ajout des arcs à pieds des arrêts de certaine stations vers l'arret point destination
-
-            //calculer la distance a marcher
-            distanceMarche = abs(itrStation->second.getCoords()-p_pointDestination);
-
-            //si la station n'est pas trop loin
-            if(distanceMarche<=distanceMaxMarche)
+            int64_t retardArrivee = retardCourant, retardDepart = retardCourant;
+            if (k < arrets.size() && (arrets[k].sequence != RetardArret::aucun ? arrets[k].sequence == sequence
+                                                                                : arrets[k].stationId == stationId))
             {
-                //calculer le temps de marche vers l'arret
-                int tempsMarche = (distanceMarche/vitesseDeMarche)*3600;
-
-                //calculer l'heure d'arrivee
-                Heure heureArrivee = tempsDebut;
-                heureArrivee=heureArrivee.add_secondes(tempsMarche);
-
-                //pour tous les arrets
-                for(auto itrArret = itrStation->second.getArrets().begin(); itrArret != itrStation->second.getArrets().end();++itrArret)
-                {
-                    auto itrSommet = m_sommetDeArret.find(itrArret->second);
-
-                    m_sommetsVersDestination.push_back(itrSommet->second);
+                const RetardArret &r = arrets[k++];
+                if (r.aArrivee)
+                    retardArrivee = r.heureArrivee ? r.heureArrivee - origine - arriveePrevue : r.retardArrivee;
+                if (r.aDepart)
+                    retardDepart = r.heureDepart ? r.heureDepart - origine - departPrevu : r.retardDepart;
+                if (!r.aArrivee) retardArrivee = retardDepart;
+                if (!r.aDepart) retardDepart = retardArrivee;
+                retardCourant = retardDepart;
+            }
 
-                    //ajouter l'arc entre l'arret et la destination
-                    m_leGraphe.ajouterArc(itrSommet->second, m_sommetDestination, tempsMarche);
-                    ++m_nbArcsStationsVersDestination;
-                }
+            int64_t arrivee = max(max(arriveePrevue + retardArrivee, (int64_t) 0), arriveePrecedente);
+            int64_t depart = max(departPrevu + retardDepart, arrivee);
+            arriveePrecedente = arrivee;
+            if (arrivee == m_table.getArrivee(a) && depart == m_table.getDepart(a)) continue;
+            if (arrivee != m_table.getArrivee(a))
+            {
+                arriveeModifiee[a] = 1;
+                stationModifiee[m_table.getStation(a)] = 1;
             }
+            m_table.modifierHeures(a, (unsigned int) arrivee, (unsigned int) depart);
+            ++nbModifies;
         }
+    }
+    if (nbModifies == 0) return 0;
+    m_retardsAppliques = true;
 
-        m_origine_dest_ajoute=true;
+    //les stations dont les arrêts ont des arcs d'attente ou de transfert à recalculer
+    vector<char> stationARecalculer(stationModifiee);
+    for (unsigned int s = 0; s < m_table.getNbStations(); ++s)
+    {
+        if (stationModifiee[s]) m_table.trierStation(s);
+        for (size_t k = m_table.getDebutTransferts(s); k < m_table.getDebutTransferts(s + 1); ++k)
+            if (stationModifiee[m_table.getTransfert(k).first]) stationARecalculer[s] = 1;
     }
-    catch(...)
+    //un arrêt dont seul l'arc de voyage change a aussi tous ses arcs recalculés: son arc d'attente est donc requis
+    vector<char> stationSuivants(stationARecalculer);
+    for (size_t a = 0; a + 1 < nbArrets; ++a)
+        if (arriveeModifiee[a + 1] && m_table.getVoyage(a + 1) == m_table.getVoyage(a))
+            stationSuivants[m_table.getStation(a)] = 1;
+    vector<size_t> suivants(nbArrets, TableArrets::aucunArret);
+    for (unsigned int s = 0; s < m_table.getNbStations(); ++s)
+        if (stationSuivants[s]) suivantsAttenteStation(m_table, s, suivants);
+
+    const size_t *ancienDebutArcs = m_leGraphe.getDebutArcsFiges();
+    const Graphe::ArcFige *anciensArcs = m_leGraphe.getArcsFiges();
+    vector<size_t> debutArcs(nbArrets + 1, 0);
+    vector<Graphe::ArcFige> arcs;
+    arcs.reserve(m_leGraphe.getNbArcs());
+    for (size_t a = 0; a < nbArrets; ++a)
     {
-        throw logic_error("Une erreur s'est produite dans ajouterArcOrigineDestination");
+        bool memeVoyage = a + 1 < nbArrets && m_table.getVoyage(a + 1) == m_table.getVoyage(a);
+        if (!stationARecalculer[m_table.getStation(a)] && !(memeVoyage && arriveeModifiee[a + 1]))
+        {
+            arcs.insert(arcs.end(), anciensArcs + ancienDebutArcs[a], anciensArcs + ancienDebutArcs[a + 1]);
+        }
+        else
+        {
+            //les arcs du sommet, dans l'ordre où le constructeur les ajoute
+            if (memeVoyage)
+                arcs.push_back({(unsigned int) (a + 1), m_table.getArrivee(a + 1) - m_table.getArrivee(a)});
+            if (suivants[a] != TableArrets::aucunArret)
+                arcs.push_back({(unsigned int) suivants[a], m_table.getArrivee(suivants[a]) - m_table.getArrivee(a)});
+            arcsTransferts(m_table, a, arcs);
+        }
+        debutArcs[a + 1] = arcs.size();
     }
+
+    m_leGraphe = Graphe(nbArrets, std::move(debutArcs), std::move(arcs));
+    m_grapheInverse = m_leGraphe.inverser();
+    calculerVitesseMax();
+    return nbModifies;
 }
 
-//! \brief Remet ReseauGTFS dans l'était qu'il était avant l'exécution de ReseauGTFS::ajouterArcsOrigineDestination()
+//! \brief construit la surcouche d'une requête: les arcs allant du point origine vers une station si celle-ci est
+//! \brief accessible à pieds et les arcs allant d'une station accessible à pieds vers le point destination
+//! \brief Le point origine est le sommet getNbSommets() et le point destination le sommet getNbSommets() + 1;
+//! \brief le réseau n'est pas modifié.
 //! \param[in] p_gtfs: un objet DonneesGTFS
-//! \throws logic_error si une incohérence est détecté lors de la modification du graphe
-//! \post Enlève de ReaseauGTFS tous les arcs allant du point source vers un arrêt de station et ceux allant d'un arrêt de station vers la destination
-//! \post assigne la variable m_origine_dest_ajoute à false (les points orignine et destination sont enlevés du graphe)
-//! \post enlève les données de m_sommetsVersDestination
-void ReseauGTFS::enleverArcsOrigineDestination()
+//! \param[in] p_pointOrigine: les coordonnées GPS du point origine
+//! \param[in] p_pointDestination: les coordonnées GPS du point destination
+//! \param[out] p_surcouche: les arcs origine/destination (ses tampons sont réutilisés)
+void ReseauGTFS::construireSurcouche(const DonneesGTFS &p_gtfs, const Coordonnees &p_pointOrigine,
+                                     const Coordonnees &p_pointDestination, Graphe::Surcouche &p_surcouche) const
+{
+    construireSurcouche(p_gtfs, p_pointOrigine, p_pointDestination, TableArrets::enSecondes(p_gtfs.getTempsDebut()),
+                        p_surcouche);
+}
+
+//! \brief Identique à construireSurcouche(p_gtfs, p_pointOrigine, p_pointDestination, p_surcouche), mais en partant
+//! \brief du point origine à p_heureDepart plutôt qu'au début de l'intervalle; les distances de la recherche sont
+//! \brief alors comptées à partir de p_heureDepart.
+//! \param[in] p_heureDepart: l'heure de départ, en secondes depuis minuit, dans [getTempsDebut(), getTempsFin())
+//! \throws logic_error si p_heureDepart est hors de l'intervalle de p_gtfs
+void ReseauGTFS::construireSurcouche(const DonneesGTFS &p_gtfs, const Coordonnees &p_pointOrigine,
+                                     const Coordonnees &p_pointDestination, unsigned int p_heureDepart,
+                                     Graphe::Surcouche &p_surcouche) const
 {
-    try
+    if (p_heureDepart < TableArrets::enSecondes(p_gtfs.getTempsDebut()) ||
+        p_heureDepart >= TableArrets::enSecondes(p_gtfs.getTempsFin()))
+        throw logic_error("ReseauGTFS::construireSurcouche(): l'heure de départ est hors de l'intervalle du réseau");
+    arcsOrigine(p_pointOrigine, p_heureDepart, p_surcouche.departs);
+    arcsDestination(p_pointDestination, p_heureDepart, p_surcouche.arrivees);
+}
+
+//! \brief les arcs à pieds du point p_point, où l'on est à p_heureDepart, vers le premier arrêt atteignable de chaque
+//! \brief station à distance de marche; le poids d'un arc est l'attente totale jusqu'à l'heure d'arrivée de l'arrêt
+//! \param[in] p_heureDepart: l'heure de départ, en secondes depuis minuit
+//! \param[out] p_arcs: les paires (sommet, poids en secondes), en ordre de station
+void ReseauGTFS::arcsOrigine(const Coordonnees &p_point, unsigned int p_heureDepart,
+                             vector<pair<size_t, unsigned int> > &p_arcs) const
+{
+    p_arcs.clear();
+    vector<pair<unsigned int, double> > accessibles;
+    m_table.stationsAccessibles(p_point, distanceMaxMarche, accessibles);
+    for (const auto &station : accessibles)
     {
-        //enlever les arcs vers la destination
-        for(int i=0; i<m_sommetsVersDestination.size();++i)
-        {
-            m_leGraphe.enleverArc(m_sommetsVersDestination[i],m_sommetDestination);
-        }
-        m_sommetsVersDestination.clear();
+        unsigned int s = station.first;
+        unsigned int tempsMarche = (unsigned int) round((station.second / vitesseDeMarche) * 3600);
+        unsigned int rang = m_table.premierRangApres(s, p_heureDepart + tempsMarche);
+        if (rang < m_table.getNbArretsStation(s))
+            p_arcs.push_back({m_table.getArretStation(s, rang), m_table.getArriveeStation(s, rang) - p_heureDepart});
+    }
+}
 
-        //enlever les sommets origine et destination
-        m_leGraphe.resize(m_leGraphe.getNbSommets()-2);
-        for(int i=0; i<2;++i)
-        {
-            m_sommetDeArret.erase(m_arretDuSommet[m_arretDuSommet.size()-1]);
-            m_arretDuSommet.pop_back();
-        }
+//! \brief les arcs à pieds de tous les arrêts des stations à distance de marche vers le point p_point
+//! \param[out] p_arcs: les paires (sommet, poids en secondes), en ordre de station puis de rang
+void ReseauGTFS::arcsDestination(const Coordonnees &p_point, vector<pair<size_t, unsigned int> > &p_arcs) const
+{
+    arcsDestination(p_point, 0, p_arcs);
+}
 
-        //retour a la valeur de base
-        m_nbArcsOrigineVersStations = 0;
-        m_nbArcsStationsVersDestination = 0;
-        m_origine_dest_ajoute = false;
-    }catch(...)
+//! \brief Identique à arcsDestination(p_point, p_arcs), mais seulement à partir des arrêts dont l'heure d'arrivée est
+//! \brief >= p_heureMin: en partant à p_heureMin, les arrêts antérieurs ne sont pas atteignables. Une recherche à
+//! \brief rebours à partir de la destination n'explore donc pas la partie de la journée qui précède le départ.
+//! \param[in] p_heureMin: l'heure de départ, en secondes depuis minuit
+void ReseauGTFS::arcsDestination(const Coordonnees &p_point, unsigned int p_heureMin,
+                                 vector<pair<size_t, unsigned int> > &p_arcs) const
+{
+    p_arcs.clear();
+    vector<pair<unsigned int, double> > accessibles;
+    m_table.stationsAccessibles(p_point, distanceMaxMarche, accessibles);
+    for (const auto &station : accessibles)
     {
-        throw logic_error("Une erreur s'est produite dans enleverArcsOrigineDestination");
+        unsigned int s = station.first;
+        unsigned int tempsMarche = (unsigned int) ((station.second / vitesseDeMarche) * 3600);
+        for (unsigned int rang = m_table.premierRangApres(s, p_heureMin); rang < m_table.getNbArretsStation(s); ++rang)
+            p_arcs.push_back({m_table.getArretStation(s, rang), tempsMarche});
     }
 }
 
 
-//! \brief Trouve le plus court chemin menant du point d'origine au point destination préalablement choisis
+//! \brief Trouve le plus court chemin menant du point d'origine au point destination
 //! \brief Permet également d'affichier l'itinéraire du voyage et retourne le temps d'exécution de l'algorithme de plus court chemin utilisé
+//! \param[in] p_gtfs: l'objet DonneesGTFS qui a servi à construire le réseau
+//! \param[in] p_pointOrigine: les coordonnées GPS du point origine
+//! \param[in] p_pointDestination: les coordonnées GPS du point destination
 //! \param[in] p_afficherItineraire: true si on désire afficher l'itinéraire et false autrement
 //! \param[out] p_tempsExecution: le temps d'exécution de l'algorithme de plus court chemin utilisé
+//! \return la durée du trajet en secondes (= numeric_limits<unsigned int>::max() si la destination n'est pas atteignable)
 //! \throws logic_error si un problème survient durant l'exécution de la méthode
-void ReseauGTFS::itineraire(const DonneesGTFS &p_gtfs, bool p_afficherItineraire, long &p_tempsExecution) const
+unsigned int ReseauGTFS::itineraire(const DonneesGTFS &p_gtfs, const Coordonnees &p_pointOrigine,
+                                    const Coordonnees &p_pointDestination, bool p_afficherItineraire,
+                                    long &p_tempsExecution) const
 {
-    if (!m_origine_dest_ajoute)
-        throw logic_error(
-                "ReseauGTFS::afficherItineraire(): il faut ajouter un point origine et un point destination avant d'obtenir un itinéraire");
+    EspaceRecherche espace;
+    return itineraire(p_gtfs, p_pointOrigine, p_pointDestination, p_afficherItineraire, p_tempsExecution, espace);
+}
+
+//! \brief Identique à itineraire(p_gtfs, p_pointOrigine, p_pointDestination, p_afficherItineraire, p_tempsExecution)
+//! \brief Le réseau n'est que consulté: plusieurs requêtes peuvent s'exécuter en même temps, chacune avec son espace.
+//! \param[in,out] p_espace: l'espace de travail de la recherche, réutilisé d'une requête à l'autre par l'appelant;
+//! \param[in,out] contient les compteurs d'opérations de la recherche au retour
+unsigned int ReseauGTFS::itineraire(const DonneesGTFS &p_gtfs, const Coordonnees &p_pointOrigine,
+                                    const Coordonnees &p_pointDestination, bool p_afficherItineraire,
+                                    long &p_tempsExecution, EspaceRecherche &p_espace) const
+{
+    auto debutSurcouche = chrono::steady_clock::now();
+    Graphe::Surcouche surcouche;
+    construireSurcouche(p_gtfs, p_pointOrigine, p_pointDestination, surcouche);
 
     vector<size_t> chemin;
 
     timeval tv1;
     timeval tv2;
+    auto debutRecherche = chrono::steady_clock::now();
     if (gettimeofday(&tv1, 0) != 0)
         throw logic_error("ReseauGTFS::afficherItineraire(): gettimeofday() a échoué pour tv1");
-    unsigned int tempsDuTrajet = m_leGraphe.plusCourtChemin(m_sommetOrigine, m_sommetDestination, chemin);
+    unsigned int tempsDuTrajet = m_leGraphe.plusCourtChemin(surcouche, chemin, p_espace);
     if (gettimeofday(&tv2, 0) != 0)
         throw logic_error("ReseauGTFS::afficherItineraire(): gettimeofday() a échoué pour tv2");
     p_tempsExecution = tempsExecution(tv1, tv2);
+    auto finRecherche = chrono::steady_clock::now();
+    enregistrerRequete(chrono::duration<double>(debutRecherche - debutSurcouche).count(),
+                       chrono::duration<double>(finRecherche - debutRecherche).count(), p_espace.getStatistiques(),
+                       tempsDuTrajet, chemin);
+
+    afficherItineraire(p_gtfs, m_table, chemin, tempsDuTrajet, p_afficherItineraire);
+    return tempsDuTrajet;
+}
+
+//! \brief Requête de profil: tous les départs utiles du point origine vers le point destination dans [now1, now2)
+//! \brief Une seule recherche à rebours, à partir de la destination dans le graphe transposé, donne la durée restante
+//! \brief depuis chaque arrêt; comme les poids du graphe sont des écarts d'heures, l'arrivée en partant d'un arrêt est
+//! \brief son heure plus cette durée, quelle que soit l'heure de départ du point origine. Les stations accessibles de
+//! \brief l'origine sont ensuite balayées de la dernière heure de départ à la première.
+//! \param[in] p_gtfs: l'objet DonneesGTFS qui a servi à construire le réseau
+//! \param[in] p_pointOrigine: les coordonnées GPS du point origine
+//! \param[in] p_pointDestination: les coordonnées GPS du point destination
+//! \param[out] p_departs: les départs utiles, par heure de départ croissante (et donc d'arrivée croissante);
+//! \param[out] partir à une heure t de l'intervalle mène à destination à l'heure d'arrivée du premier départ >= t
+//! \param[in,out] p_espace: l'espace de travail de la recherche à rebours
+void ReseauGTFS::profil(const DonneesGTFS &p_gtfs, const Coordonnees &p_pointOrigine,
+                        const Coordonnees &p_pointDestination, vector<DepartProfil> &p_departs,
+                        EspaceRecherche &p_espace) const
+{
+    p_departs.clear();
+    const unsigned int debut = TableArrets::enSecondes(p_gtfs.getTempsDebut());
+    const unsigned int fin = TableArrets::enSecondes(p_gtfs.getTempsFin());
+    const size_t origine = getNbSommets();
+    const unsigned int aucune = numeric_limits<unsigned int>::max();
+
+    vector<pair<size_t, unsigned int> > arrivees;
+    arcsDestination(p_pointDestination, arrivees);
+    m_grapheInverse.distancesDepuis(arrivees, p_espace);
+
+    struct StationOrigine
+    {
+        unsigned int station;
+        unsigned int tempsMarche;
+        unsigned int rang; //le premier rang atteignable en partant à l'heure courante du balayage
+    };
+    vector<StationOrigine> stations;
+    vector<unsigned int> heures; //les heures de départ où le premier arrêt atteignable d'une station change
+    heures.push_back(debut);
+    vector<pair<unsigned int, double> > accessibles;
+    m_table.stationsAccessibles(p_pointOrigine, distanceMaxMarche, accessibles);
+    for (const auto &station : accessibles)
+    {
+        unsigned int s = station.first;
+        unsigned int tempsMarche = (unsigned int) round((station.second / vitesseDeMarche) * 3600);
+        stations.push_back({s, tempsMarche, m_table.getNbArretsStation(s)});
+        for (unsigned int rang = 0; rang < m_table.getNbArretsStation(s); ++rang)
+        {
+            unsigned int arrivee = m_table.getArriveeStation(s, rang);
+            if (arrivee < debut + tempsMarche || arrivee - tempsMarche >= fin) continue;
+            if (rang > 0 && m_table.getArriveeStation(s, rang - 1) == arrivee) continue;
+            heures.push_back(arrivee - tempsMarche);
+        }
+    }
+    sort(heures.begin(), heures.end(), greater<unsigned int>());
+    heures.erase(unique(heures.begin(), heures.end()), heures.end());
+
+    //en partant à l'heure t, la station s est atteinte au premier rang dont l'arrivée est >= t + tempsMarche;
+    //ce rang ne fait que reculer lorsque t diminue
+    unsigned int meilleureArrivee = aucune;
+    for (unsigned int heure : heures)
+    {
+        unsigned int arrivee = aucune;
+        size_t premierArret = 0;
+        for (auto &station : stations)
+        {
+            while (station.rang > 0 &&
+                   m_table.getArriveeStation(station.station, station.rang - 1) >= heure + station.tempsMarche)
+                --station.rang;
+            if (station.rang == m_table.getNbArretsStation(station.station)) continue;
+            size_t arret = m_table.getArretStation(station.station, station.rang);
+            unsigned int reste = p_espace.getDistance(arret);
+            if (reste == aucune) continue;
+            if (m_table.getArrivee(arret) + reste < arrivee)
+            {
+                arrivee = m_table.getArrivee(arret) + reste;
+                premierArret = arret;
+            }
+        }
+        if (arrivee >= meilleureArrivee) continue;
+        meilleureArrivee = arrivee;
+
+        DepartProfil depart = {heure, arrivee, vector<size_t>(1, origine)};
+        for (size_t sommet = premierArret; sommet != origine; sommet = p_espace.getPredecesseur(sommet))
+            depart.chemin.push_back(sommet);
+        depart.chemin.push_back(origine + 1);
+        p_departs.push_back(depart);
+    }
+    reverse(p_departs.begin(), p_departs.end());
+}
 
-    if (tempsDuTrajet == numeric_limits<unsigned int>::max())
+//! \brief Vérifie et affiche un itinéraire, quel que soit l'algorithme qui l'a produit
+//! \param[in] p_gtfs: l'objet DonneesGTFS des arrêts de l'itinéraire
+//! \param[in] p_table: la table des arrêts construite à partir de p_gtfs
+//! \param[in] p_chemin: les arrêts parcourus (indices de p_table); le premier est le point origine
+//! \param[in] p_chemin: (p_table.getNbArrets()) et le dernier est le point destination (p_table.getNbArrets() + 1)
+//! \param[in] p_tempsDuTrajet: la durée du trajet en secondes (numeric_limits<unsigned int>::max() si inatteignable)
+//! \param[in] p_afficherItineraire: true si on désire afficher l'itinéraire et false autrement
+//! \throws logic_error si le chemin est incohérent
+void ReseauGTFS::afficherItineraire(const DonneesGTFS &p_gtfs, const TableArrets &p_table,
+                                    const vector<size_t> &p_chemin, unsigned int p_tempsDuTrajet,
+                                    bool p_afficherItineraire)
+{
+    afficherItineraire(p_gtfs, p_table, p_chemin, p_tempsDuTrajet, p_afficherItineraire, p_gtfs.getTempsDebut());
+}
+
+//! \brief Identique à afficherItineraire(p_gtfs, p_table, p_chemin, p_tempsDuTrajet, p_afficherItineraire) pour un
+//! \brief itinéraire partant du point origine à p_heureDepart (voir construireSurcouche())
+void ReseauGTFS::afficherItineraire(const DonneesGTFS &p_gtfs, const TableArrets &p_table,
+                                    const vector<size_t> &p_chemin, unsigned int p_tempsDuTrajet,
+                                    bool p_afficherItineraire, const Heure &p_heureDepart)
+{
+    afficherItineraire(VueTable(p_gtfs, p_table), p_chemin, p_tempsDuTrajet, p_afficherItineraire, p_heureDepart);
+}
+
+//! \brief Vérifie et affiche un itinéraire partant du point origine à p_heureDepart, quels que soient l'algorithme qui
+//! \brief l'a produit et la représentation des arrêts (voir VueArrets)
+//! \param[in] p_chemin: les arrêts parcourus; le premier est le point origine (p_arrets.getNbArrets()) et le dernier
+//! \param[in] p_chemin: le point destination (p_arrets.getNbArrets() + 1)
+//! \throws logic_error si le chemin est incohérent
+void ReseauGTFS::afficherItineraire(const VueArrets &p_arrets, const vector<size_t> &p_chemin,
+                                    unsigned int p_tempsDuTrajet, bool p_afficherItineraire, const Heure &p_heureDepart)
+{
+    if (p_tempsDuTrajet == numeric_limits<unsigned int>::max())
     {
         if (p_afficherItineraire)
             cout << "La destination n'est pas atteignable de l'orignine durant cet intervalle de temps" << endl;
         return;
     }
 
-    if (tempsDuTrajet == 0)
+    if (p_tempsDuTrajet == 0)
     {
         if (p_afficherItineraire) cout << "Vous êtes déjà situé à la destination demandée" << endl;
         return;
     }
 
     //un chemin non trivial a été trouvé
-    if (chemin.size() <= 2)
+    const size_t sommetOrigine = p_arrets.getNbArrets();
+    const size_t sommetDestination = sommetOrigine + 1;
+    if (p_chemin.size() <= 2)
         throw logic_error("ReseauGTFS::afficherItineraire(): un chemin non trivial doit contenir au moins 3 sommets");
-    if (m_arretDuSommet[chemin[0]]->getStationId() != stationIdOrigine)
+    if (p_chemin[0] != sommetOrigine)
         throw logic_error("ReseauGTFS::afficherItineraire(): le premier noeud du chemin doit être le point origine");
-    if (m_arretDuSommet[chemin[chemin.size() - 1]]->getStationId() != stationIdDestination)
+    if (p_chemin[p_chemin.size() - 1] != sommetDestination)
         throw logic_error(
                 "ReseauGTFS::afficherItineraire(): le dernier noeud du chemin doit être le point destination");
+    for (size_t i = 1; i + 1 < p_chemin.size(); ++i)
+        if (p_chemin[i] >= sommetOrigine)
+            throw logic_error("ReseauGTFS::afficherItineraire(): le chemin passe par un arrêt inexistant");
+
+    //station et voyage de chaque noeud; les points origine et destination ont chacun les leurs
+    const unsigned int aucun = numeric_limits<unsigned int>::max();
+    auto station = [&](size_t p_sommet) -> unsigned int
+    {
+        if (p_sommet >= sommetOrigine) return aucun - (unsigned int) (p_sommet - sommetOrigine);
+        return p_arrets.getStation(p_sommet);
+    };
+    auto voyage = [&](size_t p_sommet) -> unsigned int
+    {
+        if (p_sommet >= sommetOrigine) return aucun - (unsigned int) (p_sommet - sommetOrigine);
+        return p_arrets.getVoyage(p_sommet);
+    };
+    auto heureArrivee = [&](size_t p_sommet)
+    {
+        return Heure(0, 0, 0).add_secondes(p_arrets.getArrivee(p_sommet));
+    };
+    auto allerAPieds = [&](size_t p_sommet)
+    {
+        if (!p_afficherItineraire) return;
+        cout << "De cette station, rendez-vous à pieds à la station ";
+        p_arrets.afficherStation(cout, p_sommet);
+        cout << endl;
+    };
 
     if (p_afficherItineraire)
     {
@@ -399,85 +904,87 @@ void ReseauGTFS::itineraire(const DonneesGTFS &p_gtfs, bool p_afficherItineraire
         std::cout << std::endl;
     }
 
-    if (p_afficherItineraire) cout << "Heure de départ du point d'origine: "  << p_gtfs.getTempsDebut() << endl;
-    Arret::Ptr ptr_a = m_arretDuSommet.at(chemin[0]);
-    Arret::Ptr ptr_b = m_arretDuSommet.at(chemin[1]);
+    if (p_afficherItineraire) cout << "Heure de départ du point d'origine: "  << p_heureDepart << endl;
+    size_t a = p_chemin.at(0);
+    size_t b = p_chemin.at(1);
     if (p_afficherItineraire)
-        cout << "Rendez vous à la station " << p_gtfs.getStations().at(ptr_b->getStationId()) << endl;
+    {
+        cout << "Rendez vous à la station ";
+        p_arrets.afficherStation(cout, b);
+        cout << endl;
+    }
 
     unsigned int sommet = 1;
 
-    while (sommet < chemin.size() - 1)
+    while (sommet < p_chemin.size() - 1)
     {
-        ptr_a = ptr_b;
+        a = b;
         ++sommet;
-        ptr_b = m_arretDuSommet.at(chemin[sommet]);
-        while (ptr_b->getStationId() == ptr_a->getStationId())
+        b = p_chemin.at(sommet);
+        while (station(b) == station(a))
         {
-            ptr_a = ptr_b;
+            a = b;
             ++sommet;
-            ptr_b = m_arretDuSommet.at(chemin[sommet]);
+            b = p_chemin.at(sommet);
         }
         //on a changé de station
-        if (ptr_b->getStationId() == stationIdDestination) //cas où on est arrivé à la destination
+        if (b == sommetDestination) //cas où on est arrivé à la destination
         {
-            if (sommet != chemin.size() - 1)
+            if (sommet != p_chemin.size() - 1)
                 throw logic_error(
                         "ReseauGTFS::afficherItineraire(): incohérence de fin de chemin lors d'un changement de station");
             break;
         }
-        if (sommet == chemin.size() - 1)
+        if (sommet == p_chemin.size() - 1)
             throw logic_error("ReseauGTFS::afficherItineraire(): on ne devrait pas être arrivé à destination");
         //on a changé de station mais sommet n'est pas le noeud destination
-        string voyage_id_a = ptr_a->getVoyageId();
-        string voyage_id_b = ptr_b->getVoyageId();
-        if (voyage_id_a != voyage_id_b) //on a changé de station à pieds
-        {
-            if (p_afficherItineraire)
-                cout << "De cette station, rendez-vous à pieds à la station " << p_gtfs.getStations().at(ptr_b->getStationId()) << endl;
-        }
+        if (voyage(a) != voyage(b)) //on a changé de station à pieds
+            allerAPieds(b);
         else //on a changé de station avec un voyage
         {
-            Heure heure = ptr_a->getHeureArrivee();
-            unsigned int ligne_id = p_gtfs.getVoyages().at(voyage_id_a).getLigne();
-            string ligne_numero = p_gtfs.getLignes().at(ligne_id).getNumero();
             if (p_afficherItineraire)
-                cout << "De cette station, prenez l'autobus numéro " << ligne_numero << " à l'heure " << heure << " "
-                     << p_gtfs.getVoyages().at(voyage_id_a) << endl;
+            {
+                cout << "De cette station, prenez l'autobus numéro " << p_arrets.getNumeroLigne(a) << " à l'heure "
+                     << heureArrivee(a) << " ";
+                p_arrets.afficherVoyage(cout, a);
+                cout << endl;
+            }
             //maintenant allons à la dernière station de ce voyage
-            ptr_a = ptr_b;
+            a = b;
             ++sommet;
-            ptr_b = m_arretDuSommet.at(chemin[sommet]);
-            while (ptr_b->getVoyageId() == ptr_a->getVoyageId())
+            b = p_chemin.at(sommet);
+            while (voyage(b) == voyage(a))
             {
-                ptr_a = ptr_b;
+                a = b;
                 ++sommet;
-                ptr_b = m_arretDuSommet.at(chemin[sommet]);
+                b = p_chemin.at(sommet);
             }
             //on a changé de voyage
             if (p_afficherItineraire)
-                cout << "et arrêtez-vous à la station " << p_gtfs.getStations().at(ptr_a->getStationId()) << " à l'heure "
-                     << ptr_a->getHeureArrivee() << endl;
-            if (ptr_b->getStationId() == stationIdDestination) //cas où on est arrivé à la destination
             {
-                if (sommet != chemin.size() - 1)
+                cout << "et arrêtez-vous à la station ";
+                p_arrets.afficherStation(cout, a);
+                cout << " à l'heure " << heureArrivee(a) << endl;
+            }
+            if (b == sommetDestination) //cas où on est arrivé à la destination
+            {
+                if (sommet != p_chemin.size() - 1)
                     throw logic_error(
                             "ReseauGTFS::afficherItineraire(): incohérence de fin de chemin lors d'u changement de voyage");
                 break;
             }
-            if (ptr_a->getStationId() != ptr_b->getStationId()) //alors on s'est rendu à pieds à l'autre station
-                if (p_afficherItineraire)
-                    cout << "De cette station, rendez-vous à pieds à la station " << p_gtfs.getStations().at(ptr_b->getStationId()) << endl;
+            if (station(a) != station(b)) //alors on s'est rendu à pieds à l'autre station
+                allerAPieds(b);
         }
     }
 
     if (p_afficherItineraire)
     {
         cout << "Déplacez-vous à pieds de cette station au point destination" << endl;
-        cout << "Heure d'arrivée à la destination: " << p_gtfs.getTempsDebut().add_secondes(tempsDuTrajet) << endl;
+        cout << "Heure d'arrivée à la destination: " << p_heureDepart.add_secondes(p_tempsDuTrajet) << endl;
     }
-    unsigned int h = tempsDuTrajet / 3600;
-    unsigned int reste_sec = tempsDuTrajet % 3600;
+    unsigned int h = p_tempsDuTrajet / 3600;
+    unsigned int reste_sec = p_tempsDuTrajet % 3600;
     unsigned int m = reste_sec / 60;
     unsigned int s = reste_sec % 60;
     if (p_afficherItineraire)
@@ -486,5 +993,3 @@ void ReseauGTFS::itineraire(const DonneesGTFS &p_gtfs, bool p_afficherItineraire
     }
 
 }
-
-
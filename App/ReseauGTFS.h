@@ -5,42 +5,115 @@
 #ifndef TP2_RESEAUGTFS_H
 #define TP2_RESEAUGTFS_H
 
+#include <sys/time.h>
+
 #include "DonneesGTFS.h"
 #include "graphe.h"
+#include "tablearrets.h"
+#include "retardstempsreel.h"
+
+class Reperes;
+
+long tempsExecution(const timeval &tv1, const timeval &tv2);
+
+//! \brief un départ utile d'une requête de profil: partir plus tard ne permet pas d'arriver aussi tôt
+struct DepartProfil
+{
+    unsigned int heureDepart; /*!< la dernière heure de départ du point origine, en secondes depuis minuit */
+    unsigned int heureArrivee; /*!< l'heure d'arrivée au point destination, en secondes depuis minuit */
+    std::vector<size_t> chemin; /*!< de getNbSommets() à getNbSommets() + 1, comme pour itineraire() */
+};
+
+//! \brief les arrêts d'un réseau tels que ReseauGTFS::afficherItineraire() les affiche, indexés comme les sommets
+//! \brief du graphe: ReseauGTFS les tire de TableArrets et de DonneesGTFS, InstantaneReseau de son fichier projeté
+class VueArrets
+{
+public:
+    virtual ~VueArrets() {}
+    virtual size_t getNbArrets() const = 0;
+    //! \brief indice de la station de l'arrêt p_arret
+    virtual unsigned int getStation(size_t p_arret) const = 0;
+    //! \brief indice du voyage de l'arrêt p_arret
+    virtual unsigned int getVoyage(size_t p_arret) const = 0;
+    //! \brief heure d'arrivée (en secondes depuis minuit) de l'arrêt p_arret
+    virtual unsigned int getArrivee(size_t p_arret) const = 0;
+    //! \brief le route_short_name de la ligne du voyage de l'arrêt p_arret
+    virtual std::string getNumeroLigne(size_t p_arret) const = 0;
+    //! \brief affiche la station de l'arrêt p_arret comme operator<<(ostream &, const Station &)
+    virtual void afficherStation(std::ostream &p_flux, size_t p_arret) const = 0;
+    //! \brief affiche le voyage de l'arrêt p_arret comme operator<<(ostream &, const Voyage &)
+    virtual void afficherVoyage(std::ostream &p_flux, size_t p_arret) const = 0;
+};
 
+//! \brief la durée, en secondes, de chaque phase de la construction d'un ReseauGTFS
+struct DureesConstruction
+{
+    double arcsVoyages;
+    double arcsAttentes;
+    double arcsTransferts;
+    double figer; /*!< la compaction des arcs en format CSR */
+    double inverser; /*!< la construction du graphe transposé */
+};
 
 class ReseauGTFS
 {
 
 public:
     ReseauGTFS(const DonneesGTFS &);
-    void ajouterArcsOrigineDestination(const DonneesGTFS &, const Coordonnees &, const Coordonnees &);
-    void enleverArcsOrigineDestination();
-    void itineraire(const DonneesGTFS &, bool, long &) const;
-    size_t getNbArcsOrigineVersStations() const;
-    size_t getNbArcsStationsVersDestination() const;
+    void avancerIntervalle(const DonneesGTFS &, const std::vector<Arret::Ptr> &);
+    unsigned int appliquerRetards(const DonneesGTFS &, const std::vector<RetardVoyage> &);
+    void construireSurcouche(const DonneesGTFS &, const Coordonnees &, const Coordonnees &, Graphe::Surcouche &) const;
+    void construireSurcouche(const DonneesGTFS &, const Coordonnees &, const Coordonnees &, unsigned int,
+                             Graphe::Surcouche &) const;
+    void arcsOrigine(const Coordonnees &, unsigned int, std::vector<std::pair<size_t, unsigned int> > &) const;
+    void arcsDestination(const Coordonnees &, std::vector<std::pair<size_t, unsigned int> > &) const;
+    void arcsDestination(const Coordonnees &, unsigned int, std::vector<std::pair<size_t, unsigned int> > &) const;
+    unsigned int plusCourtCheminGeographique(const Graphe::Surcouche &, const Coordonnees &, std::vector<size_t> &,
+                                             EspaceRecherche &) const;
+    unsigned int plusCourtCheminReperes(const Reperes &, const Graphe::Surcouche &, std::vector<size_t> &,
+                                        EspaceRecherche &) const;
+    unsigned int itineraire(const DonneesGTFS &, const Coordonnees &, const Coordonnees &, bool, long &) const;
+    unsigned int itineraire(const DonneesGTFS &, const Coordonnees &, const Coordonnees &, bool, long &,
+                            EspaceRecherche &) const;
+    void profil(const DonneesGTFS &, const Coordonnees &, const Coordonnees &, std::vector<DepartProfil> &,
+                EspaceRecherche &) const;
+    static void afficherItineraire(const DonneesGTFS &, const TableArrets &, const std::vector<size_t> &, unsigned int,
+                                   bool);
+    static void afficherItineraire(const DonneesGTFS &, const TableArrets &, const std::vector<size_t> &, unsigned int,
+                                   bool, const Heure &);
+    static void afficherItineraire(const VueArrets &, const std::vector<size_t> &, unsigned int, bool, const Heure &);
+    size_t getNbSommets() const;
+    const Graphe &getGraphe() const;
+    const Graphe &getGrapheInverse() const;
+    const TableArrets &getTable() const;
     double getDistMaxMarche() const;
+    double getVitesseMax() const;
+    const DureesConstruction &getDureesConstruction() const;
+    static void enregistrerRequete(double, double, const StatistiquesRecherche &, unsigned int,
+                                   const std::vector<size_t> &);
+
+    static constexpr double vitesseDeMarche = 5.0; // vitesse moyenne de marche, en km/heure, d'un humain selon wikipedia */
+    static constexpr double distanceMaxMarche = 1.5; // distance maximale de marche permise, en km
+    static const unsigned int stationIdOrigine = 0; //numéro de stationID donné pour l'arret fantôme de départ
+    static const unsigned int stationIdDestination = 1; //numéro de stationID donné pour les arrets fantômes de destination
 
 private:
-    Graphe m_leGraphe;
-    std::vector<Arret::Ptr> m_arretDuSommet; //m_arretDuSommet[i] est le pointeur (shared_ptr) de l'arret (associé au sommet i du graphe
-    std::unordered_map<Arret::Ptr,size_t> m_sommetDeArret; //m_sommetDeArret[a_ptr] est le sommet du graphe associé au pointeur de l'arret a_ptr
-    std::vector<size_t> m_sommetsVersDestination; //Chaque élément est un sommet possédant un arc vers la destination
-
-    bool m_origine_dest_ajoute; //indique si on a ajouté le point origine, le point destination, et les arcs correspondants
-    size_t m_sommetOrigine; //le sommet du graphe qui représente le point d'origine
-    size_t m_sommetDestination; //le sommet du graphe qui représente le point destination
-    size_t m_nbArcsOrigineVersStations; //le nombre d'arcs du point origine vers des stations
-    size_t m_nbArcsStationsVersDestination; //le nombre d'arcs d'une station vers le point destination
-
-    const double vitesseDeMarche = 5.0; // vitesse moyenne de marche, en km/heure, d'un humain selon wikipedia */
-    const double distanceMaxMarche = 1.5; // distance maximale de marche permise, en km
-    const unsigned int stationIdOrigine = 0; //numéro de stationID donné pour l'arret fantôme de départ
-    const unsigned int stationIdDestination = 1; //numéro de stationID donné pour les arrets fantômes de destination
-
-    void ajouterArcsVoyages(const DonneesGTFS &); //ajout des arcs dus aux voyages
-    void ajouterArcsAttentes(const DonneesGTFS &); //ajout des arcs dus aux attentes à une station (arcs temporels)
-    void ajouterArcsTransferts(const DonneesGTFS &); //ajout des arcs dus aux transferts
+    Graphe m_leGraphe; //figé à la construction et jamais modifié ensuite: les requêtes n'y ajoutent qu'une surcouche
+    Graphe m_grapheInverse; //le graphe transposé, pour les recherches à rebours à partir de la destination
+    TableArrets m_table; //l'arrêt i de m_table est associé au sommet i du graphe
+    DureesConstruction m_durees; //mesurées par le constructeur
+    bool m_retardsAppliques; //vrai si les heures de m_table ne sont plus celles de l'horaire (appliquerRetards())
+    std::vector<std::pair<unsigned int, unsigned int> > m_horaire; //(arrivée, départ) de l'horaire de chaque arrêt,
+                                                                     //gardés par le premier appel de appliquerRetards()
+    double m_vitesseMax; //en km/h, recalculée chaque fois que les arcs changent (heuristique de l'A*)
+
+    void ajouterArcsVoyages(); //ajout des arcs dus aux voyages
+    void ajouterArcsAttentes(); //ajout des arcs dus aux attentes à une station (arcs temporels)
+    void ajouterArcsTransferts(); //ajout des arcs dus aux transferts
+    static void suivantsAttente(const TableArrets &, std::vector<size_t> &);
+    static void suivantsAttenteStation(const TableArrets &, unsigned int, std::vector<size_t> &);
+    static void arcsTransferts(const TableArrets &, size_t, std::vector<Graphe::ArcFige> &);
+    void calculerVitesseMax();
 
 };
 
@@ -11,7 +11,7 @@
  *  \param[in] p_heure_depart: heure de départ
  *  \param[in] p_heure_arrivee: heure d'arrivée
  *  \param[in] p_numero_sequence: numéro de séquence de l'arrêt dans le voyage
- *  \param[in] p_voyage_id: identificateur du voyage
+ *  \param[in] p_voyage_id: numéro interné de l'identificateur du voyage
  *   	Pour votre information le fichier stop_times.txt comprend des données relatives aux arrêts effectués par les autobus ;
  *		il est composé des champs :
  *		- trip_id : identifiant du voyage ;
@@ -29,7 +29,7 @@
  * 		et stop_sequence(m_numero_sequence)
  */
 Arret::Arret(unsigned int p_station_id, const Heure &p_heure_arrivee, const Heure &p_heure_depart,
-             unsigned int p_numero_sequence, const std::string &p_voyage_id)
+             unsigned int p_numero_sequence, unsigned int p_voyage_id)
         : m_station_id(p_station_id), m_heure_arrivee(p_heure_arrivee), m_heure_depart(p_heure_depart),
           m_numero_sequence(p_numero_sequence), m_voyage_id(p_voyage_id)
 {
@@ -105,7 +105,7 @@ std::ostream &operator<<(std::ostream &flux, const Arret &p_arret)
     return flux;
 }
 
-std::string Arret::getVoyageId() const
+unsigned int Arret::getVoyageId() const
 {
     return m_voyage_id;
 }
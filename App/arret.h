@@ -27,12 +27,12 @@ public:
 	typedef std::shared_ptr<Arret> Ptr;  //permet le raccourcis Arret::Ptr à l'externe
 
 	Arret(unsigned int p_station_id, const Heure & p_heure_arrivee, const Heure & p_heure_depart,
-          unsigned int p_numero_sequence, const std::string & p_voyage_id);
+          unsigned int p_numero_sequence, unsigned int p_voyage_id);
 	const Heure & getHeureArrivee() const;
 	const Heure & getHeureDepart() const;
 	unsigned int getNumeroSequence() const;
 	unsigned int getStationId() const;
-	std::string getVoyageId() const;
+	unsigned int getVoyageId() const;
 
 	bool operator< (const Arret & p_other) const;
 	bool operator> (const Arret & p_other) const;
@@ -44,7 +44,7 @@ private:
 	Heure m_heure_arrivee;
 	Heure m_heure_depart;
 	unsigned int m_numero_sequence;
-	std::string m_voyage_id;
+	unsigned int m_voyage_id; //le trip_id interné (voir DonneesGTFS::getIdsVoyages())
 };
 
 
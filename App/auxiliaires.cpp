@@ -5,6 +5,13 @@
 
 #include "auxiliaires.h"
 
+#include <cerrno>
+#include <cstdlib>
+#include <mutex>
+#include <stdexcept>
+
+#include <sys/stat.h>
+
 using namespace std;;
 
 /*!
@@ -70,6 +77,81 @@ bool Date::operator>(const Date &other) const
     return m_code > other.m_code;
 }
 
+/*!
+ * \brief Différence entre deux dates
+ * \param[in] other: l'autre date avec qui l'on fait l'opération
+ * \return le nombre de jours (positif ou négatif) qui sépare les deux dates.
+ */
+int Date::operator-(const Date &other) const
+{
+    return m_code - other.m_code;
+}
+
+/*!
+ * \brief Ajoute un certain nombre de jours à la date de l'objet courant
+ * \param[in] jours: le nombre de jours à ajouter (négatif pour reculer)
+ * \return la nouvelle date obtenue après l'ajout des jours
+ */
+Date Date::add_jours(int jours) const
+{
+    struct tm t = {};
+    t.tm_year = (int) m_an - 1900;
+    t.tm_mon = (int) m_mois - 1;
+    t.tm_mday = (int) m_jour + jours;
+    t.tm_hour = 12; //loin de minuit: un changement d'heure ne change pas le jour
+    t.tm_isdst = -1;
+    mktime(&t); //normalise le jour, le mois et l'année
+    return Date((unsigned int) (t.tm_year + 1900), (unsigned int) (t.tm_mon + 1), (unsigned int) t.tm_mday);
+}
+
+/*!
+ * \brief Donne l'heure POSIX à laquelle commencent les heures GTFS de la date: midi moins 12 heures, heure locale
+ * du fuseau horaire de l'agence (agency_timezone). Les jours de changement d'heure, ce n'est pas minuit.
+ * \param[in] fuseauHoraire: le fuseau de la base de données tz (ex. America/Montreal)
+ * \return le nombre de secondes depuis 1970-01-01 00:00 UTC
+ * \throws logic_error si le fuseau est vide
+ * \note Change TZ le temps du calcul, ce qui n'est pas sûr si d'autres threads consultent l'environnement ou l'heure
+ * locale: l'appeler seulement au chargement (DonneesGTFS::ajouterAgences(), FluxGTFS), jamais durant les requêtes.
+ */
+long long Date::debutJourneeService(const std::string &fuseauHoraire) const
+{
+    if (fuseauHoraire.empty()) throw logic_error("Date::debutJourneeService(): le fuseau horaire est inconnu");
+
+    //mktime() ne connaît que le fuseau de TZ: il est changé le temps du calcul, puis remis tel quel
+    static mutex verrouTZ;
+    lock_guard<mutex> verrou(verrouTZ);
+    const char *ancien = getenv("TZ");
+    const string ancienTZ = ancien ? ancien : "";
+    setenv("TZ", fuseauHoraire.c_str(), 1);
+    tzset();
+    struct tm t = {};
+    t.tm_year = (int) m_an - 1900;
+    t.tm_mon = (int) m_mois - 1;
+    t.tm_mday = (int) m_jour;
+    t.tm_hour = 12;
+    t.tm_isdst = -1;
+    const long long midi = (long long) mktime(&t);
+    if (ancien) setenv("TZ", ancienTZ.c_str(), 1);
+    else unsetenv("TZ");
+    tzset();
+    return midi - 12 * 3600;
+}
+
+unsigned int Date::getAn() const
+{
+    return m_an;
+}
+
+unsigned int Date::getMois() const
+{
+    return m_mois;
+}
+
+unsigned int Date::getJour() const
+{
+    return m_jour;
+}
+
 /*!
  * \brief Permet de déterminer le code d'une date, i.e le nombre de jours depuis 1970-01-01
  * \param[in] an: l'année dela date
@@ -79,14 +161,15 @@ bool Date::operator>(const Date &other) const
  */
 void Date::encode(unsigned int an, unsigned int mois, unsigned int jour)
 {
-    mois -= 2;
-    if (mois <= 0)
+    int a = (int) an;
+    int m = (int) mois - 2; //signé: janvier et février deviennent les mois 11 et 12 de l'année précédente
+    if (m <= 0)
     {
-        mois += 12;
-        an -= 1;
+        m += 12;
+        a -= 1;
     }
-    m_code = an / 4 - an / 100 + an / 400 + 367 * mois / 12 + jour;
-    m_code = m_code + 365 * an - 719499;
+    m_code = a / 4 - a / 100 + a / 400 + 367 * m / 12 + (int) jour;
+    m_code = m_code + 365 * a - 719499;
 }
 
 /*!
@@ -267,3 +350,26 @@ std::ostream &operator<<(std::ostream &flux, const Heure &p_heure)
     }
     return flux;
 }
+
+/*!
+ * \brief Prépare le dossier où un programme écrit ses fichiers (instantané, matrices, métriques, ...), pour ne jamais
+ * écrire dans le dossier du flux GTFS
+ * \param[in] p_dossier: le dossier choisi, créé s'il n'existe pas; s'il est vide, un dossier temporaire unique est créé
+ * dans $TMPDIR (ou /tmp)
+ * \return le chemin du dossier
+ * \throws logic_error si le dossier ne peut pas être créé
+ */
+std::string preparerDossierSortie(const std::string &p_dossier)
+{
+    if (!p_dossier.empty())
+    {
+        if (mkdir(p_dossier.c_str(), 0755) != 0 && errno != EEXIST)
+            throw logic_error("preparerDossierSortie(): impossible de créer " + p_dossier);
+        return p_dossier;
+    }
+    const char *tmpdir = getenv("TMPDIR");
+    string modele = string(tmpdir && *tmpdir ? tmpdir : "/tmp") + "/rtc-XXXXXX";
+    if (mkdtemp(&modele[0]) == nullptr)
+        throw logic_error("preparerDossierSortie(): impossible de créer un dossier temporaire " + modele);
+    return modele;
+}
@@ -28,6 +28,12 @@ public:
     bool operator==(const Date &other) const;
     bool operator<(const Date &other) const;
     bool operator>(const Date &other) const;
+    int operator-(const Date &other) const;
+    Date add_jours(int jours) const;
+    long long debutJourneeService(const std::string &fuseauHoraire) const;
+    unsigned int getAn() const;
+    unsigned int getMois() const;
+    unsigned int getJour() const;
     friend std::ostream &operator<<(std::ostream &flux, const Date &p_date);
 
 
@@ -71,5 +77,6 @@ private:
     void encode(unsigned int heure, unsigned int min, unsigned int sec);
 };
 
+std::string preparerDossierSortie(const std::string &p_dossier);
 
 #endif //RTC_AUXILIAIRES_H
@@ -0,0 +1,397 @@
+//
+//  bench.cpp
+//  Bancs d'essai répétables du chargement GTFS, de la construction du réseau et des requêtes
+//
+//  Chaque banc mesure une série d'exécutions (répétitions ou requêtes tirées avec une graine fixe) et rapporte les
+//  percentiles p50/p95/p99 en plus de la moyenne, afin de repérer une régression avant de déployer une version.
+//  Usage: bench [--dossier=RTC-8aout-1dec] [--requetes=200] [--repetitions=10] [--graine=42] [--filtre=texte]
+//               [--csv=fichier]
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DonneesGTFS.h"
+#include "ReseauGTFS.h"
+#include "reperes.h"
+#include "motifstransferts.h"
+
+using namespace std;
+
+namespace
+{
+    //! \brief les paramètres de la ligne de commande
+    struct Options
+    {
+        string dossier = "RTC-8aout-1dec";
+        unsigned int nbRequetes = 200;
+        unsigned int nbRepetitions = 10;
+        unsigned int graine = 42;
+        string filtre; //seuls les bancs dont le nom contient ce texte sont exécutés
+        string fichierCSV;
+    };
+
+    //! \brief les durées, en microsecondes, des exécutions d'un banc
+    class Mesures
+    {
+    public:
+        explicit Mesures(const string &p_nom) : m_nom(p_nom)
+        {
+        }
+
+        void ajouter(double p_secondes)
+        {
+            m_durees.push_back(p_secondes * 1e6);
+        }
+
+        //! \brief le percentile p_p (rang le plus proche) des durées
+        double percentile(double p_p) const
+        {
+            vector<double> triees(m_durees);
+            sort(triees.begin(), triees.end());
+            size_t rang = (size_t) ceil(p_p / 100 * triees.size());
+            return triees[rang == 0 ? 0 : rang - 1];
+        }
+
+        double moyenne() const
+        {
+            double somme = 0;
+            for (double duree : m_durees) somme += duree;
+            return somme / m_durees.size();
+        }
+
+        const string &getNom() const { return m_nom; }
+        size_t getNbExecutions() const { return m_durees.size(); }
+
+    private:
+        string m_nom;
+        vector<double> m_durees;
+    };
+
+    //! \brief exécute les bancs retenus par le filtre et rapporte leurs percentiles
+    class Rapport
+    {
+    public:
+        explicit Rapport(const Options &p_options) : m_options(p_options)
+        {
+            cout << left << setw(44) << "Banc" << right << setw(8) << "n" << setw(13) << "p50 (us)" << setw(13)
+                 << "p95 (us)" << setw(13) << "p99 (us)" << setw(13) << "moy (us)" << endl;
+            cout << string(104, '-') << endl;
+        }
+
+        bool retenu(const string &p_nom) const
+        {
+            return m_options.filtre.empty() || p_nom.find(m_options.filtre) != string::npos;
+        }
+
+        void rapporter(const Mesures &p_mesures)
+        {
+            if (p_mesures.getNbExecutions() == 0 || !retenu(p_mesures.getNom())) return;
+            cout << left << setw(44) << p_mesures.getNom() << right << setw(8) << p_mesures.getNbExecutions()
+                 << fixed << setprecision(1) << setw(13) << p_mesures.percentile(50) << setw(13)
+                 << p_mesures.percentile(95) << setw(13) << p_mesures.percentile(99) << setw(13)
+                 << p_mesures.moyenne() << endl;
+            m_lignes.push_back(p_mesures);
+        }
+
+        //! \brief écrit les résultats en CSV (nom, n, p50, p95, p99, moyenne), pour comparer deux versions
+        void ecrireCSV() const
+        {
+            if (m_options.fichierCSV.empty()) return;
+            ofstream fichier(m_options.fichierCSV);
+            if (!fichier) throw logic_error("bench: impossible d'écrire " + m_options.fichierCSV);
+            fichier << "banc,n,p50_us,p95_us,p99_us,moyenne_us" << endl;
+            for (const Mesures &mesures : m_lignes)
+                fichier << mesures.getNom() << "," << mesures.getNbExecutions() << "," << mesures.percentile(50)
+                        << "," << mesures.percentile(95) << "," << mesures.percentile(99) << ","
+                        << mesures.moyenne() << endl;
+        }
+
+    private:
+        const Options &m_options;
+        vector<Mesures> m_lignes;
+    };
+
+    double secondesDepuis(const chrono::steady_clock::time_point &p_debut)
+    {
+        return chrono::duration<double>(chrono::steady_clock::now() - p_debut).count();
+    }
+
+    Options lireOptions(int argc, char *argv[])
+    {
+        Options options;
+        for (int i = 1; i < argc; ++i)
+        {
+            string argument = argv[i];
+            size_t egal = argument.find('=');
+            string cle = argument.substr(0, egal);
+            string valeur = egal == string::npos ? "" : argument.substr(egal + 1);
+            if (cle == "--dossier") options.dossier = valeur;
+            else if (cle == "--requetes") options.nbRequetes = (unsigned int) stoul(valeur);
+            else if (cle == "--repetitions") options.nbRepetitions = (unsigned int) stoul(valeur);
+            else if (cle == "--graine") options.graine = (unsigned int) stoul(valeur);
+            else if (cle == "--filtre") options.filtre = valeur;
+            else if (cle == "--csv") options.fichierCSV = valeur;
+            else throw logic_error("bench: option inconnue " + argument);
+        }
+        if (options.nbRequetes == 0 || options.nbRepetitions == 0)
+            throw logic_error("bench: --requetes et --repetitions doivent être positifs");
+        return options;
+    }
+
+    //! \brief charge les données GTFS de p_date et [p_now1, p_now2), en mesurant chaque étape dans p_mesures
+    //! \param[in,out] p_mesures: les mesures de ajouterLignes, ajouterStations, ajouterServices, ajouterVoyagesDeLaDate,
+    //! \param[in,out] ajouterArretsDesVoyagesDeLaDate et ajouterTransferts, dans cet ordre
+    void charger(const string &p_dossier, DonneesGTFS &p_donnees, vector<Mesures> &p_mesures)
+    {
+        auto debut = chrono::steady_clock::now();
+        p_donnees.ajouterLignes(p_dossier + "/routes.txt");
+        p_mesures[0].ajouter(secondesDepuis(debut));
+        debut = chrono::steady_clock::now();
+        p_donnees.ajouterStations(p_dossier + "/stops.txt");
+        p_mesures[1].ajouter(secondesDepuis(debut));
+        debut = chrono::steady_clock::now();
+        p_donnees.ajouterServices(p_dossier + "/calendar_dates.txt");
+        p_mesures[2].ajouter(secondesDepuis(debut));
+        debut = chrono::steady_clock::now();
+        p_donnees.ajouterVoyagesDeLaDate(p_dossier + "/trips.txt");
+        p_mesures[3].ajouter(secondesDepuis(debut));
+        debut = chrono::steady_clock::now();
+        p_donnees.ajouterArretsDesVoyagesDeLaDate(p_dossier + "/stop_times.txt");
+        p_mesures[4].ajouter(secondesDepuis(debut));
+        debut = chrono::steady_clock::now();
+        p_donnees.ajouterTransferts(p_dossier + "/transfers.txt");
+        p_mesures[5].ajouter(secondesDepuis(debut));
+    }
+
+    //! \brief des paires de points à plus de 2,1 fois la distance de marche, tirées avec p_generateur (comme main.cpp)
+    vector<pair<Coordonnees, Coordonnees> > tirerRequetes(const DonneesGTFS &p_donnees, unsigned int p_nbRequetes,
+                                                          mt19937 &p_generateur)
+    {
+        vector<Coordonnees> points;
+        for (const auto &station : p_donnees.getStations()) points.push_back(station.second.getCoords());
+        uniform_int_distribution<size_t> distribution(0, points.size() - 1);
+        vector<pair<Coordonnees, Coordonnees> > requetes;
+        while (requetes.size() < p_nbRequetes)
+        {
+            const Coordonnees &origine = points[distribution(p_generateur)];
+            const Coordonnees &destination = points[distribution(p_generateur)];
+            if (origine - destination > 2.1 * ReseauGTFS::distanceMaxMarche) requetes.push_back({origine, destination});
+        }
+        return requetes;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        const Options options = lireOptions(argc, argv);
+        const Date date(2017, 8, 18);
+        const Heure now1(8, 30, 0);
+        const Heure now2 = now1.add_secondes(86400);
+        Rapport rapport(options);
+
+        //chargement: chaque répétition part d'un objet DonneesGTFS vide
+        vector<Mesures> chargement = {Mesures("DonneesGTFS::ajouterLignes"), Mesures("DonneesGTFS::ajouterStations"),
+                                      Mesures("DonneesGTFS::ajouterServices"),
+                                      Mesures("DonneesGTFS::ajouterVoyagesDeLaDate"),
+                                      Mesures("DonneesGTFS::ajouterArretsDesVoyagesDeLaDate"),
+                                      Mesures("DonneesGTFS::ajouterTransferts")};
+        DonneesGTFS donnees(date, now1, now2);
+        charger(options.dossier, donnees, chargement);
+        for (unsigned int r = 1; r < options.nbRepetitions; ++r)
+        {
+            DonneesGTFS repetition(date, now1, now2);
+            charger(options.dossier, repetition, chargement);
+        }
+        for (const Mesures &mesures : chargement) rapport.rapporter(mesures);
+
+        //construction du réseau, phase par phase
+        Mesures table("TableArrets::TableArrets"), voyages("ReseauGTFS::ajouterArcsVoyages"),
+                attentes("ReseauGTFS::ajouterArcsAttentes"), transferts("ReseauGTFS::ajouterArcsTransferts"),
+                figer("Graphe::figer"), inverser("Graphe::inverser"), reseauComplet("ReseauGTFS::ReseauGTFS");
+        for (unsigned int r = 0; r < options.nbRepetitions; ++r)
+        {
+            auto debut = chrono::steady_clock::now();
+            TableArrets tableArrets(donnees);
+            table.ajouter(secondesDepuis(debut));
+            debut = chrono::steady_clock::now();
+            ReseauGTFS reseau(donnees);
+            reseauComplet.ajouter(secondesDepuis(debut));
+            const DureesConstruction &durees = reseau.getDureesConstruction();
+            voyages.ajouter(durees.arcsVoyages);
+            attentes.ajouter(durees.arcsAttentes);
+            transferts.ajouter(durees.arcsTransferts);
+            figer.ajouter(durees.figer);
+            inverser.ajouter(durees.inverser);
+        }
+        for (const Mesures *mesures : {&table, &voyages, &attentes, &transferts, &figer, &inverser, &reseauComplet})
+            rapport.rapporter(*mesures);
+
+        //requêtes de bout en bout sur le réseau de la journée
+        ReseauGTFS reseau(donnees);
+        mt19937 generateur(options.graine);
+        vector<pair<Coordonnees, Coordonnees> > requetes = tirerRequetes(donnees, options.nbRequetes, generateur);
+        EspaceRecherche espace;
+        Mesures itineraire("ReseauGTFS::itineraire");
+        if (rapport.retenu(itineraire.getNom()))
+        {
+            for (const auto &requete : requetes)
+            {
+                long tempsExecution(0);
+                auto debut = chrono::steady_clock::now();
+                reseau.itineraire(donnees, requete.first, requete.second, false, tempsExecution, espace);
+                itineraire.ajouter(secondesDepuis(debut));
+            }
+        }
+        rapport.rapporter(itineraire);
+
+        //recherche unidirectionnelle et bidirectionnelle sur les mêmes surcouches
+        vector<Graphe::Surcouche> surcouches(requetes.size());
+        for (size_t i = 0; i < requetes.size(); ++i)
+            reseau.construireSurcouche(donnees, requetes[i].first, requetes[i].second, surcouches[i]);
+        Mesures unidirectionnel("Graphe::plusCourtChemin(surcouche)"),
+                bidirectionnel("Graphe::plusCourtCheminBidirectionnel");
+        vector<unsigned int> durees(surcouches.size());
+        vector<size_t> cheminSurcouche;
+        for (size_t i = 0; i < surcouches.size() && rapport.retenu(unidirectionnel.getNom()); ++i)
+        {
+            auto debut = chrono::steady_clock::now();
+            durees[i] = reseau.getGraphe().plusCourtChemin(surcouches[i], cheminSurcouche, espace);
+            unidirectionnel.ajouter(secondesDepuis(debut));
+        }
+        EspaceRecherche espaceArriere;
+        for (size_t i = 0; i < surcouches.size() && rapport.retenu(bidirectionnel.getNom()); ++i)
+        {
+            auto debut = chrono::steady_clock::now();
+            unsigned int duree = reseau.getGraphe().plusCourtCheminBidirectionnel(
+                    reseau.getGrapheInverse(), surcouches[i], cheminSurcouche, espace, espaceArriere);
+            bidirectionnel.ajouter(secondesDepuis(debut));
+            if (unidirectionnel.getNbExecutions() && duree != durees[i])
+                throw logic_error("bench: plusCourtCheminBidirectionnel() et plusCourtChemin() diffèrent");
+        }
+        Mesures aEtoile("ReseauGTFS::plusCourtCheminGeographique");
+        for (size_t i = 0; i < surcouches.size() && rapport.retenu(aEtoile.getNom()); ++i)
+        {
+            auto debut = chrono::steady_clock::now();
+            unsigned int duree = reseau.plusCourtCheminGeographique(surcouches[i], requetes[i].second, cheminSurcouche,
+                                                                    espace);
+            aEtoile.ajouter(secondesDepuis(debut));
+            if (unidirectionnel.getNbExecutions() && duree != durees[i])
+                throw logic_error("bench: plusCourtCheminGeographique() et plusCourtChemin() diffèrent");
+        }
+        //repères ALT: le prétraitement, puis les requêtes qu'il oriente
+        Mesures pretraitement("Reperes::Reperes"), alt("ReseauGTFS::plusCourtCheminReperes");
+        Reperes reperes;
+        const bool avecReperes = rapport.retenu(pretraitement.getNom()) || rapport.retenu(alt.getNom());
+        for (unsigned int r = 0; r < options.nbRepetitions && avecReperes; ++r)
+        {
+            auto debut = chrono::steady_clock::now();
+            reperes = Reperes(reseau, 16, max(1u, thread::hardware_concurrency()));
+            pretraitement.ajouter(secondesDepuis(debut));
+        }
+        for (size_t i = 0; i < surcouches.size() && rapport.retenu(alt.getNom()); ++i)
+        {
+            auto debut = chrono::steady_clock::now();
+            unsigned int duree = reseau.plusCourtCheminReperes(reperes, surcouches[i], cheminSurcouche, espace);
+            alt.ajouter(secondesDepuis(debut));
+            if (unidirectionnel.getNbExecutions() && duree != durees[i])
+                throw logic_error("bench: plusCourtCheminReperes() et plusCourtChemin() diffèrent");
+        }
+        rapport.rapporter(unidirectionnel);
+        rapport.rapporter(bidirectionnel);
+        rapport.rapporter(aEtoile);
+        rapport.rapporter(pretraitement);
+        rapport.rapporter(alt);
+
+        //motifs de trajets: le précalcul de 100 stations origine, puis des requêtes de station à station au départ de
+        //ces stations (main.cpp les compare à la recherche de Dijkstra)
+        Mesures precalculMotifs("MotifsTransferts::MotifsTransferts"), motifs("MotifsTransferts::tempsDuTrajet");
+        if (rapport.retenu(precalculMotifs.getNom()) || rapport.retenu(motifs.getNom()))
+        {
+            uniform_int_distribution<unsigned int> stations(0, reseau.getTable().getNbStations() - 1);
+            uniform_int_distribution<unsigned int> heures(0, 4 * 3600);
+            vector<unsigned int> origines(100);
+            for (unsigned int &origine : origines) origine = stations(generateur);
+            unique_ptr<MotifsTransferts> precalcul;
+            for (unsigned int r = 0; r < options.nbRepetitions; ++r)
+            {
+                auto debut = chrono::steady_clock::now();
+                precalcul.reset(new MotifsTransferts(reseau, origines, max(1u, thread::hardware_concurrency())));
+                precalculMotifs.ajouter(secondesDepuis(debut));
+            }
+            for (unsigned int i = 0; i < options.nbRequetes && precalcul; ++i)
+            {
+                const unsigned int origine = origines[i % origines.size()], destination = stations(generateur);
+                const unsigned int heureDepart = TableArrets::enSecondes(now1) + heures(generateur);
+                auto debut = chrono::steady_clock::now();
+                precalcul->tempsDuTrajet(origine, destination, heureDepart);
+                motifs.ajouter(secondesDepuis(debut));
+            }
+        }
+        rapport.rapporter(precalculMotifs);
+        rapport.rapporter(motifs);
+
+        //algorithmes de plus court chemin entre sommets: legacyplusCourtChemin() est quadratique et pccBellmanFord()
+        //trie tout le graphe à chaque requête, ils sont donc comparés sur le réseau d'une heure
+        DonneesGTFS donneesHeure(date, now1, now1.add_secondes(3600));
+        vector<Mesures> inutilisees(6, Mesures(""));
+        charger(options.dossier, donneesHeure, inutilisees);
+        ReseauGTFS reseauHeure(donneesHeure);
+        const Graphe &graphe = reseauHeure.getGraphe();
+        uniform_int_distribution<size_t> sommets(0, graphe.getNbSommets() - 1);
+        vector<pair<size_t, size_t> > paires;
+        for (unsigned int i = 0; i < options.nbRequetes; ++i)
+        {
+            size_t origine = sommets(generateur);
+            paires.push_back({origine, sommets(generateur)});
+        }
+        Mesures dijkstra("Graphe::plusCourtChemin"), legacy("Graphe::legacyplusCourtChemin"),
+                bellmanFord("Graphe::pccBellmanFord");
+        vector<size_t> chemin;
+        vector<unsigned int> distances(paires.size());
+        for (size_t i = 0; i < paires.size() && rapport.retenu(dijkstra.getNom()); ++i)
+        {
+            auto debut = chrono::steady_clock::now();
+            distances[i] = graphe.plusCourtChemin(paires[i].first, paires[i].second, chemin, espace);
+            dijkstra.ajouter(secondesDepuis(debut));
+        }
+        for (size_t i = 0; i < paires.size() && rapport.retenu(legacy.getNom()); ++i)
+        {
+            auto debut = chrono::steady_clock::now();
+            unsigned int distance = graphe.legacyplusCourtChemin(paires[i].first, paires[i].second, chemin);
+            legacy.ajouter(secondesDepuis(debut));
+            if (dijkstra.getNbExecutions() && distance != distances[i])
+                throw logic_error("bench: legacyplusCourtChemin() et plusCourtChemin() diffèrent");
+        }
+        for (size_t i = 0; i < paires.size() && rapport.retenu(bellmanFord.getNom()); ++i)
+        {
+            auto debut = chrono::steady_clock::now();
+            unsigned int distance = graphe.pccBellmanFord(paires[i].first, paires[i].second, chemin);
+            bellmanFord.ajouter(secondesDepuis(debut));
+            if (dijkstra.getNbExecutions() && distance != distances[i])
+                throw logic_error("bench: pccBellmanFord() et plusCourtChemin() diffèrent");
+        }
+        rapport.rapporter(dijkstra);
+        rapport.rapporter(legacy);
+        rapport.rapporter(bellmanFord);
+
+        rapport.ecrireCSV();
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,55 @@
+//
+//  espacerecherche.cpp
+//  Tampons réutilisables d'une recherche de plus court chemin
+//
+
+#include "espacerecherche.h"
+
+using namespace std;
+
+//! \brief Constructeur: tous les compteurs sont à zéro
+StatistiquesRecherche::StatistiquesRecherche()
+    : nbInsertions(0), nbExtractions(0), nbEntreesPerimees(0), nbRelaxations(0), nbSommetsFixes(0)
+{
+}
+
+//! \brief Constructeur d'un espace vide; la mémoire est allouée à la première recherche
+EspaceRecherche::EspaceRecherche() : m_generation(0)
+{
+}
+
+//! \brief prépare l'espace pour une nouvelle recherche sur un graphe de p_nbSommets sommets
+//! \post aucun sommet n'est atteint, la file de priorité est vide et les compteurs sont à zéro
+//! \post les tampons ne sont remplis que lorsqu'ils grandissent ou lorsque le compteur de générations déborde
+void EspaceRecherche::preparer(size_t p_nbSommets)
+{
+    m_generation += 2;
+    if (m_generation == 0) //débordement: on repart de zéro
+    {
+        m_generation = 2;
+        for (Etiquette &e : m_etiquettes) e.generation = 0;
+        for (Cible &c : m_cibles) c.generation = 0;
+    }
+    if (m_etiquettes.size() < p_nbSommets)
+    {
+        m_etiquettes.resize(p_nbSommets, {0, numeric_limits<unsigned int>::max(), numeric_limits<size_t>::max()});
+        m_cibles.resize(p_nbSommets, {0, 0});
+    }
+    m_tas.vider();
+    m_stats = StatistiquesRecherche();
+}
+
+TasRadix &EspaceRecherche::getTas()
+{
+    return m_tas;
+}
+
+StatistiquesRecherche &EspaceRecherche::getStatistiques()
+{
+    return m_stats;
+}
+
+const StatistiquesRecherche &EspaceRecherche::getStatistiques() const
+{
+    return m_stats;
+}
@@ -0,0 +1,119 @@
+//
+//  espacerecherche.h
+//  Tampons réutilisables d'une recherche de plus court chemin
+//
+
+#ifndef ESPACERECHERCHE_H
+#define ESPACERECHERCHE_H
+
+#include <vector>
+#include <cstddef>
+#include <limits>
+
+#include "tasradix.h"
+
+//! \brief  Compteurs d'opérations d'une recherche de plus court chemin
+struct StatistiquesRecherche
+{
+    StatistiquesRecherche();
+
+    unsigned long nbInsertions; /*!< le nombre d'insertions dans la file de priorité */
+    unsigned long nbExtractions; /*!< le nombre d'extractions de la file de priorité */
+    unsigned long nbEntreesPerimees; /*!< les extractions d'un sommet déjà fixé (entrée remplacée par une distance plus courte) */
+    unsigned long nbRelaxations; /*!< le nombre d'arcs examinés */
+    unsigned long nbSommetsFixes; /*!< le nombre de sommets dont la distance a été fixée */
+};
+
+//! \brief  Espace de travail d'une recherche de plus court chemin (distances, prédécesseurs, file de priorité)
+//! \brief  Les tampons sont conservés d'une requête à l'autre. Plutôt que de les remplir à chaque requête (O(|V|)),
+//! \brief  chaque sommet porte la génération de la dernière requête qui l'a atteint: un sommet d'une génération
+//! \brief  antérieure est considéré comme non atteint.
+//! \note   Un espace ne doit servir qu'à une recherche à la fois.
+class EspaceRecherche
+{
+public:
+
+    EspaceRecherche();
+    void preparer(size_t p_nbSommets);
+
+    //! \brief indique si p_sommet a été atteint par la recherche courante
+    bool estAtteint(size_t p_sommet) const
+    {
+        return m_etiquettes[p_sommet].generation >= m_generation;
+    }
+
+    //! \brief indique si la distance de p_sommet a été fixée par la recherche courante
+    bool estFixe(size_t p_sommet) const
+    {
+        return m_etiquettes[p_sommet].generation == m_generation + 1;
+    }
+
+    //! \brief retourne la distance provisoire de p_sommet (numeric_limits<unsigned int>::max() s'il n'est pas atteint)
+    unsigned int getDistance(size_t p_sommet) const
+    {
+        return estAtteint(p_sommet) ? m_etiquettes[p_sommet].distance : std::numeric_limits<unsigned int>::max();
+    }
+
+    //! \brief retourne le prédécesseur de p_sommet (numeric_limits<size_t>::max() s'il n'en a pas)
+    size_t getPredecesseur(size_t p_sommet) const
+    {
+        return estAtteint(p_sommet) ? m_etiquettes[p_sommet].predecesseur : std::numeric_limits<size_t>::max();
+    }
+
+    //! \brief assigne une distance provisoire et un prédécesseur à p_sommet
+    void assigner(size_t p_sommet, unsigned int p_distance, size_t p_predecesseur)
+    {
+        Etiquette &e = m_etiquettes[p_sommet];
+        e.generation = m_generation;
+        e.distance = p_distance;
+        e.predecesseur = p_predecesseur;
+    }
+
+    //! \brief fixe la distance de p_sommet (qui doit être atteint)
+    void fixer(size_t p_sommet)
+    {
+        m_etiquettes[p_sommet].generation = m_generation + 1;
+    }
+
+    //! \brief ajoute, pour la recherche courante, un arc de poids p_poids de p_sommet vers la destination virtuelle
+    //! \brief d'une Graphe::Surcouche (s'il y en a déjà un, le plus léger est gardé)
+    void ajouterArcCible(size_t p_sommet, unsigned int p_poids)
+    {
+        Cible &c = m_cibles[p_sommet];
+        if (c.generation != m_generation || p_poids < c.poids) c = {m_generation, p_poids};
+    }
+
+    //! \brief poids de l'arc de p_sommet vers la destination virtuelle (numeric_limits<unsigned int>::max() s'il n'y en a pas)
+    unsigned int getPoidsCible(size_t p_sommet) const
+    {
+        const Cible &c = m_cibles[p_sommet];
+        return c.generation == m_generation ? c.poids : std::numeric_limits<unsigned int>::max();
+    }
+
+    TasRadix &getTas();
+    StatistiquesRecherche &getStatistiques();
+    const StatistiquesRecherche &getStatistiques() const;
+
+private:
+
+    struct Etiquette
+    {
+        unsigned int generation; /*!< m_generation si atteint, m_generation + 1 si fixé */
+        unsigned int distance;
+        size_t predecesseur;
+    };
+
+    struct Cible
+    {
+        unsigned int generation; /*!< m_generation si l'arc appartient à la recherche courante */
+        unsigned int poids;
+    };
+
+    std::vector<Etiquette> m_etiquettes; /*!< les étiquettes des sommets, valides seulement pour la génération courante */
+    std::vector<Cible> m_cibles; /*!< les arcs vers la destination virtuelle, valides seulement pour la génération courante */
+    unsigned int m_generation; /*!< la génération de la recherche courante (toujours paire) */
+    TasRadix m_tas;
+    StatistiquesRecherche m_stats;
+};
+
+#endif //ESPACERECHERCHE_H
@@ -0,0 +1,348 @@
+//
+//  fluxgtfs.cpp
+//  Flux GTFS lu une seule fois, dont on tire ensuite un DonneesGTFS pour n'importe quelle date de sa période
+//
+
+#include "fluxgtfs.h"
+#include "lecteurcsv.h"
+
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <algorithm>
+
+using namespace std;
+
+//! \brief lit tous les fichiers du dossier GTFS p_dossier
+//! \param[in] p_dossier: le dossier qui contient routes.txt, stops.txt, calendar_dates.txt, trips.txt,
+//! \param[in] stop_times.txt et transfers.txt
+//! \param[in] p_nbThreads: le nombre de threads qui lisent stop_times.txt (0 pour thread::hardware_concurrency())
+//! \throws logic_error si un fichier ne peut pas être lu ou si calendar_dates.txt ne contient aucune date
+FluxGTFS::FluxGTFS(const std::string &p_dossier, unsigned int p_nbThreads)
+        : m_nbJours(0), m_nbMots(0)
+{
+    if (p_nbThreads == 0) p_nbThreads = max(1u, thread::hardware_concurrency());
+    m_fuseauHoraire = lireFuseauHoraire(p_dossier + "/agency.txt");
+    lireLignes(p_dossier + "/routes.txt");
+    lireStations(p_dossier + "/stops.txt");
+    lireServices(p_dossier + "/calendar_dates.txt");
+    for (unsigned int jour = 0; jour < m_nbJours; ++jour) //TZ n'est changé qu'ici, au chargement
+        m_debutsJournees.push_back(m_premiereDate.add_jours((int) jour).debutJourneeService(m_fuseauHoraire));
+    lireVoyages(p_dossier + "/trips.txt");
+    lireArrets(p_dossier + "/stop_times.txt", p_nbThreads);
+    lireTransferts(p_dossier + "/transfers.txt");
+
+    m_ordreArrivees.resize(m_arrets.size());
+    for (unsigned int i = 0; i < m_ordreArrivees.size(); ++i) m_ordreArrivees[i] = i;
+    stable_sort(m_ordreArrivees.begin(), m_ordreArrivees.end(), [this](unsigned int p_a, unsigned int p_b)
+    {
+        return m_arrets[p_a].arrivee < m_arrets[p_b].arrivee;
+    });
+}
+
+//! \brief la première date de calendar_dates.txt
+Date FluxGTFS::getPremiereDate() const
+{
+    return m_premiereDate;
+}
+
+//! \brief la dernière date de calendar_dates.txt
+Date FluxGTFS::getDerniereDate() const
+{
+    return m_premiereDate.add_jours((int) m_nbJours - 1);
+}
+
+unsigned int FluxGTFS::getNbJours() const
+{
+    return m_nbJours;
+}
+
+//! \brief indique si le service p_service (numéro interné) roule à la date p_date
+//! \return false si p_date est hors de la période du flux
+bool FluxGTFS::estActif(unsigned int p_service, const Date &p_date) const
+{
+    int jour = p_date - m_premiereDate;
+    if (p_service >= m_idsServices.getNbIdentifiants() || jour < 0 || jour >= (int) m_nbJours) return false;
+    return (m_joursServices[p_service * m_nbMots + jour / 64] >> (jour % 64)) & 1;
+}
+
+size_t FluxGTFS::getNbServices() const
+{
+    return m_idsServices.getNbIdentifiants();
+}
+
+//! \brief l'agency_timezone du flux (celui de la première agence, GTFS l'imposant à toutes)
+const std::string &FluxGTFS::getFuseauHoraire() const
+{
+    return m_fuseauHoraire;
+}
+
+//! \brief l'heure POSIX où commencent les heures GTFS de p_date (voir Date::debutJourneeService()), calculée à la lecture
+//! \throws logic_error si p_date est hors de la période du flux
+long long FluxGTFS::getDebutJourneeService(const Date &p_date) const
+{
+    int jour = p_date - m_premiereDate;
+    if (jour < 0 || jour >= (int) m_nbJours)
+        throw logic_error("FluxGTFS::getDebutJourneeService(): la date est hors de la période du flux");
+    return m_debutsJournees[jour];
+}
+
+const Identifiants &FluxGTFS::getIdsServices() const
+{
+    return m_idsServices;
+}
+
+//! \brief la table qui donne le trip_id de chaque voyage de getVoyages()
+const Identifiants &FluxGTFS::getIdsVoyages() const
+{
+    return m_idsVoyages;
+}
+
+const std::vector<Ligne> &FluxGTFS::getLignes() const
+{
+    return m_lignes;
+}
+
+//! \brief les stations de stops.txt, sans arrêts
+const std::vector<Station> &FluxGTFS::getStations() const
+{
+    return m_stations;
+}
+
+//! \brief la station de stops.txt dont le stop_id est p_stationId (nullptr si elle est absente)
+const Station *FluxGTFS::chercherStation(unsigned int p_stationId) const
+{
+    auto itr = m_indiceStation.find(p_stationId);
+    return itr == m_indiceStation.end() ? nullptr : &m_stations[itr->second];
+}
+
+const std::vector<FluxGTFS::VoyageFlux> &FluxGTFS::getVoyages() const
+{
+    return m_voyages;
+}
+
+const std::vector<FluxGTFS::ArretFlux> &FluxGTFS::getArrets() const
+{
+    return m_arrets;
+}
+
+//! \brief les arrêts dont l'heure d'arrivée est dans [p_debut, p_fin), sans parcourir les autres
+//! \param[out] p_arrets: leurs indices dans getArrets(), dans l'ordre du fichier
+void FluxGTFS::arretsArrivantDans(unsigned int p_debut, unsigned int p_fin, std::vector<unsigned int> &p_arrets) const
+{
+    p_arrets.clear();
+    if (p_debut >= p_fin) return;
+    auto avant = [this](unsigned int p_arret, unsigned int p_heure) { return m_arrets[p_arret].arrivee < p_heure; };
+    auto debut = lower_bound(m_ordreArrivees.begin(), m_ordreArrivees.end(), p_debut, avant);
+    auto fin = lower_bound(debut, m_ordreArrivees.end(), p_fin, avant);
+    p_arrets.assign(debut, fin);
+    sort(p_arrets.begin(), p_arrets.end());
+}
+
+//! \brief les transferts entre deux stations différentes (un temps nul devient 1 seconde), que les stations aient des
+//! \brief arrêts ou non
+const std::vector<std::tuple<unsigned int, unsigned int, unsigned int> > &FluxGTFS::getTransferts() const
+{
+    return m_transferts;
+}
+
+//! \brief lit le fuseau horaire (agency_timezone) de la première agence de agency.txt
+//! \brief agency_id est facultatif: la colonne du fuseau est cherchée dans l'en-tête. Sert aussi à
+//! \brief DonneesGTFS::ajouterAgences().
+//! \throws logic_error si le fichier ne peut pas être lu ou s'il ne donne aucun fuseau
+string FluxGTFS::lireFuseauHoraire(const std::string &p_nomFichier)
+{
+    LecteurCSV lecteur(p_nomFichier);
+    string fuseauHoraire;
+    try
+    {
+        vector<ChampCSV> champs;
+        lecteur.lireLigne(champs);
+        size_t colonne = 0;
+        while (colonne < champs.size() && champs[colonne].versString() != "agency_timezone") ++colonne;
+        if (lecteur.lireLigne(champs)) fuseauHoraire = champs.at(colonne).versString();
+    }
+    catch (...)
+    {
+        throw logic_error("FluxGTFS::lireFuseauHoraire(): erreur à la ligne " + to_string(lecteur.getNumeroLigne()));
+    }
+    if (fuseauHoraire.empty()) throw logic_error("FluxGTFS::lireFuseauHoraire(): aucun agency_timezone");
+    return fuseauHoraire;
+}
+
+void FluxGTFS::lireLignes(const std::string &p_nomFichier)
+{
+    LecteurCSV lecteur(p_nomFichier);
+    try
+    {
+        vector<ChampCSV> champs;
+        lecteur.lireLigne(champs);
+        while (lecteur.lireLigne(champs))
+            m_lignes.push_back(Ligne(champs.at(0).versEntier(), champs.at(2).versString(), champs.at(4).versString(),
+                                     Ligne::couleurToCategorie(champs.at(7).versString())));
+    }
+    catch (...)
+    {
+        throw logic_error("FluxGTFS::lireLignes(): erreur à la ligne " + to_string(lecteur.getNumeroLigne()));
+    }
+}
+
+void FluxGTFS::lireStations(const std::string &p_nomFichier)
+{
+    LecteurCSV lecteur(p_nomFichier);
+    try
+    {
+        vector<ChampCSV> champs;
+        lecteur.lireLigne(champs);
+        while (lecteur.lireLigne(champs))
+        {
+            unsigned int id = champs.at(0).versEntier();
+            m_indiceStation.insert({id, (unsigned int) m_stations.size()}); //la première station d'un stop_id répété
+            m_stations.push_back(Station(id, champs.at(1).versString(), champs.at(2).versString(),
+                                         Coordonnees(champs.at(3).versReel(), champs.at(4).versReel())));
+        }
+    }
+    catch (...)
+    {
+        throw logic_error("FluxGTFS::lireStations(): erreur à la ligne " + to_string(lecteur.getNumeroLigne()));
+    }
+}
+
+//! \brief interne tous les service_id et construit leur masque de jours actifs
+//! \brief Comme DonneesGTFS::ajouterServices(), seules les exceptions de type 1 (service ajouté) rendent un service actif.
+void FluxGTFS::lireServices(const std::string &p_nomFichier)
+{
+    vector<pair<unsigned int, Date> > ajouts;
+    LecteurCSV lecteur(p_nomFichier);
+    try
+    {
+        vector<ChampCSV> champs;
+        lecteur.lireLigne(champs);
+        while (lecteur.lireLigne(champs))
+        {
+            unsigned int service = m_idsServices.interner(champs.at(0));
+            Date date = champs.at(1).versDate();
+            if (m_nbJours == 0 || date < m_premiereDate) m_premiereDate = date;
+            m_nbJours = 1;
+            if (champs.at(2).versEntier() == 1) ajouts.push_back({service, date});
+        }
+    }
+    catch (...)
+    {
+        throw logic_error("FluxGTFS::lireServices(): erreur à la ligne " + to_string(lecteur.getNumeroLigne()));
+    }
+    if (m_nbJours == 0)
+        throw logic_error("FluxGTFS::lireServices(): " + p_nomFichier + " ne contient aucune date");
+
+    for (const auto &ajout : ajouts)
+        m_nbJours = max(m_nbJours, (unsigned int) (ajout.second - m_premiereDate) + 1);
+    m_nbMots = (m_nbJours + 63) / 64;
+    m_joursServices.assign(m_idsServices.getNbIdentifiants() * m_nbMots, 0);
+    for (const auto &ajout : ajouts)
+    {
+        unsigned int jour = (unsigned int) (ajout.second - m_premiereDate);
+        m_joursServices[ajout.first * m_nbMots + jour / 64] |= uint64_t(1) << (jour % 64);
+    }
+}
+
+//! \brief lit tous les voyages; un trip_id répété n'est gardé qu'une fois, comme dans DonneesGTFS
+void FluxGTFS::lireVoyages(const std::string &p_nomFichier)
+{
+    LecteurCSV lecteur(p_nomFichier);
+    try
+    {
+        vector<ChampCSV> champs;
+        lecteur.lireLigne(champs);
+        while (lecteur.lireLigne(champs))
+        {
+            if (m_idsVoyages.interner(champs.at(2)) != m_voyages.size()) continue;
+            unsigned int service = m_idsServices.chercher(champs.at(1));
+            if (service == Identifiants::aucun) service = m_idsServices.interner(champs.at(1)); //jamais actif
+            m_voyages.push_back({(unsigned int) champs.at(0).versEntier(), service, champs.at(3).versString()});
+        }
+    }
+    catch (...)
+    {
+        throw logic_error("FluxGTFS::lireVoyages(): erreur à la ligne " + to_string(lecteur.getNumeroLigne()));
+    }
+    m_joursServices.resize(m_idsServices.getNbIdentifiants() * m_nbMots, 0);
+}
+
+//! \brief lit tous les arrêts des voyages connus, par plages de lignes lues simultanément, puis les regroupe dans
+//! \brief l'ordre du fichier
+void FluxGTFS::lireArrets(const std::string &p_nomFichier, unsigned int p_nbThreads)
+{
+    LecteurCSV lecteur(p_nomFichier);
+    try
+    {
+        vector<ChampCSV> champs;
+        lecteur.lireLigne(champs);
+    }
+    catch (...)
+    {
+        throw logic_error("FluxGTFS::lireArrets(): erreur à la ligne 1");
+    }
+
+    const Heure minuit(0, 0, 0);
+    vector<PlageCSV> plages = lecteur.decouper(p_nbThreads);
+    vector<vector<ArretFlux> > arretsLus(plages.size());
+    vector<exception_ptr> erreurs(plages.size());
+    auto lirePlage = [this, &plages, &arretsLus, &erreurs, &minuit](size_t p_plage)
+    {
+        try
+        {
+            vector<ChampCSV> champs;
+            while (plages[p_plage].lireLigne(champs))
+            {
+                unsigned int voyage = m_idsVoyages.chercher(champs.at(0));
+                if (voyage == Identifiants::aucun) continue;
+                arretsLus[p_plage].push_back({voyage, (unsigned int) champs.at(3).versEntier(),
+                                              (unsigned int) (champs.at(1).versHeure() - minuit),
+                                              (unsigned int) (champs.at(2).versHeure() - minuit),
+                                              (unsigned int) champs.at(4).versEntier()});
+            }
+        }
+        catch (...) //l'erreur est relancée par le thread principal
+        {
+            erreurs[p_plage] = current_exception();
+        }
+    };
+    vector<thread> threads;
+    for (size_t i = 1; i < plages.size(); ++i) threads.push_back(thread(lirePlage, i));
+    if (!plages.empty()) lirePlage(0);
+    for (thread &t : threads) t.join();
+
+    size_t nbArrets = 0;
+    for (size_t i = 0; i < plages.size(); ++i)
+    {
+        if (erreurs[i])
+            throw logic_error("FluxGTFS::lireArrets(): erreur à la ligne " + to_string(plages[i].getNumeroLigne()) +
+                              " de la plage " + to_string(i));
+        nbArrets += arretsLus[i].size();
+    }
+    m_arrets.reserve(nbArrets);
+    for (const vector<ArretFlux> &arrets : arretsLus)
+        m_arrets.insert(m_arrets.end(), arrets.begin(), arrets.end());
+}
+
+void FluxGTFS::lireTransferts(const std::string &p_nomFichier)
+{
+    LecteurCSV lecteur(p_nomFichier);
+    try
+    {
+        vector<ChampCSV> champs;
+        lecteur.lireLigne(champs);
+        while (lecteur.lireLigne(champs))
+        {
+            unsigned int de = champs.at(0).versEntier();
+            unsigned int vers = champs.at(1).versEntier();
+            if (de == vers) continue;
+            unsigned int temps = champs.at(3).versEntier();
+            m_transferts.push_back(make_tuple(de, vers, max(1u, temps)));
+        }
+    }
+    catch (...)
+    {
+        throw logic_error("FluxGTFS::lireTransferts(): erreur à la ligne " + to_string(lecteur.getNumeroLigne()));
+    }
+}
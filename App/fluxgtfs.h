@@ -0,0 +1,95 @@
+//
+//  fluxgtfs.h
+//  Flux GTFS lu une seule fois, dont on tire ensuite un DonneesGTFS pour n'importe quelle date de sa période
+//
+
+#ifndef FLUXGTFS_H
+#define FLUXGTFS_H
+
+#include <string>
+#include <vector>
+#include <tuple>
+#include <cstdint>
+#include <unordered_map>
+
+#include "auxiliaires.h"
+#include "ligne.h"
+#include "station.h"
+#include "identifiants.h"
+
+//! \brief  Toutes les lignes, stations, services, voyages, arrêts et transferts d'un dossier GTFS, sans filtre de date
+//! \brief  ni d'heure. Chaque service porte un masque de bits des jours où il est actif sur la période couverte par
+//! \brief  calendar_dates.txt; DonneesGTFS(const FluxGTFS &, ...) en tire le réseau d'une date sans relire les fichiers.
+//! \brief  Les heures sont en secondes depuis minuit et les éléments sont gardés dans l'ordre des fichiers.
+class FluxGTFS
+{
+public:
+
+    //! \brief un voyage de trips.txt; son trip_id est getIdsVoyages().getChaine() de son indice
+    struct VoyageFlux
+    {
+        unsigned int ligne; /*!< le route_id */
+        unsigned int service; /*!< le service_id interné (voir getIdsServices()) */
+        std::string destination;
+    };
+
+    //! \brief une ligne de stop_times.txt dont le voyage est connu
+    struct ArretFlux
+    {
+        unsigned int voyage; /*!< l'indice du voyage dans getVoyages() */
+        unsigned int station;
+        unsigned int arrivee;
+        unsigned int depart;
+        unsigned int sequence;
+    };
+
+    explicit FluxGTFS(const std::string &p_dossier, unsigned int p_nbThreads = 0);
+
+    Date getPremiereDate() const;
+    Date getDerniereDate() const;
+    unsigned int getNbJours() const;
+    bool estActif(unsigned int p_service, const Date &p_date) const;
+
+    const std::string &getFuseauHoraire() const;
+    long long getDebutJourneeService(const Date &p_date) const;
+    size_t getNbServices() const;
+    const Identifiants &getIdsServices() const;
+    const Identifiants &getIdsVoyages() const;
+    const std::vector<Ligne> &getLignes() const;
+    const std::vector<Station> &getStations() const;
+    const Station *chercherStation(unsigned int p_stationId) const;
+    const std::vector<VoyageFlux> &getVoyages() const;
+    const std::vector<ArretFlux> &getArrets() const;
+    void arretsArrivantDans(unsigned int p_debut, unsigned int p_fin, std::vector<unsigned int> &p_arrets) const;
+    const std::vector<std::tuple<unsigned int, unsigned int, unsigned int> > &getTransferts() const;
+
+    static std::string lireFuseauHoraire(const std::string &p_nomFichier);
+
+private:
+
+    std::string m_fuseauHoraire; /*!< l'agency_timezone de agency.txt */
+    Date m_premiereDate;
+    unsigned int m_nbJours;
+    std::vector<long long> m_debutsJournees; /*!< Date::debutJourneeService() de chaque jour de la période */
+    unsigned int m_nbMots; /*!< le nombre de mots de 64 bits du masque de chaque service */
+    std::vector<uint64_t> m_joursServices; /*!< le masque du service s: m_joursServices[s * m_nbMots ..] */
+
+    Identifiants m_idsServices;
+    Identifiants m_idsVoyages;
+    std::vector<Ligne> m_lignes;
+    std::vector<Station> m_stations;
+    std::unordered_map<unsigned int, unsigned int> m_indiceStation; /*!< le stop_id vers l'indice dans m_stations */
+    std::vector<VoyageFlux> m_voyages;
+    std::vector<ArretFlux> m_arrets;
+    std::vector<unsigned int> m_ordreArrivees; /*!< les indices de m_arrets par heure d'arrivée, puis dans l'ordre du fichier */
+    std::vector<std::tuple<unsigned int, unsigned int, unsigned int> > m_transferts; /*!< comme DonneesGTFS::getTransferts() */
+
+    void lireLignes(const std::string &p_nomFichier);
+    void lireStations(const std::string &p_nomFichier);
+    void lireServices(const std::string &p_nomFichier);
+    void lireVoyages(const std::string &p_nomFichier);
+    void lireArrets(const std::string &p_nomFichier, unsigned int p_nbThreads);
+    void lireTransferts(const std::string &p_nomFichier);
+};
+
+#endif //FLUXGTFS_H
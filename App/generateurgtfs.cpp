@@ -0,0 +1,392 @@
+//
+//  generateurgtfs.cpp
+//  Générateur de flux GTFS synthétiques, pour mesurer le passage à l'échelle au-delà du réseau du RTC
+//
+//  Les stations sont placées sur une grille autour de Québec; chaque ligne est un trajet sans détour sur la grille,
+//  parcouru dans les deux sens toute la journée à intervalle fixe (doublé la fin de semaine). Les transferts relient
+//  les stations voisines à distance de marche. Le dossier produit est lisible par les DonneesGTFS::ajouter*() et par
+//  FluxGTFS; stop_times.txt est écrit au fil de l'eau et peut compter des dizaines de millions de lignes.
+//  Usage: generateurgtfs --dossier=synthetique [--stations=5000] [--lignes=300] [--arrets-par-ligne=30]
+//                        [--intervalle=600] [--voyages-par-ligne=0] [--premier=05:00:00] [--dernier=25:00:00]
+//                        [--espacement=250] [--rayon-transferts=400] [--densite-transferts=1.0]
+//                        [--debut=20170808] [--jours=120] [--graine=42]
+//
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+#include "auxiliaires.h"
+#include "coordonnees.h"
+
+using namespace std;
+
+namespace
+{
+    //! \brief les paramètres du réseau à générer
+    struct Parametres
+    {
+        string dossier;
+        unsigned int nbStations = 5000;
+        unsigned int nbLignes = 300;
+        unsigned int arretsParLigne = 30;
+        unsigned int intervalle = 600; //secondes entre deux départs d'une ligne dans un sens, en semaine
+        unsigned int voyagesParLigne = 0; //par sens et par jour de semaine; 0: déduit de l'intervalle
+        unsigned int premier = 5 * 3600; //heure du premier départ, en secondes depuis minuit
+        unsigned int dernier = 25 * 3600; //heure limite des départs (peut dépasser 24:00:00, comme dans GTFS)
+        double espacement = 250; //mètres entre deux stations voisines de la grille
+        double rayonTransferts = 400; //mètres
+        double densiteTransferts = 1.0; //proportion des paires à distance de marche qui ont un transfert
+        unsigned int debut = 20170808; //première date du calendrier (AAAAMMJJ)
+        unsigned int nbJours = 120;
+        unsigned int graine = 42;
+    };
+
+    const double latitudeCentre = 46.81;
+    const double longitudeCentre = -71.25;
+    const double metresParDegreLatitude = 111320.0;
+    const double vitesseBus = 20.0 / 3.6; //mètres par seconde
+    const double vitesseMarche = 5.0 / 3.6;
+    const unsigned int arretEnStation = 20; //secondes entre l'arrivée et le départ
+    const char *const couleurs[] = {"97BF0D", "013888", "E04503", "1A171B"}; //voir Ligne::couleurToCategorie()
+
+    //! \brief écriture tamponnée d'un fichier texte, sans passer par les flux de la bibliothèque standard
+    class Fichier
+    {
+    public:
+        explicit Fichier(const string &p_nom) : m_nom(p_nom), m_fichier(fopen(p_nom.c_str(), "wb"))
+        {
+            if (!m_fichier) throw logic_error("generateurgtfs: impossible d'écrire " + p_nom);
+            m_tampon.reserve(taille + 256);
+        }
+
+        ~Fichier()
+        {
+            if (m_fichier) fclose(m_fichier);
+        }
+
+        Fichier &operator<<(const char *p_texte)
+        {
+            m_tampon.append(p_texte);
+            return vider();
+        }
+
+        Fichier &operator<<(const string &p_texte)
+        {
+            m_tampon.append(p_texte);
+            return vider();
+        }
+
+        Fichier &operator<<(char p_caractere)
+        {
+            m_tampon.push_back(p_caractere);
+            return vider();
+        }
+
+        Fichier &operator<<(unsigned int p_valeur)
+        {
+            char chiffres[16];
+            int n = 0;
+            do
+            {
+                chiffres[n++] = (char) ('0' + p_valeur % 10);
+                p_valeur /= 10;
+            } while (p_valeur);
+            while (n) m_tampon.push_back(chiffres[--n]);
+            return vider();
+        }
+
+        //! \brief écrit p_secondes depuis minuit au format HH:MM:SS de GTFS (les heures peuvent dépasser 23)
+        Fichier &heure(unsigned int p_secondes)
+        {
+            unsigned int h = p_secondes / 3600, m = p_secondes / 60 % 60, s = p_secondes % 60;
+            if (h < 10) m_tampon.push_back('0');
+            *this << h;
+            char texte[7] = {':', (char) ('0' + m / 10), (char) ('0' + m % 10), ':', (char) ('0' + s / 10),
+                             (char) ('0' + s % 10), '\0'};
+            return *this << texte;
+        }
+
+        Fichier &reel(double p_valeur)
+        {
+            char texte[32];
+            snprintf(texte, sizeof(texte), "%.6f", p_valeur);
+            return *this << texte;
+        }
+
+        void fermer()
+        {
+            ecrire();
+            if (fclose(m_fichier) != 0)
+            {
+                m_fichier = nullptr;
+                throw logic_error("generateurgtfs: erreur d'écriture dans " + m_nom);
+            }
+            m_fichier = nullptr;
+        }
+
+    private:
+        static const size_t taille = 1 << 20;
+        string m_nom;
+        FILE *m_fichier;
+        string m_tampon;
+
+        Fichier &vider()
+        {
+            if (m_tampon.size() >= taille) ecrire();
+            return *this;
+        }
+
+        void ecrire()
+        {
+            if (fwrite(m_tampon.data(), 1, m_tampon.size(), m_fichier) != m_tampon.size())
+                throw logic_error("generateurgtfs: erreur d'écriture dans " + m_nom);
+            m_tampon.clear();
+        }
+    };
+
+    //! \brief une ligne générée: la suite de ses stations (indices dans la grille) et la durée de chaque tronçon
+    struct LigneGeneree
+    {
+        vector<unsigned int> stations;
+        vector<unsigned int> durees; //durees[k] est le temps de parcours de stations[k] à stations[k + 1]
+    };
+
+    unsigned int lireHeure(const string &p_texte)
+    {
+        unsigned int h = 0, m = 0, s = 0;
+        if (sscanf(p_texte.c_str(), "%u:%u:%u", &h, &m, &s) < 2)
+            throw logic_error("generateurgtfs: heure invalide " + p_texte);
+        return h * 3600 + m * 60 + s;
+    }
+
+    Parametres lireParametres(int argc, char *argv[])
+    {
+        Parametres parametres;
+        for (int i = 1; i < argc; ++i)
+        {
+            string argument = argv[i];
+            size_t egal = argument.find('=');
+            string cle = argument.substr(0, egal);
+            string valeur = egal == string::npos ? "" : argument.substr(egal + 1);
+            if (cle == "--dossier") parametres.dossier = valeur;
+            else if (cle == "--stations") parametres.nbStations = (unsigned int) stoul(valeur);
+            else if (cle == "--lignes") parametres.nbLignes = (unsigned int) stoul(valeur);
+            else if (cle == "--arrets-par-ligne") parametres.arretsParLigne = (unsigned int) stoul(valeur);
+            else if (cle == "--intervalle") parametres.intervalle = (unsigned int) stoul(valeur);
+            else if (cle == "--voyages-par-ligne") parametres.voyagesParLigne = (unsigned int) stoul(valeur);
+            else if (cle == "--premier") parametres.premier = lireHeure(valeur);
+            else if (cle == "--dernier") parametres.dernier = lireHeure(valeur);
+            else if (cle == "--espacement") parametres.espacement = stod(valeur);
+            else if (cle == "--rayon-transferts") parametres.rayonTransferts = stod(valeur);
+            else if (cle == "--densite-transferts") parametres.densiteTransferts = stod(valeur);
+            else if (cle == "--debut") parametres.debut = (unsigned int) stoul(valeur);
+            else if (cle == "--jours") parametres.nbJours = (unsigned int) stoul(valeur);
+            else if (cle == "--graine") parametres.graine = (unsigned int) stoul(valeur);
+            else throw logic_error("generateurgtfs: option inconnue " + argument);
+        }
+        if (parametres.dossier.empty()) throw logic_error("generateurgtfs: --dossier est requis");
+        if (parametres.nbStations < 2 || parametres.nbLignes == 0 || parametres.arretsParLigne < 2 ||
+            parametres.intervalle == 0 || parametres.nbJours == 0 || parametres.premier >= parametres.dernier)
+            throw logic_error("generateurgtfs: paramètres invalides");
+        return parametres;
+    }
+
+    //! \brief trace une ligne sur la grille: une marche sans retour sur ses pas, qui garde le plus souvent sa direction
+    LigneGeneree tracerLigne(const Parametres &p_parametres, unsigned int p_largeur, const vector<Coordonnees> &p_coords,
+                             mt19937 &p_generateur)
+    {
+        static const int directions[8][2] = {{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}};
+        const unsigned int nbStations = p_parametres.nbStations;
+        const unsigned int hauteur = (nbStations + p_largeur - 1) / p_largeur;
+        LigneGeneree ligne;
+        vector<char> visitee(nbStations, 0);
+        unsigned int courante = uniform_int_distribution<unsigned int>(0, nbStations - 1)(p_generateur);
+        int direction = uniform_int_distribution<int>(0, 7)(p_generateur);
+        ligne.stations.push_back(courante);
+        visitee[courante] = 1;
+        while (ligne.stations.size() < p_parametres.arretsParLigne)
+        {
+            //la direction courante d'abord, puis un virage d'un huitième de tour, puis les autres directions
+            int essais[8] = {0, 1, -1, 2, -2, 3, -3, 4};
+            if (p_generateur() % 4 == 0) swap(essais[0], essais[1 + p_generateur() % 2]);
+            bool avance = false;
+            for (int essai : essais)
+            {
+                int d = ((direction + essai) % 8 + 8) % 8;
+                int x = (int) (courante % p_largeur) + directions[d][0];
+                int y = (int) (courante / p_largeur) + directions[d][1];
+                if (x < 0 || y < 0 || x >= (int) p_largeur || y >= (int) hauteur) continue;
+                unsigned int suivante = (unsigned int) y * p_largeur + (unsigned int) x;
+                if (suivante >= nbStations || visitee[suivante]) continue;
+                double metres = (p_coords[courante] - p_coords[suivante]) * 1000;
+                ligne.durees.push_back((unsigned int) lround(metres / vitesseBus));
+                ligne.stations.push_back(suivante);
+                visitee[suivante] = 1;
+                courante = suivante;
+                direction = d;
+                avance = true;
+                break;
+            }
+            if (!avance) break; //impasse: la ligne est plus courte
+        }
+        return ligne;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        const Parametres parametres = lireParametres(argc, argv);
+        mt19937 generateur(parametres.graine);
+        if (mkdir(parametres.dossier.c_str(), 0755) != 0 && errno != EEXIST)
+            throw logic_error("generateurgtfs: impossible de créer " + parametres.dossier);
+        const string dossier = parametres.dossier + "/";
+
+        //stations, sur une grille carrée
+        const unsigned int largeur = (unsigned int) ceil(sqrt((double) parametres.nbStations));
+        const double pasLatitude = parametres.espacement / metresParDegreLatitude;
+        const double pasLongitude = pasLatitude / cos(latitudeCentre * acos(-1.0) / 180);
+        vector<Coordonnees> coords;
+        coords.reserve(parametres.nbStations);
+        Fichier stops(dossier + "stops.txt");
+        stops << "stop_id,stop_name,stop_desc,stop_lat,stop_lon,stop_url,location_type,wheelchair_boarding\n";
+        for (unsigned int s = 0; s < parametres.nbStations; ++s)
+        {
+            double latitude = latitudeCentre + ((double) (s / largeur) - largeur / 2.0) * pasLatitude;
+            double longitude = longitudeCentre + ((double) (s % largeur) - largeur / 2.0) * pasLongitude;
+            coords.push_back(Coordonnees(latitude, longitude));
+            stops << s + 1 << ",\"Station " << s + 1 << "\",\"Rangée " << s / largeur << " / colonne " << s % largeur
+                  << "\",";
+            stops.reel(latitude) << ',';
+            stops.reel(longitude) << ",,0,1\n";
+        }
+        stops.fermer();
+
+        //transferts entre stations voisines, dans les deux sens
+        Fichier transfers(dossier + "transfers.txt");
+        transfers << "from_stop_id,to_stop_id,transfer_type,min_transfer_time\n";
+        const int portee = (int) (parametres.rayonTransferts / parametres.espacement);
+        uniform_real_distribution<double> tirage(0, 1);
+        size_t nbTransferts = 0;
+        for (unsigned int s = 0; s < parametres.nbStations; ++s)
+        {
+            int x = (int) (s % largeur), y = (int) (s / largeur);
+            for (int dy = -portee; dy <= portee; ++dy)
+                for (int dx = -portee; dx <= portee; ++dx)
+                {
+                    if ((dx == 0 && dy == 0) || x + dx < 0 || x + dx >= (int) largeur || y + dy < 0) continue;
+                    unsigned int t = (unsigned int) ((y + dy) * (int) largeur + x + dx);
+                    if (t >= parametres.nbStations) continue;
+                    double metres = (coords[s] - coords[t]) * 1000;
+                    if (metres > parametres.rayonTransferts || tirage(generateur) >= parametres.densiteTransferts)
+                        continue;
+                    transfers << s + 1 << ',' << t + 1 << ",2," << (unsigned int) lround(metres / vitesseMarche)
+                              << '\n';
+                    ++nbTransferts;
+                }
+        }
+        transfers.fermer();
+
+        //calendrier: un service de semaine et un service de fin de semaine
+        Fichier calendar(dossier + "calendar_dates.txt");
+        calendar << "service_id,date,exception_type\n";
+        Date premiereDate(parametres.debut / 10000, parametres.debut / 100 % 100, parametres.debut % 100);
+        for (unsigned int j = 0; j < parametres.nbJours; ++j)
+        {
+            Date date = premiereDate.add_jours((int) j);
+            struct tm t = {};
+            t.tm_year = (int) date.getAn() - 1900;
+            t.tm_mon = (int) date.getMois() - 1;
+            t.tm_mday = (int) date.getJour();
+            t.tm_hour = 12;
+            t.tm_isdst = -1;
+            mktime(&t);
+            bool finDeSemaine = t.tm_wday == 0 || t.tm_wday == 6;
+            calendar << (finDeSemaine ? "FIN-DE-SEMAINE," : "SEMAINE,")
+                     << date.getAn() * 10000 + date.getMois() * 100 + date.getJour() << ",1\n";
+        }
+        calendar.fermer();
+
+        Fichier agency(dossier + "agency.txt");
+        agency << "agency_id,agency_name,agency_url,agency_timezone,agency_lang,agency_phone\n"
+               << "SYN,\"Réseau synthétique\",http://example.org,America/Montreal,fr,\n";
+        agency.fermer();
+
+        //lignes, voyages et arrêts
+        Fichier routes(dossier + "routes.txt");
+        Fichier trips(dossier + "trips.txt");
+        Fichier stopTimes(dossier + "stop_times.txt");
+        routes << "route_id,agency_id,route_short_name,route_long_name,route_desc,route_type,route_url,route_color,"
+                  "route_text_color\n";
+        trips << "route_id,service_id,trip_id,trip_headsign,trip_short_name,direction_id,block_id,shape_id,"
+                 "wheelchair_accessible\n";
+        stopTimes << "trip_id,arrival_time,departure_time,stop_id,stop_sequence,pickup_type,drop_off_type\n";
+        const unsigned int amplitude = parametres.dernier - parametres.premier;
+        size_t nbVoyages = 0, nbArrets = 0;
+        for (unsigned int l = 0; l < parametres.nbLignes; ++l)
+        {
+            LigneGeneree ligne = tracerLigne(parametres, largeur, coords, generateur);
+            if (ligne.stations.size() < 2) continue;
+            const unsigned int routeId = 1000 + l;
+            routes << routeId << ",SYN,\"" << l + 1 << "\",,\"Station " << ligne.stations.front() + 1
+                   << " - Station " << ligne.stations.back() + 1 << "\",3,," << couleurs[l % 4] << ",000000\n";
+            //les lignes ne partent pas toutes à la même seconde
+            unsigned int decalage = uniform_int_distribution<unsigned int>(0, parametres.intervalle - 1)(generateur);
+            for (unsigned int sens = 0; sens < 2; ++sens)
+            {
+                const unsigned int terminus = sens == 0 ? ligne.stations.back() : ligne.stations.front();
+                for (const char *service : {"SEMAINE", "FIN-DE-SEMAINE"})
+                {
+                    unsigned int intervalle = parametres.intervalle * (strcmp(service, "SEMAINE") == 0 ? 1 : 2);
+                    unsigned int nbDeparts = parametres.voyagesParLigne ? parametres.voyagesParLigne : amplitude / intervalle;
+                    if (strcmp(service, "SEMAINE") != 0 && parametres.voyagesParLigne)
+                        nbDeparts = (nbDeparts + 1) / 2;
+                    if (nbDeparts > 1 && parametres.voyagesParLigne) intervalle = amplitude / nbDeparts;
+                    for (unsigned int k = 0; k < nbDeparts; ++k)
+                    {
+                        string tripId = to_string(routeId) + "-" + to_string(sens) + "-" + to_string(k) + "-" + service;
+                        trips << routeId << ',' << service << ',' << tripId << ",\"Station " << terminus + 1 << "\",,"
+                              << sens << ",,,1\n";
+                        unsigned int heure = parametres.premier + decalage + k * intervalle;
+                        const size_t n = ligne.stations.size();
+                        for (size_t a = 0; a < n; ++a)
+                        {
+                            size_t rang = sens == 0 ? a : n - 1 - a;
+                            if (a > 0) heure += ligne.durees[sens == 0 ? rang - 1 : rang];
+                            unsigned int depart = a + 1 < n ? heure + arretEnStation : heure;
+                            stopTimes << tripId << ',';
+                            stopTimes.heure(heure) << ',';
+                            stopTimes.heure(depart) << ',' << ligne.stations[rang] + 1 << ','
+                                                    << (unsigned int) a + 1 << ",0,0\n";
+                            heure = depart;
+                        }
+                        ++nbVoyages;
+                        nbArrets += n;
+                    }
+                }
+            }
+        }
+        routes.fermer();
+        trips.fermer();
+        stopTimes.fermer();
+
+        cout << parametres.dossier << ": " << parametres.nbStations << " stations, " << parametres.nbLignes
+             << " lignes, " << nbVoyages << " voyages, " << nbArrets << " arrêts, " << nbTransferts << " transferts"
+             << endl;
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -13,10 +13,35 @@ using namespace std;
 //! \param[in] p_nbSommets indique le nombre de sommets désiré
 //! \post crée le vecteur de p_nbSommets de listes d'adjacence vides
 Graphe::Graphe(size_t p_nbSommets)
-    : m_listesAdj(p_nbSommets), nbArcs(0)
+    : m_listesAdj(p_nbSommets), m_vueDebutArcs(nullptr), m_vueArcs(nullptr), m_nbSommetsFiges(0), nbArcs(0)
 {
 }
 
+//! \brief Constructeur d'un graphe figé dont les arcs sont empruntés plutôt que copiés (aucune allocation par arc)
+//! \param[in] p_nbSommets: le nombre de sommets
+//! \param[in] p_debutArcs: p_nbSommets + 1 débuts; les arcs du sommet i sont p_arcs[p_debutArcs[i]..p_debutArcs[i+1])
+//! \param[in] p_arcs: les arcs regroupés par sommet d'origine
+//! \pre les deux tableaux doivent exister aussi longtemps que le graphe et ses copies
+//! \post les arcs ajoutés ensuite vont dans les listes d'adjacence; modifier un arc emprunté le copie d'abord (defiger())
+Graphe::Graphe(size_t p_nbSommets, const size_t *p_debutArcs, const ArcFige *p_arcs)
+    : m_listesAdj(p_nbSommets), m_vueDebutArcs(p_debutArcs), m_vueArcs(p_arcs), m_nbSommetsFiges(p_nbSommets),
+      nbArcs(p_debutArcs[p_nbSommets])
+{
+}
+
+//! \brief Constructeur d'un graphe figé à partir de tableaux CSR déjà construits, qui lui sont cédés
+//! \param[in] p_nbSommets: le nombre de sommets
+//! \param[in] p_debutArcs: p_nbSommets + 1 débuts; les arcs du sommet i sont p_arcs[p_debutArcs[i]..p_debutArcs[i+1])
+//! \param[in] p_arcs: les arcs regroupés par sommet d'origine
+//! \throws logic_error si les tableaux sont incohérents
+Graphe::Graphe(size_t p_nbSommets, std::vector<size_t> &&p_debutArcs, std::vector<ArcFige> &&p_arcs)
+    : m_listesAdj(p_nbSommets), m_debutArcs(std::move(p_debutArcs)), m_arcsFiges(std::move(p_arcs)),
+      m_vueDebutArcs(nullptr), m_vueArcs(nullptr), m_nbSommetsFiges(p_nbSommets), nbArcs(m_arcsFiges.size())
+{
+    if (m_debutArcs.size() != p_nbSommets + 1 || m_debutArcs.back() != m_arcsFiges.size())
+        throw logic_error("Graphe::Graphe(): tableaux CSR incohérents");
+}
+
 //! \brief change le nombre de sommets du graphe
 //! \param[in] p_nouvelleTaille indique le nouveau nombre de sommet
 //! \post le graphe est un vecteur de p_nouvelleTaille de listes d'adjacence
@@ -24,6 +49,7 @@ Graphe::Graphe(size_t p_nbSommets)
 //! \post les dernières listes d'adjacence sont enlevées lorsque p_nouvelleTaille < à l'ancienne taille
 void Graphe::resize(size_t p_nouvelleTaille)
 {
+    if (m_nbSommetsFiges > p_nouvelleTaille) defiger(); //des sommets figés seraient enlevés
     m_listesAdj.resize(p_nouvelleTaille);
 }
 
@@ -37,6 +63,103 @@ size_t Graphe::getNbArcs() const
     return nbArcs;
 }
 
+//! \brief compacte tous les arcs du graphe en format CSR (tableaux contigus de destinations et de poids)
+//! \post les arcs des listes d'adjacence sont déplacés dans m_arcsFiges, dans le même ordre, et les listes sont vidées
+//! \post les arcs ajoutés ensuite avec ajouterArc() sont conservés dans les listes d'adjacence jusqu'au prochain figer()
+//! \throws logic_error lorsque le nombre de sommets ne peut être représenté sur un unsigned int
+void Graphe::figer()
+{
+    if (m_listesAdj.size() >= numeric_limits<unsigned int>::max())
+        throw logic_error("Graphe::figer(): trop de sommets pour le format compact");
+
+    vector<size_t> debutArcs(m_listesAdj.size() + 1, 0);
+    vector<ArcFige> arcsFiges;
+    arcsFiges.reserve(nbArcs);
+    for (size_t i = 0; i < m_listesAdj.size(); ++i)
+    {
+        pourChaqueArc(i, [&arcsFiges](size_t destination, unsigned int poids)
+        {
+            arcsFiges.push_back({(unsigned int) destination, poids});
+        });
+        debutArcs[i + 1] = arcsFiges.size();
+        m_listesAdj[i].clear();
+    }
+    m_debutArcs.swap(debutArcs);
+    m_arcsFiges.swap(arcsFiges);
+    m_vueDebutArcs = nullptr;
+    m_vueArcs = nullptr;
+    m_nbSommetsFiges = m_listesAdj.size();
+}
+
+//! \brief indique si le graphe possède une partie figée en format CSR
+bool Graphe::estFige() const
+{
+    return m_nbSommetsFiges > 0;
+}
+
+//! \brief le nombre de sommets couverts par la partie figée (les autres n'ont que des listes d'adjacence)
+size_t Graphe::getNbSommetsFiges() const
+{
+    return m_nbSommetsFiges;
+}
+
+//! \brief les débuts des arcs figés de chaque sommet (getNbSommetsFiges() + 1 éléments), nullptr si le graphe n'est pas figé
+const size_t *Graphe::getDebutArcsFiges() const
+{
+    return m_vueDebutArcs ? m_vueDebutArcs : m_debutArcs.data();
+}
+
+//! \brief les arcs figés, regroupés par sommet d'origine
+const Graphe::ArcFige *Graphe::getArcsFiges() const
+{
+    return m_vueArcs ? m_vueArcs : m_arcsFiges.data();
+}
+
+//! \brief construit le graphe transposé: chaque arc (i, j) devient l'arc (j, i), de même poids
+//! \return un graphe figé de getNbSommets() sommets; les arcs entrants de chaque sommet y sont en ordre d'origine
+Graphe Graphe::inverser() const
+{
+    const size_t nbSommets = m_listesAdj.size();
+    vector<size_t> debutArcs(nbSommets + 1, 0);
+    for (size_t i = 0; i < nbSommets; ++i)
+        pourChaqueArc(i, [&debutArcs](size_t destination, unsigned int)
+        {
+            ++debutArcs[destination + 1];
+        });
+    for (size_t j = 1; j <= nbSommets; ++j)
+        debutArcs[j] += debutArcs[j - 1];
+
+    vector<ArcFige> arcsFiges(debutArcs[nbSommets]);
+    vector<size_t> prochain(debutArcs.begin(), debutArcs.end() - 1);
+    for (size_t i = 0; i < nbSommets; ++i)
+        pourChaqueArc(i, [&arcsFiges, &prochain, i](size_t destination, unsigned int poids)
+        {
+            arcsFiges[prochain[destination]++] = {(unsigned int) i, poids};
+        });
+
+    return Graphe(nbSommets, std::move(debutArcs), std::move(arcsFiges));
+}
+
+//! \brief remet les arcs figés dans les listes d'adjacence (opération coûteuse, utilisée seulement pour modifier un arc figé)
+//! \post les arcs figés précèdent, dans chaque liste, les arcs ajoutés après le dernier figer()
+void Graphe::defiger()
+{
+    const size_t *debutArcs = getDebutArcsFiges();
+    const ArcFige *arcsFiges = getArcsFiges();
+    for (size_t i = 0; i < m_nbSommetsFiges; ++i)
+    {
+        list<Arc> arcs;
+        for (size_t k = debutArcs[i]; k < debutArcs[i + 1]; ++k)
+            arcs.emplace_back(Arc(arcsFiges[k].destination, arcsFiges[k].poids));
+        m_listesAdj[i].splice(m_listesAdj[i].begin(), arcs);
+    }
+    vector<size_t>().swap(m_debutArcs);
+    vector<ArcFige>().swap(m_arcsFiges);
+    m_vueDebutArcs = nullptr;
+    m_vueArcs = nullptr;
+    m_nbSommetsFiges = 0;
+}
+
 //! \brief ajoute un arc d'un poids donné dans le graphe
 //! \param[in] i: le sommet origine de l'arc
 //! \param[in] j: le sommet destination de l'arc
@@ -80,6 +203,13 @@ void Graphe::enleverArc(size_t i, size_t j)
             break;
         }
     }
+    if (!arc_enleve && i < m_nbSommetsFiges && getDebutArcsFiges()[i] != getDebutArcsFiges()[i + 1])
+    {
+        //l'arc est peut-être figé: il faut alors revenir aux listes d'adjacence pour l'enlever
+        defiger();
+        enleverArc(i, j);
+        return;
+    }
     if (!arc_enleve)
         throw logic_error("Graphe::enleverArc: cet arc n'existe pas; donc impossible de l'enlever");
     --nbArcs;
@@ -89,10 +219,17 @@ void Graphe::enleverArc(size_t i, size_t j)
 unsigned int Graphe::getPoids(size_t i, size_t j) const
 {
     if (i >= m_listesAdj.size()) throw logic_error("Graphe::getPoids(): l'incice i n,est pas un sommet existant");
-    for (auto & arc : m_listesAdj[i])
+    bool trouve = false;
+    unsigned int poidsTrouve = 0;
+    pourChaqueArc(i, [&](size_t destination, unsigned int poids)
     {
-        if (arc.destination == j) return arc.poids;
-    }
+        if (!trouve && destination == j)
+        {
+            trouve = true;
+            poidsTrouve = poids;
+        }
+    });
+    if (trouve) return poidsTrouve;
     throw logic_error("Graphe::getPoids(): l'arc(i,j) est inexistant");
 }
 
@@ -102,13 +239,13 @@ void  Graphe::triTopologique(size_t sommet, vector<bool> &visite, stack<size_t>
     //marquer comme visite
     visite[sommet]=true;
 
-    for (auto u_itr = m_listesAdj[sommet].begin(); u_itr != m_listesAdj[sommet].end(); ++u_itr)
+    pourChaqueArc(sommet, [&](size_t destination, unsigned int)
     {
-        if (!visite[u_itr->destination])
+        if (!visite[destination])
         {
-            triTopologique(u_itr->destination,visite,tri);
+            triTopologique(destination,visite,tri);
         }
-    }
+    });
     tri.push(sommet);
 }
 
@@ -154,18 +291,18 @@ unsigned int Graphe::pccBellmanFord(size_t p_origine, size_t p_destination, std:
 
             if (distance[sommet]!=numeric_limits<unsigned int>::max()) {
                 //relâcher les arcs
-                for (auto u_itr = m_listesAdj[sommet].begin(); u_itr != m_listesAdj[sommet].end(); ++u_itr) {
+                pourChaqueArc(sommet, [&](size_t destination, unsigned int poids) {
 
 
                     //chercher la nouvelle distance
-                    unsigned int nouvelleDistance = distance[sommet] + u_itr->poids;
+                    unsigned int nouvelleDistance = distance[sommet] + poids;
 
 
-                    if (nouvelleDistance < distance[u_itr->destination]) {
-                        distance[u_itr->destination] = nouvelleDistance;
-                        predecesseur[u_itr->destination] = sommet;
+                    if (nouvelleDistance < distance[destination]) {
+                        distance[destination] = nouvelleDistance;
+                        predecesseur[destination] = sommet;
                     }
-                }
+                });
             }
 
         }
@@ -207,84 +344,556 @@ unsigned int Graphe::pccBellmanFord(size_t p_origine, size_t p_destination, std:
 //! \return la longueur du chemin (= numeric_limits<unsigned int>::max() si p_destination n'est pas atteignable)
 //! \throws logic_error lorsque p_origine ou p_destination n'existe pas
 unsigned int Graphe::plusCourtChemin(size_t p_origine, size_t p_destination, std::vector<size_t> &p_chemin) const
+{
+    EspaceRecherche espace;
+    return plusCourtChemin(p_origine, p_destination, p_chemin, espace);
+}
+
+//! \brief Identique à plusCourtChemin(p_origine, p_destination, p_chemin)
+//! \param[out] p_stats: les compteurs d'opérations de la recherche
+unsigned int Graphe::plusCourtChemin(size_t p_origine, size_t p_destination, std::vector<size_t> &p_chemin,
+                                     StatistiquesRecherche &p_stats) const
+{
+    EspaceRecherche espace;
+    unsigned int longueur = plusCourtChemin(p_origine, p_destination, p_chemin, espace);
+    p_stats = espace.getStatistiques();
+    return longueur;
+}
+
+//! \brief Algorithme de Dijkstra dont la file de priorité (TasRadix) est ordonnée selon la distance provisoire
+//! \brief Les entrées périmées sont laissées dans la file et ignorées à leur extraction.
+//! \brief La recherche s'arrête dès que la distance de p_destination est fixée.
+//! \pre p_origine et p_destination doivent être des sommets du graphe
+//! \param[out] p_chemin: le chemin (un seul noeud si p_destination == p_origine ou si p_destination est inatteignable)
+//! \param[in,out] p_espace: les tampons de la recherche, réutilisés d'une requête à l'autre; contient les compteurs au retour
+//! \return la longueur du chemin (= numeric_limits<unsigned int>::max() si p_destination n'est pas atteignable)
+//! \throws logic_error lorsque p_origine ou p_destination n'existe pas
+unsigned int Graphe::plusCourtChemin(size_t p_origine, size_t p_destination, std::vector<size_t> &p_chemin,
+                                     EspaceRecherche &p_espace) const
 {
     try {
         if (p_origine >= m_listesAdj.size() || p_destination >= m_listesAdj.size())
             throw logic_error("Graphe::dijkstra(): p_origine ou p_destination n'existe pas");
 
         p_chemin.clear();
+        p_espace.preparer(m_listesAdj.size());
 
         if (p_origine == p_destination)
         {
             p_chemin.push_back(p_destination);
             return 0;
         }
-        vector<unsigned int> distance(m_listesAdj.size(), numeric_limits<unsigned int>::max());
-        vector<size_t> predecesseur(m_listesAdj.size(), numeric_limits<size_t>::max());
-        vector<bool> listeFermee(m_listesAdj.size(),false);
-        distance[p_origine] = 0;
 
+        StatistiquesRecherche &stats = p_espace.getStatistiques();
+        TasRadix &listeOuvert = p_espace.getTas(); //ensemble des noeuds non solutionnés, ordonnés selon leur distance provisoire
+        p_espace.assigner(p_origine, 0, numeric_limits<size_t>::max());
+        listeOuvert.inserer(0, p_origine);
+        ++stats.nbInsertions;
 
-        vector<size_t> listeOuvert = {p_origine}; //ensemble des noeuds non solutionnés
+        //Boucle principale: touver distance[] et predecesseur[]
+        while (!listeOuvert.estVide()) {
+            unsigned int cle;
+            size_t sommet = listeOuvert.extraireMin(cle); //ramasser le noeud en traitement
+            ++stats.nbExtractions;
 
-        make_heap(listeOuvert.begin(), listeOuvert.end()); //faire un tas avec le vecteur
+            if (p_espace.estFixe(sommet) || cle != p_espace.getDistance(sommet))
+            {
+                ++stats.nbEntreesPerimees;
+                continue;
+            }
+            p_espace.fixer(sommet);
+            ++stats.nbSommetsFixes;
 
+            if (sommet == p_destination) break; //distance[p_destination] et predecesseur[p_destination] sont définitifs
 
+            //relâcher les arcs
+            pourChaqueArc(sommet, [&](size_t destination, unsigned int poids) {
+                ++stats.nbRelaxations;
 
-        //Boucle principale: touver distance[] et predecesseur[]
-        while (!listeOuvert.empty()) {
-            size_t sommet = listeOuvert.back(); //ramasser le noeud en traitement
-            listeOuvert.pop_back(); //enlever le noeud de listeOuvert
+                //chercher la nouvelle distance
+                unsigned int nouvelleDistance = cle + poids;
+
+                if (nouvelleDistance < p_espace.getDistance(destination)) {
+                    p_espace.assigner(destination, nouvelleDistance, sommet);
+                    listeOuvert.inserer(nouvelleDistance, destination);
+                    ++stats.nbInsertions;
+                }
+            });
+        }
+
+        //cas où l'on n'a pas de solution
+        if (!p_espace.estFixe(p_destination))
+        {
+            p_chemin.push_back(p_destination);
+            return numeric_limits<unsigned int>::max();
+        }
 
-            if(!listeFermee[sommet])
+        //On a une solution, donc construire le plus court chemin à l'aide des prédécesseurs
+        for (size_t numero = p_destination; numero != numeric_limits<size_t>::max(); numero = p_espace.getPredecesseur(numero))
+        {
+            p_chemin.push_back(numero);
+        }
+        reverse(p_chemin.begin(), p_chemin.end());
+        return p_espace.getDistance(p_destination);
+    }catch(...)
+    {
+        throw logic_error("Une erreur est survenue");
+    }
+}
+
+//! \brief Algorithme de Dijkstra de l'origine à la destination virtuelles de p_surcouche
+//! \brief Les arcs de la surcouche sont relâchés comme s'ils suivaient les arcs du graphe: le résultat est celui qu'on
+//! \brief obtiendrait en ajoutant les deux sommets et leurs arcs au graphe, sans le modifier.
+//! \param[in] p_surcouche: les arcs de l'origine (sommet getNbSommets()) et vers la destination (getNbSommets() + 1)
+//! \param[out] p_chemin: le chemin, de getNbSommets() à getNbSommets() + 1 (un seul noeud si la destination est inatteignable)
+//! \param[in,out] p_espace: les tampons de la recherche, réutilisés d'une requête à l'autre; contient les compteurs au retour
+//! \return la longueur du chemin (= numeric_limits<unsigned int>::max() si la destination n'est pas atteignable)
+//! \throws logic_error si un arc de la surcouche touche un sommet inexistant
+unsigned int Graphe::plusCourtChemin(const Surcouche &p_surcouche, std::vector<size_t> &p_chemin,
+                                     EspaceRecherche &p_espace) const
+{
+    const size_t nbSommets = m_listesAdj.size();
+    const size_t origine = nbSommets;
+    const size_t destination = nbSommets + 1;
+
+    p_chemin.clear();
+    p_espace.preparer(nbSommets + 2);
+    for (const auto &arc : p_surcouche.arrivees)
+    {
+        if (arc.first >= nbSommets)
+            throw logic_error("Graphe::plusCourtChemin(): un arc vers la destination part d'un sommet inexistant");
+        p_espace.ajouterArcCible(arc.first, arc.second);
+    }
+
+    StatistiquesRecherche &stats = p_espace.getStatistiques();
+    TasRadix &listeOuvert = p_espace.getTas();
+    p_espace.assigner(origine, 0, numeric_limits<size_t>::max());
+    listeOuvert.inserer(0, origine);
+    ++stats.nbInsertions;
+
+    while (!listeOuvert.estVide())
+    {
+        unsigned int cle;
+        size_t sommet = listeOuvert.extraireMin(cle);
+        ++stats.nbExtractions;
+
+        if (p_espace.estFixe(sommet) || cle != p_espace.getDistance(sommet))
+        {
+            ++stats.nbEntreesPerimees;
+            continue;
+        }
+        p_espace.fixer(sommet);
+        ++stats.nbSommetsFixes;
+
+        if (sommet == destination) break;
+
+        auto relacher = [&](size_t p_destination, unsigned int p_poids)
+        {
+            ++stats.nbRelaxations;
+            unsigned int nouvelleDistance = cle + p_poids;
+            if (nouvelleDistance < p_espace.getDistance(p_destination))
             {
-                listeFermee[sommet]=true;
-                //relâcher les arcs
-                for (auto u_itr = m_listesAdj[sommet].begin(); u_itr != m_listesAdj[sommet].end(); ++u_itr) {
-                    if (u_itr->poids < 0) //gestion d'erreur, car l'algorithme n'accepte pas les negatifs
-                        throw logic_error("arc de poids negatif");
+                p_espace.assigner(p_destination, nouvelleDistance, sommet);
+                listeOuvert.inserer(nouvelleDistance, p_destination);
+                ++stats.nbInsertions;
+            }
+        };
+        if (sommet == origine)
+        {
+            for (const auto &arc : p_surcouche.departs)
+            {
+                if (arc.first >= nbSommets)
+                    throw logic_error("Graphe::plusCourtChemin(): un arc de l'origine mène à un sommet inexistant");
+                relacher(arc.first, arc.second);
+            }
+            continue;
+        }
+        pourChaqueArc(sommet, relacher);
+        unsigned int poidsCible = p_espace.getPoidsCible(sommet);
+        if (poidsCible != numeric_limits<unsigned int>::max()) relacher(destination, poidsCible);
+    }
 
-                    //chercher la nouvelle distance
-                    unsigned int nouvelleDistance = distance[sommet] + u_itr->poids;
+    if (!p_espace.estFixe(destination))
+    {
+        p_chemin.push_back(destination);
+        return numeric_limits<unsigned int>::max();
+    }
+    for (size_t numero = destination; numero != numeric_limits<size_t>::max(); numero = p_espace.getPredecesseur(numero))
+    {
+        p_chemin.push_back(numero);
+    }
+    reverse(p_chemin.begin(), p_chemin.end());
+    return p_espace.getDistance(destination);
+}
 
+//! \brief Algorithme A* de l'origine à la destination virtuelles de p_surcouche
+//! \brief Les sommets sont extraits dans l'ordre de leur distance plus p_heuristique(sommet): la recherche s'oriente
+//! \brief vers la destination et en fixe d'autant moins que l'heuristique est serrée. L'heuristique doit être
+//! \brief cohérente (h(u) <= poids(u, v) + h(v) pour chaque arc, et h(u) <= poids de l'arc de u vers la destination):
+//! \brief chaque sommet est alors fixé une seule fois à sa distance exacte, les clés extraites ne diminuent pas (ce
+//! \brief qu'exige le tas radix) et le résultat est celui de plusCourtChemin(p_surcouche, p_chemin, p_espace).
+//! \brief Une heuristique nulle redonne l'algorithme de Dijkstra.
+//! \param[in] p_heuristique: appelée pour les sommets du graphe seulement (l'origine et la destination valent 0)
+//! \param[out] p_chemin: le chemin, de getNbSommets() à getNbSommets() + 1 (un seul noeud si la destination est inatteignable)
+//! \param[in,out] p_espace: les tampons de la recherche, réutilisés d'une requête à l'autre; contient les compteurs au retour
+//! \return la longueur du chemin (= numeric_limits<unsigned int>::max() si la destination n'est pas atteignable)
+//! \throws logic_error si un arc de la surcouche touche un sommet inexistant ou si l'heuristique n'est pas cohérente
+//! \throws sur un arc relâché
+unsigned int Graphe::plusCourtCheminAStar(const Surcouche &p_surcouche, const Heuristique &p_heuristique,
+                                          std::vector<size_t> &p_chemin, EspaceRecherche &p_espace) const
+{
+    const size_t nbSommets = m_listesAdj.size();
+    const size_t origine = nbSommets;
+    const size_t destination = nbSommets + 1;
 
-                    if (nouvelleDistance < distance[u_itr->destination]) {
-                        distance[u_itr->destination] = nouvelleDistance;
-                        predecesseur[u_itr->destination] = sommet;
-                        listeOuvert.push_back(u_itr->destination);
-                        push_heap(listeOuvert.begin(), listeOuvert.end());
-                    }
-                }
+    p_chemin.clear();
+    p_espace.preparer(nbSommets + 2);
+    for (const auto &arc : p_surcouche.arrivees)
+    {
+        if (arc.first >= nbSommets)
+            throw logic_error("Graphe::plusCourtCheminAStar(): un arc vers la destination part d'un sommet inexistant");
+        p_espace.ajouterArcCible(arc.first, arc.second);
+    }
+
+    StatistiquesRecherche &stats = p_espace.getStatistiques();
+    TasRadix &listeOuvert = p_espace.getTas();
+    p_espace.assigner(origine, 0, numeric_limits<size_t>::max());
+    listeOuvert.inserer(0, origine);
+    ++stats.nbInsertions;
+
+    while (!listeOuvert.estVide())
+    {
+        unsigned int cle;
+        size_t sommet = listeOuvert.extraireMin(cle);
+        ++stats.nbExtractions;
+
+        //la clé d'une entrée à jour est la distance du sommet plus son heuristique
+        const unsigned int heuristique = sommet < nbSommets ? p_heuristique(sommet) : 0;
+        if (p_espace.estFixe(sommet) || cle != (unsigned long) p_espace.getDistance(sommet) + heuristique)
+        {
+            ++stats.nbEntreesPerimees;
+            continue;
+        }
+        p_espace.fixer(sommet);
+        ++stats.nbSommetsFixes;
+
+        if (sommet == destination) break;
+
+        const unsigned int distance = p_espace.getDistance(sommet);
+        auto relacher = [&](size_t p_destination, unsigned int p_poids)
+        {
+            ++stats.nbRelaxations;
+            unsigned int nouvelleDistance = distance + p_poids;
+            if (nouvelleDistance < p_espace.getDistance(p_destination))
+            {
+                //une clé inférieure à celle du sommet courant briserait l'ordre du tas radix
+                unsigned int h = p_destination < nbSommets ? p_heuristique(p_destination) : 0;
+                if (nouvelleDistance + (unsigned long) h < cle)
+                    throw logic_error("Graphe::plusCourtCheminAStar(): l'heuristique n'est pas cohérente");
+                p_espace.assigner(p_destination, nouvelleDistance, sommet);
+                listeOuvert.inserer(nouvelleDistance + h, p_destination);
+                ++stats.nbInsertions;
             }
+        };
+        if (sommet == origine)
+        {
+            for (const auto &arc : p_surcouche.departs)
+            {
+                if (arc.first >= nbSommets)
+                    throw logic_error("Graphe::plusCourtCheminAStar(): un arc de l'origine mène à un sommet inexistant");
+                relacher(arc.first, arc.second);
+            }
+            continue;
+        }
+        pourChaqueArc(sommet, relacher);
+        unsigned int poidsCible = p_espace.getPoidsCible(sommet);
+        if (poidsCible != numeric_limits<unsigned int>::max()) relacher(destination, poidsCible);
+    }
 
+    if (!p_espace.estFixe(destination))
+    {
+        p_chemin.push_back(destination);
+        return numeric_limits<unsigned int>::max();
+    }
+    for (size_t numero = destination; numero != numeric_limits<size_t>::max(); numero = p_espace.getPredecesseur(numero))
+    {
+        p_chemin.push_back(numero);
+    }
+    reverse(p_chemin.begin(), p_chemin.end());
+    return p_espace.getDistance(destination);
+}
+
+//! \brief Algorithme de Dijkstra bidirectionnel de l'origine à la destination virtuelles de p_surcouche
+//! \brief Une recherche avant part de l'origine dans ce graphe et une recherche arrière part de la destination dans
+//! \brief p_inverse; on avance à chaque pas celle qui a fixé le moins de sommets. Chaque arc relâché vers un sommet
+//! \brief déjà atteint par l'autre recherche propose un chemin; mu est le plus court proposé. Comme les clés extraites
+//! \brief d'un tas ne diminuent pas, la dernière distance fixée de chaque côté est une borne inférieure de ses distances
+//! \brief restantes: dès que leur somme atteint mu, aucun chemin plus court ne reste à trouver.
+//! \brief Le résultat est celui de plusCourtChemin(p_surcouche, p_chemin, p_espace).
+//! \param[in] p_inverse: le graphe transposé de ce graphe (inverser())
+//! \param[in] p_surcouche: les arcs de l'origine (sommet getNbSommets()) et vers la destination (getNbSommets() + 1)
+//! \param[out] p_chemin: le chemin, de getNbSommets() à getNbSommets() + 1 (un seul noeud si la destination est inatteignable)
+//! \param[in,out] p_espaceAvant: les tampons de la recherche avant; contient ses compteurs au retour
+//! \param[in,out] p_espaceArriere: les tampons de la recherche arrière; contient ses compteurs au retour
+//! \return la longueur du chemin (= numeric_limits<unsigned int>::max() si la destination n'est pas atteignable)
+//! \throws logic_error si p_inverse n'a pas le même nombre de sommets ou si un arc de la surcouche touche un sommet inexistant
+unsigned int Graphe::plusCourtCheminBidirectionnel(const Graphe &p_inverse, const Surcouche &p_surcouche,
+                                                   std::vector<size_t> &p_chemin, EspaceRecherche &p_espaceAvant,
+                                                   EspaceRecherche &p_espaceArriere) const
+{
+    const size_t nbSommets = m_listesAdj.size();
+    const size_t origine = nbSommets;
+    const size_t destination = nbSommets + 1;
+    const size_t aucun = numeric_limits<size_t>::max();
+    const unsigned int infini = numeric_limits<unsigned int>::max();
+    if (p_inverse.getNbSommets() != nbSommets)
+        throw logic_error("Graphe::plusCourtCheminBidirectionnel(): p_inverse n'est pas le transposé de ce graphe");
+
+    p_chemin.clear();
+    EspaceRecherche *espaces[2] = {&p_espaceAvant, &p_espaceArriere};
+    unsigned int derniereCle[2] = {0, 0};
+    p_espaceAvant.preparer(nbSommets + 2);
+    p_espaceArriere.preparer(nbSommets + 2);
+    p_espaceAvant.assigner(origine, 0, aucun);
+    p_espaceAvant.getTas().inserer(0, origine);
+    ++p_espaceAvant.getStatistiques().nbInsertions;
+    p_espaceArriere.assigner(destination, 0, aucun);
+    p_espaceArriere.getTas().inserer(0, destination);
+    ++p_espaceArriere.getStatistiques().nbInsertions;
+
+    unsigned int mu = infini; //la longueur du plus court chemin trouvé jusqu'ici
+    size_t rencontre = aucun; //le sommet où les deux moitiés de ce chemin se rejoignent
+
+    //les deux tas doivent être non vides: si l'un est vide, tous les sommets de son côté sont fixés et mu est exact
+    while (!p_espaceAvant.getTas().estVide() && !p_espaceArriere.getTas().estVide() &&
+           (mu == infini || (unsigned long) derniereCle[0] + derniereCle[1] < mu))
+    {
+        const int cote =
+                p_espaceAvant.getStatistiques().nbSommetsFixes <= p_espaceArriere.getStatistiques().nbSommetsFixes ? 0 : 1;
+        EspaceRecherche &espace = *espaces[cote];
+        const EspaceRecherche &autre = *espaces[1 - cote];
+        StatistiquesRecherche &stats = espace.getStatistiques();
+        TasRadix &listeOuvert = espace.getTas();
+
+        unsigned int cle;
+        size_t sommet = listeOuvert.extraireMin(cle);
+        ++stats.nbExtractions;
+        if (espace.estFixe(sommet) || cle != espace.getDistance(sommet))
+        {
+            ++stats.nbEntreesPerimees;
+            continue;
         }
+        espace.fixer(sommet);
+        ++stats.nbSommetsFixes;
+        derniereCle[cote] = cle;
 
-        //cas où l'on n'a pas de solution
-        if (predecesseur[p_destination] == numeric_limits<unsigned int>::max())
+        auto relacher = [&](size_t p_destination, unsigned int p_poids)
         {
-            p_chemin.push_back(p_destination);
-            return numeric_limits<unsigned int>::max();
+            ++stats.nbRelaxations;
+            unsigned int nouvelleDistance = cle + p_poids;
+            if (nouvelleDistance >= espace.getDistance(p_destination)) return;
+            espace.assigner(p_destination, nouvelleDistance, sommet);
+            listeOuvert.inserer(nouvelleDistance, p_destination);
+            ++stats.nbInsertions;
+            unsigned int distanceAutre = autre.getDistance(p_destination);
+            if (distanceAutre != infini && (unsigned long) nouvelleDistance + distanceAutre < mu)
+            {
+                mu = nouvelleDistance + distanceAutre;
+                rencontre = p_destination;
+            }
+        };
+        if (sommet == origine || sommet == destination)
+        {
+            //les arcs de la surcouche; ceux de l'autre extrémité sont relâchés par l'autre recherche
+            for (const auto &arc : sommet == origine ? p_surcouche.departs : p_surcouche.arrivees)
+            {
+                if (arc.first >= nbSommets)
+                    throw logic_error("Graphe::plusCourtCheminBidirectionnel(): un arc de la surcouche touche un "
+                                      "sommet inexistant");
+                relacher(arc.first, arc.second);
+            }
+            continue;
         }
+        if (cote == 0) pourChaqueArc(sommet, relacher);
+        else p_inverse.pourChaqueArc(sommet, relacher);
+    }
 
-        //On a une solution, donc construire le plus court chemin à l'aide de predecesseur[]
-        stack<size_t> pileDuChemin;
-        size_t numero = p_destination;
-        pileDuChemin.push(numero);
-        while (predecesseur[numero] != numeric_limits<size_t>::max())
+    if (rencontre == aucun)
+    {
+        p_chemin.push_back(destination);
+        return infini;
+    }
+    for (size_t numero = rencontre; numero != aucun; numero = p_espaceAvant.getPredecesseur(numero))
+        p_chemin.push_back(numero);
+    reverse(p_chemin.begin(), p_chemin.end());
+    for (size_t numero = p_espaceArriere.getPredecesseur(rencontre); numero != aucun;
+         numero = p_espaceArriere.getPredecesseur(numero))
+        p_chemin.push_back(numero);
+    return mu;
+}
+
+//! \brief Construit des cibles vides
+Graphe::Cibles::Cibles() : nbCibles(0), debutArcs(1, 0)
+{
+}
+
+//! \brief Construit les cibles d'une série de recherches sur un graphe de p_nbSommets sommets
+//! \param[in] p_arrivees: p_arrivees[j] contient les arcs (sommet, poids) vers la cible j
+//! \throws logic_error si un arc part d'un sommet inexistant
+Graphe::Cibles::Cibles(size_t p_nbSommets, const std::vector<std::vector<std::pair<size_t, unsigned int> > > &p_arrivees)
+        : nbCibles((unsigned int) p_arrivees.size()), debutArcs(p_nbSommets + 1, 0)
+{
+    for (const auto &arrivees : p_arrivees)
+        for (const auto &arc : arrivees)
         {
-            numero = predecesseur[numero];
-            pileDuChemin.push(numero);
+            if (arc.first >= p_nbSommets)
+                throw logic_error("Graphe::Cibles::Cibles(): un arc vers une cible part d'un sommet inexistant");
+            ++debutArcs[arc.first + 1];
         }
-        while (!pileDuChemin.empty())
+    for (size_t v = 1; v <= p_nbSommets; ++v)
+        debutArcs[v] += debutArcs[v - 1];
+    arcs.resize(debutArcs[p_nbSommets]);
+    vector<size_t> prochain(debutArcs.begin(), debutArcs.end() - 1);
+    for (unsigned int j = 0; j < nbCibles; ++j)
+        for (const auto &arc : p_arrivees[j])
+            arcs[prochain[arc.first]++] = {j, arc.second};
+}
+
+//! \brief Algorithme de Dijkstra d'une origine virtuelle vers toutes les cibles de p_cibles à la fois
+//! \brief L'origine est le sommet getNbSommets() et ses arcs sont p_departs. La recherche s'arrête dès que la distance
+//! \brief de toutes les cibles est fixée: une seule recherche remplace une recherche par paire origine/cible.
+//! \param[in] p_departs: les arcs (sommet, poids) de l'origine
+//! \param[in] p_cibles: les cibles, construites pour ce graphe
+//! \param[out] p_distances: p_distances[j] est la distance de l'origine à la cible j
+//! \param[out] (numeric_limits<unsigned int>::max() si la cible n'est pas atteignable)
+//! \param[in,out] p_espace: les tampons de la recherche, réutilisés d'une requête à l'autre; contient les compteurs au retour
+//! \throws logic_error si les cibles n'ont pas été construites pour ce graphe ou si un arc mène à un sommet inexistant
+void Graphe::distancesVersCibles(const std::vector<std::pair<size_t, unsigned int> > &p_departs,
+                                 const Cibles &p_cibles, std::vector<unsigned int> &p_distances,
+                                 EspaceRecherche &p_espace) const
+{
+    const size_t nbSommets = m_listesAdj.size();
+    const size_t origine = nbSommets;
+    const size_t premiereCible = nbSommets + 1;
+    if (p_cibles.debutArcs.size() != nbSommets + 1)
+        throw logic_error("Graphe::distancesVersCibles(): les cibles ont été construites pour un autre graphe");
+
+    p_espace.preparer(premiereCible + p_cibles.nbCibles);
+    StatistiquesRecherche &stats = p_espace.getStatistiques();
+    TasRadix &listeOuvert = p_espace.getTas();
+    p_espace.assigner(origine, 0, numeric_limits<size_t>::max());
+    listeOuvert.inserer(0, origine);
+    ++stats.nbInsertions;
+
+    unsigned int nbCiblesFixees = 0;
+    while (!listeOuvert.estVide() && nbCiblesFixees < p_cibles.nbCibles)
+    {
+        unsigned int cle;
+        size_t sommet = listeOuvert.extraireMin(cle);
+        ++stats.nbExtractions;
+
+        if (p_espace.estFixe(sommet) || cle != p_espace.getDistance(sommet))
         {
-            size_t temp = pileDuChemin.top();
-            p_chemin.push_back(temp);
-            pileDuChemin.pop();
+            ++stats.nbEntreesPerimees;
+            continue;
         }
-        return distance[p_destination];
-    }catch(...)
+        p_espace.fixer(sommet);
+        ++stats.nbSommetsFixes;
+
+        if (sommet >= premiereCible)
+        {
+            ++nbCiblesFixees;
+            continue;
+        }
+
+        auto relacher = [&](size_t p_destination, unsigned int p_poids)
+        {
+            ++stats.nbRelaxations;
+            unsigned int nouvelleDistance = cle + p_poids;
+            if (nouvelleDistance < p_espace.getDistance(p_destination))
+            {
+                p_espace.assigner(p_destination, nouvelleDistance, sommet);
+                listeOuvert.inserer(nouvelleDistance, p_destination);
+                ++stats.nbInsertions;
+            }
+        };
+        if (sommet == origine)
+        {
+            for (const auto &arc : p_departs)
+            {
+                if (arc.first >= nbSommets)
+                    throw logic_error("Graphe::distancesVersCibles(): un arc de l'origine mène à un sommet inexistant");
+                relacher(arc.first, arc.second);
+            }
+            continue;
+        }
+        pourChaqueArc(sommet, relacher);
+        for (size_t k = p_cibles.debutArcs[sommet]; k < p_cibles.debutArcs[sommet + 1]; ++k)
+            relacher(premiereCible + p_cibles.arcs[k].first, p_cibles.arcs[k].second);
+    }
+
+    p_distances.resize(p_cibles.nbCibles);
+    for (unsigned int j = 0; j < p_cibles.nbCibles; ++j)
+        p_distances[j] = p_espace.estFixe(premiereCible + j) ? p_espace.getDistance(premiereCible + j)
+                                                             : numeric_limits<unsigned int>::max();
+}
+
+//! \brief Algorithme de Dijkstra d'une origine virtuelle vers tous les sommets du graphe
+//! \brief L'origine est le sommet getNbSommets() et ses arcs sont p_departs; la recherche se poursuit jusqu'à ce que
+//! \brief tous les sommets atteignables soient fixés.
+//! \param[in] p_departs: les arcs (sommet, poids) de l'origine
+//! \param[in,out] p_espace: au retour, les distances et prédécesseurs de tous les sommets (le prédécesseur d'un sommet
+//! \param[in,out] atteint directement par l'origine est getNbSommets()) ainsi que les compteurs de la recherche
+//! \throws logic_error si un arc de l'origine mène à un sommet inexistant
+void Graphe::distancesDepuis(const std::vector<std::pair<size_t, unsigned int> > &p_departs,
+                             EspaceRecherche &p_espace) const
+{
+    const size_t nbSommets = m_listesAdj.size();
+    const size_t origine = nbSommets;
+
+    p_espace.preparer(nbSommets + 1);
+    StatistiquesRecherche &stats = p_espace.getStatistiques();
+    TasRadix &listeOuvert = p_espace.getTas();
+    p_espace.assigner(origine, 0, numeric_limits<size_t>::max());
+    listeOuvert.inserer(0, origine);
+    ++stats.nbInsertions;
+
+    while (!listeOuvert.estVide())
     {
-        throw logic_error("Une erreur est survenue");
+        unsigned int cle;
+        size_t sommet = listeOuvert.extraireMin(cle);
+        ++stats.nbExtractions;
+
+        if (p_espace.estFixe(sommet) || cle != p_espace.getDistance(sommet))
+        {
+            ++stats.nbEntreesPerimees;
+            continue;
+        }
+        p_espace.fixer(sommet);
+        ++stats.nbSommetsFixes;
+
+        auto relacher = [&](size_t p_destination, unsigned int p_poids)
+        {
+            ++stats.nbRelaxations;
+            unsigned int nouvelleDistance = cle + p_poids;
+            if (nouvelleDistance < p_espace.getDistance(p_destination))
+            {
+                p_espace.assigner(p_destination, nouvelleDistance, sommet);
+                listeOuvert.inserer(nouvelleDistance, p_destination);
+                ++stats.nbInsertions;
+            }
+        };
+        if (sommet == origine)
+        {
+            for (const auto &arc : p_departs)
+            {
+                if (arc.first >= nbSommets)
+                    throw logic_error("Graphe::distancesDepuis(): un arc de l'origine mène à un sommet inexistant");
+                relacher(arc.first, arc.second);
+            }
+            continue;
+        }
+        pourChaqueArc(sommet, relacher);
     }
 }
 
@@ -334,15 +943,15 @@ unsigned int Graphe::legacyplusCourtChemin(size_t p_origine, size_t p_destinatio
         if (uStar == p_destination) break; //car on a obtenu distance[p_destination] et predecesseur[p_destination]
 
         //relâcher les arcs sortant de uStar
-        for (auto u_itr = m_listesAdj[uStar].begin(); u_itr != m_listesAdj[uStar].end(); ++u_itr)
+        pourChaqueArc(uStar, [&](size_t destination, unsigned int poids)
         {
-            unsigned int temp = distance[uStar] + u_itr->poids;
-            if (temp < distance[u_itr->destination])
+            unsigned int temp = distance[uStar] + poids;
+            if (temp < distance[destination])
             {
-                distance[u_itr->destination] = temp;
-                predecesseur[u_itr->destination] = uStar;
+                distance[destination] = temp;
+                predecesseur[destination] = uStar;
             }
-        }
+        });
     }
 
     //cas où l'on n'a pas de solution
@@ -14,22 +14,83 @@
 #include <limits>
 #include <iostream>
 #include <algorithm>
+#include <utility>
+#include <stdexcept>
+#include <functional>
+
+#include "espacerecherche.h"
 
 //! \brief  Classe pour graphes orientés pondérés (non négativement) avec listes d'adjacence
+//! \brief  Une fois la construction terminée, figer() compacte les arcs en format CSR (compressed sparse row)
+//! \brief  afin que les algorithmes de plus court chemin parcourent des tableaux contigus
 class Graphe
 {
 public:
 
+	//! \brief un arc figé (format CSR); sa taille et son alignement sont fixes pour pouvoir être projeté d'un fichier
+	struct ArcFige
+	{
+		unsigned int destination;
+		unsigned int poids;
+	};
+
+	//! \brief les points origine et destination d'une requête, ajoutés virtuellement le temps d'une recherche
+	//! \brief L'origine est le sommet getNbSommets() et la destination le sommet getNbSommets() + 1; le graphe n'est
+	//! \brief pas modifié et peut donc servir à plusieurs recherches simultanées.
+	struct Surcouche
+	{
+		std::vector<std::pair<size_t, unsigned int> > departs; /*!< les arcs (sommet, poids) de l'origine */
+		std::vector<std::pair<size_t, unsigned int> > arrivees; /*!< les arcs (sommet, poids) vers la destination */
+	};
+
+	//! \brief plusieurs destinations virtuelles partagées par une série de recherches un-vers-plusieurs
+	//! \brief La destination j est le sommet getNbSommets() + 1 + j; ses arcs entrants sont regroupés par sommet d'origine.
+	struct Cibles
+	{
+		Cibles();
+		Cibles(size_t p_nbSommets, const std::vector<std::vector<std::pair<size_t, unsigned int> > > &p_arrivees);
+
+		unsigned int nbCibles;
+		std::vector<size_t> debutArcs; /*!< les arcs du sommet v sont arcs[debutArcs[v]..debutArcs[v+1]) */
+		std::vector<std::pair<unsigned int, unsigned int> > arcs; /*!< les paires (cible, poids) */
+	};
+
+	//! \brief une borne inférieure de la distance d'un sommet (réel) à la destination d'une recherche A*
+	typedef std::function<unsigned int(size_t)> Heuristique;
+
 	Graphe(size_t = 0);
+	Graphe(size_t p_nbSommets, const size_t *p_debutArcs, const ArcFige *p_arcs);
+	Graphe(size_t p_nbSommets, std::vector<size_t> &&p_debutArcs, std::vector<ArcFige> &&p_arcs);
     void resize(size_t);
 	void ajouterArc(size_t i, size_t j, unsigned int poids);
 	void enleverArc(size_t i, size_t j);
 	unsigned int getPoids(size_t i, size_t j) const;
 	size_t getNbSommets() const;
     size_t getNbArcs() const;
+    void figer();
+    bool estFige() const;
+    size_t getNbSommetsFiges() const;
+    const size_t *getDebutArcsFiges() const;
+    const ArcFige *getArcsFiges() const;
+    Graphe inverser() const;
 
     unsigned int plusCourtChemin(size_t p_origine, size_t p_destination,
                              std::vector<size_t> & p_chemin) const;
+    unsigned int plusCourtChemin(size_t p_origine, size_t p_destination,
+                             std::vector<size_t> & p_chemin, StatistiquesRecherche & p_stats) const;
+    unsigned int plusCourtChemin(size_t p_origine, size_t p_destination,
+                             std::vector<size_t> & p_chemin, EspaceRecherche & p_espace) const;
+    unsigned int plusCourtChemin(const Surcouche & p_surcouche, std::vector<size_t> & p_chemin,
+                             EspaceRecherche & p_espace) const;
+    unsigned int plusCourtCheminAStar(const Surcouche & p_surcouche, const Heuristique & p_heuristique,
+                             std::vector<size_t> & p_chemin, EspaceRecherche & p_espace) const;
+    unsigned int plusCourtCheminBidirectionnel(const Graphe & p_inverse, const Surcouche & p_surcouche,
+                             std::vector<size_t> & p_chemin, EspaceRecherche & p_espaceAvant,
+                             EspaceRecherche & p_espaceArriere) const;
+    void distancesVersCibles(const std::vector<std::pair<size_t, unsigned int> > & p_departs, const Cibles & p_cibles,
+                             std::vector<unsigned int> & p_distances, EspaceRecherche & p_espace) const;
+    void distancesDepuis(const std::vector<std::pair<size_t, unsigned int> > & p_departs,
+                             EspaceRecherche & p_espace) const;
 
 	unsigned int legacyplusCourtChemin(size_t p_origine, size_t p_destination,
 								 std::vector<size_t> & p_chemin) const;
@@ -48,8 +109,30 @@ private:
 		unsigned int poids;
 	};
 
-	std::vector<std::list<Arc> > m_listesAdj; /*!< les listes d'adjacence */
+	std::vector<std::list<Arc> > m_listesAdj; /*!< les listes d'adjacence (arcs ajoutés depuis le dernier figer()) */
+	std::vector<size_t> m_debutArcs; /*!< les arcs figés du sommet i sont m_arcsFiges[m_debutArcs[i]..m_debutArcs[i+1]) */
+	std::vector<ArcFige> m_arcsFiges; /*!< les arcs figés, contigus et regroupés par sommet d'origine */
+	const size_t *m_vueDebutArcs; /*!< les arcs figés empruntés (par exemple d'un fichier projeté), sinon nullptr */
+	const ArcFige *m_vueArcs;
+	size_t m_nbSommetsFiges; /*!< les sommets [0, m_nbSommetsFiges) ont des arcs figés */
     unsigned long nbArcs;
+
+	void defiger();
+
+	//! \brief applique p_fonction(destination, poids) à chaque arc sortant de p_sommet (arcs figés puis listes d'adjacence)
+	template <typename Fonction>
+	void pourChaqueArc(size_t p_sommet, Fonction p_fonction) const
+	{
+		if (p_sommet < m_nbSommetsFiges)
+		{
+			const size_t *debutArcs = getDebutArcsFiges();
+			const ArcFige *arcs = getArcsFiges();
+			for (const ArcFige *arc = arcs + debutArcs[p_sommet]; arc != arcs + debutArcs[p_sommet + 1]; ++arc)
+				p_fonction(arc->destination, arc->poids);
+		}
+		for (const Arc &arc : m_listesAdj[p_sommet])
+			p_fonction(arc.destination, arc.poids);
+	}
 };
 
 #endif  //GRAPH_H
@@ -0,0 +1,136 @@
+//
+//  grillestations.cpp
+//  Index spatial des stations: grille régulière en latitude et longitude
+//
+
+#include "grillestations.h"
+
+#include <algorithm>
+
+using namespace std;
+
+constexpr double GrilleStations::tailleCaseDefaut;
+constexpr double GrilleStations::rayonTerre;
+constexpr double GrilleStations::radParDegre;
+
+//! \brief construit une grille vide
+GrilleStations::GrilleStations()
+        : m_latMin(0), m_lonMin(0), m_pasLat(1), m_pasLon(1), m_nbLignes(0), m_nbColonnes(0), m_debutCases(1, 0)
+{
+}
+
+//! \brief construit la grille des stations
+//! \param[in] p_coords: les coordonnées des stations; l'indice d'une station est sa position dans p_coords
+//! \param[in] p_tailleCase: le côté approximatif d'une case, en km (idéalement de l'ordre des rayons recherchés)
+//! \throws logic_error si p_tailleCase n'est pas positive
+GrilleStations::GrilleStations(const std::vector<Coordonnees> &p_coords, double p_tailleCase)
+        : m_coords(p_coords), m_latMin(0), m_lonMin(0), m_pasLat(1), m_pasLon(1), m_nbLignes(0), m_nbColonnes(0)
+{
+    if (!(p_tailleCase > 0))
+        throw logic_error("GrilleStations::GrilleStations(): la taille d'une case doit être positive");
+    m_debutCases.assign(1, 0);
+    if (m_coords.empty()) return;
+
+    double latMax = m_coords[0].getLatitude();
+    double lonMax = m_coords[0].getLongitude();
+    m_latMin = latMax;
+    m_lonMin = lonMax;
+    double latMaxAbs = 0;
+    for (const Coordonnees &c : m_coords)
+    {
+        m_latMin = min(m_latMin, c.getLatitude());
+        m_lonMin = min(m_lonMin, c.getLongitude());
+        latMax = max(latMax, c.getLatitude());
+        lonMax = max(lonMax, c.getLongitude());
+        latMaxAbs = max(latMaxAbs, fabs(c.getLatitude()));
+    }
+
+    //une case fait au moins p_tailleCase km de côté partout dans la grille; le nombre de cases reste borné
+    //pour un réseau très étendu
+    const unsigned int nbMaxParCote = 4096;
+    m_pasLat = max(p_tailleCase / (rayonTerre * radParDegre), (latMax - m_latMin) / nbMaxParCote);
+    double cosLat = max(cos(min(latMaxAbs, 89.0) * radParDegre), 0.01);
+    m_pasLon = max(p_tailleCase / (rayonTerre * radParDegre * cosLat), (lonMax - m_lonMin) / nbMaxParCote);
+    m_nbLignes = (unsigned int) ((latMax - m_latMin) / m_pasLat) + 1;
+    m_nbColonnes = (unsigned int) ((lonMax - m_lonMin) / m_pasLon) + 1;
+
+    //répartition par comptage: les stations de chaque case restent en ordre d'indice
+    vector<unsigned int> caseStation(m_coords.size());
+    m_debutCases.assign((size_t) m_nbLignes * m_nbColonnes + 1, 0);
+    for (unsigned int s = 0; s < m_coords.size(); ++s)
+    {
+        caseStation[s] = ligne(m_coords[s].getLatitude()) * m_nbColonnes + colonne(m_coords[s].getLongitude());
+        ++m_debutCases[caseStation[s] + 1];
+    }
+    for (size_t c = 1; c < m_debutCases.size(); ++c)
+        m_debutCases[c] += m_debutCases[c - 1];
+    m_stationsCases.resize(m_coords.size());
+    vector<unsigned int> prochain(m_debutCases.begin(), m_debutCases.end() - 1);
+    for (unsigned int s = 0; s < m_coords.size(); ++s)
+        m_stationsCases[prochain[caseStation[s]]++] = s;
+}
+
+//! \brief la ligne de la grille qui contient p_latitude (bornée aux lignes de la grille)
+unsigned int GrilleStations::ligne(double p_latitude) const
+{
+    double l = floor((p_latitude - m_latMin) / m_pasLat);
+    if (!(l > 0)) return 0;
+    return (unsigned int) min(l, (double) m_nbLignes - 1);
+}
+
+//! \brief la colonne de la grille qui contient p_longitude (bornée aux colonnes de la grille)
+unsigned int GrilleStations::colonne(double p_longitude) const
+{
+    double c = floor((p_longitude - m_lonMin) / m_pasLon);
+    if (!(c > 0)) return 0;
+    return (unsigned int) min(c, (double) m_nbColonnes - 1);
+}
+
+//! \brief trouve les stations situées à au plus p_distanceMax km de p_point
+//! \brief Le résultat est exactement celui d'un parcours de toutes les stations avec Coordonnees::operator-.
+//! \param[out] p_stations: les paires (indice de station, distance en km), en ordre d'indice de station
+void GrilleStations::stationsAccessibles(const Coordonnees &p_point, double p_distanceMax,
+                                         vector<pair<unsigned int, double> > &p_stations) const
+{
+    p_stations.clear();
+    if (m_coords.empty() || !(p_distanceMax >= 0)) return;
+
+    //rectangle englobant du cercle, avec une marge pour les écarts entre l'approximation et la distance exacte
+    const double marge = 1.01;
+    double lat = p_point.getLatitude();
+    double lon = p_point.getLongitude();
+    double dLat = marge * p_distanceMax / (rayonTerre * radParDegre);
+    double latLoin = min(fabs(lat) + dLat, 90.0); //là où le cercle est le plus large en longitude
+    double cosLoin = cos(latLoin * radParDegre);
+    bool toutesColonnes = cosLoin < 0.01;
+    double dLon = toutesColonnes ? 0 : marge * p_distanceMax / (rayonTerre * radParDegre * cosLoin);
+
+    double latMaxGrille = m_latMin + m_nbLignes * m_pasLat;
+    double lonMaxGrille = m_lonMin + m_nbColonnes * m_pasLon;
+    if (lat + dLat < m_latMin || lat - dLat > latMaxGrille) return;
+    if (!toutesColonnes && (lon + dLon < m_lonMin || lon - dLon > lonMaxGrille)) return;
+    unsigned int l1 = ligne(lat - dLat), l2 = ligne(lat + dLat);
+    unsigned int c1 = toutesColonnes ? 0 : colonne(lon - dLon);
+    unsigned int c2 = toutesColonnes ? m_nbColonnes - 1 : colonne(lon + dLon);
+
+    //filtre équirectangulaire: sqrt(dlat² + (cos(lat) dlon)²) ne s'écarte de la distance exacte que de l'ordre
+    //de (distance / rayon)², négligeable devant la marge pour des rayons de quelques km
+    double cosLat = cos(lat * radParDegre);
+    double seuil = marge * p_distanceMax / (rayonTerre * radParDegre);
+    double seuilCarre = seuil * seuil;
+    for (unsigned int l = l1; l <= l2; ++l)
+    {
+        const unsigned int *debut = m_stationsCases.data() + m_debutCases[(size_t) l * m_nbColonnes + c1];
+        const unsigned int *fin = m_stationsCases.data() + m_debutCases[(size_t) l * m_nbColonnes + c2 + 1];
+        for (const unsigned int *s = debut; s != fin; ++s)
+        {
+            const Coordonnees &c = m_coords[*s];
+            double ecartLat = c.getLatitude() - lat;
+            double ecartLon = (c.getLongitude() - lon) * cosLat;
+            if (ecartLat * ecartLat + ecartLon * ecartLon > seuilCarre) continue;
+            double distance = abs(c - p_point);
+            if (distance <= p_distanceMax) p_stations.push_back({*s, distance});
+        }
+    }
+    sort(p_stations.begin(), p_stations.end());
+}
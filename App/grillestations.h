@@ -0,0 +1,47 @@
+//
+//  grillestations.h
+//  Index spatial des stations: grille régulière en latitude et longitude
+//
+
+#ifndef GRILLESTATIONS_H
+#define GRILLESTATIONS_H
+
+#include <vector>
+#include <utility>
+
+#include "coordonnees.h"
+
+//! \brief  Grille régulière sur les coordonnées des stations, construite une fois pour répondre aux recherches
+//! \brief  par rayon sans parcourir toutes les stations. Une recherche ne visite que les cases qui recoupent le
+//! \brief  rectangle englobant du cercle; chaque station de ces cases passe d'abord un filtre équirectangulaire
+//! \brief  (une racine, aucun appel trigonométrique) et seules les stations retenues sont mesurées avec
+//! \brief  Coordonnees::operator-, qui reste la distance de référence.
+class GrilleStations
+{
+public:
+
+    static constexpr double tailleCaseDefaut = 1.5; // côté d'une case en km, de l'ordre des distances de marche
+
+    GrilleStations();
+    GrilleStations(const std::vector<Coordonnees> &p_coords, double p_tailleCase = tailleCaseDefaut);
+
+    void stationsAccessibles(const Coordonnees &p_point, double p_distanceMax,
+                             std::vector<std::pair<unsigned int, double> > &p_stations) const;
+
+private:
+
+    std::vector<Coordonnees> m_coords; //les coordonnées de chaque station, par indice de station
+    double m_latMin, m_lonMin; //le coin sud-ouest de la grille, en degrés
+    double m_pasLat, m_pasLon; //la taille d'une case, en degrés
+    unsigned int m_nbLignes, m_nbColonnes;
+    std::vector<unsigned int> m_debutCases; //les stations de la case c sont m_stationsCases[m_debutCases[c]..m_debutCases[c+1])
+    std::vector<unsigned int> m_stationsCases; //par case, puis par indice de station
+
+    static constexpr double rayonTerre = 6371; // en km, le même que Coordonnees::operator-
+    static constexpr double radParDegre = 3.14159265358979323846 / 180.0;
+
+    unsigned int ligne(double p_latitude) const;
+    unsigned int colonne(double p_longitude) const;
+};
+
+#endif //GRILLESTATIONS_H
@@ -0,0 +1,103 @@
+//
+//  identifiants.cpp
+//  Table d'internement des identifiants GTFS textuels (trip_id, service_id)
+//
+
+#include "identifiants.h"
+
+#include <cstring>
+
+using namespace std;
+
+const unsigned int Identifiants::aucun;
+
+Identifiants::Identifiants() : m_cases(16, aucun)
+{
+}
+
+//! \brief hachage FNV-1a des caractères [p_debut, p_debut + p_taille)
+size_t Identifiants::hacher(const char *p_debut, size_t p_taille)
+{
+    size_t hachage = 14695981039346656037ULL;
+    for (size_t i = 0; i < p_taille; ++i)
+    {
+        hachage ^= (unsigned char) p_debut[i];
+        hachage *= 1099511628211ULL;
+    }
+    return hachage;
+}
+
+//! \brief retourne la case qui contient la chaîne, ou la case libre où elle serait ajoutée
+size_t Identifiants::trouverCase(const char *p_debut, size_t p_taille, size_t p_hachage) const
+{
+    size_t masque = m_cases.size() - 1;
+    for (size_t c = p_hachage & masque;; c = (c + 1) & masque)
+    {
+        unsigned int numero = m_cases[c];
+        if (numero == aucun) return c;
+        const string &chaine = m_chaines[numero];
+        if (m_hachages[numero] == p_hachage && chaine.size() == p_taille && memcmp(chaine.data(), p_debut, p_taille) == 0)
+            return c;
+    }
+}
+
+//! \brief double le nombre de cases et y replace tous les numéros
+void Identifiants::agrandir()
+{
+    m_cases.assign(m_cases.size() * 2, aucun);
+    size_t masque = m_cases.size() - 1;
+    for (unsigned int numero = 0; numero < m_chaines.size(); ++numero)
+    {
+        size_t c = m_hachages[numero] & masque;
+        while (m_cases[c] != aucun) c = (c + 1) & masque;
+        m_cases[c] = numero;
+    }
+}
+
+//! \brief retourne le numéro de la chaîne [p_debut, p_debut + p_taille), en l'ajoutant si elle n'est pas internée
+//! \throws logic_error si la table contient déjà aucun - 1 identifiants
+unsigned int Identifiants::ajouter(const char *p_debut, size_t p_taille, size_t p_hachage)
+{
+    size_t c = trouverCase(p_debut, p_taille, p_hachage);
+    if (m_cases[c] != aucun) return m_cases[c];
+    if (m_chaines.size() == aucun - 1)
+        throw logic_error("Identifiants::interner(): trop d'identifiants");
+
+    unsigned int numero = (unsigned int) m_chaines.size();
+    m_chaines.push_back(string(p_debut, p_taille));
+    m_hachages.push_back(p_hachage);
+    m_cases[c] = numero;
+    if (2 * m_chaines.size() > m_cases.size()) agrandir(); //au plus une case sur deux est occupée
+    return numero;
+}
+
+//! \brief retourne le numéro de p_chaine, en l'internant si ce n'est pas déjà fait
+unsigned int Identifiants::interner(const std::string &p_chaine)
+{
+    return ajouter(p_chaine.data(), p_chaine.size(), hacher(p_chaine.data(), p_chaine.size()));
+}
+
+//! \brief retourne le numéro de la valeur de p_champ, en l'internant si ce n'est pas déjà fait
+unsigned int Identifiants::interner(const ChampCSV &p_champ)
+{
+    if (p_champ.aGuillemetsDoubles()) return interner(p_champ.versString());
+    return ajouter(p_champ.debut(), p_champ.taille(), hacher(p_champ.debut(), p_champ.taille()));
+}
+
+//! \brief retourne le numéro de p_chaine, ou aucun si elle n'est pas internée
+unsigned int Identifiants::chercher(const std::string &p_chaine) const
+{
+    return m_cases[trouverCase(p_chaine.data(), p_chaine.size(), hacher(p_chaine.data(), p_chaine.size()))];
+}
+
+//! \brief retourne le numéro de la valeur de p_champ, ou aucun si elle n'est pas internée
+unsigned int Identifiants::chercher(const ChampCSV &p_champ) const
+{
+    if (p_champ.aGuillemetsDoubles()) return chercher(p_champ.versString());
+    return m_cases[trouverCase(p_champ.debut(), p_champ.taille(), hacher(p_champ.debut(), p_champ.taille()))];
+}
+
+unsigned int Identifiants::getNbIdentifiants() const
+{
+    return (unsigned int) m_chaines.size();
+}
@@ -0,0 +1,49 @@
+//
+//  identifiants.h
+//  Table d'internement des identifiants GTFS textuels (trip_id, service_id)
+//
+
+#ifndef IDENTIFIANTS_H
+#define IDENTIFIANTS_H
+
+#include <string>
+#include <vector>
+#include <climits>
+
+#include "lecteurcsv.h"
+
+//! \brief  Associe à chaque identifiant textuel un entier dense de 32 bits (0, 1, 2, ... dans l'ordre d'internement)
+//! \brief  Une fois les identifiants internés, les recherches et comparaisons se font sur les entiers; la chaîne
+//! \brief  n'est conservée qu'une fois, pour l'affichage. La table est adressée ouvertement sur les numéros et
+//! \brief  compare directement les caractères d'un ChampCSV: une recherche ne fait aucune allocation.
+//! \brief  Les recherches (méthodes const) peuvent être faites simultanément par plusieurs threads.
+class Identifiants
+{
+public:
+
+    static const unsigned int aucun = UINT_MAX; /*!< retourné par chercher() si l'identifiant n'est pas interné */
+
+    Identifiants();
+
+    unsigned int interner(const std::string &p_chaine);
+    unsigned int interner(const ChampCSV &p_champ);
+    unsigned int chercher(const std::string &p_chaine) const;
+    unsigned int chercher(const ChampCSV &p_champ) const;
+
+    //! \brief la chaîne de l'identifiant p_numero
+    const std::string &getChaine(unsigned int p_numero) const { return m_chaines[p_numero]; }
+    unsigned int getNbIdentifiants() const;
+
+private:
+
+    std::vector<std::string> m_chaines; //m_chaines[i] est la chaîne du numéro i
+    std::vector<unsigned int> m_cases; //numéros (ou aucun) adressés par hachage, taille en puissance de 2
+    std::vector<size_t> m_hachages; //m_hachages[i] est le hachage de m_chaines[i], pour agrandir sans rehacher
+
+    static size_t hacher(const char *p_debut, size_t p_taille);
+    size_t trouverCase(const char *p_debut, size_t p_taille, size_t p_hachage) const;
+    unsigned int ajouter(const char *p_debut, size_t p_taille, size_t p_hachage);
+    void agrandir();
+};
+
+#endif //IDENTIFIANTS_H
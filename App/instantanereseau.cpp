@@ -0,0 +1,443 @@
+//
+//  instantanereseau.cpp
+//  Instantané binaire d'un ReseauGTFS construit, projeté en mémoire au chargement
+//
+
+#include "instantanereseau.h"
+
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+const uint32_t InstantaneReseau::version;
+const uint32_t InstantaneReseau::aucunIndice;
+
+namespace
+{
+    const char marqueInstantane[8] = {'R', 'T', 'C', 'R', 'E', 'S', 'O', '\0'};
+    const uint32_t boutismeMachine = 0x01020304;
+
+    //! \brief ajoute les octets de p_valeurs à p_octets
+    template <typename T>
+    void ajouterOctets(vector<char> &p_octets, const vector<T> &p_valeurs)
+    {
+        const char *debut = reinterpret_cast<const char *>(p_valeurs.data());
+        p_octets.insert(p_octets.end(), debut, debut + p_valeurs.size() * sizeof(T));
+    }
+}
+
+//! \brief somme de contrôle FNV-1a de 64 bits
+uint64_t InstantaneReseau::sommeControle(const char *p_debut, size_t p_taille)
+{
+    uint64_t somme = 14695981039346656037ULL;
+    for (size_t i = 0; i < p_taille; ++i)
+    {
+        somme ^= (unsigned char) p_debut[i];
+        somme *= 1099511628211ULL;
+    }
+    return somme;
+}
+
+//! \brief écrit l'instantané d'un réseau construit à partir de p_gtfs
+//! \param[in] p_gtfs: les données GTFS qui ont servi à construire p_reseau
+//! \param[in] p_reseau: le réseau, sans arcs origine/destination
+//! \param[in] p_nomFichier: le fichier à écrire (remplacé s'il existe)
+//! \throws logic_error si le réseau contient des arcs non figés ou si le fichier ne peut pas être écrit
+void InstantaneReseau::sauvegarder(const DonneesGTFS &p_gtfs, const ReseauGTFS &p_reseau, const std::string &p_nomFichier)
+{
+    static_assert(sizeof(size_t) == sizeof(uint64_t), "DEBUT_ARCS est projeté directement en size_t");
+    const Graphe &graphe = p_reseau.getGraphe();
+    const size_t nbSommets = graphe.getNbSommets();
+    if (nbSommets != p_gtfs.getNbArrets() || graphe.getNbSommetsFiges() != nbSommets ||
+        graphe.getDebutArcsFiges()[nbSommets] != graphe.getNbArcs())
+        throw logic_error("InstantaneReseau::sauvegarder(): le réseau doit être figé et sans arcs origine/destination");
+
+    vector<char> chaines;
+    auto ajouterChaine = [&chaines](const string &p_chaine) -> Chaine
+    {
+        Chaine resultat = {(uint32_t) chaines.size(), (uint32_t) p_chaine.size()};
+        chaines.insert(chaines.end(), p_chaine.begin(), p_chaine.end());
+        return resultat;
+    };
+
+    //lignes, par identifiant pour que le fichier ne dépende pas de l'ordre de la table de hachage
+    vector<const Ligne *> lignesTriees;
+    for (const auto &ligne : p_gtfs.getLignes()) lignesTriees.push_back(&ligne.second);
+    sort(lignesTriees.begin(), lignesTriees.end(), [](const Ligne *l1, const Ligne *l2)
+    {
+        return l1->getId() < l2->getId();
+    });
+    vector<LigneInstantanee> lignes;
+    unordered_map<unsigned int, uint32_t> indiceLigne;
+    for (const Ligne *ligne : lignesTriees)
+    {
+        indiceLigne[ligne->getId()] = (uint32_t) lignes.size();
+        lignes.push_back({ligne->getId(), (uint32_t) ligne->getCategorie(), ajouterChaine(ligne->getNumero()),
+                          ajouterChaine(ligne->getDescription())});
+    }
+
+    vector<VoyageInstantane> voyages;
+    for (const auto &voyage : p_gtfs.getVoyages())
+    {
+        auto itrLigne = indiceLigne.find(voyage.second.getLigne());
+        voyages.push_back({ajouterChaine(p_gtfs.getIdsVoyages().getChaine(voyage.first)),
+                           ajouterChaine(p_gtfs.getIdsServices().getChaine(voyage.second.getServiceId())),
+                           ajouterChaine(voyage.second.getDestination()),
+                           itrLigne == indiceLigne.end() ? aucunIndice : itrLigne->second});
+    }
+
+    vector<StationInstantanee> stations;
+    for (const auto &station : p_gtfs.getStations())
+    {
+        stations.push_back({station.second.getCoords().getLatitude(), station.second.getCoords().getLongitude(),
+                            station.first, ajouterChaine(station.second.getNom()),
+                            ajouterChaine(station.second.getDescription()), 0});
+    }
+
+    //les stations et les voyages de la table des arrêts sont numérotés dans le même ordre que ci-dessus
+    const TableArrets &table = p_reseau.getTable();
+    vector<Sommet> sommets;
+    sommets.reserve(nbSommets);
+    for (size_t v = 0; v < nbSommets; ++v)
+        sommets.push_back({table.getStation(v), table.getArrivee(v), table.getDepart(v), table.getSequence(v),
+                           table.getVoyage(v)});
+
+    vector<uint32_t> debutSommetsStation(1, 0);
+    vector<uint32_t> sommetsStation;
+    for (unsigned int s = 0; s < table.getNbStations(); ++s)
+    {
+        for (unsigned int rang = 0; rang < table.getNbArretsStation(s); ++rang)
+            sommetsStation.push_back((uint32_t) table.getArretStation(s, rang));
+        debutSommetsStation.push_back((uint32_t) sommetsStation.size());
+    }
+
+    //assembler les sections après l'en-tête, chacune alignée sur 8 octets
+    EnTete entete;
+    memset(&entete, 0, sizeof(entete));
+    vector<char> contenu;
+    auto ajouterSection = [&contenu, &entete](Section p_section, const char *p_octets, size_t p_taille)
+    {
+        while ((sizeof(EnTete) + contenu.size()) % 8 != 0) contenu.push_back('\0');
+        entete.decalages[p_section] = sizeof(EnTete) + contenu.size();
+        entete.tailles[p_section] = p_taille;
+        contenu.insert(contenu.end(), p_octets, p_octets + p_taille);
+    };
+    vector<char> octets;
+    const size_t *debutArcs = graphe.getDebutArcsFiges();
+    ajouterSection(DEBUT_ARCS, reinterpret_cast<const char *>(debutArcs), (nbSommets + 1) * sizeof(size_t));
+    ajouterSection(ARCS, reinterpret_cast<const char *>(graphe.getArcsFiges()),
+                   debutArcs[nbSommets] * sizeof(Graphe::ArcFige));
+    ajouterOctets(octets, sommets);
+    ajouterSection(SOMMETS, octets.data(), octets.size());
+    octets.clear();
+    ajouterOctets(octets, debutSommetsStation);
+    ajouterSection(DEBUT_SOMMETS_STATION, octets.data(), octets.size());
+    octets.clear();
+    ajouterOctets(octets, sommetsStation);
+    ajouterSection(SOMMETS_STATION, octets.data(), octets.size());
+    octets.clear();
+    ajouterOctets(octets, stations);
+    ajouterSection(STATIONS, octets.data(), octets.size());
+    octets.clear();
+    ajouterOctets(octets, voyages);
+    ajouterSection(VOYAGES, octets.data(), octets.size());
+    octets.clear();
+    ajouterOctets(octets, lignes);
+    ajouterSection(LIGNES, octets.data(), octets.size());
+    ajouterSection(CHAINES, chaines.data(), chaines.size());
+
+    memcpy(entete.marque, marqueInstantane, sizeof(entete.marque));
+    entete.version = version;
+    entete.boutisme = boutismeMachine;
+    entete.taille = sizeof(EnTete) + contenu.size();
+    entete.sommeControle = sommeControle(contenu.data(), contenu.size());
+    entete.an = p_gtfs.getDate().getAn();
+    entete.mois = p_gtfs.getDate().getMois();
+    entete.jour = p_gtfs.getDate().getJour();
+    entete.tempsDebut = (uint32_t) TableArrets::enSecondes(p_gtfs.getTempsDebut());
+    entete.tempsFin = (uint32_t) TableArrets::enSecondes(p_gtfs.getTempsFin());
+    entete.nbSommets = (uint32_t) nbSommets;
+    entete.nbStations = (uint32_t) stations.size();
+    entete.nbVoyages = (uint32_t) voyages.size();
+    entete.nbLignes = (uint32_t) lignes.size();
+
+    ofstream fichier(p_nomFichier, ios::binary | ios::trunc);
+    if (!fichier.is_open())
+        throw logic_error("InstantaneReseau::sauvegarder(): le fichier " + p_nomFichier + " n'a pas pu ouvrir");
+    fichier.write(reinterpret_cast<const char *>(&entete), sizeof(entete));
+    fichier.write(contenu.data(), contenu.size());
+    if (!fichier)
+        throw logic_error("InstantaneReseau::sauvegarder(): l'écriture de " + p_nomFichier + " a échoué");
+}
+
+//! \brief projette un instantané en mémoire et vérifie son intégrité
+//! \param[in] p_nomFichier: un fichier produit par InstantaneReseau::sauvegarder()
+//! \throws logic_error si le fichier ne peut pas être projeté, n'est pas un instantané de cette version,
+//! \throws logic_error a été produit sur une machine de boutisme différent ou est corrompu
+InstantaneReseau::InstantaneReseau(const std::string &p_nomFichier)
+        : m_debut(nullptr), m_taille(0), m_entete(nullptr)
+{
+    int fd = open(p_nomFichier.c_str(), O_RDONLY);
+    if (fd < 0) throw logic_error("InstantaneReseau: le fichier " + p_nomFichier + " n'a pas pu ouvrir");
+    struct stat infos;
+    if (fstat(fd, &infos) != 0 || (size_t) infos.st_size < sizeof(EnTete))
+    {
+        close(fd);
+        throw logic_error("InstantaneReseau: " + p_nomFichier + " est trop petit pour être un instantané");
+    }
+    m_taille = (size_t) infos.st_size;
+    void *projection = mmap(nullptr, m_taille, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (projection == MAP_FAILED) throw logic_error("InstantaneReseau: mmap() a échoué pour " + p_nomFichier);
+    m_debut = static_cast<const char *>(projection);
+    m_entete = reinterpret_cast<const EnTete *>(m_debut);
+
+    try
+    {
+        if (memcmp(m_entete->marque, marqueInstantane, sizeof(marqueInstantane)) != 0)
+            throw logic_error("InstantaneReseau: " + p_nomFichier + " n'est pas un instantané de réseau");
+        if (m_entete->version != version)
+            throw logic_error("InstantaneReseau: " + p_nomFichier + " est de la version " +
+                              to_string(m_entete->version) + " au lieu de " + to_string(version));
+        if (m_entete->boutisme != boutismeMachine)
+            throw logic_error("InstantaneReseau: " + p_nomFichier + " a été produit avec un autre boutisme");
+        if (m_entete->taille != m_taille)
+            throw logic_error("InstantaneReseau: " + p_nomFichier + " est tronqué");
+        if (sommeControle(m_debut + sizeof(EnTete), m_taille - sizeof(EnTete)) != m_entete->sommeControle)
+            throw logic_error("InstantaneReseau: la somme de contrôle de " + p_nomFichier + " est invalide");
+
+        m_debutArcs = section<size_t>(DEBUT_ARCS, (uint64_t) m_entete->nbSommets + 1);
+        m_arcs = section<Graphe::ArcFige>(ARCS, m_debutArcs[m_entete->nbSommets]);
+        m_sommets = section<Sommet>(SOMMETS, m_entete->nbSommets);
+        m_debutSommetsStation = section<uint32_t>(DEBUT_SOMMETS_STATION, (uint64_t) m_entete->nbStations + 1);
+        m_sommetsStation = section<uint32_t>(SOMMETS_STATION, m_debutSommetsStation[m_entete->nbStations]);
+        m_stations = section<StationInstantanee>(STATIONS, m_entete->nbStations);
+        m_voyages = section<VoyageInstantane>(VOYAGES, m_entete->nbVoyages);
+        m_lignes = section<LigneInstantanee>(LIGNES, m_entete->nbLignes);
+        m_chaines = section<char>(CHAINES, m_entete->tailles[CHAINES]);
+        verifierContenu();
+    }
+    catch (...)
+    {
+        munmap(const_cast<char *>(m_debut), m_taille);
+        throw;
+    }
+    m_graphe = Graphe(m_entete->nbSommets, m_debutArcs, m_arcs);
+
+    vector<Coordonnees> coords;
+    coords.reserve(m_entete->nbStations);
+    for (uint32_t s = 0; s < m_entete->nbStations; ++s)
+        coords.push_back(Coordonnees(m_stations[s].latitude, m_stations[s].longitude));
+    m_grille = GrilleStations(coords);
+}
+
+InstantaneReseau::~InstantaneReseau()
+{
+    munmap(const_cast<char *>(m_debut), m_taille);
+}
+
+//! \brief retourne le début de la section p_section après avoir vérifié qu'elle contient p_nbElements éléments de type T
+//! \throws logic_error si la section sort du fichier, est mal alignée ou n'a pas la taille attendue
+template <typename T>
+const T *InstantaneReseau::section(Section p_section, uint64_t p_nbElements) const
+{
+    uint64_t decalage = m_entete->decalages[p_section];
+    uint64_t taille = m_entete->tailles[p_section];
+    if (decalage % 8 != 0 || decalage < sizeof(EnTete) || decalage > m_taille || taille > m_taille - decalage ||
+        taille != p_nbElements * sizeof(T))
+        throw logic_error("InstantaneReseau: la section " + to_string((int) p_section) + " est invalide");
+    return reinterpret_cast<const T *>(m_debut + decalage);
+}
+
+//! \brief vérifie que les indices de l'instantané restent dans leurs tables, afin qu'une requête ne puisse pas lire
+//! \brief hors de la projection
+//! \throws logic_error si un indice est invalide
+void InstantaneReseau::verifierContenu() const
+{
+    const uint32_t nbSommets = m_entete->nbSommets;
+    for (uint32_t v = 0; v < nbSommets; ++v)
+    {
+        if (m_debutArcs[v] > m_debutArcs[v + 1] ||
+            (m_sommets[v].station >= m_entete->nbStations && m_sommets[v].station != aucunIndice) ||
+            m_sommets[v].voyage >= m_entete->nbVoyages)
+            throw logic_error("InstantaneReseau: le sommet " + to_string(v) + " est invalide");
+    }
+    for (size_t k = 0; k < m_debutArcs[nbSommets]; ++k)
+        if (m_arcs[k].destination >= nbSommets) throw logic_error("InstantaneReseau: un arc est invalide");
+    for (uint32_t s = 0; s < m_entete->nbStations; ++s)
+        if (m_debutSommetsStation[s] > m_debutSommetsStation[s + 1])
+            throw logic_error("InstantaneReseau: la station " + to_string(s) + " est invalide");
+    for (uint32_t k = 0; k < m_debutSommetsStation[m_entete->nbStations]; ++k)
+        if (m_sommetsStation[k] >= nbSommets) throw logic_error("InstantaneReseau: un sommet de station est invalide");
+
+    auto verifierChaine = [this](const Chaine &p_chaine)
+    {
+        if ((uint64_t) p_chaine.debut + p_chaine.taille > m_entete->tailles[CHAINES])
+            throw logic_error("InstantaneReseau: une chaîne est invalide");
+    };
+    for (uint32_t s = 0; s < m_entete->nbStations; ++s)
+    {
+        verifierChaine(m_stations[s].nom);
+        verifierChaine(m_stations[s].description);
+    }
+    for (uint32_t v = 0; v < m_entete->nbVoyages; ++v)
+    {
+        verifierChaine(m_voyages[v].id);
+        verifierChaine(m_voyages[v].service);
+        verifierChaine(m_voyages[v].destination);
+        if (m_voyages[v].ligne >= m_entete->nbLignes && m_voyages[v].ligne != aucunIndice)
+            throw logic_error("InstantaneReseau: le voyage " + to_string(v) + " est invalide");
+    }
+    for (uint32_t l = 0; l < m_entete->nbLignes; ++l)
+    {
+        verifierChaine(m_lignes[l].numero);
+        verifierChaine(m_lignes[l].description);
+    }
+}
+
+Date InstantaneReseau::getDate() const
+{
+    return Date(m_entete->an, m_entete->mois, m_entete->jour);
+}
+
+Heure InstantaneReseau::getTempsDebut() const
+{
+    return Heure(0, 0, 0).add_secondes(m_entete->tempsDebut);
+}
+
+Heure InstantaneReseau::getTempsFin() const
+{
+    return Heure(0, 0, 0).add_secondes(m_entete->tempsFin);
+}
+
+//! \brief le nombre de sommets du graphe, sans les points origine et destination
+size_t InstantaneReseau::getNbSommets() const
+{
+    return m_entete->nbSommets;
+}
+
+unsigned int InstantaneReseau::getNbStations() const
+{
+    return m_entete->nbStations;
+}
+
+unsigned int InstantaneReseau::getNbVoyages() const
+{
+    return m_entete->nbVoyages;
+}
+
+unsigned int InstantaneReseau::getNbLignes() const
+{
+    return m_entete->nbLignes;
+}
+
+std::string InstantaneReseau::chaine(const Chaine &p_chaine) const
+{
+    return string(m_chaines + p_chaine.debut, p_chaine.taille);
+}
+
+//! \brief les arrêts des sections SOMMETS, STATIONS, VOYAGES et LIGNES, pour ReseauGTFS::afficherItineraire()
+class InstantaneReseau::Vue : public VueArrets
+{
+public:
+    explicit Vue(const InstantaneReseau &p_instantane) : m_instantane(p_instantane) {}
+
+    size_t getNbArrets() const override { return m_instantane.m_entete->nbSommets; }
+    unsigned int getStation(size_t p_arret) const override { return m_instantane.m_sommets[p_arret].station; }
+    unsigned int getVoyage(size_t p_arret) const override { return m_instantane.m_sommets[p_arret].voyage; }
+    unsigned int getArrivee(size_t p_arret) const override { return m_instantane.m_sommets[p_arret].arrivee; }
+    std::string getNumeroLigne(size_t p_arret) const override
+    {
+        uint32_t ligne = voyage(p_arret).ligne;
+        return ligne == aucunIndice ? string("?") : m_instantane.chaine(m_instantane.m_lignes[ligne].numero);
+    }
+    void afficherStation(std::ostream &p_flux, size_t p_arret) const override
+    {
+        m_instantane.afficherStation(p_flux, (uint32_t) p_arret);
+    }
+    void afficherVoyage(std::ostream &p_flux, size_t p_arret) const override
+    {
+        p_flux << "Vers " << m_instantane.chaine(voyage(p_arret).destination);
+    }
+
+private:
+    const VoyageInstantane &voyage(size_t p_arret) const
+    {
+        return m_instantane.m_voyages[m_instantane.m_sommets[p_arret].voyage];
+    }
+
+    const InstantaneReseau &m_instantane;
+};
+
+//! \brief Trouve le plus court chemin du point origine au point destination, partant à getTempsDebut()
+//! \brief Les arcs origine/destination forment une surcouche construite comme dans ReseauGTFS::construireSurcouche();
+//! \brief la projection n'est que consultée.
+//! \param[in] p_pointOrigine: les coordonnées GPS du point origine
+//! \param[in] p_pointDestination: les coordonnées GPS du point destination
+//! \param[in] p_afficherItineraire: true si on désire afficher l'itinéraire et false autrement
+//! \param[out] p_tempsExecution: le temps d'exécution, en microsecondes, de l'algorithme de plus court chemin
+//! \param[in,out] p_espace: l'espace de travail de la recherche, réutilisé d'une requête à l'autre par l'appelant
+//! \return la durée du trajet en secondes (= numeric_limits<unsigned int>::max() si la destination n'est pas atteignable)
+//! \throws logic_error si un problème survient durant l'exécution de la méthode
+unsigned int InstantaneReseau::itineraire(const Coordonnees &p_pointOrigine, const Coordonnees &p_pointDestination,
+                                          bool p_afficherItineraire, long &p_tempsExecution,
+                                          EspaceRecherche &p_espace) const
+{
+    const unsigned int tempsDebut = m_entete->tempsDebut;
+
+    Graphe::Surcouche surcouche;
+    vector<pair<unsigned int, double> > accessibles;
+    m_grille.stationsAccessibles(p_pointOrigine, ReseauGTFS::distanceMaxMarche, accessibles);
+    for (const auto &station : accessibles)
+    {
+        const uint32_t *debut = m_sommetsStation + m_debutSommetsStation[station.first];
+        const uint32_t *fin = m_sommetsStation + m_debutSommetsStation[station.first + 1];
+
+        //le premier arrêt de la station à partir de l'heure où on y arrive à pieds
+        unsigned int heure = tempsDebut + (unsigned int) round((station.second / ReseauGTFS::vitesseDeMarche) * 3600);
+        const uint32_t *premier = lower_bound(debut, fin, heure, [this](uint32_t p_sommet, unsigned int p_heure)
+        {
+            return m_sommets[p_sommet].arrivee < p_heure;
+        });
+        if (premier != fin)
+            surcouche.departs.push_back({*premier, m_sommets[*premier].arrivee - tempsDebut});
+    }
+
+    m_grille.stationsAccessibles(p_pointDestination, ReseauGTFS::distanceMaxMarche, accessibles);
+    for (const auto &station : accessibles)
+    {
+        const uint32_t *debut = m_sommetsStation + m_debutSommetsStation[station.first];
+        const uint32_t *fin = m_sommetsStation + m_debutSommetsStation[station.first + 1];
+        unsigned int tempsMarche = (unsigned int) ((station.second / ReseauGTFS::vitesseDeMarche) * 3600);
+        for (const uint32_t *sommet = debut; sommet != fin; ++sommet)
+            surcouche.arrivees.push_back({*sommet, tempsMarche});
+    }
+
+    vector<size_t> chemin;
+    timeval tv1;
+    timeval tv2;
+    if (gettimeofday(&tv1, 0) != 0)
+        throw logic_error("InstantaneReseau::itineraire(): gettimeofday() a échoué pour tv1");
+    unsigned int tempsDuTrajet = m_graphe.plusCourtChemin(surcouche, chemin, p_espace);
+    if (gettimeofday(&tv2, 0) != 0)
+        throw logic_error("InstantaneReseau::itineraire(): gettimeofday() a échoué pour tv2");
+    p_tempsExecution = tempsExecution(tv1, tv2);
+
+    ReseauGTFS::afficherItineraire(Vue(*this), chemin, tempsDuTrajet, p_afficherItineraire, getTempsDebut());
+    return tempsDuTrajet;
+}
+
+//! \brief affiche la station du sommet p_sommet comme operator<<(ostream&, const Station&)
+void InstantaneReseau::afficherStation(std::ostream &p_flux, uint32_t p_sommet) const
+{
+    uint32_t s = m_sommets[p_sommet].station;
+    if (s == aucunIndice) throw logic_error("InstantaneReseau::afficherStation(): station inconnue");
+    p_flux << m_stations[s].id << " - " << chaine(m_stations[s].nom) << " "
+           << Coordonnees(m_stations[s].latitude, m_stations[s].longitude);
+}
@@ -0,0 +1,148 @@
+//
+//  instantanereseau.h
+//  Instantané binaire d'un ReseauGTFS construit, projeté en mémoire au chargement
+//
+
+#ifndef INSTANTANERESEAU_H
+#define INSTANTANERESEAU_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ReseauGTFS.h"
+#include "grillestations.h"
+
+//! \brief  Instantané binaire d'un ReseauGTFS construit pour une date et un intervalle [now1, now2): arcs du graphe,
+//! \brief  arrêt de chaque sommet, stations, voyages et lignes. Le fichier commence par un en-tête (marque, version,
+//! \brief  boutisme, taille, somme de contrôle FNV-1a de 64 bits) suivi de sections alignées sur 8 octets.
+//! \brief  Au chargement, le fichier est projeté avec mmap et lu sur place: le graphe emprunte ses arcs à la projection
+//! \brief  et aucune allocation n'est faite par arc, arrêt ou station. L'instantané répond ensuite aux requêtes comme
+//! \brief  ReseauGTFS, sans relire le GTFS.
+class InstantaneReseau
+{
+public:
+
+    static const uint32_t version = 1; /*!< à incrémenter à chaque changement du format */
+
+    static void sauvegarder(const DonneesGTFS &, const ReseauGTFS &, const std::string &);
+
+    explicit InstantaneReseau(const std::string &);
+    ~InstantaneReseau();
+
+    Date getDate() const;
+    Heure getTempsDebut() const;
+    Heure getTempsFin() const;
+    size_t getNbSommets() const;
+    unsigned int getNbStations() const;
+    unsigned int getNbVoyages() const;
+    unsigned int getNbLignes() const;
+
+    unsigned int itineraire(const Coordonnees &, const Coordonnees &, bool, long &, EspaceRecherche &) const;
+
+private:
+
+    InstantaneReseau(const InstantaneReseau &);
+    InstantaneReseau &operator=(const InstantaneReseau &);
+
+    //! \brief une chaîne de caractères de la section CHAINES
+    struct Chaine
+    {
+        uint32_t debut;
+        uint32_t taille;
+    };
+
+    //! \brief l'arrêt associé à un sommet du graphe; les heures sont en secondes depuis minuit
+    struct Sommet
+    {
+        uint32_t station; /*!< indice dans la section STATIONS (aucunIndice si la station est inconnue) */
+        uint32_t arrivee;
+        uint32_t depart;
+        uint32_t sequence;
+        uint32_t voyage; /*!< indice dans la section VOYAGES */
+    };
+
+    struct StationInstantanee
+    {
+        double latitude;
+        double longitude;
+        uint32_t id;
+        Chaine nom;
+        Chaine description;
+        uint32_t reserve;
+    };
+
+    struct VoyageInstantane
+    {
+        Chaine id;
+        Chaine service;
+        Chaine destination;
+        uint32_t ligne; /*!< indice dans la section LIGNES (aucunIndice si la ligne est inconnue) */
+    };
+
+    struct LigneInstantanee
+    {
+        uint32_t id;
+        uint32_t categorie;
+        Chaine numero;
+        Chaine description;
+    };
+
+    enum Section
+    {
+        DEBUT_ARCS, /*!< nbSommets + 1 uint64_t: début des arcs de chaque sommet */
+        ARCS, /*!< Graphe::ArcFige regroupés par sommet d'origine */
+        SOMMETS, /*!< un Sommet par sommet du graphe */
+        DEBUT_SOMMETS_STATION, /*!< nbStations + 1 uint32_t: début des sommets de chaque station */
+        SOMMETS_STATION, /*!< les sommets de chaque station, par heure d'arrivée (ordre de Station::getArrets()) */
+        STATIONS,
+        VOYAGES,
+        LIGNES,
+        CHAINES,
+        NB_SECTIONS
+    };
+
+    struct EnTete
+    {
+        char marque[8];
+        uint32_t version;
+        uint32_t boutisme; /*!< 0x01020304 écrit dans l'ordre de la machine qui a produit le fichier */
+        uint64_t taille; /*!< taille totale du fichier */
+        uint64_t sommeControle; /*!< FNV-1a de 64 bits de tout ce qui suit l'en-tête */
+        uint32_t an, mois, jour;
+        uint32_t tempsDebut, tempsFin; /*!< l'intervalle [now1, now2), en secondes depuis minuit */
+        uint32_t nbSommets, nbStations, nbVoyages, nbLignes;
+        uint32_t reserve;
+        uint64_t decalages[NB_SECTIONS];
+        uint64_t tailles[NB_SECTIONS];
+    };
+
+    static const uint32_t aucunIndice = 0xFFFFFFFF;
+
+    const char *m_debut; /*!< le fichier projeté */
+    size_t m_taille;
+    const EnTete *m_entete;
+    const size_t *m_debutArcs;
+    const Graphe::ArcFige *m_arcs;
+    const Sommet *m_sommets;
+    const uint32_t *m_debutSommetsStation;
+    const uint32_t *m_sommetsStation;
+    const StationInstantanee *m_stations;
+    const VoyageInstantane *m_voyages;
+    const LigneInstantanee *m_lignes;
+    const char *m_chaines;
+
+    Graphe m_graphe; /*!< emprunte les arcs de la projection; les requêtes n'y ajoutent qu'une surcouche */
+    GrilleStations m_grille; /*!< construite au chargement à partir de la section STATIONS */
+
+    static uint64_t sommeControle(const char *p_debut, size_t p_taille);
+    template <typename T>
+    const T *section(Section p_section, uint64_t p_nbElements) const;
+    void verifierContenu() const;
+    std::string chaine(const Chaine &p_chaine) const;
+    void afficherStation(std::ostream &p_flux, uint32_t p_sommet) const;
+
+    class Vue;
+};
+
+#endif //INSTANTANERESEAU_H
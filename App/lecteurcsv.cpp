@@ -0,0 +1,253 @@
+//
+//  lecteurcsv.cpp
+//  Lecture sans copie des fichiers CSV du GTFS, projetés en mémoire
+//
+
+#include "lecteurcsv.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace
+{
+    //! \brief lit un entier non signé de [p_courant, p_fin) jusqu'au premier caractère qui n'est pas un chiffre
+    //! \return le nombre de chiffres lus (0 si aucun)
+    size_t lireChiffres(const char *p_courant, const char *p_fin, unsigned int &p_valeur)
+    {
+        const char *debut = p_courant;
+        p_valeur = 0;
+        while (p_courant < p_fin && *p_courant >= '0' && *p_courant <= '9')
+        {
+            p_valeur = p_valeur * 10 + (unsigned int) (*p_courant - '0');
+            ++p_courant;
+        }
+        return (size_t) (p_courant - debut);
+    }
+}
+
+ChampCSV::ChampCSV() : m_debut(nullptr), m_taille(0), m_guillemetsDoubles(false)
+{
+}
+
+ChampCSV::ChampCSV(const char *p_debut, size_t p_taille, bool p_guillemetsDoubles)
+        : m_debut(p_debut), m_taille(p_taille), m_guillemetsDoubles(p_guillemetsDoubles)
+{
+}
+
+//! \brief copie le champ dans un nouveau string
+std::string ChampCSV::versString() const
+{
+    string resultat;
+    copierDans(resultat);
+    return resultat;
+}
+
+//! \brief copie le champ dans p_destination, en réutilisant sa mémoire lorsque c'est possible
+void ChampCSV::copierDans(std::string &p_destination) const
+{
+    p_destination.assign(m_debut, m_taille);
+    if (m_guillemetsDoubles)
+    {
+        size_t j = 0;
+        for (size_t i = 0; i < p_destination.size(); ++i, ++j)
+        {
+            p_destination[j] = p_destination[i];
+            if (p_destination[i] == '"') ++i; //le second guillemet de la paire est sauté
+        }
+        p_destination.resize(j);
+    }
+}
+
+//! \brief convertit un champ formé uniquement de chiffres
+//! \throws logic_error si le champ est vide ou contient autre chose que des chiffres
+unsigned int ChampCSV::versEntier() const
+{
+    unsigned int valeur;
+    if (m_taille == 0 || lireChiffres(m_debut, m_debut + m_taille, valeur) != m_taille)
+        throw logic_error("ChampCSV::versEntier(): entier invalide: " + versString());
+    return valeur;
+}
+
+//! \brief convertit un champ en nombre réel
+//! \throws logic_error si le champ n'est pas un nombre réel
+double ChampCSV::versReel() const
+{
+    char tampon[64]; //strtod() exige une chaîne terminée par un zéro, ce que le fichier projeté n'offre pas
+    if (m_taille == 0 || m_taille >= sizeof(tampon))
+        throw logic_error("ChampCSV::versReel(): réel invalide: " + versString());
+    memcpy(tampon, m_debut, m_taille);
+    tampon[m_taille] = '\0';
+    char *fin;
+    double valeur = strtod(tampon, &fin);
+    if (fin != tampon + m_taille)
+        throw logic_error("ChampCSV::versReel(): réel invalide: " + versString());
+    return valeur;
+}
+
+//! \brief convertit un champ au format H:MM:SS ou HH:MM:SS (les heures peuvent dépasser 24)
+//! \throws logic_error si le champ n'est pas une heure
+Heure ChampCSV::versHeure() const
+{
+    const char *courant = m_debut;
+    const char *fin = m_debut + m_taille;
+    unsigned int heure, min, sec;
+    size_t n = lireChiffres(courant, fin, heure);
+    courant += n;
+    bool valide = n > 0 && courant < fin && *courant++ == ':';
+    valide = valide && lireChiffres(courant, fin, min) == 2 && (courant += 2) < fin && *courant++ == ':';
+    valide = valide && lireChiffres(courant, fin, sec) == 2 && courant + 2 == fin;
+    if (!valide)
+        throw logic_error("ChampCSV::versHeure(): heure invalide: " + versString());
+    return Heure(heure, min, sec);
+}
+
+//! \brief convertit un champ au format AAAAMMJJ
+//! \throws logic_error si le champ n'est pas une date
+Date ChampCSV::versDate() const
+{
+    unsigned int an, mois, jour;
+    if (m_taille != 8 || lireChiffres(m_debut, m_debut + 4, an) != 4 ||
+        lireChiffres(m_debut + 4, m_debut + 6, mois) != 2 || lireChiffres(m_debut + 6, m_debut + 8, jour) != 2)
+        throw logic_error("ChampCSV::versDate(): date invalide: " + versString());
+    return Date(an, mois, jour);
+}
+
+PlageCSV::PlageCSV() : m_courant(nullptr), m_fin(nullptr), m_numeroLigne(0)
+{
+}
+
+//! \param[in] p_debut: le début de la première ligne de la plage
+//! \param[in] p_fin: la fin de la plage, juste après une fin de ligne ou à la fin du fichier
+PlageCSV::PlageCSV(const char *p_debut, const char *p_fin) : m_courant(p_debut), m_fin(p_fin), m_numeroLigne(0)
+{
+}
+
+//! \brief projette le fichier en mémoire en lecture seule
+//! \param[in] p_nomFichier: le nom du fichier CSV
+//! \throws logic_error si le fichier ne peut pas être ouvert ou projeté
+LecteurCSV::LecteurCSV(const std::string &p_nomFichier) : m_debut(nullptr), m_taille(0)
+{
+    int fd = open(p_nomFichier.c_str(), O_RDONLY);
+    if (fd < 0) throw logic_error("LecteurCSV: le fichier " + p_nomFichier + " n'a pas pu ouvrir");
+    struct stat infos;
+    if (fstat(fd, &infos) != 0)
+    {
+        close(fd);
+        throw logic_error("LecteurCSV: fstat() a échoué pour " + p_nomFichier);
+    }
+    m_taille = (size_t) infos.st_size;
+    if (m_taille > 0)
+    {
+        void *projection = mmap(nullptr, m_taille, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (projection == MAP_FAILED)
+        {
+            close(fd);
+            throw logic_error("LecteurCSV: mmap() a échoué pour " + p_nomFichier);
+        }
+        madvise(projection, m_taille, MADV_SEQUENTIAL);
+        m_debut = static_cast<const char *>(projection);
+        m_fin = m_debut + m_taille;
+        m_courant = m_debut;
+        if (m_taille >= 3 && memcmp(m_debut, "\xEF\xBB\xBF", 3) == 0) m_courant += 3; //BOM UTF-8
+    }
+    close(fd); //la projection demeure valide après la fermeture du descripteur
+}
+
+LecteurCSV::~LecteurCSV()
+{
+    if (m_debut) munmap(const_cast<char *>(m_debut), m_taille);
+}
+
+//! \brief découpe les lignes qui restent à lire en plages de tailles semblables, coupées après une fin de ligne
+//! \param[in] p_nbPlages: le nombre de plages désiré (au moins 1)
+//! \return les plages non vides, dans l'ordre du fichier; leur concaténation couvre toutes les lignes restantes
+//! \pre aucun champ entre guillemets des lignes restantes ne contient de fin de ligne
+std::vector<PlageCSV> LecteurCSV::decouper(size_t p_nbPlages) const
+{
+    vector<PlageCSV> plages;
+    if (p_nbPlages == 0) p_nbPlages = 1;
+    size_t tailleRestante = (size_t) (m_fin - m_courant);
+    const char *debut = m_courant;
+    for (size_t i = 1; i <= p_nbPlages && debut < m_fin; ++i)
+    {
+        const char *fin = (i == p_nbPlages) ? m_fin : m_courant + tailleRestante / p_nbPlages * i;
+        if (fin < debut) fin = debut;
+        const char *finLigne = static_cast<const char *>(memchr(fin, '\n', (size_t) (m_fin - fin)));
+        fin = finLigne ? finLigne + 1 : m_fin;
+        plages.push_back(PlageCSV(debut, fin));
+        debut = fin;
+    }
+    return plages;
+}
+
+//! \brief lit la prochaine ligne non vide du fichier
+//! \param[out] p_champs: les champs de la ligne, qui pointent dans le fichier projeté
+//! \return false s'il n'y a plus de ligne à lire
+//! \throws logic_error si un champ entre guillemets n'est pas fermé
+bool PlageCSV::lireLigne(std::vector<ChampCSV> &p_champs)
+{
+    p_champs.clear();
+    while (m_courant < m_fin && (*m_courant == '\n' || *m_courant == '\r'))
+    {
+        if (*m_courant == '\n') ++m_numeroLigne;
+        ++m_courant;
+    }
+    if (m_courant >= m_fin) return false;
+    ++m_numeroLigne;
+
+    for (;;)
+    {
+        if (m_courant < m_fin && *m_courant == '"')
+        {
+            const char *debut = ++m_courant;
+            bool guillemetsDoubles = false;
+            for (;;)
+            {
+                if (m_courant >= m_fin)
+                    throw logic_error("PlageCSV::lireLigne(): guillemet non fermé à la ligne " +
+                                      to_string(m_numeroLigne));
+                if (*m_courant == '"')
+                {
+                    if (m_courant + 1 < m_fin && m_courant[1] == '"')
+                    {
+                        guillemetsDoubles = true;
+                        m_courant += 2;
+                        continue;
+                    }
+                    break;
+                }
+                if (*m_courant == '\n') ++m_numeroLigne;
+                ++m_courant;
+            }
+            p_champs.push_back(ChampCSV(debut, (size_t) (m_courant - debut), guillemetsDoubles));
+            ++m_courant;
+            //tout ce qui suit le guillemet fermant jusqu'au séparateur est ignoré
+            while (m_courant < m_fin && *m_courant != ',' && *m_courant != '\n' && *m_courant != '\r') ++m_courant;
+        }
+        else
+        {
+            const char *debut = m_courant;
+            while (m_courant < m_fin && *m_courant != ',' && *m_courant != '\n' && *m_courant != '\r') ++m_courant;
+            p_champs.push_back(ChampCSV(debut, (size_t) (m_courant - debut), false));
+        }
+
+        if (m_courant >= m_fin) break;
+        char separateur = *m_courant++;
+        if (separateur == ',') continue;
+        if (separateur == '\r' && m_courant < m_fin && *m_courant == '\n') ++m_courant;
+        break;
+    }
+    return true;
+}
+
+//! \brief le numéro (à partir de 1) de la dernière ligne lue, utile pour les messages d'erreur
+size_t PlageCSV::getNumeroLigne() const
+{
+    return m_numeroLigne;
+}
@@ -0,0 +1,87 @@
+//
+//  lecteurcsv.h
+//  Lecture sans copie des fichiers CSV du GTFS, projetés en mémoire
+//
+
+#ifndef LECTEURCSV_H
+#define LECTEURCSV_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <stdexcept>
+
+#include "auxiliaires.h"
+
+//! \brief  Un champ d'une ligne CSV: une plage de caractères du fichier projeté, sans les guillemets qui l'entourent
+//! \brief  Le champ n'est valide que tant que le LecteurCSV qui l'a produit existe. Les conversions se font sur place;
+//! \brief  seul versString() (et copierDans()) copie les caractères.
+class ChampCSV
+{
+public:
+
+    ChampCSV();
+    ChampCSV(const char *p_debut, size_t p_taille, bool p_guillemetsDoubles);
+
+    const char *debut() const { return m_debut; }
+    size_t taille() const { return m_taille; }
+    bool estVide() const { return m_taille == 0; }
+    //! \brief vrai si le champ contient des guillemets doublés: ses caractères diffèrent alors de sa valeur
+    bool aGuillemetsDoubles() const { return m_guillemetsDoubles; }
+
+    std::string versString() const;
+    void copierDans(std::string &p_destination) const;
+    unsigned int versEntier() const;
+    double versReel() const;
+    Heure versHeure() const;
+    Date versDate() const;
+
+private:
+
+    const char *m_debut;
+    size_t m_taille;
+    bool m_guillemetsDoubles; /*!< le champ contient des guillemets échappés ("") à remplacer par un seul */
+};
+
+//! \brief  Curseur sur une suite de lignes complètes d'un fichier CSV (RFC 4180) projeté en mémoire
+//! \brief  Les champs entre guillemets peuvent contenir des virgules, des guillemets doublés et des fins de ligne.
+//! \brief  Les fins de ligne \n et \r\n sont acceptées et les lignes vides sont ignorées. Une plage ne possède pas
+//! \brief  la projection: elle doit être utilisée pendant que le LecteurCSV qui l'a produite existe.
+class PlageCSV
+{
+public:
+
+    PlageCSV();
+    PlageCSV(const char *p_debut, const char *p_fin);
+
+    bool lireLigne(std::vector<ChampCSV> &p_champs);
+    size_t getNumeroLigne() const;
+
+protected:
+
+    const char *m_courant; /*!< le début de la prochaine ligne à lire */
+    const char *m_fin;
+    size_t m_numeroLigne; /*!< le numéro de la dernière ligne lue, à partir de 1 au début de la plage */
+};
+
+//! \brief  Projette un fichier CSV en mémoire avec mmap et le parcourt une ligne à la fois (un BOM UTF-8 initial est sauté)
+//! \brief  Le reste du fichier peut aussi être découpé en plages indépendantes pour être lu par plusieurs threads.
+class LecteurCSV : public PlageCSV
+{
+public:
+
+    explicit LecteurCSV(const std::string &p_nomFichier);
+    ~LecteurCSV();
+
+    std::vector<PlageCSV> decouper(size_t p_nbPlages) const;
+
+private:
+
+    LecteurCSV(const LecteurCSV &);
+    LecteurCSV &operator=(const LecteurCSV &);
+
+    const char *m_debut; /*!< le début du fichier projeté (nullptr si le fichier est vide) */
+    size_t m_taille;
+};
+
+#endif //LECTEURCSV_H
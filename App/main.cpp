@@ -1,26 +1,39 @@
 //
 // Produced by Mario on Dec 2016.
 //
+// Usage: main [dossier de sortie]
+// Les métriques sont écrites dans le dossier de sortie (un dossier temporaire s'il est omis), jamais dans celui du flux.
+// Les vérifications croisées des moteurs de recherche sont dans verifications.cpp.
+//
 
 #include <iostream>
 #include <random>
+#include <chrono>
+#include <thread>
 
 #include "DonneesGTFS.h"
 #include "ReseauGTFS.h"
+#include "routeurcsa.h"
+#include "routeurraptor.h"
+#include "serviceitineraires.h"
+#include "metriques.h"
 
 using namespace std;
 
-int main()
+int main(int argc, char *argv[])
 {
     const string chemin_dossier = "RTC-8aout-1dec";
+    const string dossier_sortie = preparerDossierSortie(argc > 1 ? argv[1] : "");
     Date today(2017, 8, 18);
     Heure now1(8, 30, 0);
 //    Date today; //Le constructeur par défaut initialise la date à aujourd'hui
 //    Heure now1; //Le constructeur par défaut initialise l'heure à maintenant
     Heure now2 = now1.add_secondes(86400); //on désire obtenir tous les arrêts du reste de la journée
 
-    clock_t begin = clock();
+    //le chargement est multithread: on mesure le temps réel écoulé plutôt que le temps processeur
+    auto debutChargement = chrono::steady_clock::now();
     DonneesGTFS donnees_rtc(today, now1, now2);
+    donnees_rtc.ajouterAgences(chemin_dossier + "/agency.txt");
     donnees_rtc.ajouterLignes(chemin_dossier + "/routes.txt");
     cout << "Nombre de lignes = " << donnees_rtc.getNbLignes() << endl;
     donnees_rtc.ajouterStations(chemin_dossier + "/stops.txt");
@@ -32,17 +45,28 @@ int main()
     donnees_rtc.ajouterVoyagesDeLaDate(chemin_dossier + "/trips.txt");
     donnees_rtc.ajouterArretsDesVoyagesDeLaDate(chemin_dossier + "/stop_times.txt");
     donnees_rtc.ajouterTransferts(chemin_dossier + "/transfers.txt");
-    clock_t end = clock();
-    cout << "Chargement des données effectué en " << double(end - begin) / CLOCKS_PER_SEC << " secondes" << endl;
+    chrono::duration<double> dureeChargement = chrono::steady_clock::now() - debutChargement;
+    cout << "Chargement des données effectué en " << dureeChargement.count() << " secondes ("
+         << donnees_rtc.getNbThreadsChargement() << " threads)" << endl;
     cout << "Nombre de stations ayant au moins 1 arret = " << donnees_rtc.getNbStations() << endl;
     cout << "Nombre de transferts = " << donnees_rtc.getNbTransferts() << endl;
     cout << "Nombres de voyages = " << donnees_rtc.getNbVoyages() << endl;
     cout << "Nombre d'arrets = " << donnees_rtc.getNbArrets() << endl;
-    begin = clock();
+    clock_t begin = clock();
     ReseauGTFS reseau_rtc(donnees_rtc);
-    end = clock();
+    clock_t end = clock();
     cout << "Graphe (sans le point source et destination) a été produit en " << double(end - begin) / CLOCKS_PER_SEC
-         << " secondes" << endl << endl;
+         << " secondes" << endl;
+    begin = clock();
+    RouteurCSA routeur_csa(donnees_rtc);
+    end = clock();
+    cout << "Tableau de " << routeur_csa.getNbConnexions() << " connexions (CSA) produit en "
+         << double(end - begin) / CLOCKS_PER_SEC << " secondes" << endl;
+    begin = clock();
+    RouteurRaptor routeur_raptor(donnees_rtc);
+    end = clock();
+    cout << routeur_raptor.getNbRoutes() << " routes (RAPTOR) produites en "
+         << double(end - begin) / CLOCKS_PER_SEC << " secondes" << endl << endl;
 
     cout << "==========================================" << endl;
     cout << "           début de la simulation         " << endl;
@@ -67,6 +91,10 @@ int main()
     bool afficherItineraire = true;
     const unsigned int nbDeTests = 10; //nombre de tests à effectuer
     long moy_tempsExecution = 0;
+    long moy_tempsExecutionCSA = 0;
+    EspaceRecherche espace; //les tampons de recherche sont réutilisés par toutes les requêtes
+    RouteurCSA::Espace espaceCSA;
+    RouteurRaptor::Espace espaceRaptor;
 
     for (unsigned int i = 0; i < nbDeTests; ++i)
     {
@@ -89,22 +117,57 @@ int main()
         cout << "station du point destination = " << stations.at(stationIdDestination) << endl;
         cout << "distance = " << pointOrigine - pointDestination << " kilomètres" << endl;
 
-        reseau_rtc.ajouterArcsOrigineDestination(donnees_rtc, pointOrigine, pointDestination);
-
         long tempsExecution(0);
-        reseau_rtc.itineraire(donnees_rtc, afficherItineraire, tempsExecution);
+        reseau_rtc.itineraire(donnees_rtc, pointOrigine, pointDestination, afficherItineraire, tempsExecution, espace);
+        const StatistiquesRecherche &stats = espace.getStatistiques();
         moy_tempsExecution += tempsExecution;
         cout << "Temps d'exécution de l'algorithme de plus court chemin: " << tempsExecution
              << " microsecondes" << endl;
-
-        reseau_rtc.enleverArcsOrigineDestination();
-
+        cout << "Sommets fixés: " << stats.nbSommetsFixes << " / " << reseau_rtc.getNbSommets()
+             << " (extractions: " << stats.nbExtractions << ", périmées: " << stats.nbEntreesPerimees
+             << ", relaxations: " << stats.nbRelaxations << ")" << endl;
+
+        long tempsExecutionCSA(0);
+        routeur_csa.itineraire(donnees_rtc, pointOrigine, pointDestination, false, tempsExecutionCSA, espaceCSA);
+        moy_tempsExecutionCSA += tempsExecutionCSA;
+        cout << "Temps d'exécution du balayage de connexions (CSA): " << tempsExecutionCSA << " microsecondes" << endl;
+
+        long tempsExecutionRaptor(0);
+        vector<TrajetRaptor> trajets;
+        routeur_raptor.itineraires(donnees_rtc, pointOrigine, pointDestination, trajets, tempsExecutionRaptor,
+                                   espaceRaptor);
+        cout << "Temps d'exécution de RAPTOR: " << tempsExecutionRaptor << " microsecondes" << endl;
+        routeur_raptor.afficherItineraires(donnees_rtc, trajets, false);
     }
 
     cout << endl << "La moyenne du temps d'exécution sur " << nbDeTests << " itinéraires est de "
          << (double)moy_tempsExecution / (double)nbDeTests << " microsecondes" << endl;
+    cout << "La moyenne du temps d'exécution du CSA sur " << nbDeTests << " itinéraires est de "
+         << (double)moy_tempsExecutionCSA / (double)nbDeTests << " microsecondes" << endl;
+
+    //requêtes simultanées sur le même réseau, avec des heures de départ dans les quatre heures qui suivent now1
+    const unsigned int nbRequetes = 500;
+    std::uniform_int_distribution<unsigned int> distributionDepart(0, 4 * 3600);
+    vector<RequeteItineraire> requetes;
+    for (unsigned int i = 0; i < nbRequetes; ++i)
+    {
+        Coordonnees origine = stations.at(station_ids.at(distribution(generator))).getCoords();
+        Coordonnees destination = stations.at(station_ids.at(distribution(generator))).getCoords();
+        requetes.push_back({origine, destination, TableArrets::enSecondes(now1) + distributionDepart(generator)});
+    }
+    vector<ReponseItineraire> reponses;
+    ServiceItineraires serviceSequentiel(donnees_rtc, reseau_rtc, 1);
+    serviceSequentiel.repondre(requetes, reponses);
+    ServiceItineraires service(donnees_rtc, reseau_rtc, thread::hardware_concurrency());
+    service.repondre(requetes, reponses);
+    cout << nbRequetes << " requêtes: " << serviceSequentiel.getRequetesParSeconde() << " requêtes/s avec 1 thread, "
+         << service.getRequetesParSeconde() << " requêtes/s avec " << service.getNbThreads() << " threads" << endl;
+
+    //les métriques cumulées par la bibliothèque (chargement, construction et requêtes), dans les deux formats
+    Metriques::globales().ecrire(dossier_sortie + "/metriques.json");
+    Metriques::globales().ecrire(dossier_sortie + "/metriques.prom");
+    cout << "Métriques écrites dans " << dossier_sortie << "/metriques.json et metriques.prom" << endl;
 
     return 0;
 }
 
-
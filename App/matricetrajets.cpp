@@ -0,0 +1,109 @@
+//
+//  matricetrajets.cpp
+//  Matrice des durées de trajet entre des points origine et des points destination
+//
+
+#include "matricetrajets.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+using namespace std;
+
+const unsigned int MatriceTrajets::inatteignable;
+const uint32_t MatriceTrajets::version;
+
+namespace
+{
+    const char marqueMatrice[8] = {'R', 'T', 'C', 'M', 'A', 'T', 'R', '\0'};
+    const uint32_t boutismeMachine = 0x01020304;
+}
+
+MatriceTrajets::MatriceTrajets() : m_nbOrigines(0), m_nbDestinations(0)
+{
+}
+
+//! \brief construit une matrice dont toutes les durées sont inatteignable
+MatriceTrajets::MatriceTrajets(size_t p_nbOrigines, size_t p_nbDestinations)
+        : m_nbOrigines(p_nbOrigines), m_nbDestinations(p_nbDestinations),
+          m_temps(p_nbOrigines * p_nbDestinations, inatteignable)
+{
+}
+
+size_t MatriceTrajets::getNbOrigines() const
+{
+    return m_nbOrigines;
+}
+
+size_t MatriceTrajets::getNbDestinations() const
+{
+    return m_nbDestinations;
+}
+
+//! \brief écrit la matrice en CSV: l'en-tête "origine,0,1,..." puis une ligne par origine
+//! \throws logic_error si le fichier ne peut pas être écrit
+void MatriceTrajets::ecrireCSV(const std::string &p_nomFichier) const
+{
+    ofstream fichier(p_nomFichier, ios::trunc);
+    if (!fichier.is_open())
+        throw logic_error("MatriceTrajets::ecrireCSV(): le fichier " + p_nomFichier + " n'a pas pu ouvrir");
+    fichier << "origine";
+    for (size_t d = 0; d < m_nbDestinations; ++d) fichier << ',' << d;
+    fichier << '\n';
+    for (size_t o = 0; o < m_nbOrigines; ++o)
+    {
+        fichier << o;
+        for (size_t d = 0; d < m_nbDestinations; ++d)
+        {
+            fichier << ',';
+            unsigned int temps = getTempsDuTrajet(o, d);
+            if (temps != inatteignable) fichier << temps;
+        }
+        fichier << '\n';
+    }
+    if (!fichier)
+        throw logic_error("MatriceTrajets::ecrireCSV(): l'écriture de " + p_nomFichier + " a échoué");
+}
+
+//! \brief écrit la matrice en binaire
+//! \throws logic_error si le fichier ne peut pas être écrit
+void MatriceTrajets::ecrireBinaire(const std::string &p_nomFichier) const
+{
+    static_assert(sizeof(unsigned int) == sizeof(uint32_t), "les durées sont écrites directement en uint32_t");
+    EnTete entete;
+    memset(&entete, 0, sizeof(entete));
+    memcpy(entete.marque, marqueMatrice, sizeof(entete.marque));
+    entete.version = version;
+    entete.boutisme = boutismeMachine;
+    entete.nbOrigines = m_nbOrigines;
+    entete.nbDestinations = m_nbDestinations;
+
+    ofstream fichier(p_nomFichier, ios::binary | ios::trunc);
+    if (!fichier.is_open())
+        throw logic_error("MatriceTrajets::ecrireBinaire(): le fichier " + p_nomFichier + " n'a pas pu ouvrir");
+    fichier.write(reinterpret_cast<const char *>(&entete), sizeof(entete));
+    fichier.write(reinterpret_cast<const char *>(m_temps.data()), m_temps.size() * sizeof(unsigned int));
+    if (!fichier)
+        throw logic_error("MatriceTrajets::ecrireBinaire(): l'écriture de " + p_nomFichier + " a échoué");
+}
+
+//! \brief lit une matrice écrite par ecrireBinaire()
+//! \throws logic_error si le fichier ne peut pas être lu ou n'est pas une matrice de cette version et de ce boutisme
+MatriceTrajets MatriceTrajets::lireBinaire(const std::string &p_nomFichier)
+{
+    ifstream fichier(p_nomFichier, ios::binary);
+    if (!fichier.is_open())
+        throw logic_error("MatriceTrajets::lireBinaire(): le fichier " + p_nomFichier + " n'a pas pu ouvrir");
+    EnTete entete;
+    if (!fichier.read(reinterpret_cast<char *>(&entete), sizeof(entete)) ||
+        memcmp(entete.marque, marqueMatrice, sizeof(entete.marque)) != 0)
+        throw logic_error("MatriceTrajets::lireBinaire(): " + p_nomFichier + " n'est pas une matrice de trajets");
+    if (entete.version != version || entete.boutisme != boutismeMachine)
+        throw logic_error("MatriceTrajets::lireBinaire(): version ou boutisme incompatible");
+
+    MatriceTrajets matrice((size_t) entete.nbOrigines, (size_t) entete.nbDestinations);
+    if (!fichier.read(reinterpret_cast<char *>(matrice.m_temps.data()), matrice.m_temps.size() * sizeof(unsigned int)))
+        throw logic_error("MatriceTrajets::lireBinaire(): " + p_nomFichier + " est tronqué");
+    return matrice;
+}
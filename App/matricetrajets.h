@@ -0,0 +1,59 @@
+//
+//  matricetrajets.h
+//  Matrice des durées de trajet entre des points origine et des points destination
+//
+
+#ifndef MATRICETRAJETS_H
+#define MATRICETRAJETS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <climits>
+
+//! \brief  Durées de trajet (en secondes) de chaque point origine vers chaque point destination, rangées par origine
+//! \brief  Une durée vaut inatteignable si la destination ne peut pas être atteinte de l'origine.
+//! \brief  La matrice s'écrit en CSV (une ligne par origine, case vide si inatteignable) ou en binaire: un en-tête
+//! \brief  (marque, version, boutisme, dimensions) suivi des durées en uint32_t, origine par origine.
+class MatriceTrajets
+{
+public:
+
+    static const unsigned int inatteignable = UINT_MAX;
+    static const uint32_t version = 1; /*!< à incrémenter à chaque changement du format binaire */
+
+    MatriceTrajets();
+    MatriceTrajets(size_t p_nbOrigines, size_t p_nbDestinations);
+
+    size_t getNbOrigines() const;
+    size_t getNbDestinations() const;
+
+    //! \brief la durée du trajet de l'origine p_origine à la destination p_destination
+    unsigned int getTempsDuTrajet(size_t p_origine, size_t p_destination) const
+    {
+        return m_temps[p_origine * m_nbDestinations + p_destination];
+    }
+    //! \brief les durées de l'origine p_origine vers chaque destination
+    unsigned int *getLigne(size_t p_origine) { return m_temps.data() + p_origine * m_nbDestinations; }
+
+    void ecrireCSV(const std::string &p_nomFichier) const;
+    void ecrireBinaire(const std::string &p_nomFichier) const;
+    static MatriceTrajets lireBinaire(const std::string &p_nomFichier);
+
+private:
+
+    struct EnTete
+    {
+        char marque[8];
+        uint32_t version;
+        uint32_t boutisme; /*!< 0x01020304 écrit dans l'ordre de la machine qui a produit le fichier */
+        uint64_t nbOrigines;
+        uint64_t nbDestinations;
+    };
+
+    size_t m_nbOrigines;
+    size_t m_nbDestinations;
+    std::vector<unsigned int> m_temps;
+};
+
+#endif //MATRICETRAJETS_H
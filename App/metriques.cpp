@@ -0,0 +1,338 @@
+//
+//  metriques.cpp
+//  Compteurs et histogrammes toujours actifs, exportables en JSON ou au format texte de Prometheus
+//
+
+#include "metriques.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+namespace
+{
+    //! \brief un réel en texte, sans zéros superflus (assez de chiffres pour distinguer les seuils)
+    string enTexte(double p_valeur)
+    {
+        if (std::isinf(p_valeur)) return p_valeur > 0 ? "+Inf" : "-Inf";
+        ostringstream texte;
+        texte.precision(12);
+        texte << p_valeur;
+        return texte.str();
+    }
+
+    //! \brief p_texte échappé pour une chaîne JSON ou une valeur d'étiquette Prometheus (mêmes règles pour ces caractères);
+    //! \brief les guillemets ne sont pas échappés si p_guillemets est faux (texte d'aide de Prometheus)
+    string echapper(const string &p_texte, bool p_guillemets = true)
+    {
+        string resultat;
+        for (char c : p_texte)
+        {
+            if (c == '\\') resultat += "\\\\";
+            else if (c == '"' && p_guillemets) resultat += "\\\"";
+            else if (c == '\n') resultat += "\\n";
+            else resultat += c;
+        }
+        return resultat;
+    }
+
+    //! \brief vrai si p_nom est un nom de métrique ou d'étiquette valide pour Prometheus ([a-zA-Z_][a-zA-Z0-9_]*)
+    bool estNomValide(const string &p_nom)
+    {
+        if (p_nom.empty() || isdigit((unsigned char) p_nom[0])) return false;
+        for (char c : p_nom)
+            if (!isalnum((unsigned char) c) && c != '_') return false;
+        return true;
+    }
+
+    //! \brief les étiquettes au format Prometheus, avec p_supplementaire (déjà formatée) à la fin: {a="x",le="0.5"}
+    string etiquettesPrometheus(const Metriques::Etiquettes &p_etiquettes, const string &p_supplementaire = "")
+    {
+        if (p_etiquettes.empty() && p_supplementaire.empty()) return "";
+        string resultat = "{";
+        for (const auto &e : p_etiquettes)
+        {
+            if (resultat.size() > 1) resultat += ",";
+            resultat += e.first + "=\"" + echapper(e.second) + "\"";
+        }
+        if (!p_supplementaire.empty())
+        {
+            if (resultat.size() > 1) resultat += ",";
+            resultat += p_supplementaire;
+        }
+        return resultat + "}";
+    }
+}
+
+//! \brief Constructeur: le compteur est à zéro
+Compteur::Compteur() : m_valeur(0)
+{
+}
+
+uint64_t Compteur::getValeur() const
+{
+    return m_valeur.load(memory_order_relaxed);
+}
+
+//! \brief Constructeur
+//! \param[in] p_seuils: les bornes supérieures des cases, strictement croissantes
+//! \throws logic_error si les seuils ne sont pas strictement croissants
+Histogramme::Histogramme(const std::vector<double> &p_seuils)
+        : m_seuils(p_seuils), m_comptes(new atomic<uint64_t>[p_seuils.size() + 1]), m_nbObservations(0), m_somme(0)
+{
+    for (size_t i = 1; i < m_seuils.size(); ++i)
+        if (!(m_seuils[i - 1] < m_seuils[i]))
+            throw logic_error("Histogramme::Histogramme(): les seuils doivent être strictement croissants");
+    for (size_t i = 0; i <= m_seuils.size(); ++i) m_comptes[i].store(0, memory_order_relaxed);
+}
+
+//! \brief ajoute l'observation p_valeur
+void Histogramme::observer(double p_valeur)
+{
+    size_t c = lower_bound(m_seuils.begin(), m_seuils.end(), p_valeur) - m_seuils.begin();
+    m_comptes[c].fetch_add(1, memory_order_relaxed);
+    m_nbObservations.fetch_add(1, memory_order_relaxed);
+    double somme = m_somme.load(memory_order_relaxed);
+    while (!m_somme.compare_exchange_weak(somme, somme + p_valeur, memory_order_relaxed));
+}
+
+const std::vector<double> &Histogramme::getSeuils() const
+{
+    return m_seuils;
+}
+
+//! \brief le nombre d'observations de la case p_case (non cumulé); la case getSeuils().size() est celle au-delà du
+//! \brief plus grand seuil
+uint64_t Histogramme::getCompte(size_t p_case) const
+{
+    return m_comptes[p_case].load(memory_order_relaxed);
+}
+
+uint64_t Histogramme::getNbObservations() const
+{
+    return m_nbObservations.load(memory_order_relaxed);
+}
+
+double Histogramme::getSomme() const
+{
+    return m_somme.load(memory_order_relaxed);
+}
+
+//! \brief p_nombre seuils p_premier, p_premier * p_facteur, p_premier * p_facteur^2, ...
+std::vector<double> Histogramme::seuilsGeometriques(double p_premier, double p_facteur, size_t p_nombre)
+{
+    vector<double> seuils;
+    for (size_t i = 0; i < p_nombre; ++i) seuils.push_back(p_premier * pow(p_facteur, (double) i));
+    return seuils;
+}
+
+//! \brief les seuils des durées, en secondes: de 1 microseconde à environ 17 secondes, en doublant
+const std::vector<double> &Histogramme::seuilsDurees()
+{
+    static const vector<double> seuils = seuilsGeometriques(1e-6, 2, 25);
+    return seuils;
+}
+
+//! \brief les seuils des tailles (sommets, arcs, ...): de 1 à environ 67 millions, en doublant
+const std::vector<double> &Histogramme::seuilsTailles()
+{
+    static const vector<double> seuils = seuilsGeometriques(1, 2, 27);
+    return seuils;
+}
+
+//! \brief Constructeur: la mesure commence
+Chronometre::Chronometre(Histogramme &p_histogramme)
+        : m_histogramme(&p_histogramme), m_debut(chrono::steady_clock::now())
+{
+}
+
+//! \brief Destructeur: observe la durée si arreter() n'a pas été appelée
+Chronometre::~Chronometre()
+{
+    arreter();
+}
+
+//! \brief observe la durée écoulée depuis la construction (seulement au premier appel)
+//! \return la durée, en secondes
+double Chronometre::arreter()
+{
+    double duree = chrono::duration<double>(chrono::steady_clock::now() - m_debut).count();
+    if (m_histogramme)
+    {
+        m_histogramme->observer(duree);
+        m_histogramme = nullptr;
+    }
+    return duree;
+}
+
+//! \brief Constructeur d'un registre vide
+Metriques::Metriques()
+{
+}
+
+//! \brief le registre du processus, dans lequel la bibliothèque enregistre ses métriques
+Metriques &Metriques::globales()
+{
+    static Metriques registre;
+    return registre;
+}
+
+//! \brief le compteur p_nom{p_etiquettes}, créé à zéro au premier appel
+//! \param[in] p_aide: la description de la métrique (celle du premier enregistrement du nom est gardée)
+//! \throws logic_error si un nom est invalide ou si p_nom{p_etiquettes} est déjà un histogramme
+Compteur &Metriques::compteur(const std::string &p_nom, const std::string &p_aide, const Etiquettes &p_etiquettes)
+{
+    lock_guard<mutex> verrou(m_verrou);
+    Serie &serie = enregistrer(p_nom, p_aide, p_etiquettes, false);
+    if (!serie.compteur) serie.compteur.reset(new Compteur());
+    return *serie.compteur;
+}
+
+//! \brief l'histogramme p_nom{p_etiquettes}, créé vide avec p_seuils au premier appel
+//! \param[in] p_aide: la description de la métrique (celle du premier enregistrement du nom est gardée)
+//! \throws logic_error si un nom est invalide ou si p_nom{p_etiquettes} est déjà un compteur
+Histogramme &Metriques::histogramme(const std::string &p_nom, const std::string &p_aide,
+                                    const std::vector<double> &p_seuils, const Etiquettes &p_etiquettes)
+{
+    lock_guard<mutex> verrou(m_verrou);
+    Serie &serie = enregistrer(p_nom, p_aide, p_etiquettes, true);
+    if (!serie.histogramme)
+    {
+        try
+        {
+            serie.histogramme.reset(new Histogramme(p_seuils));
+        }
+        catch (...) //une série sans compteur ni histogramme ne doit pas rester dans le registre
+        {
+            m_series.erase(make_pair(p_nom, p_etiquettes));
+            throw;
+        }
+    }
+    return *serie.histogramme;
+}
+
+//! \brief la série p_nom{p_etiquettes}, ajoutée au besoin (m_verrou doit être verrouillé)
+//! \throws logic_error si un nom est invalide ou si le nom est déjà enregistré avec l'autre type
+Metriques::Serie &Metriques::enregistrer(const std::string &p_nom, const std::string &p_aide,
+                                         const Etiquettes &p_etiquettes, bool p_histogramme)
+{
+    if (!estNomValide(p_nom)) throw logic_error("Metriques: nom de métrique invalide: " + p_nom);
+    for (const auto &e : p_etiquettes)
+        if (!estNomValide(e.first) || e.first == "le")
+            throw logic_error("Metriques: nom d'étiquette invalide pour " + p_nom + ": " + e.first);
+
+    //toutes les séries d'un nom sont du même type et partagent la même aide
+    auto premiere = m_series.lower_bound(make_pair(p_nom, Etiquettes()));
+    string aide = p_aide;
+    if (premiere != m_series.end() && premiere->first.first == p_nom)
+    {
+        if ((bool) premiere->second.histogramme != p_histogramme)
+            throw logic_error("Metriques: " + p_nom + " est déjà enregistrée avec un autre type");
+        aide = premiere->second.aide;
+    }
+    Serie &serie = m_series[make_pair(p_nom, p_etiquettes)];
+    serie.aide = aide;
+    return serie;
+}
+
+//! \brief écrit toutes les séries en JSON: un tableau d'objets {nom, type, aide, etiquettes, ...}
+//! \brief Un compteur a une valeur; un histogramme a le nombre d'observations, leur somme et ses cases cumulées
+//! \brief [{le, compte}], la dernière ayant "+Inf" pour borne.
+void Metriques::exporterJSON(std::ostream &p_sortie) const
+{
+    lock_guard<mutex> verrou(m_verrou);
+    p_sortie << "[";
+    const char *separateur = "\n";
+    for (const auto &s : m_series)
+    {
+        p_sortie << separateur << "  {\"nom\": \"" << s.first.first << "\", \"type\": \""
+                 << (s.second.histogramme ? "histogramme" : "compteur") << "\", \"aide\": \""
+                 << echapper(s.second.aide) << "\", \"etiquettes\": {";
+        for (size_t i = 0; i < s.first.second.size(); ++i)
+            p_sortie << (i ? ", " : "") << "\"" << s.first.second[i].first << "\": \""
+                     << echapper(s.first.second[i].second) << "\"";
+        p_sortie << "}";
+        if (s.second.compteur) p_sortie << ", \"valeur\": " << s.second.compteur->getValeur();
+        else
+        {
+            const Histogramme &h = *s.second.histogramme;
+            p_sortie << ", \"nbObservations\": " << h.getNbObservations() << ", \"somme\": "
+                     << enTexte(h.getSomme()) << ", \"cases\": [";
+            uint64_t cumul = 0;
+            for (size_t c = 0; c <= h.getSeuils().size(); ++c)
+            {
+                cumul += h.getCompte(c);
+                p_sortie << (c ? ", " : "") << "{\"le\": ";
+                if (c < h.getSeuils().size()) p_sortie << enTexte(h.getSeuils()[c]);
+                else p_sortie << "\"+Inf\"";
+                p_sortie << ", \"compte\": " << cumul << "}";
+            }
+            p_sortie << "]";
+        }
+        p_sortie << "}";
+        separateur = ",\n";
+    }
+    p_sortie << "\n]\n";
+}
+
+//! \brief écrit toutes les séries au format d'exposition texte de Prometheus (version 0.0.4)
+void Metriques::exporterPrometheus(std::ostream &p_sortie) const
+{
+    lock_guard<mutex> verrou(m_verrou);
+    const string *nomPrecedent = nullptr;
+    for (const auto &s : m_series)
+    {
+        const string &nom = s.first.first;
+        if (!nomPrecedent || *nomPrecedent != nom)
+        {
+            p_sortie << "# HELP " << nom << " " << echapper(s.second.aide, false) << "\n";
+            p_sortie << "# TYPE " << nom << " " << (s.second.histogramme ? "histogram" : "counter") << "\n";
+            nomPrecedent = &nom;
+        }
+        if (s.second.compteur)
+        {
+            p_sortie << nom << etiquettesPrometheus(s.first.second) << " " << s.second.compteur->getValeur() << "\n";
+            continue;
+        }
+        const Histogramme &h = *s.second.histogramme;
+        uint64_t cumul = 0;
+        for (size_t c = 0; c <= h.getSeuils().size(); ++c)
+        {
+            cumul += h.getCompte(c);
+            string le = c < h.getSeuils().size() ? enTexte(h.getSeuils()[c]) : "+Inf";
+            p_sortie << nom << "_bucket" << etiquettesPrometheus(s.first.second, "le=\"" + le + "\"") << " " << cumul
+                     << "\n";
+        }
+        p_sortie << nom << "_sum" << etiquettesPrometheus(s.first.second) << " " << enTexte(h.getSomme()) << "\n";
+        p_sortie << nom << "_count" << etiquettesPrometheus(s.first.second) << " " << h.getNbObservations() << "\n";
+    }
+}
+
+//! \brief écrit toutes les séries dans le fichier p_nomFichier: en JSON si son nom se termine par .json, au format de
+//! \brief Prometheus sinon. Le fichier est écrit sous un nom temporaire puis renommé, pour qu'un lecteur (par exemple
+//! \brief le collecteur de fichiers texte de node_exporter) ne le voie jamais à moitié écrit.
+//! \throws logic_error si le fichier ne peut être écrit
+void Metriques::ecrire(const std::string &p_nomFichier) const
+{
+    const string temporaire = p_nomFichier + ".tmp";
+    {
+        ofstream fichier(temporaire);
+        if (!fichier) throw logic_error("Metriques::ecrire(): impossible d'ouvrir " + temporaire);
+        const string extension = ".json";
+        if (p_nomFichier.size() >= extension.size() &&
+            p_nomFichier.compare(p_nomFichier.size() - extension.size(), extension.size(), extension) == 0)
+            exporterJSON(fichier);
+        else
+            exporterPrometheus(fichier);
+        fichier.close();
+        if (!fichier) throw logic_error("Metriques::ecrire(): erreur d'écriture dans " + temporaire);
+    }
+    if (rename(temporaire.c_str(), p_nomFichier.c_str()) != 0)
+        throw logic_error("Metriques::ecrire(): impossible de renommer " + temporaire + " en " + p_nomFichier);
+}
@@ -0,0 +1,134 @@
+//
+//  metriques.h
+//  Compteurs et histogrammes toujours actifs, exportables en JSON ou au format texte de Prometheus
+//
+
+#ifndef METRIQUES_H
+#define METRIQUES_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+//! \brief  Compteur monotone, incrémenté sans verrou par plusieurs threads
+class Compteur
+{
+public:
+
+    Compteur();
+
+    //! \brief ajoute p_n au compteur
+    void ajouter(uint64_t p_n = 1)
+    {
+        m_valeur.fetch_add(p_n, std::memory_order_relaxed);
+    }
+
+    uint64_t getValeur() const;
+
+private:
+
+    Compteur(const Compteur &);
+    Compteur &operator=(const Compteur &);
+
+    std::atomic<uint64_t> m_valeur;
+};
+
+//! \brief  Histogramme à seuils fixes, alimenté sans verrou par plusieurs threads
+//! \brief  La case i compte les observations v telles que seuil[i - 1] < v <= seuil[i]; la dernière case, au-delà du
+//! \brief  plus grand seuil, compte les autres. Les cases sont cumulées à l'exportation, comme le fait Prometheus.
+class Histogramme
+{
+public:
+
+    explicit Histogramme(const std::vector<double> &);
+    void observer(double);
+
+    const std::vector<double> &getSeuils() const;
+    uint64_t getCompte(size_t) const;
+    uint64_t getNbObservations() const;
+    double getSomme() const;
+
+    static std::vector<double> seuilsGeometriques(double, double, size_t);
+    static const std::vector<double> &seuilsDurees();
+    static const std::vector<double> &seuilsTailles();
+
+private:
+
+    Histogramme(const Histogramme &);
+    Histogramme &operator=(const Histogramme &);
+
+    std::vector<double> m_seuils; //croissants
+    std::unique_ptr<std::atomic<uint64_t>[]> m_comptes; //m_seuils.size() + 1 cases
+    std::atomic<uint64_t> m_nbObservations;
+    std::atomic<double> m_somme;
+};
+
+//! \brief  Mesure, à l'horloge monotone, la durée d'une portée et l'ajoute en secondes à un histogramme
+//! \brief  La durée est observée à l'appel d'arreter() ou, à défaut, à la destruction (même sur une exception).
+class Chronometre
+{
+public:
+
+    explicit Chronometre(Histogramme &);
+    ~Chronometre();
+    double arreter();
+
+private:
+
+    Chronometre(const Chronometre &);
+    Chronometre &operator=(const Chronometre &);
+
+    Histogramme *m_histogramme; //nullptr une fois la durée observée
+    std::chrono::steady_clock::time_point m_debut;
+};
+
+//! \brief  Registre des compteurs et histogrammes d'un processus
+//! \brief  Une série est identifiée par son nom et ses étiquettes (par exemple {"phase", "transferts"}); la demander
+//! \brief  à nouveau retourne la même. Les références retournées restent valides tant que le registre existe: le
+//! \brief  code chaud les obtient une fois (par exemple dans une variable locale statique) et ne fait ensuite que des
+//! \brief  opérations atomiques, sans verrou. Seuls l'enregistrement et l'exportation prennent le verrou du registre.
+class Metriques
+{
+public:
+
+    typedef std::vector<std::pair<std::string, std::string> > Etiquettes;
+
+    Metriques();
+    static Metriques &globales();
+
+    Compteur &compteur(const std::string &, const std::string &, const Etiquettes & = Etiquettes());
+    Histogramme &histogramme(const std::string &, const std::string &, const std::vector<double> &,
+                             const Etiquettes & = Etiquettes());
+
+    void exporterJSON(std::ostream &) const;
+    void exporterPrometheus(std::ostream &) const;
+    void ecrire(const std::string &) const;
+
+private:
+
+    Metriques(const Metriques &);
+    Metriques &operator=(const Metriques &);
+
+    struct Serie
+    {
+        std::string aide;
+        std::unique_ptr<Compteur> compteur; //exactement un des deux est non nul
+        std::unique_ptr<Histogramme> histogramme;
+    };
+
+    typedef std::map<std::pair<std::string, Etiquettes>, Serie> Series;
+
+    Serie &enregistrer(const std::string &, const std::string &, const Etiquettes &, bool);
+
+    mutable std::mutex m_verrou;
+    Series m_series; //triées par nom, ce qui regroupe les séries d'une même métrique à l'exportation
+};
+
+#endif //METRIQUES_H
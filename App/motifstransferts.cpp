@@ -0,0 +1,534 @@
+//
+//  motifstransferts.cpp
+//  Motifs de trajets précalculés (transfer patterns) pour les requêtes de station à station
+//
+
+#include "motifstransferts.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+using namespace std;
+
+const unsigned int MotifsTransferts::infini;
+const uint32_t MotifsTransferts::version;
+const uint32_t MotifsTransferts::aucun;
+const uint32_t MotifsTransferts::marche;
+
+namespace
+{
+    const char marqueMotifs[8] = {'R', 'T', 'C', 'M', 'O', 'T', 'I', '\0'};
+    const uint32_t boutismeMachine = 0x01020304;
+
+    //! \brief ajoute p_taille octets à une empreinte FNV-1a de 64 bits
+    void hacher(uint64_t &p_empreinte, const void *p_debut, size_t p_taille)
+    {
+        const unsigned char *octets = static_cast<const unsigned char *>(p_debut);
+        for (size_t i = 0; i < p_taille; ++i)
+        {
+            p_empreinte ^= octets[i];
+            p_empreinte *= 1099511628211ULL;
+        }
+    }
+}
+
+struct MotifsTransferts::Travail
+{
+    //! \brief l'étiquette d'un arrêt pour l'origine courante
+    //! \brief Un arrêt atteint en autobus garde le noeud où le motif est monté à bord; un arrêt atteint autrement garde
+    //! \brief le noeud de sa station. La clé 2 * (nombre d'étapes) + (1 si pas à bord) ordonne la visite: à nombre
+    //! \brief d'étapes égal, être encore à bord permet de continuer sans ajouter d'étape.
+    struct Etiquette
+    {
+        uint32_t generation; /*!< l'étiquette n'a de sens que si elle vaut celle de l'origine courante */
+        uint32_t cle;
+        uint32_t noeud;
+        bool surVoyage;
+        bool fixe;
+    };
+
+    Travail() : generation(0) {}
+
+    vector<Etiquette> etiquettes;
+    uint32_t generation;
+    vector<Noeud> arbre;
+    unordered_map<uint64_t, uint32_t> enfants; //(parent, station et bit marche) vers le noeud
+    vector<unsigned int> meilleurRang; //le plus petit rang atteint de chaque station
+    vector<uint32_t> meilleurNoeud; //le noeud du motif qui l'atteint
+    vector<unsigned int> departAmelioration; //le dernier départ qui a diminué le rang de chaque station
+    vector<unsigned int> ameliorees; //les stations dont le rang a diminué au départ courant
+    vector<vector<size_t> > seaux; //file de priorité à clés entières et petites
+    vector<Cible> cibles;
+};
+
+//! \brief prépare les heures d'arrivée des stations du réseau; les motifs sont calculés ou lus ensuite
+//! \throws logic_error si un arrêt suit, dans sa station, un arrêt du même voyage: le réseau ne lui donne pas d'arc
+//! \throws d'attente, alors que les motifs supposent qu'on peut prendre à une station tout arrêt de rang supérieur ou
+//! \throws égal à celui où l'on se trouve (ils donneraient des durées fausses)
+MotifsTransferts::MotifsTransferts(const ReseauGTFS &p_reseau) : m_signature(signature(p_reseau))
+{
+    const TableArrets &table = p_reseau.getTable();
+    m_debutStation.assign(table.getNbStations() + 1, 0);
+    for (unsigned int s = 0; s < table.getNbStations(); ++s)
+    {
+        for (unsigned int rang = 0; rang < table.getNbArretsStation(s); ++rang)
+        {
+            if (rang > 0 && table.getVoyage(table.getArretStation(s, rang)) ==
+                            table.getVoyage(table.getArretStation(s, rang - 1)))
+                throw logic_error("MotifsTransferts::MotifsTransferts(): la station " +
+                                  to_string(table.getStationId(s)) + " a deux arrêts consécutifs du même voyage");
+            m_arrivees.push_back(table.getArriveeStation(s, rang));
+        }
+        m_debutStation[s + 1] = m_arrivees.size();
+    }
+}
+
+//! \brief calcule les motifs optimaux des stations p_origines vers toutes les stations du réseau
+//! \param[in] p_reseau: le réseau; les motifs ne valent que pour lui (mêmes arrêts, mêmes heures)
+//! \param[in] p_origines: les stations origine (indices de TableArrets), dans n'importe quel ordre
+//! \param[in] p_nbThreads: le nombre de threads entre lesquels répartir les origines
+//! \throws logic_error si p_nbThreads est nul, si une origine n'est pas une station du réseau ou si une station a deux
+//! \throws arrêts consécutifs du même voyage (voir MotifsTransferts(const ReseauGTFS &))
+MotifsTransferts::MotifsTransferts(const ReseauGTFS &p_reseau, const std::vector<unsigned int> &p_origines,
+                                   unsigned int p_nbThreads) : MotifsTransferts(p_reseau)
+{
+    const unsigned int nbStations = p_reseau.getTable().getNbStations();
+    if (p_nbThreads == 0)
+        throw logic_error("MotifsTransferts::MotifsTransferts(): il faut au moins un thread");
+    vector<unsigned int> origines(p_origines);
+    sort(origines.begin(), origines.end());
+    origines.erase(unique(origines.begin(), origines.end()), origines.end());
+    if (!origines.empty() && origines.back() >= nbStations)
+        throw logic_error("MotifsTransferts::MotifsTransferts(): une origine n'est pas une station du réseau");
+
+    vector<vector<Noeud> > noeuds(nbStations);
+    vector<vector<Cible> > cibles(nbStations);
+    atomic<size_t> prochaine(0);
+    vector<exception_ptr> erreurs(p_nbThreads);
+    auto travailler = [this, &p_reseau, &origines, &noeuds, &cibles, &prochaine, &erreurs](unsigned int p_thread)
+    {
+        try
+        {
+            Travail travail;
+            for (size_t i = prochaine++; i < origines.size(); i = prochaine++)
+                calculerOrigine(p_reseau, origines[i], travail, noeuds[origines[i]], cibles[origines[i]]);
+        }
+        catch (...) //l'erreur est relancée par le thread principal
+        {
+            erreurs[p_thread] = current_exception();
+            prochaine = origines.size();
+        }
+    };
+    vector<thread> threads;
+    for (unsigned int t = 1; t < p_nbThreads; ++t) threads.push_back(thread(travailler, t));
+    travailler(0);
+    for (thread &t : threads) t.join();
+    for (const exception_ptr &erreur : erreurs)
+        if (erreur) rethrow_exception(erreur);
+
+    m_debutNoeuds.assign(nbStations + 1, 0);
+    m_debutCibles.assign(nbStations + 1, 0);
+    for (unsigned int s = 0; s < nbStations; ++s)
+    {
+        m_noeuds.insert(m_noeuds.end(), noeuds[s].begin(), noeuds[s].end());
+        m_cibles.insert(m_cibles.end(), cibles[s].begin(), cibles[s].end());
+        m_debutNoeuds[s + 1] = m_noeuds.size();
+        m_debutCibles[s + 1] = m_cibles.size();
+        vector<Noeud>().swap(noeuds[s]);
+        vector<Cible>().swap(cibles[s]);
+    }
+    preparerEtapes(p_reseau);
+}
+
+//! \brief calcule l'arbre des motifs de la station p_origine
+//! \brief Les départs de l'origine sont parcourus du dernier au premier. Chaque départ visite, par nombre d'étapes
+//! \brief croissant, les arrêts qu'aucun départ plus tardif n'atteint; à la fin du départ, chaque station dont le plus
+//! \brief petit rang atteint a diminué reçoit le motif qui l'atteint à ce rang.
+//! \param[out] p_noeuds: l'arbre, réduit aux préfixes des motifs; sa racine (l'origine) est le noeud 0
+//! \param[out] p_cibles: les motifs, triés par station
+void MotifsTransferts::calculerOrigine(const ReseauGTFS &p_reseau, unsigned int p_origine, Travail &p_travail,
+                                       std::vector<Noeud> &p_noeuds, std::vector<Cible> &p_cibles) const
+{
+    const TableArrets &table = p_reseau.getTable();
+    const size_t *debutArcs = p_reseau.getGraphe().getDebutArcsFiges();
+    const Graphe::ArcFige *arcs = p_reseau.getGraphe().getArcsFiges();
+    Travail &t = p_travail;
+    if (t.etiquettes.size() != table.getNbArrets())
+    {
+        t.etiquettes.assign(table.getNbArrets(), Travail::Etiquette());
+        for (Travail::Etiquette &e : t.etiquettes) e.generation = 0;
+        t.generation = 0;
+    }
+    const uint32_t generation = ++t.generation;
+    t.arbre.assign(1, {aucun, p_origine});
+    t.enfants.clear();
+    t.meilleurRang.assign(table.getNbStations(), UINT_MAX);
+    t.meilleurNoeud.assign(table.getNbStations(), aucun);
+    t.departAmelioration.assign(table.getNbStations(), UINT_MAX);
+    t.cibles.clear();
+
+    auto enfant = [&t](uint32_t p_parent, uint32_t p_station)
+    {
+        const uint64_t cle = ((uint64_t) p_parent << 32) | p_station;
+        auto it = t.enfants.find(cle);
+        if (it != t.enfants.end()) return it->second;
+        const uint32_t noeud = (uint32_t) t.arbre.size();
+        t.arbre.push_back({p_parent, p_station});
+        t.enfants.emplace(cle, noeud);
+        return noeud;
+    };
+    auto ameliore = [&t, generation](size_t p_arret, uint32_t p_cle)
+    {
+        const Travail::Etiquette &e = t.etiquettes[p_arret];
+        return e.generation != generation || (!e.fixe && p_cle < e.cle);
+    };
+    auto etiqueter = [&t, generation](size_t p_arret, uint32_t p_cle, uint32_t p_noeud, bool p_surVoyage)
+    {
+        t.etiquettes[p_arret] = {generation, p_cle, p_noeud, p_surVoyage, false};
+        if (p_cle >= t.seaux.size()) t.seaux.resize(p_cle + 1);
+        t.seaux[p_cle].push_back(p_arret);
+    };
+
+    for (unsigned int rangDepart = table.getNbArretsStation(p_origine); rangDepart-- > 0;)
+    {
+        const size_t depart = table.getArretStation(p_origine, rangDepart);
+        if (!ameliore(depart, 1)) continue; //déjà atteint par un départ plus tardif
+        etiqueter(depart, 1, 0, false);
+        for (uint32_t cle = 0; cle < t.seaux.size(); ++cle)
+        {
+            while (!t.seaux[cle].empty())
+            {
+                const size_t arret = t.seaux[cle].back();
+                t.seaux[cle].pop_back();
+                Travail::Etiquette &e = t.etiquettes[arret];
+                if (e.fixe || e.cle != cle) continue;
+                e.fixe = true;
+                const uint32_t noeud = e.noeud;
+                const bool surVoyage = e.surVoyage;
+                const unsigned int station = table.getStation(arret);
+                if (table.getRang(arret) < t.meilleurRang[station])
+                {
+                    if (t.departAmelioration[station] != rangDepart) t.ameliorees.push_back(station);
+                    t.departAmelioration[station] = rangDepart;
+                    t.meilleurRang[station] = table.getRang(arret);
+                    t.meilleurNoeud[station] = surVoyage ? enfant(noeud, station) : noeud;
+                }
+
+                for (size_t k = debutArcs[arret]; k < debutArcs[arret + 1]; ++k)
+                {
+                    const size_t suivant = arcs[k].destination;
+                    if (suivant == arret + 1 && table.getVoyage(suivant) == table.getVoyage(arret))
+                    {
+                        //en autobus: on reste à bord ou on y monte (une étape de plus)
+                        const uint32_t c = surVoyage ? cle : cle + 1;
+                        if (ameliore(suivant, c)) etiqueter(suivant, c, noeud, true);
+                    }
+                    else if (table.getStation(suivant) == station)
+                    {
+                        //attente: on descend si on était à bord
+                        const uint32_t c = surVoyage ? cle + 1 : cle;
+                        if (ameliore(suivant, c)) etiqueter(suivant, c, surVoyage ? enfant(noeud, station) : noeud, false);
+                    }
+                    else
+                    {
+                        //transfert vers une autre station
+                        const uint32_t c = surVoyage ? cle + 3 : cle + 2;
+                        if (ameliore(suivant, c))
+                            etiqueter(suivant, c, enfant(surVoyage ? enfant(noeud, station) : noeud,
+                                                         table.getStation(suivant) | marche), false);
+                    }
+                }
+            }
+        }
+        for (unsigned int station : t.ameliorees) t.cibles.push_back({station, t.meilleurNoeud[station]});
+        t.ameliorees.clear();
+    }
+
+    sort(t.cibles.begin(), t.cibles.end(), [](const Cible &a, const Cible &b)
+    {
+        return a.station != b.station ? a.station < b.station : a.noeud < b.noeud;
+    });
+    t.cibles.erase(unique(t.cibles.begin(), t.cibles.end(), [](const Cible &a, const Cible &b)
+    {
+        return a.station == b.station && a.noeud == b.noeud;
+    }), t.cibles.end());
+
+    //seuls les préfixes des motifs sont gardés; un parent précède toujours ses enfants
+    vector<uint32_t> nouveau(t.arbre.size(), aucun);
+    nouveau[0] = 0;
+    for (const Cible &cible : t.cibles)
+        for (uint32_t n = cible.noeud; nouveau[n] == aucun; n = t.arbre[n].parent) nouveau[n] = 0;
+    p_noeuds.clear();
+    for (size_t n = 0; n < t.arbre.size(); ++n)
+    {
+        if (nouveau[n] == aucun) continue;
+        nouveau[n] = (uint32_t) p_noeuds.size();
+        p_noeuds.push_back({n == 0 ? aucun : nouveau[t.arbre[n].parent], t.arbre[n].station});
+    }
+    p_cibles.clear();
+    for (const Cible &cible : t.cibles) p_cibles.push_back({cible.station, nouveau[cible.noeud]});
+}
+
+//! \brief prépare l'évaluation des motifs: la durée de chaque étape à pieds et, pour chaque paire de stations reliée
+//! \brief par une étape en autobus, la table de ses liaisons directes (tous les voyages qui passent par la première
+//! \brief station puis par la seconde), triée par rang de départ
+//! \throws logic_error si une étape à pieds n'est pas un transfert du réseau
+void MotifsTransferts::preparerEtapes(const ReseauGTFS &p_reseau)
+{
+    const TableArrets &table = p_reseau.getTable();
+    unordered_map<uint64_t, uint32_t> liaisons;
+    m_etapes.assign(m_noeuds.size(), aucun);
+    for (unsigned int s = 0; s + 1 < m_debutNoeuds.size(); ++s)
+    {
+        const Noeud *arbre = m_noeuds.data() + m_debutNoeuds[s];
+        for (size_t n = 1; n < m_debutNoeuds[s + 1] - m_debutNoeuds[s]; ++n)
+        {
+            const unsigned int depart = arbre[arbre[n].parent].station & ~marche;
+            const unsigned int arrivee = arbre[n].station & ~marche;
+            uint32_t &etape = m_etapes[m_debutNoeuds[s] + n];
+            if (arbre[n].station & marche)
+            {
+                for (size_t k = table.getDebutTransferts(depart); k < table.getDebutTransferts(depart + 1); ++k)
+                    if (table.getTransfert(k).first == arrivee) etape = min(etape, table.getTransfert(k).second);
+                if (etape == aucun)
+                    throw logic_error("MotifsTransferts::preparerEtapes(): une étape à pieds n'est pas un transfert du réseau");
+            }
+            else
+            {
+                etape = liaisons.emplace(((uint64_t) depart << 32) | arrivee, (uint32_t) liaisons.size()).first->second;
+            }
+        }
+    }
+
+    //les paires (liaison, (rang de départ, rang d'arrivée)) de chaque voyage, pour les seules liaisons des motifs
+    vector<pair<uint32_t, pair<unsigned int, unsigned int> > > departs;
+    for (unsigned int v = 0; v < table.getNbVoyages() && !liaisons.empty(); ++v)
+    {
+        for (size_t a = table.getDebutVoyage(v); a < table.getDebutVoyage(v + 1); ++a)
+        {
+            const uint64_t depart = (uint64_t) table.getStation(a) << 32;
+            for (size_t b = a + 1; b < table.getDebutVoyage(v + 1); ++b)
+            {
+                auto liaison = liaisons.find(depart | table.getStation(b));
+                if (liaison != liaisons.end())
+                    departs.push_back(make_pair(liaison->second, make_pair(table.getRang(a), table.getRang(b))));
+            }
+        }
+    }
+    sort(departs.begin(), departs.end());
+
+    m_debutLiaisons.assign(liaisons.size() + 1, 0);
+    m_departs.clear();
+    m_departs.reserve(departs.size());
+    for (const auto &depart : departs)
+    {
+        ++m_debutLiaisons[depart.first + 1];
+        m_departs.push_back(depart.second);
+    }
+    for (size_t l = 0; l < liaisons.size(); ++l)
+    {
+        m_debutLiaisons[l + 1] += m_debutLiaisons[l];
+        //le plus petit rang d'arrivée parmi les départs de rang supérieur ou égal
+        for (size_t k = m_debutLiaisons[l + 1] - 1; k > m_debutLiaisons[l]; --k)
+            m_departs[k - 1].second = min(m_departs[k - 1].second, m_departs[k].second);
+    }
+}
+
+//! \brief le rang du premier arrêt de p_station dont l'heure d'arrivée est p_heure ou plus tard
+unsigned int MotifsTransferts::premierRangApres(unsigned int p_station, unsigned int p_heure) const
+{
+    auto debut = m_arrivees.begin() + m_debutStation[p_station];
+    auto fin = m_arrivees.begin() + m_debutStation[p_station + 1];
+    return (unsigned int) (lower_bound(debut, fin, p_heure) - debut);
+}
+
+//! \brief l'empreinte FNV-1a de 64 bits du graphe de p_reseau et de la station de chacun de ses sommets
+uint64_t MotifsTransferts::signature(const ReseauGTFS &p_reseau)
+{
+    const Graphe &graphe = p_reseau.getGraphe();
+    const TableArrets &table = p_reseau.getTable();
+    uint64_t empreinte = 14695981039346656037ULL;
+    const uint64_t dimensions[2] = {table.getNbStations(), graphe.getNbSommetsFiges()};
+    hacher(empreinte, dimensions, sizeof(dimensions));
+    for (size_t a = 0; a < graphe.getNbSommetsFiges(); ++a)
+    {
+        const uint64_t debut = graphe.getDebutArcsFiges()[a];
+        const uint32_t station = table.getStation(a);
+        hacher(empreinte, &debut, sizeof(debut));
+        hacher(empreinte, &station, sizeof(station));
+    }
+    hacher(empreinte, graphe.getArcsFiges(), graphe.getNbArcs() * sizeof(Graphe::ArcFige));
+    return empreinte;
+}
+
+//! \brief indique si les motifs de la station origine p_station ont été calculés
+bool MotifsTransferts::estCalculee(unsigned int p_station) const
+{
+    return p_station + 1 < m_debutNoeuds.size() && m_debutNoeuds[p_station + 1] > m_debutNoeuds[p_station];
+}
+
+//! \brief le nombre de motifs gardés, toutes origines confondues
+size_t MotifsTransferts::getNbMotifs() const
+{
+    return m_cibles.size();
+}
+
+//! \brief le nombre de noeuds des arbres de motifs, toutes origines confondues
+size_t MotifsTransferts::getNbNoeuds() const
+{
+    return m_noeuds.size();
+}
+
+//! \brief la mémoire occupée par les motifs, les tables de liaisons et les heures d'arrivée, en octets
+size_t MotifsTransferts::getTailleMemoire() const
+{
+    return (m_debutNoeuds.size() + m_debutCibles.size()) * sizeof(uint64_t) + m_noeuds.size() * sizeof(Noeud) +
+           m_cibles.size() * sizeof(Cible) + m_etapes.size() * sizeof(uint32_t) +
+           (m_debutStation.size() + m_debutLiaisons.size()) * sizeof(size_t) + m_arrivees.size() * sizeof(unsigned int) +
+           m_departs.size() * sizeof(pair<unsigned int, unsigned int>);
+}
+
+//! \brief la durée du trajet le plus rapide de la station p_origine à la station p_destination
+//! \brief Chaque motif de p_destination est évalué au plus tôt, étape par étape: en autobus, le premier arrêt atteint
+//! \brief de la station d'arrivée parmi les liaisons directes qui partent au rang courant ou plus tard; à pieds, le
+//! \brief premier arrêt de la station d'arrivée après la durée du transfert.
+//! \param[in] p_origine: une station origine dont les motifs ont été calculés (indice de TableArrets)
+//! \param[in] p_destination: la station destination (indice de TableArrets)
+//! \param[in] p_heureDepart: l'heure d'arrivée à la station origine, en secondes depuis minuit
+//! \return la durée, en secondes, de p_heureDepart à l'heure d'arrivée du premier arrêt atteint de p_destination
+//! \return (infini si aucun n'est atteint)
+//! \throws logic_error si les motifs de p_origine n'ont pas été calculés ou si p_destination n'est pas une station
+unsigned int MotifsTransferts::tempsDuTrajet(unsigned int p_origine, unsigned int p_destination,
+                                             unsigned int p_heureDepart) const
+{
+    if (!estCalculee(p_origine))
+        throw logic_error("MotifsTransferts::tempsDuTrajet(): les motifs de la station origine n'ont pas été calculés");
+    if (p_destination + 1 >= m_debutStation.size())
+        throw logic_error("MotifsTransferts::tempsDuTrajet(): la destination n'est pas une station du réseau");
+    const unsigned int rangDepart = premierRangApres(p_origine, p_heureDepart);
+    if (rangDepart == m_debutStation[p_origine + 1] - m_debutStation[p_origine]) return infini;
+
+    const Noeud *arbre = m_noeuds.data() + m_debutNoeuds[p_origine];
+    const uint32_t *etapes = m_etapes.data() + m_debutNoeuds[p_origine];
+    auto motifs = equal_range(m_cibles.begin() + m_debutCibles[p_origine], m_cibles.begin() + m_debutCibles[p_origine + 1],
+                              Cible{p_destination, 0}, [](const Cible &a, const Cible &b)
+                              {
+                                  return a.station < b.station;
+                              });
+    unsigned int meilleure = infini;
+    vector<uint32_t> chemin;
+    for (auto motif = motifs.first; motif != motifs.second; ++motif)
+    {
+        chemin.clear();
+        for (uint32_t n = motif->noeud; n != 0; n = arbre[n].parent) chemin.push_back(n);
+        unsigned int station = p_origine, rang = rangDepart;
+        bool possible = true;
+        for (auto n = chemin.rbegin(); n != chemin.rend() && possible; ++n)
+        {
+            const unsigned int suivante = arbre[*n].station & ~marche;
+            if (arbre[*n].station & marche)
+            {
+                rang = premierRangApres(suivante, m_arrivees[m_debutStation[station] + rang] + etapes[*n]);
+                possible = rang < m_debutStation[suivante + 1] - m_debutStation[suivante];
+            }
+            else
+            {
+                auto debut = m_departs.begin() + m_debutLiaisons[etapes[*n]];
+                auto fin = m_departs.begin() + m_debutLiaisons[etapes[*n] + 1];
+                auto depart = lower_bound(debut, fin, make_pair(rang, 0u));
+                possible = depart != fin;
+                if (possible) rang = depart->second;
+            }
+            station = suivante;
+        }
+        if (possible) meilleure = min(meilleure, m_arrivees[m_debutStation[station] + rang]);
+    }
+    return meilleure == infini ? infini : meilleure - p_heureDepart;
+}
+
+//! \brief écrit les motifs en binaire: un en-tête (marque, version, boutisme, signature, dimensions), puis le début
+//! \brief de l'arbre de chaque origine, les noeuds, le début des motifs de chaque origine et les motifs
+//! \throws logic_error si le fichier ne peut pas être écrit
+void MotifsTransferts::ecrire(const std::string &p_nomFichier) const
+{
+    EnTete entete;
+    memset(&entete, 0, sizeof(entete));
+    memcpy(entete.marque, marqueMotifs, sizeof(entete.marque));
+    entete.version = version;
+    entete.boutisme = boutismeMachine;
+    entete.signature = m_signature;
+    entete.nbStations = m_debutStation.size() - 1;
+    entete.nbNoeuds = m_noeuds.size();
+    entete.nbCibles = m_cibles.size();
+
+    ofstream fichier(p_nomFichier, ios::binary | ios::trunc);
+    if (!fichier.is_open())
+        throw logic_error("MotifsTransferts::ecrire(): le fichier " + p_nomFichier + " n'a pas pu ouvrir");
+    fichier.write(reinterpret_cast<const char *>(&entete), sizeof(entete));
+    fichier.write(reinterpret_cast<const char *>(m_debutNoeuds.data()), m_debutNoeuds.size() * sizeof(uint64_t));
+    fichier.write(reinterpret_cast<const char *>(m_noeuds.data()), m_noeuds.size() * sizeof(Noeud));
+    fichier.write(reinterpret_cast<const char *>(m_debutCibles.data()), m_debutCibles.size() * sizeof(uint64_t));
+    fichier.write(reinterpret_cast<const char *>(m_cibles.data()), m_cibles.size() * sizeof(Cible));
+    if (!fichier)
+        throw logic_error("MotifsTransferts::ecrire(): l'écriture de " + p_nomFichier + " a échoué");
+}
+
+//! \brief lit des motifs écrits par ecrire() pour le réseau p_reseau
+//! \throws logic_error si le fichier ne peut pas être lu, n'est pas de cette version et de ce boutisme, ou a été
+//! \throws calculé sur un autre réseau (autre horaire, autre intervalle ou autres retards), ou si une station du
+//! \throws réseau a deux arrêts consécutifs du même voyage
+MotifsTransferts MotifsTransferts::lire(const std::string &p_nomFichier, const ReseauGTFS &p_reseau)
+{
+    ifstream fichier(p_nomFichier, ios::binary);
+    if (!fichier.is_open())
+        throw logic_error("MotifsTransferts::lire(): le fichier " + p_nomFichier + " n'a pas pu ouvrir");
+    EnTete entete;
+    if (!fichier.read(reinterpret_cast<char *>(&entete), sizeof(entete)) ||
+        memcmp(entete.marque, marqueMotifs, sizeof(entete.marque)) != 0)
+        throw logic_error("MotifsTransferts::lire(): " + p_nomFichier + " n'est pas un fichier de motifs");
+    if (entete.version != version || entete.boutisme != boutismeMachine)
+        throw logic_error("MotifsTransferts::lire(): version ou boutisme incompatible");
+
+    MotifsTransferts motifs(p_reseau);
+    if (entete.signature != motifs.m_signature || entete.nbStations != p_reseau.getTable().getNbStations())
+        throw logic_error("MotifsTransferts::lire(): " + p_nomFichier + " a été calculé pour un autre réseau");
+    motifs.m_debutNoeuds.resize(entete.nbStations + 1);
+    motifs.m_noeuds.resize(entete.nbNoeuds);
+    motifs.m_debutCibles.resize(entete.nbStations + 1);
+    motifs.m_cibles.resize(entete.nbCibles);
+    if (!fichier.read(reinterpret_cast<char *>(motifs.m_debutNoeuds.data()), motifs.m_debutNoeuds.size() * sizeof(uint64_t)) ||
+        !fichier.read(reinterpret_cast<char *>(motifs.m_noeuds.data()), motifs.m_noeuds.size() * sizeof(Noeud)) ||
+        !fichier.read(reinterpret_cast<char *>(motifs.m_debutCibles.data()), motifs.m_debutCibles.size() * sizeof(uint64_t)) ||
+        !fichier.read(reinterpret_cast<char *>(motifs.m_cibles.data()), motifs.m_cibles.size() * sizeof(Cible)))
+        throw logic_error("MotifsTransferts::lire(): " + p_nomFichier + " est tronqué");
+
+    //les indices sont vérifiés une fois ici pour que les requêtes n'aient pas à le faire
+    bool coherent = motifs.m_debutNoeuds.front() == 0 && motifs.m_debutNoeuds.back() == entete.nbNoeuds &&
+                    motifs.m_debutCibles.front() == 0 && motifs.m_debutCibles.back() == entete.nbCibles;
+    for (size_t s = 0; s < entete.nbStations && coherent; ++s)
+    {
+        const uint64_t nbNoeuds = motifs.m_debutNoeuds[s + 1] - motifs.m_debutNoeuds[s];
+        coherent = motifs.m_debutNoeuds[s] <= motifs.m_debutNoeuds[s + 1] &&
+                   motifs.m_debutCibles[s] <= motifs.m_debutCibles[s + 1] &&
+                   (nbNoeuds > 0 || motifs.m_debutCibles[s] == motifs.m_debutCibles[s + 1]);
+        for (uint64_t n = 0; n < nbNoeuds && coherent; ++n)
+        {
+            const Noeud &noeud = motifs.m_noeuds[motifs.m_debutNoeuds[s] + n];
+            coherent = (noeud.station & ~marche) < entete.nbStations &&
+                       (n == 0 ? noeud.parent == aucun && noeud.station == s : noeud.parent < n);
+        }
+        for (uint64_t c = motifs.m_debutCibles[s]; c < motifs.m_debutCibles[s + 1] && coherent; ++c)
+            coherent = motifs.m_cibles[c].noeud < nbNoeuds && motifs.m_cibles[c].station < entete.nbStations &&
+                       (c == motifs.m_debutCibles[s] || motifs.m_cibles[c - 1].station <= motifs.m_cibles[c].station);
+    }
+    if (!coherent)
+        throw logic_error("MotifsTransferts::lire(): " + p_nomFichier + " est corrompu");
+    motifs.preparerEtapes(p_reseau);
+    return motifs;
+}
@@ -0,0 +1,106 @@
+//
+//  motifstransferts.h
+//  Motifs de trajets précalculés (transfer patterns) pour les requêtes de station à station
+//
+
+#ifndef MOTIFSTRANSFERTS_H
+#define MOTIFSTRANSFERTS_H
+
+#include <climits>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ReseauGTFS.h"
+
+//! \brief  Motifs de trajets (transfer patterns) optimaux d'un ReseauGTFS, de chaque station origine vers chaque station
+//! \brief  Le motif d'un trajet est la suite des stations où il monte dans un autobus, en descend ou change de station
+//! \brief  à pieds, avec la nature de chaque étape (un seul voyage ou un transfert). Pour une station origine A, le
+//! \brief  précalcul trouve, pour toutes les heures de départ de A dans l'intervalle du réseau, un motif optimal vers
+//! \brief  chaque station. Les motifs de A partagent leurs préfixes dans un arbre dont la racine est A.
+//! \brief  Une requête de A à B n'évalue ensuite que les motifs de B: chaque étape en autobus est une recherche
+//! \brief  dichotomique dans la table des liaisons directes entre ses deux stations, chaque étape à pieds une
+//! \brief  recherche dans les arrêts de la station d'arrivée. Le minimum est la durée que donne la recherche de
+//! \brief  Dijkstra de ReseauGTFS entre l'arrêt de A pris au départ (le premier à partir de l'heure de départ) et le
+//! \brief  premier arrêt atteint de B.
+//! \brief  Dans le graphe de ReseauGTFS, un arrêt est atteint à sa propre heure d'arrivée par n'importe quel chemin:
+//! \brief  le profil d'une origine se calcule donc en parcourant ses départs du dernier au premier, chaque départ
+//! \brief  n'explorant que les arrêts qu'aucun départ plus tardif n'atteint. Les arrêts sont visités par nombre
+//! \brief  d'étapes croissant, ce qui garde des motifs courts. Les origines sont réparties entre plusieurs threads.
+//! \note   Un arrêt qui suit un arrêt du même voyage dans sa station (une boucle qui repasse à son terminus, par
+//! \note   exemple) n'a pas d'arc d'attente (ReseauGTFS); les motifs supposent au contraire qu'on peut prendre à une
+//! \note   station tout arrêt de rang supérieur ou égal à celui où l'on se trouve. Un tel réseau est refusé (logic_error)
+//! \note   à la construction et à la lecture; celui de la RTC n'en a pas.
+class MotifsTransferts
+{
+public:
+
+    static const unsigned int infini = UINT_MAX; /*!< la durée d'un trajet impossible */
+    static const uint32_t version = 1; /*!< à incrémenter à chaque changement du format binaire */
+
+    MotifsTransferts(const ReseauGTFS &, const std::vector<unsigned int> &, unsigned int);
+
+    bool estCalculee(unsigned int) const;
+    size_t getNbMotifs() const;
+    size_t getNbNoeuds() const;
+    size_t getTailleMemoire() const;
+    unsigned int tempsDuTrajet(unsigned int, unsigned int, unsigned int) const;
+
+    void ecrire(const std::string &) const;
+    static MotifsTransferts lire(const std::string &, const ReseauGTFS &);
+
+private:
+
+    struct EnTete
+    {
+        char marque[8];
+        uint32_t version;
+        uint32_t boutisme; /*!< 0x01020304 écrit dans l'ordre de la machine qui a produit le fichier */
+        uint64_t signature; /*!< l'empreinte du graphe du réseau */
+        uint64_t nbStations;
+        uint64_t nbNoeuds;
+        uint64_t nbCibles;
+    };
+
+    //! \brief un noeud de l'arbre des motifs d'une origine: la dernière étape d'un préfixe de motif
+    struct Noeud
+    {
+        uint32_t parent; /*!< indice dans l'arbre de la même origine (aucun pour la racine) */
+        uint32_t station; /*!< la station où mène l'étape, plus le bit marche si l'étape est un transfert */
+    };
+
+    //! \brief un motif optimal vers une station: le noeud de l'arbre où il se termine
+    struct Cible
+    {
+        uint32_t station;
+        uint32_t noeud;
+    };
+
+    //! \brief les tampons du précalcul d'une origine, propres à chaque thread
+    struct Travail;
+
+    static const uint32_t aucun = UINT32_MAX;
+    static const uint32_t marche = 0x80000000u;
+
+    explicit MotifsTransferts(const ReseauGTFS &);
+    void calculerOrigine(const ReseauGTFS &, unsigned int, Travail &, std::vector<Noeud> &,
+                         std::vector<Cible> &) const;
+    void preparerEtapes(const ReseauGTFS &);
+    unsigned int premierRangApres(unsigned int, unsigned int) const;
+    static uint64_t signature(const ReseauGTFS &);
+
+    uint64_t m_signature;
+    std::vector<uint64_t> m_debutNoeuds; //l'arbre de l'origine s est m_noeuds[m_debutNoeuds[s]..m_debutNoeuds[s+1])
+    std::vector<Noeud> m_noeuds;
+    std::vector<uint64_t> m_debutCibles; //les motifs de l'origine s, triés par station, sont m_cibles[m_debutCibles[s]..)
+    std::vector<Cible> m_cibles;
+
+    //recalculés à partir du réseau à la construction et à la lecture
+    std::vector<size_t> m_debutStation; //les heures d'arrivée de la station s sont m_arrivees[m_debutStation[s]..)
+    std::vector<unsigned int> m_arrivees;
+    std::vector<uint32_t> m_etapes; //par noeud: l'indice de sa liaison (autobus) ou la durée du transfert (à pieds)
+    std::vector<size_t> m_debutLiaisons; //les départs de la liaison l sont m_departs[m_debutLiaisons[l]..)
+    std::vector<std::pair<unsigned int, unsigned int> > m_departs; //(rang de départ, plus petit rang d'arrivée ensuite)
+};
+
+#endif //MOTIFSTRANSFERTS_H
@@ -0,0 +1,332 @@
+//
+//  reperes.cpp
+//  Points de repère (ALT) d'un ReseauGTFS: bornes inférieures des durées entre stations
+//
+
+#include "reperes.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+
+using namespace std;
+
+const unsigned int Reperes::infini;
+const uint32_t Reperes::version;
+const unsigned int Reperes::borneInatteignable;
+
+namespace
+{
+    const char marqueReperes[8] = {'R', 'T', 'C', 'R', 'E', 'P', 'E', '\0'};
+    const uint32_t boutismeMachine = 0x01020304;
+
+    //! \brief ajoute p_taille octets à une empreinte FNV-1a de 64 bits
+    void hacher(uint64_t &p_empreinte, const void *p_debut, size_t p_taille)
+    {
+        const unsigned char *octets = static_cast<const unsigned char *>(p_debut);
+        for (size_t i = 0; i < p_taille; ++i)
+        {
+            p_empreinte ^= octets[i];
+            p_empreinte *= 1099511628211ULL;
+        }
+    }
+}
+
+Reperes::Reperes() : m_nbStations(0), m_signature(0)
+{
+}
+
+//! \brief choisit p_nbReperes stations repères et calcule leurs durées vers et depuis toutes les stations
+//! \param[in] p_reseau: le réseau dont les arcs donnent le graphe des stations
+//! \param[in] p_nbReperes: le nombre de repères voulus (il peut y en avoir moins si le réseau a peu de stations)
+//! \param[in] p_nbThreads: le nombre de threads entre lesquels répartir les 2 * p_nbReperes recherches
+//! \throws logic_error si p_nbReperes ou p_nbThreads est nul
+Reperes::Reperes(const ReseauGTFS &p_reseau, unsigned int p_nbReperes, unsigned int p_nbThreads)
+{
+    if (p_nbReperes == 0 || p_nbThreads == 0)
+        throw logic_error("Reperes::Reperes(): il faut au moins un repère et un thread");
+
+    const Graphe stations = grapheStations(p_reseau, m_signature);
+    const Graphe inverse = stations.inverser();
+    m_nbStations = (unsigned int) stations.getNbSommets();
+    m_stationsReperes = choisirReperes(p_reseau.getTable(), stations, p_nbReperes);
+    const size_t nbReperes = m_stationsReperes.size();
+    m_depuis.assign((size_t) m_nbStations * nbReperes, infini);
+    m_vers.assign((size_t) m_nbStations * nbReperes, infini);
+
+    //la tâche l < K calcule d(L, s) dans le graphe des stations; la tâche K + l calcule d(s, L) dans son transposé
+    const size_t nbTaches = 2 * nbReperes;
+    atomic<size_t> prochaine(0);
+    vector<exception_ptr> erreurs(p_nbThreads);
+    auto travailler = [this, &stations, &inverse, nbReperes, nbTaches, &prochaine, &erreurs](unsigned int p_thread)
+    {
+        try
+        {
+            EspaceRecherche espace;
+            for (size_t i = prochaine++; i < nbTaches; i = prochaine++)
+            {
+                const size_t repere = i % nbReperes;
+                const vector<pair<size_t, unsigned int> > departs(1, make_pair((size_t) m_stationsReperes[repere], 0u));
+                (i < nbReperes ? stations : inverse).distancesDepuis(departs, espace);
+                vector<unsigned int> &durees = i < nbReperes ? m_depuis : m_vers;
+                for (unsigned int s = 0; s < m_nbStations; ++s)
+                    if (espace.estFixe(s)) durees[s * nbReperes + repere] = espace.getDistance(s);
+            }
+        }
+        catch (...) //l'erreur est relancée par le thread principal
+        {
+            erreurs[p_thread] = current_exception();
+            prochaine = nbTaches;
+        }
+    };
+    vector<thread> threads;
+    for (unsigned int t = 1; t < p_nbThreads; ++t) threads.push_back(thread(travailler, t));
+    travailler(0);
+    for (thread &t : threads) t.join();
+
+    for (const exception_ptr &erreur : erreurs)
+        if (erreur) rethrow_exception(erreur);
+}
+
+unsigned int Reperes::getNbReperes() const
+{
+    return (unsigned int) m_stationsReperes.size();
+}
+
+unsigned int Reperes::getNbStations() const
+{
+    return m_nbStations;
+}
+
+//! \brief la station (indice de TableArrets) du repère p_repere
+unsigned int Reperes::getStationRepere(unsigned int p_repere) const
+{
+    return m_stationsReperes[p_repere];
+}
+
+//! \brief la mémoire occupée par les durées et les repères, en octets
+size_t Reperes::getTailleMemoire() const
+{
+    return (m_depuis.size() + m_vers.size() + m_stationsReperes.size()) * sizeof(unsigned int);
+}
+
+//! \brief construit le graphe des stations: un sommet par station de la table du réseau, et un arc de s à t dont le
+//! \brief poids est le plus petit des arcs du réseau qui vont d'un arrêt de s à un arrêt de t. Les arcs d'attente,
+//! \brief qui restent dans une station, n'y sont pas.
+//! \param[out] p_signature: l'empreinte FNV-1a de 64 bits du graphe des stations
+Graphe Reperes::grapheStations(const ReseauGTFS &p_reseau, uint64_t &p_signature)
+{
+    const TableArrets &table = p_reseau.getTable();
+    const Graphe &graphe = p_reseau.getGraphe();
+    const size_t *debutArcsReseau = graphe.getDebutArcsFiges();
+    const Graphe::ArcFige *arcsReseau = graphe.getArcsFiges();
+    const unsigned int nbStations = table.getNbStations();
+
+    vector<size_t> debutArcs(nbStations + 1, 0);
+    vector<Graphe::ArcFige> arcs;
+    vector<unsigned int> poidsMin(nbStations, infini);
+    vector<unsigned int> voisines;
+    for (unsigned int s = 0; s < nbStations; ++s)
+    {
+        for (unsigned int rang = 0; rang < table.getNbArretsStation(s); ++rang)
+        {
+            const size_t a = table.getArretStation(s, rang);
+            for (size_t k = debutArcsReseau[a]; k < debutArcsReseau[a + 1]; ++k)
+            {
+                const unsigned int t = table.getStation(arcsReseau[k].destination);
+                if (t == s) continue;
+                if (poidsMin[t] == infini) voisines.push_back(t);
+                poidsMin[t] = min(poidsMin[t], arcsReseau[k].poids);
+            }
+        }
+        sort(voisines.begin(), voisines.end());
+        for (unsigned int t : voisines)
+        {
+            arcs.push_back({t, poidsMin[t]});
+            poidsMin[t] = infini;
+        }
+        voisines.clear();
+        debutArcs[s + 1] = arcs.size();
+    }
+
+    p_signature = 14695981039346656037ULL;
+    const uint64_t nb = nbStations;
+    hacher(p_signature, &nb, sizeof(nb));
+    for (size_t debut : debutArcs)
+    {
+        const uint64_t d = debut;
+        hacher(p_signature, &d, sizeof(d));
+    }
+    hacher(p_signature, arcs.data(), arcs.size() * sizeof(Graphe::ArcFige));
+    return Graphe(nbStations, std::move(debutArcs), std::move(arcs));
+}
+
+//! \brief choisit au plus p_nbReperes stations en bordure du réseau: les stations reliées à au moins une autre sont
+//! \brief réparties en p_nbReperes secteurs angulaires égaux autour de leur centre, et la plus éloignée du centre
+//! \brief est prise dans chaque secteur non vide (projection plane locale, suffisante à l'échelle d'une ville)
+vector<unsigned int> Reperes::choisirReperes(const TableArrets &p_table, const Graphe &p_stations,
+                                             unsigned int p_nbReperes)
+{
+    const Graphe inverse = p_stations.inverser();
+    const size_t *debutSortants = p_stations.getDebutArcsFiges();
+    const size_t *debutEntrants = inverse.getDebutArcsFiges();
+    vector<unsigned int> reliees;
+    double latitude = 0, longitude = 0;
+    for (unsigned int s = 0; s < p_stations.getNbSommets(); ++s)
+    {
+        if (debutSortants[s] == debutSortants[s + 1] && debutEntrants[s] == debutEntrants[s + 1]) continue;
+        reliees.push_back(s);
+        latitude += p_table.getCoords(s).getLatitude();
+        longitude += p_table.getCoords(s).getLongitude();
+    }
+    if (reliees.empty()) return vector<unsigned int>();
+    latitude /= reliees.size();
+    longitude /= reliees.size();
+    const double echelleLongitude = cos(latitude * M_PI / 180);
+
+    const unsigned int aucune = TableArrets::aucuneStation;
+    vector<unsigned int> choisies(p_nbReperes, aucune);
+    vector<double> eloignement(p_nbReperes, -1);
+    for (unsigned int s : reliees)
+    {
+        const double x = (p_table.getCoords(s).getLongitude() - longitude) * echelleLongitude;
+        const double y = p_table.getCoords(s).getLatitude() - latitude;
+        const double angle = atan2(y, x) + M_PI; //dans [0, 2 pi]
+        const unsigned int secteur = min(p_nbReperes - 1, (unsigned int) (angle / (2 * M_PI) * p_nbReperes));
+        const double rayon = x * x + y * y;
+        if (rayon > eloignement[secteur])
+        {
+            eloignement[secteur] = rayon;
+            choisies[secteur] = s;
+        }
+    }
+    choisies.erase(remove(choisies.begin(), choisies.end(), aucune), choisies.end());
+    return choisies;
+}
+
+//! \brief calcule les bornes par repère d'une destination atteinte par la marche à partir de quelques stations
+//! \param[in] p_arrivees: les paires (station, durée de la marche de la station au point destination)
+//! \param[out] p_cible: les bornes, à passer à borne()
+void Reperes::preparerCible(const std::vector<std::pair<unsigned int, unsigned int> > &p_arrivees, Cible &p_cible) const
+{
+    const size_t nbReperes = m_stationsReperes.size();
+    p_cible.depuisReperes.assign(nbReperes, infini);
+    p_cible.versReperes.assign(nbReperes, INT64_MIN);
+    for (size_t l = 0; l < nbReperes; ++l)
+    {
+        //d(s, t) + marche >= d(L, t) + marche - d(L, s): le minimum sur les stations d'arrivée
+        for (const auto &arrivee : p_arrivees)
+        {
+            const unsigned int depuis = getDureeDepuis((unsigned int) l, arrivee.first);
+            if (depuis != infini)
+                p_cible.depuisReperes[l] = (unsigned int) min<uint64_t>(p_cible.depuisReperes[l],
+                                                                        (uint64_t) depuis + arrivee.second);
+        }
+        //d(s, t) + marche >= d(s, L) - (d(t, L) - marche): le maximum, qui n'existe que si chaque t mène à L
+        for (const auto &arrivee : p_arrivees)
+        {
+            const unsigned int vers = getDureeVers((unsigned int) l, arrivee.first);
+            if (vers == infini)
+            {
+                p_cible.versReperes[l] = INT64_MIN;
+                break;
+            }
+            p_cible.versReperes[l] = max<int64_t>(p_cible.versReperes[l], (int64_t) vers - arrivee.second);
+        }
+    }
+}
+
+//! \brief une borne inférieure de la durée d'un trajet de p_station à la destination de p_cible
+//! \brief La borne est cohérente le long des arcs du réseau et nulle part plus grande que la marche finale d'une
+//! \brief station d'arrivée; elle vaut borneInatteignable si p_station ne mène à aucune station d'arrivée.
+unsigned int Reperes::borne(unsigned int p_station, const Cible &p_cible) const
+{
+    const size_t nbReperes = m_stationsReperes.size();
+    const unsigned int *depuis = m_depuis.data() + (size_t) p_station * nbReperes;
+    const unsigned int *vers = m_vers.data() + (size_t) p_station * nbReperes;
+    int64_t borne = 0;
+    for (size_t l = 0; l < nbReperes; ++l)
+    {
+        //d(s, t) >= d(L, t) - d(L, s)
+        if (p_cible.depuisReperes[l] != infini)
+        {
+            if (depuis[l] != infini) borne = max<int64_t>(borne, (int64_t) p_cible.depuisReperes[l] - depuis[l]);
+        }
+        else if (depuis[l] != infini) return borneInatteignable; //L atteint s, mais aucune station d'arrivée
+        //d(s, t) >= d(s, L) - d(t, L)
+        if (p_cible.versReperes[l] != INT64_MIN)
+        {
+            if (vers[l] == infini) return borneInatteignable; //toutes les stations d'arrivée mènent à L, mais pas s
+            borne = max<int64_t>(borne, (int64_t) vers[l] - p_cible.versReperes[l]);
+        }
+    }
+    return (unsigned int) min<int64_t>(borne, borneInatteignable - 1);
+}
+
+//! \brief écrit les repères en binaire: un en-tête (marque, version, boutisme, signature, dimensions), les stations
+//! \brief repères puis les durées depuis et vers les repères, station par station, en uint32_t
+//! \throws logic_error si le fichier ne peut pas être écrit
+void Reperes::ecrire(const std::string &p_nomFichier) const
+{
+    static_assert(sizeof(unsigned int) == sizeof(uint32_t), "les durées sont écrites directement en uint32_t");
+    EnTete entete;
+    memset(&entete, 0, sizeof(entete));
+    memcpy(entete.marque, marqueReperes, sizeof(entete.marque));
+    entete.version = version;
+    entete.boutisme = boutismeMachine;
+    entete.signature = m_signature;
+    entete.nbStations = m_nbStations;
+    entete.nbReperes = (uint32_t) m_stationsReperes.size();
+
+    ofstream fichier(p_nomFichier, ios::binary | ios::trunc);
+    if (!fichier.is_open())
+        throw logic_error("Reperes::ecrire(): le fichier " + p_nomFichier + " n'a pas pu ouvrir");
+    fichier.write(reinterpret_cast<const char *>(&entete), sizeof(entete));
+    fichier.write(reinterpret_cast<const char *>(m_stationsReperes.data()),
+                  m_stationsReperes.size() * sizeof(unsigned int));
+    fichier.write(reinterpret_cast<const char *>(m_depuis.data()), m_depuis.size() * sizeof(unsigned int));
+    fichier.write(reinterpret_cast<const char *>(m_vers.data()), m_vers.size() * sizeof(unsigned int));
+    if (!fichier)
+        throw logic_error("Reperes::ecrire(): l'écriture de " + p_nomFichier + " a échoué");
+}
+
+//! \brief lit des repères écrits par ecrire() pour le réseau p_reseau
+//! \throws logic_error si le fichier ne peut pas être lu, n'est pas de cette version et de ce boutisme, ou a été
+//! \throws calculé sur un autre graphe des stations (autre horaire, autre intervalle ou autres retards)
+Reperes Reperes::lire(const std::string &p_nomFichier, const ReseauGTFS &p_reseau)
+{
+    ifstream fichier(p_nomFichier, ios::binary);
+    if (!fichier.is_open())
+        throw logic_error("Reperes::lire(): le fichier " + p_nomFichier + " n'a pas pu ouvrir");
+    EnTete entete;
+    if (!fichier.read(reinterpret_cast<char *>(&entete), sizeof(entete)) ||
+        memcmp(entete.marque, marqueReperes, sizeof(entete.marque)) != 0)
+        throw logic_error("Reperes::lire(): " + p_nomFichier + " n'est pas un fichier de repères");
+    if (entete.version != version || entete.boutisme != boutismeMachine)
+        throw logic_error("Reperes::lire(): version ou boutisme incompatible");
+    uint64_t signature;
+    grapheStations(p_reseau, signature);
+    if (entete.signature != signature || entete.nbStations != p_reseau.getTable().getNbStations())
+        throw logic_error("Reperes::lire(): " + p_nomFichier + " a été calculé pour un autre réseau");
+
+    Reperes reperes;
+    reperes.m_nbStations = entete.nbStations;
+    reperes.m_signature = entete.signature;
+    reperes.m_stationsReperes.resize(entete.nbReperes);
+    reperes.m_depuis.resize((size_t) entete.nbStations * entete.nbReperes);
+    reperes.m_vers.resize(reperes.m_depuis.size());
+    if (!fichier.read(reinterpret_cast<char *>(reperes.m_stationsReperes.data()),
+                      reperes.m_stationsReperes.size() * sizeof(unsigned int)) ||
+        !fichier.read(reinterpret_cast<char *>(reperes.m_depuis.data()), reperes.m_depuis.size() * sizeof(unsigned int)) ||
+        !fichier.read(reinterpret_cast<char *>(reperes.m_vers.data()), reperes.m_vers.size() * sizeof(unsigned int)))
+        throw logic_error("Reperes::lire(): " + p_nomFichier + " est tronqué");
+    for (unsigned int station : reperes.m_stationsReperes)
+        if (station >= reperes.m_nbStations)
+            throw logic_error("Reperes::lire(): " + p_nomFichier + " est corrompu");
+    return reperes;
+}
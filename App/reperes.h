@@ -0,0 +1,91 @@
+//
+//  reperes.h
+//  Points de repère (ALT) d'un ReseauGTFS: bornes inférieures des durées entre stations
+//
+
+#ifndef REPERES_H
+#define REPERES_H
+
+#include <climits>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ReseauGTFS.h"
+
+//! \brief  Points de repère pour l'algorithme ALT (A*, Landmarks, inégalité du Triangle) sur un ReseauGTFS
+//! \brief  Le graphe des stations relie deux stations par le plus petit poids des arcs du réseau qui passent de
+//! \brief  l'une à l'autre (trajet entre deux arrêts consécutifs d'un voyage ou transfert). Il ne dépend pas de
+//! \brief  l'heure et aucun chemin du réseau n'est plus court que le chemin correspondant entre stations.
+//! \brief  Pour K stations repères L, les durées d(L, s) et d(s, L) vers et depuis toutes les stations s sont
+//! \brief  calculées d'avance (2K recherches réparties entre plusieurs threads); l'inégalité du triangle donne alors
+//! \brief  d(s, t) >= max(d(L, t) - d(L, s), d(s, L) - d(t, L)), une borne cohérente pour Graphe::plusCourtCheminAStar().
+//! \brief  Les durées sont gardées station par station (K entiers de 32 bits de chaque côté) et s'écrivent dans un
+//! \brief  fichier binaire (en-tête, puis stations repères et durées), à côté du réseau: la signature du graphe des
+//! \brief  stations y est gardée pour refuser un fichier calculé sur un autre réseau.
+//! \note   Les repères doivent être recalculés si les heures du réseau changent (ReseauGTFS::appliquerRetards()).
+class Reperes
+{
+public:
+
+    static const unsigned int infini = UINT_MAX; /*!< la durée vers une station inatteignable */
+    static const uint32_t version = 1; /*!< à incrémenter à chaque changement du format binaire */
+    static const unsigned int borneInatteignable = UINT_MAX / 2; /*!< la borne d'une station qui ne mène pas à la cible */
+
+    //! \brief les bornes d'une recherche vers un point destination, pour chaque repère
+    struct Cible
+    {
+        std::vector<unsigned int> depuisReperes; /*!< min sur les stations d'arrivée de d(L, t) + marche (infini si aucune) */
+        std::vector<int64_t> versReperes; /*!< max sur les stations d'arrivée de d(t, L) - marche (INT64_MIN si l'une
+                                               d'elles ne mène pas au repère ou s'il n'y en a aucune) */
+    };
+
+    Reperes();
+    Reperes(const ReseauGTFS &, unsigned int, unsigned int);
+
+    unsigned int getNbReperes() const;
+    unsigned int getNbStations() const;
+    unsigned int getStationRepere(unsigned int) const;
+    size_t getTailleMemoire() const;
+
+    //! \brief la durée minimale de la station repère p_repere à p_station (infini si inatteignable)
+    unsigned int getDureeDepuis(unsigned int p_repere, unsigned int p_station) const
+    {
+        return m_depuis[(size_t) p_station * m_stationsReperes.size() + p_repere];
+    }
+    //! \brief la durée minimale de p_station à la station repère p_repere (infini si inatteignable)
+    unsigned int getDureeVers(unsigned int p_repere, unsigned int p_station) const
+    {
+        return m_vers[(size_t) p_station * m_stationsReperes.size() + p_repere];
+    }
+
+    void preparerCible(const std::vector<std::pair<unsigned int, unsigned int> > &, Cible &) const;
+    unsigned int borne(unsigned int, const Cible &) const;
+
+    void ecrire(const std::string &) const;
+    static Reperes lire(const std::string &, const ReseauGTFS &);
+
+private:
+
+    struct EnTete
+    {
+        char marque[8];
+        uint32_t version;
+        uint32_t boutisme; /*!< 0x01020304 écrit dans l'ordre de la machine qui a produit le fichier */
+        uint64_t signature; /*!< l'empreinte du graphe des stations */
+        uint32_t nbStations;
+        uint32_t nbReperes;
+    };
+
+    unsigned int m_nbStations;
+    uint64_t m_signature;
+    std::vector<unsigned int> m_stationsReperes;
+    std::vector<unsigned int> m_depuis; //m_depuis[s * K + l] = d(repère l, s)
+    std::vector<unsigned int> m_vers; //m_vers[s * K + l] = d(s, repère l)
+
+    static Graphe grapheStations(const ReseauGTFS &, uint64_t &);
+    static std::vector<unsigned int> choisirReperes(const TableArrets &, const Graphe &, unsigned int);
+};
+
+#endif //REPERES_H
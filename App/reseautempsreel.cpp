@@ -0,0 +1,69 @@
+//
+//  reseautempsreel.cpp
+//  ReseauGTFS mis à jour par des retards en temps réel pendant qu'il répond à des requêtes
+//
+
+#include "reseautempsreel.h"
+
+using namespace std;
+
+//! \brief construit la première version du réseau, aux heures de l'horaire de p_gtfs
+ReseauTempsReel::ReseauTempsReel(const DonneesGTFS &p_gtfs)
+        : m_gtfs(p_gtfs), m_reseau(make_shared<const ReseauGTFS>(p_gtfs)), m_epoque(0)
+{
+}
+
+//! \brief part d'une copie de p_reseau, déjà construit à partir de p_gtfs (dont les arrêts ont pu être libérés)
+ReseauTempsReel::ReseauTempsReel(const DonneesGTFS &p_gtfs, const ReseauGTFS &p_reseau)
+        : m_gtfs(p_gtfs), m_reseau(make_shared<const ReseauGTFS>(p_reseau)), m_epoque(0)
+{
+}
+
+//! \brief la version courante du réseau; elle reste valide et inchangée tant que le pointeur est gardé
+//! \note peut être appelée par plusieurs threads en même temps qu'une mise à jour
+std::shared_ptr<const ReseauGTFS> ReseauTempsReel::getReseau() const
+{
+    return atomic_load(&m_reseau);
+}
+
+//! \brief le nombre de versions publiées depuis la construction (0 pour la version de l'horaire)
+uint64_t ReseauTempsReel::getEpoque() const
+{
+    return m_epoque.load();
+}
+
+//! \brief applique p_retards à une copie du réseau courant et la publie, sans interrompre les requêtes en cours
+//! \return le nombre d'arrêts dont les heures ont changé; aucune version n'est publiée s'il est nul
+//! \throws logic_error si ReseauGTFS::appliquerRetards() échoue; la version courante reste alors en place
+unsigned int ReseauTempsReel::appliquerRetards(const std::vector<RetardVoyage> &p_retards)
+{
+    lock_guard<mutex> verrou(m_miseAJour);
+    return publier(p_retards);
+}
+
+//! \brief applique, en une seule version, les fichiers .json de p_dossier qui n'ont pas encore été lus
+//! \brief (voir LecteurRetards::lireDossier()); un fichier doit y être déposé complet, par exemple par un rename()
+//! \return le nombre d'arrêts dont les heures ont changé
+//! \throws logic_error si le dossier ou un fichier ne peut être lu; aucun retard n'est alors appliqué et les fichiers
+//! \throws seront relus au prochain appel
+unsigned int ReseauTempsReel::lireDossier(const std::string &p_dossier)
+{
+    lock_guard<mutex> verrou(m_miseAJour);
+    set<string> lus(m_fichiersLus);
+    vector<RetardVoyage> retards;
+    if (LecteurRetards::lireDossier(p_dossier, lus, retards) == 0) return 0;
+    unsigned int nbModifies = publier(retards);
+    m_fichiersLus.swap(lus);
+    return nbModifies;
+}
+
+//! \brief applique p_retards à une copie de la version courante et publie la copie (m_miseAJour doit être verrouillé)
+unsigned int ReseauTempsReel::publier(const std::vector<RetardVoyage> &p_retards)
+{
+    shared_ptr<ReseauGTFS> copie = make_shared<ReseauGTFS>(*atomic_load(&m_reseau));
+    unsigned int nbModifies = copie->appliquerRetards(m_gtfs, p_retards);
+    if (nbModifies == 0) return 0;
+    atomic_store(&m_reseau, shared_ptr<const ReseauGTFS>(std::move(copie)));
+    ++m_epoque;
+    return nbModifies;
+}
@@ -0,0 +1,53 @@
+//
+//  reseautempsreel.h
+//  ReseauGTFS mis à jour par des retards en temps réel pendant qu'il répond à des requêtes
+//
+
+#ifndef RESEAUTEMPSREEL_H
+#define RESEAUTEMPSREEL_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "ReseauGTFS.h"
+#include "retardstempsreel.h"
+
+//! \brief  Réseau GTFS dont les heures suivent des retards en temps réel, avec des requêtes simultanées.
+//! \brief  Chaque version du réseau est immuable: une requête prend la version courante avec getReseau() au début et
+//! \brief  la garde jusqu'à la fin, sans verrou. Une mise à jour applique les retards à une copie de la version
+//! \brief  courante (ReseauGTFS::appliquerRetards(), qui ne recalcule que les arcs touchés) puis la publie d'un seul
+//! \brief  échange atomique et incrémente l'époque; les requêtes en cours terminent sur l'ancienne version, libérée par
+//! \brief  la dernière d'entre elles (à la manière de RCU). Une requête ne voit donc jamais une mise à jour à moitié
+//! \brief  appliquée. Les mises à jour sont faites une à la fois.
+//! \note   Les données GTFS doivent exister tant que l'objet existe.
+class ReseauTempsReel
+{
+public:
+
+    explicit ReseauTempsReel(const DonneesGTFS &);
+    ReseauTempsReel(const DonneesGTFS &, const ReseauGTFS &);
+
+    std::shared_ptr<const ReseauGTFS> getReseau() const;
+    uint64_t getEpoque() const;
+    unsigned int appliquerRetards(const std::vector<RetardVoyage> &);
+    unsigned int lireDossier(const std::string &);
+
+private:
+
+    ReseauTempsReel(const ReseauTempsReel &);
+    ReseauTempsReel &operator=(const ReseauTempsReel &);
+    unsigned int publier(const std::vector<RetardVoyage> &);
+
+    const DonneesGTFS &m_gtfs;
+    std::shared_ptr<const ReseauGTFS> m_reseau; //la version courante, lue et remplacée avec atomic_load/atomic_store
+    std::atomic<uint64_t> m_epoque; //le nombre de versions publiées depuis la construction
+    std::mutex m_miseAJour; //une seule mise à jour à la fois
+    std::set<std::string> m_fichiersLus; //les fichiers du dossier déjà appliqués (protégé par m_miseAJour)
+};
+
+#endif //RESEAUTEMPSREEL_H
@@ -0,0 +1,369 @@
+//
+//  retardstempsreel.cpp
+//  Lecture des retards en temps réel (TripUpdate de GTFS-Realtime) déposés en fichiers JSON dans un dossier local
+//
+
+#include "retardstempsreel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <dirent.h>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+const unsigned int RetardArret::aucun;
+
+namespace
+{
+    //! \brief une valeur d'un document JSON
+    struct ValeurJSON
+    {
+        enum Type
+        {
+            NUL, BOOLEEN, NOMBRE, CHAINE, TABLEAU, OBJET
+        };
+
+        Type type = NUL;
+        bool booleen = false;
+        double nombre = 0;
+        string chaine;
+        vector<ValeurJSON> elements;
+        vector<pair<string, ValeurJSON> > membres;
+
+        //! \brief le membre p_nom (ou p_autreNom) de l'objet, nullptr s'il est absent ou null
+        const ValeurJSON *membre(const char *p_nom, const char *p_autreNom = nullptr) const
+        {
+            if (type != OBJET) return nullptr;
+            for (const auto &m : membres)
+                if ((m.first == p_nom || (p_autreNom && m.first == p_autreNom)) && m.second.type != NUL)
+                    return &m.second;
+            return nullptr;
+        }
+
+        //! \brief la valeur entière d'un nombre ou d'une chaîne de chiffres (le protobuf écrit les int64 en chaînes)
+        bool versEntier(int64_t &p_valeur) const
+        {
+            if (type == NOMBRE)
+            {
+                p_valeur = (int64_t) llround(nombre);
+                return true;
+            }
+            if (type != CHAINE || chaine.empty()) return false;
+            char *fin = nullptr;
+            long long valeur = strtoll(chaine.c_str(), &fin, 10);
+            if (*fin != '\0') return false;
+            p_valeur = valeur;
+            return true;
+        }
+
+        //! \brief vrai si l'énumération vaut p_nom ou p_numero (le protobuf écrit les énumérations par nom)
+        bool estEnum(const char *p_nom, int p_numero) const
+        {
+            return (type == CHAINE && chaine == p_nom) || (type == NOMBRE && nombre == p_numero);
+        }
+    };
+
+    //! \brief analyseur JSON récursif (RFC 8259), suffisant pour les fichiers GTFS-Realtime
+    class AnalyseurJSON
+    {
+    public:
+        AnalyseurJSON(const string &p_texte, const string &p_nomFichier)
+                : m_texte(p_texte), m_nomFichier(p_nomFichier), m_position(0)
+        {
+        }
+
+        void lireDocument(ValeurJSON &p_valeur)
+        {
+            lireValeur(p_valeur);
+            sauterEspaces();
+            if (m_position != m_texte.size()) erreur("caractères après la valeur");
+        }
+
+    private:
+        const string &m_texte;
+        const string &m_nomFichier;
+        size_t m_position;
+
+        void erreur(const char *p_message) const
+        {
+            ostringstream message;
+            message << "LecteurRetards: JSON invalide dans " << m_nomFichier << " (" << p_message << ", position "
+                    << m_position << ")";
+            throw logic_error(message.str());
+        }
+
+        void sauterEspaces()
+        {
+            while (m_position < m_texte.size() && (m_texte[m_position] == ' ' || m_texte[m_position] == '\t' ||
+                                                   m_texte[m_position] == '\n' || m_texte[m_position] == '\r'))
+                ++m_position;
+        }
+
+        void attendre(char p_caractere)
+        {
+            sauterEspaces();
+            if (m_position >= m_texte.size() || m_texte[m_position] != p_caractere) erreur("caractère inattendu");
+            ++m_position;
+        }
+
+        bool suivantEst(char p_caractere)
+        {
+            sauterEspaces();
+            if (m_position < m_texte.size() && m_texte[m_position] == p_caractere)
+            {
+                ++m_position;
+                return true;
+            }
+            return false;
+        }
+
+        void lireMot(const char *p_mot)
+        {
+            for (const char *c = p_mot; *c; ++c, ++m_position)
+                if (m_position >= m_texte.size() || m_texte[m_position] != *c) erreur("mot inconnu");
+        }
+
+        void lireValeur(ValeurJSON &p_valeur)
+        {
+            sauterEspaces();
+            if (m_position >= m_texte.size()) erreur("fin de fichier inattendue");
+            char c = m_texte[m_position];
+            if (c == '{')
+            {
+                ++m_position;
+                p_valeur.type = ValeurJSON::OBJET;
+                if (suivantEst('}')) return;
+                do
+                {
+                    sauterEspaces();
+                    p_valeur.membres.emplace_back();
+                    lireChaine(p_valeur.membres.back().first);
+                    attendre(':');
+                    lireValeur(p_valeur.membres.back().second);
+                } while (suivantEst(','));
+                attendre('}');
+            }
+            else if (c == '[')
+            {
+                ++m_position;
+                p_valeur.type = ValeurJSON::TABLEAU;
+                if (suivantEst(']')) return;
+                do
+                {
+                    p_valeur.elements.emplace_back();
+                    lireValeur(p_valeur.elements.back());
+                } while (suivantEst(','));
+                attendre(']');
+            }
+            else if (c == '"')
+            {
+                p_valeur.type = ValeurJSON::CHAINE;
+                lireChaine(p_valeur.chaine);
+            }
+            else if (c == 't' || c == 'f')
+            {
+                p_valeur.type = ValeurJSON::BOOLEEN;
+                p_valeur.booleen = c == 't';
+                lireMot(p_valeur.booleen ? "true" : "false");
+            }
+            else if (c == 'n')
+            {
+                p_valeur.type = ValeurJSON::NUL;
+                lireMot("null");
+            }
+            else
+            {
+                p_valeur.type = ValeurJSON::NOMBRE;
+                const char *debut = m_texte.c_str() + m_position;
+                char *fin = nullptr;
+                p_valeur.nombre = strtod(debut, &fin);
+                if (fin == debut) erreur("valeur inconnue");
+                m_position += (size_t) (fin - debut);
+            }
+        }
+
+        void lireChaine(string &p_chaine)
+        {
+            if (m_position >= m_texte.size() || m_texte[m_position] != '"') erreur("chaîne attendue");
+            ++m_position;
+            p_chaine.clear();
+            while (m_position < m_texte.size() && m_texte[m_position] != '"')
+            {
+                char c = m_texte[m_position++];
+                if (c != '\\')
+                {
+                    p_chaine.push_back(c);
+                    continue;
+                }
+                if (m_position >= m_texte.size()) break;
+                c = m_texte[m_position++];
+                switch (c)
+                {
+                    case 'b': p_chaine.push_back('\b'); break;
+                    case 'f': p_chaine.push_back('\f'); break;
+                    case 'n': p_chaine.push_back('\n'); break;
+                    case 'r': p_chaine.push_back('\r'); break;
+                    case 't': p_chaine.push_back('\t'); break;
+                    case 'u': ajouterCodeUnicode(p_chaine); break;
+                    default: p_chaine.push_back(c); break;
+                }
+            }
+            if (m_position >= m_texte.size()) erreur("chaîne non terminée");
+            ++m_position;
+        }
+
+        unsigned int lireHexadecimal()
+        {
+            if (m_position + 4 > m_texte.size()) erreur("séquence \\u incomplète");
+            unsigned int code = 0;
+            for (int i = 0; i < 4; ++i)
+            {
+                char c = m_texte[m_position++];
+                code <<= 4;
+                if (c >= '0' && c <= '9') code |= (unsigned int) (c - '0');
+                else if (c >= 'a' && c <= 'f') code |= (unsigned int) (c - 'a' + 10);
+                else if (c >= 'A' && c <= 'F') code |= (unsigned int) (c - 'A' + 10);
+                else erreur("séquence \\u invalide");
+            }
+            return code;
+        }
+
+        //! \brief ajoute en UTF-8 le caractère d'une séquence \uXXXX (ou d'une paire de substitution)
+        void ajouterCodeUnicode(string &p_chaine)
+        {
+            unsigned int code = lireHexadecimal();
+            if (code >= 0xD800 && code < 0xDC00 && m_texte.compare(m_position, 2, "\\u") == 0)
+            {
+                m_position += 2;
+                code = 0x10000 + ((code - 0xD800) << 10) + (lireHexadecimal() - 0xDC00);
+            }
+            if (code < 0x80) p_chaine.push_back((char) code);
+            else if (code < 0x800)
+            {
+                p_chaine.push_back((char) (0xC0 | (code >> 6)));
+                p_chaine.push_back((char) (0x80 | (code & 0x3F)));
+            }
+            else if (code < 0x10000)
+            {
+                p_chaine.push_back((char) (0xE0 | (code >> 12)));
+                p_chaine.push_back((char) (0x80 | ((code >> 6) & 0x3F)));
+                p_chaine.push_back((char) (0x80 | (code & 0x3F)));
+            }
+            else
+            {
+                p_chaine.push_back((char) (0xF0 | (code >> 18)));
+                p_chaine.push_back((char) (0x80 | ((code >> 12) & 0x3F)));
+                p_chaine.push_back((char) (0x80 | ((code >> 6) & 0x3F)));
+                p_chaine.push_back((char) (0x80 | (code & 0x3F)));
+            }
+        }
+    };
+
+    //! \brief lit le StopTimeEvent p_evenement (arrival ou departure) d'un StopTimeUpdate
+    //! \return faux si l'événement est absent ou ne donne ni retard ni heure
+    bool lireEvenement(const ValeurJSON *p_evenement, int &p_retard, int64_t &p_heure)
+    {
+        p_retard = 0;
+        p_heure = 0;
+        if (!p_evenement) return false;
+        int64_t valeur;
+        const ValeurJSON *heure = p_evenement->membre("time");
+        if (heure && heure->versEntier(valeur) && valeur > 0)
+        {
+            p_heure = valeur;
+            return true;
+        }
+        const ValeurJSON *retard = p_evenement->membre("delay");
+        if (retard && retard->versEntier(valeur))
+        {
+            p_retard = (int) valeur;
+            return true;
+        }
+        return false;
+    }
+}
+
+//! \brief lit les TripUpdate du fichier JSON p_nomFichier (un FeedMessage GTFS-Realtime)
+//! \param[out] p_retards: les retards lus sont ajoutés à la fin, dans l'ordre du fichier
+//! \throws logic_error si le fichier ne peut être lu ou n'est pas un document JSON valide
+void LecteurRetards::lireFichier(const std::string &p_nomFichier, std::vector<RetardVoyage> &p_retards)
+{
+    ifstream fichier(p_nomFichier, ios::binary);
+    if (!fichier) throw logic_error("LecteurRetards::lireFichier(): impossible d'ouvrir " + p_nomFichier);
+    ostringstream contenu;
+    contenu << fichier.rdbuf();
+    string texte = contenu.str();
+
+    ValeurJSON document;
+    AnalyseurJSON(texte, p_nomFichier).lireDocument(document);
+    const ValeurJSON *entites = document.membre("entity");
+    if (!entites || entites->type != ValeurJSON::TABLEAU) return;
+
+    for (const ValeurJSON &entite : entites->elements)
+    {
+        const ValeurJSON *miseAJour = entite.membre("tripUpdate", "trip_update");
+        if (!miseAJour) continue;
+        const ValeurJSON *voyage = miseAJour->membre("trip");
+        const ValeurJSON *tripId = voyage ? voyage->membre("tripId", "trip_id") : nullptr;
+        if (!tripId || tripId->type != ValeurJSON::CHAINE) continue;
+        const ValeurJSON *relation = voyage->membre("scheduleRelationship", "schedule_relationship");
+        if (relation && !relation->estEnum("SCHEDULED", 0)) continue;
+
+        RetardVoyage retard;
+        retard.tripId = tripId->chaine;
+        const ValeurJSON *arrets = miseAJour->membre("stopTimeUpdate", "stop_time_update");
+        if (arrets && arrets->type == ValeurJSON::TABLEAU)
+        {
+            for (const ValeurJSON &arret : arrets->elements)
+            {
+                const ValeurJSON *relationArret = arret.membre("scheduleRelationship", "schedule_relationship");
+                if (relationArret && !relationArret->estEnum("SCHEDULED", 0)) continue;
+                RetardArret r;
+                int64_t valeur;
+                const ValeurJSON *sequence = arret.membre("stopSequence", "stop_sequence");
+                r.sequence = sequence && sequence->versEntier(valeur) && valeur >= 0 ? (unsigned int) valeur
+                                                                                       : RetardArret::aucun;
+                const ValeurJSON *stopId = arret.membre("stopId", "stop_id");
+                r.stationId = stopId && stopId->versEntier(valeur) && valeur >= 0 ? (unsigned int) valeur
+                                                                                   : RetardArret::aucun;
+                r.aArrivee = lireEvenement(arret.membre("arrival"), r.retardArrivee, r.heureArrivee);
+                r.aDepart = lireEvenement(arret.membre("departure"), r.retardDepart, r.heureDepart);
+                if ((r.aArrivee || r.aDepart) && (r.sequence != RetardArret::aucun || r.stationId != RetardArret::aucun))
+                    retard.arrets.push_back(r);
+            }
+        }
+        p_retards.push_back(std::move(retard));
+    }
+}
+
+//! \brief lit, par ordre de nom, les fichiers .json de p_dossier qui ne sont pas dans p_dejaLus
+//! \param[in,out] p_dejaLus: les noms des fichiers déjà lus; les fichiers lus y sont ajoutés
+//! \param[out] p_retards: les retards lus sont ajoutés à la fin; un voyage peut y paraître plusieurs fois, la dernière
+//! \param[out] mise à jour étant la plus récente
+//! \return le nombre de fichiers lus
+//! \throws logic_error si le dossier ou un fichier ne peut être lu
+unsigned int LecteurRetards::lireDossier(const std::string &p_dossier, std::set<std::string> &p_dejaLus,
+                                         std::vector<RetardVoyage> &p_retards)
+{
+    DIR *dossier = opendir(p_dossier.c_str());
+    if (!dossier) throw logic_error("LecteurRetards::lireDossier(): impossible d'ouvrir " + p_dossier);
+    vector<string> noms;
+    while (dirent *entree = readdir(dossier))
+    {
+        string nom = entree->d_name;
+        if (nom.size() > 5 && nom.compare(nom.size() - 5, 5, ".json") == 0 && p_dejaLus.count(nom) == 0)
+            noms.push_back(nom);
+    }
+    closedir(dossier);
+    sort(noms.begin(), noms.end());
+    for (const string &nom : noms)
+    {
+        lireFichier(p_dossier + "/" + nom, p_retards);
+        p_dejaLus.insert(nom);
+    }
+    return (unsigned int) noms.size();
+}
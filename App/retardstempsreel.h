@@ -0,0 +1,49 @@
+//
+//  retardstempsreel.h
+//  Lecture des retards en temps réel (TripUpdate de GTFS-Realtime) déposés en fichiers JSON dans un dossier local
+//
+
+#ifndef RETARDSTEMPSREEL_H
+#define RETARDSTEMPSREEL_H
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <vector>
+
+//! \brief un StopTimeUpdate: l'arrêt qu'il désigne et son retard à l'arrivée et au départ
+struct RetardArret
+{
+    static const unsigned int aucun = static_cast<unsigned int>(-1);
+
+    unsigned int sequence; /*!< le stop_sequence (aucun s'il est absent) */
+    unsigned int stationId; /*!< le stop_id (aucun s'il est absent ou non numérique) */
+    bool aArrivee; /*!< vrai si arrival donne un retard (delay) ou une heure (time) */
+    bool aDepart; /*!< vrai si departure donne un retard (delay) ou une heure (time) */
+    int retardArrivee; /*!< en secondes, si heureArrivee vaut 0 */
+    int retardDepart;
+    int64_t heureArrivee; /*!< l'heure POSIX d'arrivée (0 si seul le retard est donné) */
+    int64_t heureDepart;
+};
+
+//! \brief un TripUpdate: les retards des arrêts d'un voyage, par numéro de séquence croissant
+struct RetardVoyage
+{
+    std::string tripId;
+    std::vector<RetardArret> arrets;
+};
+
+//! \brief  Lit les TripUpdate d'un flux GTFS-Realtime écrit en JSON (la représentation JSON du protobuf, avec les noms
+//! \brief  de champs tripUpdate/stopTimeUpdate ou trip_update/stop_time_update). Seuls les voyages prévus à l'horaire
+//! \brief  sont retenus: un voyage annulé ou ajouté (schedule_relationship autre que SCHEDULED) est ignoré, tout comme
+//! \brief  un arrêt SKIPPED ou NO_DATA. Les fichiers sont lus d'un dossier local: aucun service en ligne n'est requis.
+class LecteurRetards
+{
+public:
+
+    static void lireFichier(const std::string &p_nomFichier, std::vector<RetardVoyage> &p_retards);
+    static unsigned int lireDossier(const std::string &p_dossier, std::set<std::string> &p_dejaLus,
+                                    std::vector<RetardVoyage> &p_retards);
+};
+
+#endif //RETARDSTEMPSREEL_H
@@ -0,0 +1,260 @@
+//
+//  routeurcsa.cpp
+//  Calcul d'itinéraires par balayage de connexions (Connection Scan Algorithm)
+//
+
+#include <algorithm>
+#include <functional>
+
+#include "routeurcsa.h"
+#include "ReseauGTFS.h"
+
+using namespace std;
+
+namespace
+{
+    const unsigned int aucunRang = numeric_limits<unsigned int>::max();
+    const size_t aucunArret = numeric_limits<size_t>::max();
+}
+
+//! \brief construit le tableau de connexions à partir des voyages et des transferts de DonneesGTFS
+//! \param[in] p_gtfs: un objet DonneesGTFS dont tous les arrêts et transferts ont été ajoutés
+//! \post m_connexions contient une connexion par paire d'arrêts consécutifs d'un voyage, triées par heure de départ
+RouteurCSA::RouteurCSA(const DonneesGTFS &p_gtfs) : m_table(p_gtfs)
+{
+    if (m_table.getNbArrets() >= numeric_limits<unsigned int>::max())
+        throw logic_error("RouteurCSA::RouteurCSA(): trop d'arrêts");
+    m_connexions.reserve(m_table.getNbArrets());
+    for (unsigned int v = 0; v < m_table.getNbVoyages(); ++v)
+    {
+        for (size_t a = m_table.getDebutVoyage(v); a + 1 < m_table.getDebutVoyage(v + 1); ++a)
+        {
+            if (m_table.getArrivee(a + 1) < m_table.getArrivee(a))
+                throw logic_error("RouteurCSA::RouteurCSA(): connexion de durée négative");
+            m_connexions.push_back({m_table.getArrivee(a), m_table.getArrivee(a + 1), v,
+                                    m_table.getStation(a), m_table.getRang(a),
+                                    m_table.getStation(a + 1), m_table.getRang(a + 1), (unsigned int) a});
+        }
+    }
+    //le tri stable conserve l'ordre des arrêts d'un même voyage lorsque des connexions ont la même durée nulle
+    stable_sort(m_connexions.begin(), m_connexions.end(), [](const Connexion &c1, const Connexion &c2)
+    {
+        return c1.depart < c2.depart || (c1.depart == c2.depart && c1.arrivee < c2.arrivee);
+    });
+}
+
+size_t RouteurCSA::getNbConnexions() const
+{
+    return m_connexions.size();
+}
+
+//! \brief Constructeur d'un espace vide; la mémoire est allouée à la première requête
+RouteurCSA::Espace::Espace() : m_generation(0)
+{
+}
+
+//! \brief prépare l'espace pour une nouvelle requête sur un routeur de p_nbStations stations et p_nbVoyages voyages
+//! \post aucune station n'est atteinte, aucun voyage n'a d'embarquement et la file des transferts est vide
+void RouteurCSA::Espace::preparer(unsigned int p_nbStations, unsigned int p_nbVoyages)
+{
+    ++m_generation;
+    if (m_generation == 0) //débordement: on repart de zéro
+    {
+        m_generation = 1;
+        for (EtatStation &e : m_stations) e.generation = 0;
+        for (Embarquement &e : m_embarquements) e.generation = 0;
+    }
+    if (m_stations.size() < p_nbStations) m_stations.resize(p_nbStations, EtatStation());
+    if (m_embarquements.size() < p_nbVoyages) m_embarquements.resize(p_nbVoyages, {0, aucunArret});
+    m_aPropager.clear();
+}
+
+//! \brief l'état de p_station pour la requête courante (non atteinte si la génération est antérieure)
+RouteurCSA::Espace::EtatStation &RouteurCSA::Espace::station(unsigned int p_station)
+{
+    EtatStation &e = m_stations[p_station];
+    if (e.generation != m_generation)
+        e = {m_generation, numeric_limits<unsigned int>::max(), aucunRang, {aucunRang, Acces::AUCUN, aucunArret}};
+    return e;
+}
+
+//! \brief l'arrêt où l'on monte à bord de p_voyage pour la requête courante (aucunArret si on n'y monte pas)
+size_t &RouteurCSA::Espace::embarquement(unsigned int p_voyage)
+{
+    Embarquement &e = m_embarquements[p_voyage];
+    if (e.generation != m_generation) e = {m_generation, aucunArret};
+    return e.arret;
+}
+
+//! \brief Trouve l'itinéraire arrivant le plus tôt au point destination en partant du point origine à getTempsDebut()
+//! \param[in] p_gtfs: l'objet DonneesGTFS utilisé pour construire le routeur
+//! \param[in] p_pointOrigine: les coordonnées GPS du point origine
+//! \param[in] p_pointDestination: les coordonnées GPS du point destination
+//! \param[in] p_afficherItineraire: true si on désire afficher l'itinéraire (voir ReseauGTFS::afficherItineraire())
+//! \param[out] p_tempsExecution: le temps d'exécution, en microsecondes, du balayage des connexions
+//! \return la durée du trajet en secondes (= numeric_limits<unsigned int>::max() si la destination n'est pas atteignable)
+//! \throws logic_error si un problème survient durant l'exécution de la méthode
+unsigned int RouteurCSA::itineraire(const DonneesGTFS &p_gtfs, const Coordonnees &p_pointOrigine,
+                                    const Coordonnees &p_pointDestination, bool p_afficherItineraire,
+                                    long &p_tempsExecution) const
+{
+    Espace espace;
+    return itineraire(p_gtfs, p_pointOrigine, p_pointDestination, p_afficherItineraire, p_tempsExecution, espace);
+}
+
+//! \brief Identique à itineraire(p_gtfs, p_pointOrigine, p_pointDestination, p_afficherItineraire, p_tempsExecution)
+//! \brief Le routeur n'est que consulté: plusieurs requêtes peuvent s'exécuter en même temps, chacune avec son espace.
+//! \param[in,out] p_espace: l'espace de travail de la requête, réutilisé d'une requête à l'autre par l'appelant
+unsigned int RouteurCSA::itineraire(const DonneesGTFS &p_gtfs, const Coordonnees &p_pointOrigine,
+                                    const Coordonnees &p_pointDestination, bool p_afficherItineraire,
+                                    long &p_tempsExecution, Espace &p_espace) const
+{
+    timeval tv1;
+    timeval tv2;
+    if (gettimeofday(&tv1, 0) != 0)
+        throw logic_error("RouteurCSA::itineraire(): gettimeofday() a échoué pour tv1");
+
+    const unsigned int tempsDebut = TableArrets::enSecondes(p_gtfs.getTempsDebut());
+    const unsigned int aucuneHeure = numeric_limits<unsigned int>::max();
+    p_espace.preparer(m_table.getNbStations(), m_table.getNbVoyages());
+    vector<pair<unsigned int, unsigned int> > &aPropager = p_espace.m_aPropager;
+    const auto plusTard = greater<pair<unsigned int, unsigned int> >();
+    unsigned int meilleureArrivee = aucuneHeure;
+    unsigned int stationFinale = 0;
+
+    vector<pair<unsigned int, double> > &accessibles = p_espace.m_accessibles;
+    m_table.stationsAccessibles(p_pointDestination, ReseauGTFS::distanceMaxMarche, accessibles);
+    for (const auto &station : accessibles)
+        p_espace.station(station.first).marcheVersDestination =
+                (unsigned int) ((station.second / ReseauGTFS::vitesseDeMarche) * 3600);
+
+    //atteindre le rang p_rang de p_station; ses transferts seront relâchés par propager()
+    auto atteindre = [&](unsigned int p_station, unsigned int p_rang, Acces p_acces, size_t p_arret)
+    {
+        Espace::EtatStation &etat = p_espace.station(p_station);
+        etat.etiquette = {p_rang, p_acces, p_arret};
+        unsigned int heure = m_table.getArriveeStation(p_station, p_rang);
+        if (etat.marcheVersDestination != aucuneHeure && heure + etat.marcheVersDestination < meilleureArrivee)
+        {
+            meilleureArrivee = heure + etat.marcheVersDestination;
+            stationFinale = p_station;
+        }
+        if (m_table.getDebutTransferts(p_station) != m_table.getDebutTransferts(p_station + 1))
+        {
+            aPropager.push_back({heure, p_station});
+            push_heap(aPropager.begin(), aPropager.end(), plusTard);
+        }
+    };
+
+    //relâcher, en ordre d'heure, les transferts des stations atteintes au plus tard à p_heure (un transfert mène
+    //à une heure au moins aussi tardive que celle de sa station: ceux qu'il atteint suivent dans la file)
+    auto propager = [&](unsigned int p_heure)
+    {
+        while (!aPropager.empty() && aPropager.front().first <= p_heure && aPropager.front().first < meilleureArrivee)
+        {
+            unsigned int station = aPropager.front().second;
+            pop_heap(aPropager.begin(), aPropager.end(), plusTard);
+            aPropager.pop_back();
+            Espace::EtatStation &etat = p_espace.station(station);
+            if (etat.etiquette.rang >= etat.rangPropage) continue; //déjà relâchés à partir de cette étiquette
+            etat.rangPropage = etat.etiquette.rang;
+            unsigned int heure = m_table.getArriveeStation(station, etat.rangPropage);
+            size_t depart = m_table.getArretStation(station, etat.rangPropage);
+            for (size_t k = m_table.getDebutTransferts(station); k < m_table.getDebutTransferts(station + 1); ++k)
+            {
+                const pair<unsigned int, unsigned int> &transfert = m_table.getTransfert(k);
+                unsigned int rang = m_table.premierRangApres(transfert.first, heure + transfert.second);
+                if (rang < m_table.getNbArretsStation(transfert.first) &&
+                    rang < p_espace.station(transfert.first).etiquette.rang)
+                    atteindre(transfert.first, rang, Acces::TRANSFERT, depart);
+            }
+        }
+    };
+
+    //arcs à pieds du point origine vers le premier arrêt atteignable de chaque station accessible
+    m_table.stationsAccessibles(p_pointOrigine, ReseauGTFS::distanceMaxMarche, accessibles);
+    for (const auto &station : accessibles)
+    {
+        unsigned int tempsMarche = (unsigned int) round((station.second / ReseauGTFS::vitesseDeMarche) * 3600);
+        unsigned int rang = m_table.premierRangApres(station.first, tempsDebut + tempsMarche);
+        if (rang < m_table.getNbArretsStation(station.first) && rang < p_espace.station(station.first).etiquette.rang)
+            atteindre(station.first, rang, Acces::ORIGINE, aucunArret);
+    }
+
+    //balayage des connexions en ordre d'heure de départ
+    auto premiere = lower_bound(m_connexions.begin(), m_connexions.end(), tempsDebut,
+                                [](const Connexion &c, unsigned int heure) { return c.depart < heure; });
+    for (auto c = premiere; c != m_connexions.end(); ++c)
+    {
+        propager(c->depart);
+        if (c->depart >= meilleureArrivee) break; //aucune connexion restante ne peut améliorer l'arrivée
+
+        size_t &embarque = p_espace.embarquement(c->voyage);
+        if (embarque == aucunArret)
+        {
+            unsigned int rangAtteint = p_espace.station(c->stationDepart).etiquette.rang;
+            if (rangAtteint == aucunRang || c->rangDepart < rangAtteint)
+                continue; //on ne peut être à la station à temps pour monter à bord
+            embarque = c->arret;
+        }
+
+        if (c->rangArrivee < p_espace.station(c->stationArrivee).etiquette.rang)
+            atteindre(c->stationArrivee, c->rangArrivee, Acces::VOYAGE, c->arret + 1);
+    }
+    propager(aucuneHeure); //les transferts qui peuvent encore mener au point destination plus tôt
+
+    if (gettimeofday(&tv2, 0) != 0)
+        throw logic_error("RouteurCSA::itineraire(): gettimeofday() a échoué pour tv2");
+    p_tempsExecution = tempsExecution(tv1, tv2);
+
+    vector<size_t> chemin;
+    unsigned int tempsDuTrajet = numeric_limits<unsigned int>::max();
+    if (meilleureArrivee != aucuneHeure)
+    {
+        tempsDuTrajet = meilleureArrivee - tempsDebut;
+        construireChemin(stationFinale, p_espace, chemin);
+    }
+    ReseauGTFS::afficherItineraire(p_gtfs, m_table, chemin, tempsDuTrajet, p_afficherItineraire);
+    return tempsDuTrajet;
+}
+
+//! \brief reconstruit les arrêts parcourus, du point origine jusqu'au point destination atteint de p_stationFinale
+//! \param[in] p_espace: l'espace de la requête qui a atteint p_stationFinale
+//! \param[out] p_chemin: les indices d'arrêts dans le format attendu par ReseauGTFS::afficherItineraire()
+//! \throws logic_error si les étiquettes sont incohérentes
+void RouteurCSA::construireChemin(unsigned int p_stationFinale, Espace &p_espace, vector<size_t> &p_chemin) const
+{
+    p_chemin.clear();
+    p_chemin.push_back(m_table.getNbArrets() + 1); //le point destination
+
+    unsigned int station = p_stationFinale;
+    size_t arret = m_table.getArretStation(station, p_espace.station(station).etiquette.rang);
+    for (size_t nbEtapes = 0; ; ++nbEtapes)
+    {
+        if (nbEtapes > m_table.getNbArrets())
+            throw logic_error("RouteurCSA::construireChemin(): le chemin contient un cycle");
+
+        //arret est l'arrêt requis à station; on y attend depuis le premier arrêt atteint de la station
+        const Etiquette &etiquette = p_espace.station(station).etiquette;
+        if (etiquette.acces == Acces::AUCUN)
+            throw logic_error("RouteurCSA::construireChemin(): station non atteinte sur le chemin");
+        size_t premier = m_table.getArretStation(station, etiquette.rang);
+        p_chemin.push_back(arret);
+        if (premier != arret) p_chemin.push_back(premier);
+
+        if (etiquette.acces == Acces::ORIGINE)
+            break;
+        else if (etiquette.acces == Acces::VOYAGE) //on est descendu du voyage à premier; on y est monté à embarque
+        {
+            size_t embarque = p_espace.embarquement(m_table.getVoyage(premier));
+            for (size_t a = premier - 1; a > embarque; --a)
+                p_chemin.push_back(a);
+            arret = embarque;
+        }
+        else
+            arret = etiquette.arret;
+        station = m_table.getStation(arret);
+    }
+    p_chemin.push_back(m_table.getNbArrets()); //le point origine
+    reverse(p_chemin.begin(), p_chemin.end());
+}
@@ -0,0 +1,108 @@
+//
+//  routeurcsa.h
+//  Calcul d'itinéraires par balayage de connexions (Connection Scan Algorithm)
+//
+
+#ifndef ROUTEURCSA_H
+#define ROUTEURCSA_H
+
+#include <vector>
+
+#include "DonneesGTFS.h"
+#include "tablearrets.h"
+
+//! \brief  Routeur par balayage de connexions (CSA) construit à partir des voyages et des transferts de DonneesGTFS
+//! \brief  Une connexion relie deux arrêts consécutifs d'un voyage; les connexions sont triées par heure de départ
+//! \brief  et une requête les parcourt une seule fois, en ordre, dans un tableau contigu.
+//! \brief  Les règles sont celles du graphe de ReseauGTFS: on monte à bord d'un arrêt si on est à sa station au plus
+//! \brief  tard à son heure d'arrivée, on attend à une station pour n'importe quel arrêt suivant (dans l'ordre de
+//! \brief  Station::getArrets()), et un transfert mène au premier arrêt de l'autre station après la durée du transfert.
+//! \brief  Les heures d'arrivée obtenues sont donc identiques à celles de ReseauGTFS::itineraire().
+//! \brief  Les transferts d'une station sont relâchés en ordre d'heure d'arrivée, juste avant la première connexion
+//! \brief  qui part à partir de cette heure: une station améliorée plusieurs fois ne les relâche qu'une fois.
+class RouteurCSA
+{
+public:
+
+    class Espace;
+
+    explicit RouteurCSA(const DonneesGTFS &);
+
+    unsigned int itineraire(const DonneesGTFS &, const Coordonnees &, const Coordonnees &, bool, long &) const;
+    unsigned int itineraire(const DonneesGTFS &, const Coordonnees &, const Coordonnees &, bool, long &,
+                            Espace &) const;
+    size_t getNbConnexions() const;
+
+private:
+
+    //! \brief une connexion contient tout ce que le balayage consulte, afin de parcourir la mémoire de façon linéaire
+    struct Connexion
+    {
+        unsigned int depart; /*!< heure d'arrivée de l'arrêt de départ (heure limite pour y monter) */
+        unsigned int arrivee; /*!< heure d'arrivée de l'arrêt suivant du voyage */
+        unsigned int voyage;
+        unsigned int stationDepart;
+        unsigned int rangDepart; /*!< le rang de l'arrêt de départ dans sa station */
+        unsigned int stationArrivee;
+        unsigned int rangArrivee; /*!< le rang de l'arrêt d'arrivée dans sa station */
+        unsigned int arret; /*!< l'arrêt de départ; l'arrêt d'arrivée est arret + 1 */
+    };
+
+    enum class Acces {AUCUN, ORIGINE, VOYAGE, TRANSFERT};
+
+    //! \brief comment une station a été atteinte (pour reconstruire le chemin)
+    struct Etiquette
+    {
+        unsigned int rang; /*!< le rang du premier arrêt atteint de la station */
+        Acces acces;
+        size_t arret; /*!< VOYAGE: l'arrêt atteint; TRANSFERT: l'arrêt d'où part le transfert */
+    };
+
+    TableArrets m_table;
+    std::vector<Connexion> m_connexions; /*!< triées par heure de départ, puis d'arrivée */
+
+    void construireChemin(unsigned int, Espace &, std::vector<size_t> &) const;
+};
+
+//! \brief  Tampons réutilisables d'une requête de RouteurCSA: étiquettes des stations, arrêts d'embarquement des
+//! \brief  voyages et file des stations dont les transferts restent à relâcher
+//! \brief  Comme dans EspaceRecherche, chaque entrée porte la génération de la dernière requête qui l'a écrite: une
+//! \brief  entrée d'une génération antérieure est considérée comme vide, ce qui évite de remplir les tampons à chaque
+//! \brief  requête.
+//! \note   Un espace ne doit servir qu'à une requête à la fois.
+class RouteurCSA::Espace
+{
+public:
+
+    Espace();
+
+private:
+
+    friend class RouteurCSA;
+
+    struct EtatStation
+    {
+        unsigned int generation;
+        unsigned int marcheVersDestination; /*!< en secondes (aucune si la destination est hors de portée) */
+        unsigned int rangPropage; /*!< le rang de l'étiquette dont les transferts ont été relâchés */
+        Etiquette etiquette;
+    };
+
+    struct Embarquement
+    {
+        unsigned int generation;
+        size_t arret; /*!< l'arrêt où l'on monte à bord du voyage */
+    };
+
+    void preparer(unsigned int p_nbStations, unsigned int p_nbVoyages);
+    EtatStation &station(unsigned int p_station);
+    size_t &embarquement(unsigned int p_voyage);
+
+    std::vector<EtatStation> m_stations;
+    std::vector<Embarquement> m_embarquements;
+    std::vector<std::pair<unsigned int, unsigned int> > m_aPropager; /*!< tas min de paires (heure, station) */
+    std::vector<std::pair<unsigned int, double> > m_accessibles;
+    unsigned int m_generation;
+};
+
+#endif //ROUTEURCSA_H
@@ -0,0 +1,371 @@
+//
+//  routeurraptor.cpp
+//  Calcul d'itinéraires par rondes (RAPTOR) avec compromis entre l'heure d'arrivée et le nombre d'autobus
+//
+
+#include <algorithm>
+#include <functional>
+
+#include "routeurraptor.h"
+#include "ReseauGTFS.h"
+
+using namespace std;
+
+namespace
+{
+    const unsigned int aucuneHeure = numeric_limits<unsigned int>::max();
+    const unsigned int aucunVoyage = numeric_limits<unsigned int>::max();
+    const size_t aucunArret = numeric_limits<size_t>::max();
+}
+
+//! \brief construit les routes (voyages regroupés par suite de stations) à partir des données GTFS
+//! \param[in] p_gtfs: un objet DonneesGTFS dont tous les arrêts et transferts ont été ajoutés
+//! \post les voyages d'une route sont triés par heure et aucun ne dépasse le précédent à une station de la route
+RouteurRaptor::RouteurRaptor(const DonneesGTFS &p_gtfs) : m_table(p_gtfs)
+{
+    //regrouper les voyages par suite de stations desservies
+    map<vector<unsigned int>, vector<unsigned int> > voyagesParSuite;
+    for (unsigned int v = 0; v < m_table.getNbVoyages(); ++v)
+    {
+        vector<unsigned int> suite;
+        for (size_t a = m_table.getDebutVoyage(v); a < m_table.getDebutVoyage(v + 1); ++a)
+            suite.push_back(m_table.getStation(a));
+        voyagesParSuite[suite].push_back(v);
+    }
+
+    for (auto &groupe : voyagesParSuite)
+    {
+        const vector<unsigned int> &suite = groupe.first;
+        vector<unsigned int> &voyages = groupe.second;
+        stable_sort(voyages.begin(), voyages.end(), [this](unsigned int v1, unsigned int v2)
+        {
+            return m_table.getArrivee(m_table.getDebutVoyage(v1)) < m_table.getArrivee(m_table.getDebutVoyage(v2));
+        });
+
+        //séparer les voyages en routes sans dépassement: un voyage suit le dernier voyage d'une route
+        //seulement s'il arrive au plus tôt en même temps que lui à chaque station
+        vector<vector<unsigned int> > routes;
+        for (unsigned int v : voyages)
+        {
+            bool place = false;
+            for (vector<unsigned int> &route : routes)
+            {
+                size_t debutDernier = m_table.getDebutVoyage(route.back());
+                size_t debut = m_table.getDebutVoyage(v);
+                bool depasse = false;
+                for (size_t p = 0; p < suite.size() && !depasse; ++p)
+                    depasse = m_table.getArrivee(debut + p) < m_table.getArrivee(debutDernier + p);
+                if (!depasse)
+                {
+                    route.push_back(v);
+                    place = true;
+                    break;
+                }
+            }
+            if (!place) routes.push_back(vector<unsigned int>(1, v));
+        }
+
+        for (const vector<unsigned int> &route : routes)
+        {
+            m_routes.push_back({m_stationsRoutes.size(), (unsigned int) suite.size(),
+                                m_voyagesRoutes.size(), (unsigned int) route.size(), m_heures.size()});
+            m_stationsRoutes.insert(m_stationsRoutes.end(), suite.begin(), suite.end());
+            m_voyagesRoutes.insert(m_voyagesRoutes.end(), route.begin(), route.end());
+            for (unsigned int v : route)
+                for (size_t a = m_table.getDebutVoyage(v); a < m_table.getDebutVoyage(v + 1); ++a)
+                    m_heures.push_back(m_table.getArrivee(a));
+        }
+    }
+
+    //routes desservant chaque station, avec la position de la station dans la route
+    vector<size_t> nbRoutes(m_table.getNbStations() + 1, 0);
+    for (unsigned int s : m_stationsRoutes) ++nbRoutes[s + 1];
+    m_debutRoutesStation.assign(m_table.getNbStations() + 1, 0);
+    for (unsigned int s = 1; s <= m_table.getNbStations(); ++s)
+        m_debutRoutesStation[s] = m_debutRoutesStation[s - 1] + nbRoutes[s];
+    m_routesStation.resize(m_stationsRoutes.size());
+    vector<size_t> prochain(m_debutRoutesStation.begin(), m_debutRoutesStation.end() - 1);
+    for (unsigned int r = 0; r < m_routes.size(); ++r)
+        for (unsigned int p = 0; p < m_routes[r].nbStations; ++p)
+            m_routesStation[prochain[m_stationsRoutes[m_routes[r].debutStations + p]]++] = {r, p};
+}
+
+size_t RouteurRaptor::getNbRoutes() const
+{
+    return m_routes.size();
+}
+
+//! \brief améliore l'étiquette de p_station si p_heure est meilleure que toute arrivée connue et que p_borne
+//! \return true si l'étiquette a été améliorée
+bool RouteurRaptor::ameliorer(unsigned int p_station, unsigned int p_heure, size_t p_arret, Acces p_acces,
+                              size_t p_precedent, vector<Etiquette> &p_etiquettes, vector<unsigned int> &p_meilleure,
+                              unsigned int p_borne) const
+{
+    if (p_heure >= p_meilleure[p_station] || p_heure >= p_borne) return false;
+    p_meilleure[p_station] = p_heure;
+    p_etiquettes[p_station] = {p_heure, p_acces, p_arret, p_precedent};
+    return true;
+}
+
+//! \brief propage les arrivées des stations marquées de p_espace par les transferts, qui peuvent s'enchaîner
+//! \brief Les stations sont traitées en ordre d'heure d'arrivée: un transfert ne mène jamais plus tôt que sa station,
+//! \brief si bien que chacune relâche ses transferts une seule fois, à partir de sa meilleure étiquette de la ronde.
+//! \param[in,out] p_espace: les stations atteintes par transfert sont ajoutées à ses stations marquées
+void RouteurRaptor::propagerTransferts(Espace &p_espace, vector<Etiquette> &p_etiquettes, unsigned int p_borne) const
+{
+    vector<pair<unsigned int, unsigned int> > &aPropager = p_espace.m_aPropager;
+    const auto plusTard = greater<pair<unsigned int, unsigned int> >();
+    aPropager.clear();
+    for (unsigned int station : p_espace.m_marquees)
+        aPropager.push_back({p_etiquettes[station].heure, station});
+    make_heap(aPropager.begin(), aPropager.end(), plusTard);
+    while (!aPropager.empty())
+    {
+        unsigned int heure = aPropager.front().first;
+        unsigned int station = aPropager.front().second;
+        pop_heap(aPropager.begin(), aPropager.end(), plusTard);
+        aPropager.pop_back();
+        const Etiquette etiquette = p_etiquettes[station];
+        if (etiquette.heure != heure) continue; //améliorée depuis: relâchée à partir de sa nouvelle étiquette
+        for (size_t k = m_table.getDebutTransferts(station); k < m_table.getDebutTransferts(station + 1); ++k)
+        {
+            const pair<unsigned int, unsigned int> &transfert = m_table.getTransfert(k);
+            unsigned int rang = m_table.premierRangApres(transfert.first, etiquette.heure + transfert.second);
+            if (rang == m_table.getNbArretsStation(transfert.first)) continue;
+            unsigned int arrivee = m_table.getArriveeStation(transfert.first, rang);
+            if (ameliorer(transfert.first, arrivee, m_table.getArretStation(transfert.first, rang), Acces::TRANSFERT,
+                          etiquette.arret, p_etiquettes, p_espace.m_meilleure, p_borne))
+            {
+                aPropager.push_back({arrivee, transfert.first});
+                push_heap(aPropager.begin(), aPropager.end(), plusTard);
+                if (!p_espace.m_estMarquee[transfert.first])
+                {
+                    p_espace.m_estMarquee[transfert.first] = true;
+                    p_espace.m_marquees.push_back(transfert.first);
+                }
+            }
+        }
+    }
+}
+
+//! \brief Trouve les trajets non dominés selon (heure d'arrivée, nombre d'autobus) en partant du point origine à getTempsDebut()
+//! \param[in] p_gtfs: l'objet DonneesGTFS utilisé pour construire le routeur
+//! \param[in] p_pointOrigine: les coordonnées GPS du point origine
+//! \param[in] p_pointDestination: les coordonnées GPS du point destination
+//! \param[out] p_trajets: les trajets, par nombre croissant d'autobus (et donc par durée décroissante)
+//! \param[out] p_tempsExecution: le temps d'exécution, en microsecondes, des rondes
+//! \throws logic_error si un problème survient durant l'exécution de la méthode
+void RouteurRaptor::itineraires(const DonneesGTFS &p_gtfs, const Coordonnees &p_pointOrigine,
+                                const Coordonnees &p_pointDestination, vector<TrajetRaptor> &p_trajets,
+                                long &p_tempsExecution) const
+{
+    Espace espace;
+    itineraires(p_gtfs, p_pointOrigine, p_pointDestination, p_trajets, p_tempsExecution, espace);
+}
+
+//! \brief Identique à itineraires(p_gtfs, p_pointOrigine, p_pointDestination, p_trajets, p_tempsExecution)
+//! \brief Le routeur n'est que consulté: plusieurs requêtes peuvent s'exécuter en même temps, chacune avec son espace.
+//! \param[in,out] p_espace: l'espace de travail de la requête, réutilisé d'une requête à l'autre par l'appelant
+void RouteurRaptor::itineraires(const DonneesGTFS &p_gtfs, const Coordonnees &p_pointOrigine,
+                                const Coordonnees &p_pointDestination, vector<TrajetRaptor> &p_trajets,
+                                long &p_tempsExecution, Espace &p_espace) const
+{
+    timeval tv1;
+    timeval tv2;
+    if (gettimeofday(&tv1, 0) != 0)
+        throw logic_error("RouteurRaptor::itineraires(): gettimeofday() a échoué pour tv1");
+
+    p_trajets.clear();
+    const unsigned int tempsDebut = TableArrets::enSecondes(p_gtfs.getTempsDebut());
+    const unsigned int nbStations = m_table.getNbStations();
+
+    vector<pair<unsigned int, double> > &accessibles = p_espace.m_accessibles;
+    vector<pair<unsigned int, unsigned int> > &destinations = p_espace.m_destinations;
+    destinations.clear();
+    m_table.stationsAccessibles(p_pointDestination, ReseauGTFS::distanceMaxMarche, accessibles);
+    for (const auto &station : accessibles)
+        destinations.push_back({station.first, (unsigned int) ((station.second / ReseauGTFS::vitesseDeMarche) * 3600)});
+
+    vector<vector<Etiquette> > &rondes = p_espace.m_rondes;
+    if (rondes.empty()) rondes.resize(1);
+    rondes[0].assign(nbStations, {aucuneHeure, Acces::AUCUN, aucunArret, aucunArret});
+    vector<unsigned int> &meilleure = p_espace.m_meilleure;
+    meilleure.assign(nbStations, aucuneHeure);
+    vector<unsigned int> &marquees = p_espace.m_marquees;
+    marquees.clear();
+    vector<bool> &estMarquee = p_espace.m_estMarquee;
+    estMarquee.assign(nbStations, false);
+    unsigned int meilleureArrivee = aucuneHeure; //la meilleure arrivée au point destination
+
+    //ronde 0: à pieds du point origine vers le premier arrêt atteignable de chaque station accessible
+    m_table.stationsAccessibles(p_pointOrigine, ReseauGTFS::distanceMaxMarche, accessibles);
+    for (const auto &station : accessibles)
+    {
+        unsigned int tempsMarche = (unsigned int) round((station.second / ReseauGTFS::vitesseDeMarche) * 3600);
+        unsigned int rang = m_table.premierRangApres(station.first, tempsDebut + tempsMarche);
+        if (rang == m_table.getNbArretsStation(station.first)) continue;
+        if (ameliorer(station.first, m_table.getArriveeStation(station.first, rang),
+                      m_table.getArretStation(station.first, rang), Acces::ORIGINE, aucunArret,
+                      rondes[0], meilleure, aucuneHeure))
+        {
+            estMarquee[station.first] = true;
+            marquees.push_back(station.first);
+        }
+    }
+
+    vector<unsigned int> &premierePosition = p_espace.m_premierePosition;
+    premierePosition.assign(m_routes.size(), aucuneHeure);
+    vector<unsigned int> &routesTouchees = p_espace.m_routesTouchees;
+    for (unsigned int k = 0; !marquees.empty(); ++k)
+    {
+        if (k > 0)
+        {
+            if (rondes.size() == k) rondes.emplace_back();
+            rondes[k] = rondes[k - 1];
+            const vector<Etiquette> &precedente = rondes[k - 1];
+            vector<Etiquette> &courante = rondes[k];
+
+            //les routes passant par une station améliorée, à partir de la première telle station
+            routesTouchees.clear();
+            for (unsigned int station : marquees)
+            {
+                estMarquee[station] = false;
+                for (size_t i = m_debutRoutesStation[station]; i < m_debutRoutesStation[station + 1]; ++i)
+                {
+                    const pair<unsigned int, unsigned int> &routePosition = m_routesStation[i];
+                    if (premierePosition[routePosition.first] == aucuneHeure)
+                        routesTouchees.push_back(routePosition.first);
+                    premierePosition[routePosition.first] = min(premierePosition[routePosition.first],
+                                                                routePosition.second);
+                }
+            }
+            marquees.clear();
+            sort(routesTouchees.begin(), routesTouchees.end());
+
+            //parcourir chaque route avec le voyage le plus tôt auquel on peut monter à bord
+            for (unsigned int r : routesTouchees)
+            {
+                const Route &route = m_routes[r];
+                const unsigned int *heures = m_heures.data() + route.debutHeures;
+                unsigned int voyage = aucunVoyage;
+                size_t embarque = aucunArret;
+                for (unsigned int p = premierePosition[r]; p < route.nbStations; ++p)
+                {
+                    unsigned int station = m_stationsRoutes[route.debutStations + p];
+                    if (voyage != aucunVoyage)
+                    {
+                        size_t arret = m_table.getDebutVoyage(m_voyagesRoutes[route.debutVoyages + voyage]) + p;
+                        if (ameliorer(station, heures[voyage * route.nbStations + p], arret, Acces::VOYAGE, embarque,
+                                      courante, meilleure, meilleureArrivee) && !estMarquee[station])
+                        {
+                            estMarquee[station] = true;
+                            marquees.push_back(station);
+                        }
+                    }
+
+                    //peut-on monter à bord d'un voyage plus tôt à cette station?
+                    unsigned int heure = precedente[station].heure;
+                    if (heure == aucuneHeure) continue;
+                    unsigned int fin = (voyage == aucunVoyage) ? route.nbVoyages : voyage;
+                    unsigned int debut = 0;
+                    while (debut < fin) //premier voyage de [0, fin) qui arrive à la station à partir de heure
+                    {
+                        unsigned int milieu = debut + (fin - debut) / 2;
+                        if (heures[milieu * route.nbStations + p] < heure) debut = milieu + 1;
+                        else fin = milieu;
+                    }
+                    if (debut < ((voyage == aucunVoyage) ? route.nbVoyages : voyage))
+                    {
+                        voyage = debut;
+                        embarque = m_table.getDebutVoyage(m_voyagesRoutes[route.debutVoyages + voyage]) + p;
+                    }
+                }
+                premierePosition[r] = aucuneHeure;
+            }
+        }
+        propagerTransferts(p_espace, rondes[k], meilleureArrivee);
+
+        //le trajet de la ronde k fait partie du front de Pareto s'il arrive plus tôt qu'avec moins d'autobus
+        unsigned int arrivee = aucuneHeure;
+        unsigned int stationFinale = 0;
+        for (const auto &destination : destinations)
+        {
+            unsigned int heure = rondes[k][destination.first].heure;
+            if (heure != aucuneHeure && heure + destination.second < arrivee)
+            {
+                arrivee = heure + destination.second;
+                stationFinale = destination.first;
+            }
+        }
+        if (arrivee < meilleureArrivee)
+        {
+            meilleureArrivee = arrivee;
+            p_trajets.push_back({arrivee - tempsDebut, k, vector<size_t>()});
+            construireChemin(k, stationFinale, rondes, p_trajets.back().chemin);
+        }
+    }
+
+    if (gettimeofday(&tv2, 0) != 0)
+        throw logic_error("RouteurRaptor::itineraires(): gettimeofday() a échoué pour tv2");
+    p_tempsExecution = tempsExecution(tv1, tv2);
+}
+
+//! \brief reconstruit les arrêts parcourus par le trajet de la ronde p_ronde arrivant à p_stationFinale
+//! \param[out] p_chemin: les indices d'arrêts dans le format attendu par ReseauGTFS::afficherItineraire()
+//! \throws logic_error si les étiquettes sont incohérentes
+void RouteurRaptor::construireChemin(unsigned int p_ronde, unsigned int p_stationFinale,
+                                     const vector<vector<Etiquette> > &p_rondes, vector<size_t> &p_chemin) const
+{
+    p_chemin.clear();
+    p_chemin.push_back(m_table.getNbArrets() + 1); //le point destination
+
+    unsigned int ronde = p_ronde;
+    unsigned int station = p_stationFinale;
+    size_t arret = p_rondes[ronde][station].arret;
+    for (size_t nbEtapes = 0; ; ++nbEtapes)
+    {
+        if (nbEtapes > m_table.getNbArrets())
+            throw logic_error("RouteurRaptor::construireChemin(): le chemin contient un cycle");
+
+        //arret est l'arrêt requis à station; on y attend depuis l'arrêt de l'étiquette
+        const Etiquette &etiquette = p_rondes[ronde][station];
+        p_chemin.push_back(arret);
+        if (etiquette.arret != arret) p_chemin.push_back(etiquette.arret);
+
+        if (etiquette.acces == Acces::ORIGINE)
+            break;
+        else if (etiquette.acces == Acces::VOYAGE) //on est monté à bord à etiquette.precedent à la ronde précédente
+        {
+            for (size_t a = etiquette.arret - 1; a > etiquette.precedent; --a)
+                p_chemin.push_back(a);
+            if (ronde == 0)
+                throw logic_error("RouteurRaptor::construireChemin(): voyage à la ronde 0");
+            --ronde;
+        }
+        else if (etiquette.acces != Acces::TRANSFERT)
+            throw logic_error("RouteurRaptor::construireChemin(): station non atteinte sur le chemin");
+        arret = etiquette.precedent;
+        station = m_table.getStation(arret);
+    }
+    p_chemin.push_back(m_table.getNbArrets()); //le point origine
+    reverse(p_chemin.begin(), p_chemin.end());
+}
+
+//! \brief affiche les trajets du front de Pareto avec ReseauGTFS::afficherItineraire()
+//! \param[in] p_afficherItineraire: true si on désire afficher les itinéraires détaillés et false pour un résumé
+void RouteurRaptor::afficherItineraires(const DonneesGTFS &p_gtfs, const vector<TrajetRaptor> &p_trajets,
+                                        bool p_afficherItineraire) const
+{
+    if (p_trajets.empty())
+    {
+        cout << "La destination n'est pas atteignable de l'orignine durant cet intervalle de temps" << endl;
+        return;
+    }
+    for (const TrajetRaptor &trajet : p_trajets)
+    {
+        unsigned int changements = trajet.nbVoyages > 0 ? trajet.nbVoyages - 1 : 0;
+        cout << "Option RAPTOR: " << trajet.nbVoyages << " autobus (" << changements << " changements), arrivée à "
+             << p_gtfs.getTempsDebut().add_secondes(trajet.tempsDuTrajet) << endl;
+        ReseauGTFS::afficherItineraire(p_gtfs, m_table, trajet.chemin, trajet.tempsDuTrajet, p_afficherItineraire);
+    }
+}
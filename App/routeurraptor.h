@@ -0,0 +1,105 @@
+//
+//  routeurraptor.h
+//  Calcul d'itinéraires par rondes (RAPTOR) avec compromis entre l'heure d'arrivée et le nombre d'autobus
+//
+
+#ifndef ROUTEURRAPTOR_H
+#define ROUTEURRAPTOR_H
+
+#include <vector>
+
+#include "DonneesGTFS.h"
+#include "tablearrets.h"
+
+//! \brief  Un trajet du front de Pareto (durée du trajet, nombre d'autobus empruntés)
+struct TrajetRaptor
+{
+    unsigned int tempsDuTrajet; /*!< en secondes depuis le départ du point origine */
+    unsigned int nbVoyages; /*!< le nombre d'autobus empruntés (le nombre de changements d'autobus est nbVoyages - 1) */
+    std::vector<size_t> chemin; /*!< les arrêts parcourus, dans le format de ReseauGTFS::afficherItineraire() */
+};
+
+//! \brief  Routeur RAPTOR (Round-bAsed Public Transit Optimized Router) construit à partir de DonneesGTFS
+//! \brief  Les voyages qui desservent la même suite de stations sans se dépasser sont regroupés en routes. La ronde k
+//! \brief  parcourt une fois chaque route touchée par une station améliorée à la ronde k-1 et donne les heures d'arrivée
+//! \brief  les plus tôt avec au plus k autobus. On obtient ainsi tous les trajets non dominés selon (heure d'arrivée,
+//! \brief  nombre d'autobus). Comme dans ReseauGTFS, une station est atteinte à l'heure d'arrivée d'un de ses arrêts,
+//! \brief  on monte à bord d'un arrêt si on est à la station au plus tard à son heure d'arrivée et les transferts
+//! \brief  peuvent s'enchaîner. À chaque ronde, les transferts des stations marquées sont relâchés en ordre d'heure
+//! \brief  d'arrivée, une seule fois par station.
+class RouteurRaptor
+{
+public:
+
+    class Espace;
+
+    explicit RouteurRaptor(const DonneesGTFS &);
+
+    void itineraires(const DonneesGTFS &, const Coordonnees &, const Coordonnees &,
+                     std::vector<TrajetRaptor> &, long &) const;
+    void itineraires(const DonneesGTFS &, const Coordonnees &, const Coordonnees &,
+                     std::vector<TrajetRaptor> &, long &, Espace &) const;
+    void afficherItineraires(const DonneesGTFS &, const std::vector<TrajetRaptor> &, bool) const;
+    size_t getNbRoutes() const;
+
+private:
+
+    //! \brief une route: des voyages desservant la même suite de stations, triés et sans dépassement
+    struct Route
+    {
+        size_t debutStations; /*!< les stations sont m_stationsRoutes[debutStations..debutStations+nbStations) */
+        unsigned int nbStations;
+        size_t debutVoyages; /*!< les voyages sont m_voyagesRoutes[debutVoyages..debutVoyages+nbVoyages) */
+        unsigned int nbVoyages;
+        size_t debutHeures; /*!< l'heure d'arrivée du voyage i à la position p est m_heures[debutHeures + i*nbStations + p] */
+    };
+
+    enum class Acces {AUCUN, ORIGINE, VOYAGE, TRANSFERT};
+
+    //! \brief l'arrivée la plus tôt à une station pour une ronde donnée, et comment elle a été obtenue
+    struct Etiquette
+    {
+        unsigned int heure;
+        Acces acces;
+        size_t arret; /*!< l'arrêt atteint à la station */
+        size_t precedent; /*!< VOYAGE: l'arrêt où l'on est monté à bord; TRANSFERT: l'arrêt d'où part le transfert */
+    };
+
+    TableArrets m_table;
+    std::vector<Route> m_routes;
+    std::vector<unsigned int> m_stationsRoutes;
+    std::vector<unsigned int> m_voyagesRoutes; /*!< indices de voyage de la TableArrets */
+    std::vector<unsigned int> m_heures;
+    std::vector<size_t> m_debutRoutesStation; /*!< les routes de la station s sont m_routesStation[m_debutRoutesStation[s]..) */
+    std::vector<std::pair<unsigned int, unsigned int> > m_routesStation; /*!< paires (route, position de la station) */
+
+    bool ameliorer(unsigned int, unsigned int, size_t, Acces, size_t, std::vector<Etiquette> &,
+                   std::vector<unsigned int> &, unsigned int) const;
+    void propagerTransferts(Espace &, std::vector<Etiquette> &, unsigned int) const;
+    void construireChemin(unsigned int, unsigned int, const std::vector<std::vector<Etiquette> > &,
+                          std::vector<size_t> &) const;
+};
+
+//! \brief  Tampons réutilisables d'une requête de RouteurRaptor: étiquettes des rondes, stations marquées, routes
+//! \brief  touchées et file des transferts à relâcher
+//! \brief  Les tampons gardent leur capacité d'une requête à l'autre; seules les étiquettes des rondes sont
+//! \brief  réinitialisées, une ronde à la fois.
+//! \note   Un espace ne doit servir qu'à une requête à la fois.
+class RouteurRaptor::Espace
+{
+private:
+
+    friend class RouteurRaptor;
+
+    std::vector<std::vector<Etiquette> > m_rondes; /*!< les étiquettes de chaque ronde (au-delà de la dernière, périmées) */
+    std::vector<unsigned int> m_meilleure; /*!< la meilleure arrivée à chaque station, toutes rondes confondues */
+    std::vector<unsigned int> m_marquees; /*!< les stations améliorées à la ronde courante */
+    std::vector<bool> m_estMarquee;
+    std::vector<unsigned int> m_premierePosition; /*!< par route, la première position d'une station marquée */
+    std::vector<unsigned int> m_routesTouchees;
+    std::vector<std::pair<unsigned int, unsigned int> > m_aPropager; /*!< tas min de paires (heure, station) */
+    std::vector<std::pair<unsigned int, double> > m_accessibles;
+    std::vector<std::pair<unsigned int, unsigned int> > m_destinations; /*!< (station, durée de marche vers la destination) */
+};
+
+#endif //ROUTEURRAPTOR_H
@@ -0,0 +1,222 @@
+//
+//  serviceitineraires.cpp
+//  Service de calcul d'itinéraires simultanés sur un même ReseauGTFS
+//
+
+#include "serviceitineraires.h"
+
+#include <algorithm>
+#include <chrono>
+
+using namespace std;
+
+//! \brief construit un service de p_nbThreads threads
+//! \param[in] p_gtfs: les données GTFS qui ont servi à construire p_reseau
+//! \param[in] p_reseau: le réseau partagé par tous les threads
+//! \param[in] p_nbThreads: le nombre de threads (0 est traité comme 1)
+ServiceItineraires::ServiceItineraires(const DonneesGTFS &p_gtfs, const ReseauGTFS &p_reseau, unsigned int p_nbThreads)
+        : m_gtfs(p_gtfs), m_reseau(&p_reseau), m_tempsReel(nullptr), m_espaces(max(1u, p_nbThreads)), m_nbRequetes(0),
+          m_duree(0), m_serie(0), m_nbOccupes(0), m_arret(false), m_tache(nullptr), m_nbTaches(0), m_prochaine(0),
+          m_erreurs(m_espaces.size())
+{
+    demarrer();
+}
+
+//! \brief construit un service de p_nbThreads threads qui suit les versions de p_reseau
+//! \param[in] p_gtfs: les données GTFS qui ont servi à construire p_reseau
+//! \param[in] p_reseau: le réseau mis à jour en temps réel
+//! \param[in] p_nbThreads: le nombre de threads (0 est traité comme 1)
+ServiceItineraires::ServiceItineraires(const DonneesGTFS &p_gtfs, const ReseauTempsReel &p_reseau,
+                                       unsigned int p_nbThreads)
+        : m_gtfs(p_gtfs), m_reseau(nullptr), m_tempsReel(&p_reseau), m_espaces(max(1u, p_nbThreads)), m_nbRequetes(0),
+          m_duree(0), m_serie(0), m_nbOccupes(0), m_arret(false), m_tache(nullptr), m_nbTaches(0), m_prochaine(0),
+          m_erreurs(m_espaces.size())
+{
+    demarrer();
+}
+
+//! \brief arrête les threads du service, qui doivent avoir fini leur série
+ServiceItineraires::~ServiceItineraires()
+{
+    arreter();
+}
+
+//! \brief démarre les threads 1 à getNbThreads() - 1, qui attendent ensuite les séries
+//! \throws relance l'erreur de création d'un thread, après l'arrêt de ceux déjà démarrés
+void ServiceItineraires::demarrer()
+{
+    try
+    {
+        for (size_t t = 1; t < m_espaces.size(); ++t) m_threads.push_back(thread(&ServiceItineraires::attendreSeries, this, t));
+    }
+    catch (...)
+    {
+        arreter();
+        throw;
+    }
+}
+
+//! \brief réveille les threads pour qu'ils se terminent, puis les attend
+void ServiceItineraires::arreter()
+{
+    {
+        lock_guard<mutex> verrou(m_verrou);
+        m_arret = true;
+    }
+    m_serieDisponible.notify_all();
+    for (thread &t : m_threads) t.join();
+    m_threads.clear();
+}
+
+//! \brief la boucle d'un thread du service: attendre une série, y prendre des tâches, signaler sa fin
+void ServiceItineraires::attendreSeries(size_t p_thread)
+{
+    uint64_t derniere = 0;
+    unique_lock<mutex> verrou(m_verrou);
+    while (true)
+    {
+        m_serieDisponible.wait(verrou, [this, derniere] { return m_arret || m_serie != derniere; });
+        if (m_arret) return;
+        derniere = m_serie;
+        verrou.unlock();
+        travailler(p_thread);
+        verrou.lock();
+        if (--m_nbOccupes == 0) m_serieTerminee.notify_one();
+    }
+}
+
+//! \brief prend les tâches de la série en cours une à la fois jusqu'à ce qu'il n'en reste plus
+void ServiceItineraires::travailler(size_t p_thread)
+{
+    try
+    {
+        for (size_t i = m_prochaine++; i < m_nbTaches; i = m_prochaine++)
+            (*m_tache)(i, m_espaces[p_thread]);
+    }
+    catch (...) //l'erreur est relancée par le thread qui a lancé la série
+    {
+        m_erreurs[p_thread] = current_exception();
+        m_prochaine = m_nbTaches; //les autres threads s'arrêtent après leur tâche courante
+    }
+}
+
+//! \brief le réseau d'une série: la version courante de m_tempsReel, ou le réseau fixe (qui n'est pas possédé)
+std::shared_ptr<const ReseauGTFS> ServiceItineraires::getReseau() const
+{
+    if (m_tempsReel) return m_tempsReel->getReseau();
+    return shared_ptr<const ReseauGTFS>(shared_ptr<const ReseauGTFS>(), m_reseau);
+}
+
+//! \brief répond à une série de requêtes
+//! \param[in] p_requetes: les requêtes
+//! \param[out] p_reponses: p_reponses[i] est la réponse à p_requetes[i]
+//! \throws logic_error si une requête est invalide (par exemple une heure de départ hors de l'intervalle du réseau)
+void ServiceItineraires::repondre(const std::vector<RequeteItineraire> &p_requetes,
+                                  std::vector<ReponseItineraire> &p_reponses)
+{
+    auto debut = chrono::steady_clock::now();
+    shared_ptr<const ReseauGTFS> reseau = getReseau();
+    p_reponses.resize(p_requetes.size());
+    repartir(p_requetes.size(), [this, &reseau, &p_requetes, &p_reponses](size_t p_requete, EspaceRecherche &p_espace)
+    {
+        const RequeteItineraire &requete = p_requetes[p_requete];
+        auto debutSurcouche = chrono::steady_clock::now();
+        Graphe::Surcouche surcouche;
+        reseau->construireSurcouche(m_gtfs, requete.origine, requete.destination, requete.heureDepart, surcouche);
+        ReponseItineraire &reponse = p_reponses[p_requete];
+        auto debutRecherche = chrono::steady_clock::now();
+        reponse.tempsDuTrajet = reseau->getGraphe().plusCourtChemin(surcouche, reponse.chemin, p_espace);
+        ReseauGTFS::enregistrerRequete(
+                chrono::duration<double>(debutRecherche - debutSurcouche).count(),
+                chrono::duration<double>(chrono::steady_clock::now() - debutRecherche).count(),
+                p_espace.getStatistiques(), reponse.tempsDuTrajet, reponse.chemin);
+    });
+    m_nbRequetes += p_requetes.size();
+    m_duree += chrono::duration<double>(chrono::steady_clock::now() - debut).count();
+}
+
+//! \brief calcule la durée du trajet de chaque point origine vers chaque point destination, en partant à p_heureDepart
+//! \brief Les arcs vers les destinations sont construits une fois et partagés par toutes les recherches; chaque
+//! \brief origine fait une seule recherche, arrêtée dès que toutes les destinations sont fixées. Les durées sont
+//! \brief celles que donnerait ReseauGTFS::itineraire() pour chaque paire.
+//! \param[in] p_origines: les points origine
+//! \param[in] p_destinations: les points destination
+//! \param[in] p_heureDepart: l'heure de départ, en secondes depuis minuit, dans l'intervalle du réseau
+//! \param[out] p_matrice: la matrice p_origines.size() x p_destinations.size() des durées
+//! \throws logic_error si p_heureDepart est hors de l'intervalle du réseau
+void ServiceItineraires::calculerMatrice(const std::vector<Coordonnees> &p_origines,
+                                         const std::vector<Coordonnees> &p_destinations, unsigned int p_heureDepart,
+                                         MatriceTrajets &p_matrice)
+{
+    if (p_heureDepart < TableArrets::enSecondes(m_gtfs.getTempsDebut()) ||
+        p_heureDepart >= TableArrets::enSecondes(m_gtfs.getTempsFin()))
+        throw logic_error("ServiceItineraires::calculerMatrice(): l'heure de départ est hors de l'intervalle du réseau");
+
+    shared_ptr<const ReseauGTFS> reseau = getReseau();
+    vector<vector<pair<size_t, unsigned int> > > arrivees(p_destinations.size());
+    for (size_t d = 0; d < p_destinations.size(); ++d)
+        reseau->arcsDestination(p_destinations[d], arrivees[d]);
+    const Graphe::Cibles cibles(reseau->getGraphe().getNbSommets(), arrivees);
+
+    p_matrice = MatriceTrajets(p_origines.size(), p_destinations.size());
+    repartir(p_origines.size(), [&reseau, &p_origines, p_heureDepart, &cibles, &p_matrice](size_t p_origine,
+                                                                                           EspaceRecherche &p_espace)
+    {
+        vector<pair<size_t, unsigned int> > departs;
+        reseau->arcsOrigine(p_origines[p_origine], p_heureDepart, departs);
+        vector<unsigned int> distances;
+        reseau->getGraphe().distancesVersCibles(departs, cibles, distances, p_espace);
+        copy(distances.begin(), distances.end(), p_matrice.getLigne(p_origine));
+    });
+}
+
+//! \brief exécute p_tache(i, espace) pour chaque i de [0, p_nbTaches) avec les threads du service
+//! \brief Les threads prennent les tâches une à la fois à l'aide d'un compteur partagé, ce qui répartit la charge
+//! \brief même si les tâches ont des coûts inégaux; chaque thread passe son propre EspaceRecherche. Le thread
+//! \brief appelant est le thread 0; il attend que les autres aient fini leur dernière tâche.
+//! \throws relance la première erreur survenue dans une tâche, après la fin de la série dans tous les threads
+void ServiceItineraires::repartir(size_t p_nbTaches, const std::function<void(size_t, EspaceRecherche &)> &p_tache)
+{
+    {
+        lock_guard<mutex> verrou(m_verrou);
+        m_tache = &p_tache;
+        m_nbTaches = p_nbTaches;
+        m_prochaine = 0;
+        fill(m_erreurs.begin(), m_erreurs.end(), exception_ptr());
+        m_nbOccupes = m_threads.size();
+        ++m_serie;
+    }
+    m_serieDisponible.notify_all();
+    travailler(0);
+    {
+        unique_lock<mutex> verrou(m_verrou);
+        m_serieTerminee.wait(verrou, [this] { return m_nbOccupes == 0; });
+        m_tache = nullptr;
+    }
+
+    for (const exception_ptr &erreur : m_erreurs)
+        if (erreur) rethrow_exception(erreur);
+}
+
+unsigned int ServiceItineraires::getNbThreads() const
+{
+    return (unsigned int) m_espaces.size();
+}
+
+//! \brief le nombre de requêtes répondues depuis la construction du service
+size_t ServiceItineraires::getNbRequetes() const
+{
+    return m_nbRequetes;
+}
+
+//! \brief le temps total, en secondes, passé à répondre aux requêtes depuis la construction du service
+double ServiceItineraires::getDuree() const
+{
+    return m_duree;
+}
+
+//! \brief le débit moyen du service depuis sa construction (0 si aucune requête n'a été répondue)
+double ServiceItineraires::getRequetesParSeconde() const
+{
+    return m_duree > 0 ? m_nbRequetes / m_duree : 0;
+}
@@ -0,0 +1,99 @@
+//
+//  serviceitineraires.h
+//  Service de calcul d'itinéraires simultanés sur un même ReseauGTFS
+//
+
+#ifndef SERVICEITINERAIRES_H
+#define SERVICEITINERAIRES_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ReseauGTFS.h"
+#include "reseautempsreel.h"
+#include "matricetrajets.h"
+
+//! \brief une requête d'itinéraire: partir de origine à heureDepart (en secondes depuis minuit) vers destination
+struct RequeteItineraire
+{
+    Coordonnees origine;
+    Coordonnees destination;
+    unsigned int heureDepart;
+};
+
+//! \brief la réponse à une RequeteItineraire
+struct ReponseItineraire
+{
+    unsigned int tempsDuTrajet; /*!< en secondes (numeric_limits<unsigned int>::max() si la destination est inatteignable) */
+    std::vector<size_t> chemin; /*!< les sommets du chemin, comme pour ReseauGTFS::afficherItineraire() */
+};
+
+//! \brief  Répond à des séries de requêtes d'itinéraires avec plusieurs threads qui partagent un seul ReseauGTFS
+//! \brief  Le réseau et les données GTFS ne sont que consultés: chaque requête a sa propre surcouche
+//! \brief  origine/destination et chaque thread son propre EspaceRecherche, conservé d'une série à l'autre.
+//! \brief  Les threads se répartissent les requêtes d'une série une à la fois; la réponse i est celle de la requête i,
+//! \brief  quel que soit le nombre de threads. Le débit (requêtes par seconde) des séries est cumulé.
+//! \brief  Les threads sont démarrés par le constructeur et attendent les séries sur une variable de condition: une
+//! \brief  série ne crée aucun thread, et le thread qui appelle repondre() y participe. Le destructeur les arrête.
+//! \brief  Le service calcule aussi des matrices de durées: une seule recherche par origine atteint toutes les
+//! \brief  destinations, et les threads se répartissent les origines.
+//! \brief  Construit sur un ReseauTempsReel, le service prend la version courante du réseau au début de chaque série:
+//! \brief  toutes les requêtes d'une série voient la même version, même si des retards sont publiés entre-temps.
+//! \note   Le réseau et les données doivent exister tant que le service existe; une série à la fois par service.
+class ServiceItineraires
+{
+public:
+
+    ServiceItineraires(const DonneesGTFS &, const ReseauGTFS &, unsigned int);
+    ServiceItineraires(const DonneesGTFS &, const ReseauTempsReel &, unsigned int);
+    ~ServiceItineraires();
+
+    void repondre(const std::vector<RequeteItineraire> &, std::vector<ReponseItineraire> &);
+    void calculerMatrice(const std::vector<Coordonnees> &, const std::vector<Coordonnees> &, unsigned int,
+                         MatriceTrajets &);
+
+    unsigned int getNbThreads() const;
+    size_t getNbRequetes() const;
+    double getDuree() const;
+    double getRequetesParSeconde() const;
+
+private:
+
+    ServiceItineraires(const ServiceItineraires &);
+    ServiceItineraires &operator=(const ServiceItineraires &);
+
+    const DonneesGTFS &m_gtfs;
+    const ReseauGTFS *m_reseau; //le réseau fixe, ou nullptr si le service suit m_tempsReel
+    const ReseauTempsReel *m_tempsReel;
+    std::vector<EspaceRecherche> m_espaces; //un par thread
+    size_t m_nbRequetes; //le nombre de requêtes répondues depuis la construction
+    double m_duree; //le temps total passé dans repondre(), en secondes
+
+    //la série en cours, partagée avec les threads (les champs non atomiques sont protégés par m_verrou)
+    std::vector<std::thread> m_threads; //les threads 1 à getNbThreads() - 1; le thread 0 est celui de l'appelant
+    std::mutex m_verrou;
+    std::condition_variable m_serieDisponible; //une série commence, ou le service est détruit
+    std::condition_variable m_serieTerminee; //le dernier thread occupé a fini la série
+    uint64_t m_serie; //le numéro de la dernière série commencée
+    size_t m_nbOccupes; //les threads de m_threads qui n'ont pas fini la série
+    bool m_arret;
+    const std::function<void(size_t, EspaceRecherche &)> *m_tache;
+    size_t m_nbTaches;
+    std::atomic<size_t> m_prochaine; //la prochaine tâche à prendre
+    std::vector<std::exception_ptr> m_erreurs; //une par thread
+
+    std::shared_ptr<const ReseauGTFS> getReseau() const;
+    void demarrer();
+    void arreter();
+    void attendreSeries(size_t p_thread);
+    void travailler(size_t p_thread);
+    void repartir(size_t p_nbTaches, const std::function<void(size_t, EspaceRecherche &)> &p_tache);
+};
+
+#endif //SERVICEITINERAIRES_H
@@ -75,6 +75,30 @@ void Station::addArret(const Arret::Ptr &p_arret)
     m_arrets.insert({p_arret->getHeureArrivee(), p_arret});
 }
 
+//! \brief enlève les arrêts dont l'heure de départ précède p_heure (ils arrivent tous avant p_heure)
+//! \return le nombre d'arrêts enlevés
+unsigned int Station::enleverArretsPartis(const Heure &p_heure)
+{
+    unsigned int nbEnleves = 0;
+    auto fin = m_arrets.lower_bound(p_heure);
+    for (auto itr = m_arrets.begin(); itr != fin;)
+    {
+        if (itr->second->getHeureDepart() < p_heure)
+        {
+            itr = m_arrets.erase(itr);
+            ++nbEnleves;
+        }
+        else ++itr;
+    }
+    return nbEnleves;
+}
+
+//! \brief enlève tous les arrêts de la station et rend la mémoire de son conteneur
+void Station::viderArrets()
+{
+    std::multimap<Heure, Arret::Ptr>().swap(m_arrets);
+}
+
 //! \brief retourne le conteneur m_arrets par référence constante
 const std::multimap<Heure, Arret::Ptr> &Station::getArrets() const
 {
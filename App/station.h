@@ -32,6 +32,8 @@ public:
 	const std::string& getNom() const;
 	unsigned int getId() const;
     void addArret(const Arret::Ptr & p_arret);
+    unsigned int enleverArretsPartis(const Heure & p_heure);
+    void viderArrets();
     unsigned int getNbArrets() const;
     const std::multimap<Heure, Arret::Ptr> & getArrets() const;
 
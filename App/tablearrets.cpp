@@ -0,0 +1,319 @@
+//
+//  tablearrets.cpp
+//  Table des arrêts en colonnes (un arrêt par sommet du graphe de ReseauGTFS)
+//
+
+#include "tablearrets.h"
+
+using namespace std;
+
+const size_t TableArrets::aucunArret;
+const unsigned int TableArrets::aucuneStation;
+const unsigned int TableArrets::aucunVoyage;
+
+//! \brief construit la table des arrêts à partir des données GTFS
+//! \param[in] p_gtfs: un objet DonneesGTFS dont tous les arrêts et transferts ont été ajoutés
+//! \throws logic_error si un arrêt ou un transfert réfère à une station absente, ou si les arrêts de p_gtfs ont été
+//! \throws libérés (DonneesGTFS::libererArrets())
+TableArrets::TableArrets(const DonneesGTFS &p_gtfs)
+{
+    if (p_gtfs.getArretsLiberes())
+        throw logic_error("TableArrets::TableArrets(): les arrêts de l'objet GTFS ont été libérés");
+    const map<unsigned int, Station> &stations = p_gtfs.getStations();
+    construireStations(p_gtfs);
+
+    //arrêts, voyage par voyage (même numérotation que les sommets de ReseauGTFS)
+    size_t nbArrets = p_gtfs.getNbArrets();
+    m_arrivee.reserve(nbArrets);
+    m_station.reserve(nbArrets);
+    m_voyage.reserve(nbArrets);
+    m_depart.reserve(nbArrets);
+    m_sequence.reserve(nbArrets);
+    m_debutVoyage.reserve(p_gtfs.getNbVoyages() + 1);
+    m_idsVoyages.reserve(p_gtfs.getNbVoyages());
+    unordered_map<const Arret *, size_t> numeroArret;
+    numeroArret.reserve(nbArrets);
+    for (const auto &voyage : p_gtfs.getVoyages())
+    {
+        m_debutVoyage.push_back(m_arrivee.size());
+        m_idsVoyages.push_back(voyage.first);
+        for (const Arret::Ptr &a_ptr : voyage.second.getArrets())
+        {
+            numeroArret.insert({a_ptr.get(), m_arrivee.size()});
+            m_arrivee.push_back(enSecondes(a_ptr->getHeureArrivee()));
+            m_depart.push_back(enSecondes(a_ptr->getHeureDepart()));
+            m_sequence.push_back(a_ptr->getNumeroSequence());
+            m_station.push_back(getIndiceStation(a_ptr->getStationId()));
+            m_voyage.push_back((unsigned int) m_debutVoyage.size() - 1);
+        }
+    }
+    m_debutVoyage.push_back(m_arrivee.size());
+
+    //arrêts de chaque station, dans l'ordre de Station::getArrets()
+    m_rang.resize(m_arrivee.size());
+    m_debutStation.reserve(stations.size() + 1);
+    m_arretsStation.reserve(m_arrivee.size());
+    m_arriveesStation.reserve(m_arrivee.size());
+    for (const auto &station : stations)
+    {
+        m_debutStation.push_back(m_arretsStation.size());
+        for (const auto &arret : station.second.getArrets())
+        {
+            auto itr = numeroArret.find(arret.second.get());
+            if (itr == numeroArret.end())
+                throw logic_error("TableArrets::TableArrets(): un arrêt de station n'appartient à aucun voyage");
+            m_rang[itr->second] = (unsigned int) (m_arretsStation.size() - m_debutStation.back());
+            m_arretsStation.push_back(itr->second);
+            m_arriveesStation.push_back(m_arrivee[itr->second]);
+        }
+    }
+    m_debutStation.push_back(m_arretsStation.size());
+
+    construireTransferts(p_gtfs);
+}
+
+//! \brief construit la table d'un objet DonneesGTFS dont l'intervalle a été avancé (DonneesGTFS::avancerIntervalle())
+//! \brief à partir de la table de l'intervalle précédent: les arrêts conservés sont recopiés de p_ancienne et seuls
+//! \brief les arrêts ajoutés sont lus des objets Arret. Le résultat est celui de TableArrets(p_gtfs).
+//! \param[in] p_gtfs: l'objet DonneesGTFS après avancerIntervalle()
+//! \param[in] p_ancienne: la table construite avant avancerIntervalle()
+//! \param[in] p_ajoutes: les arrêts ajoutés par avancerIntervalle()
+//! \param[out] p_ancienNumero: pour chaque arrêt de la table, son numéro dans p_ancienne (aucunArret s'il a été ajouté)
+//! \throws logic_error si un arrêt ajouté n'appartient à aucun voyage ou réfère à une station absente
+TableArrets::TableArrets(const DonneesGTFS &p_gtfs, const TableArrets &p_ancienne,
+                         const std::vector<Arret::Ptr> &p_ajoutes, std::vector<size_t> &p_ancienNumero)
+{
+    construireStations(p_gtfs);
+    const unsigned int debut = enSecondes(p_gtfs.getTempsDebut());
+
+    //les arrêts ajoutés, par voyage puis par numéro de séquence (l'ordre des sommets)
+    vector<size_t> ordre(p_ajoutes.size());
+    for (size_t k = 0; k < ordre.size(); ++k) ordre[k] = k;
+    stable_sort(ordre.begin(), ordre.end(), [&p_ajoutes](size_t p_a, size_t p_b)
+    {
+        if (p_ajoutes[p_a]->getVoyageId() != p_ajoutes[p_b]->getVoyageId())
+            return p_ajoutes[p_a]->getVoyageId() < p_ajoutes[p_b]->getVoyageId();
+        return p_ajoutes[p_a]->getNumeroSequence() < p_ajoutes[p_b]->getNumeroSequence();
+    });
+
+    //arrêts, voyage par voyage: les arrêts conservés d'un voyage précèdent ses arrêts ajoutés, qui arrivent plus tard
+    size_t nbArrets = p_gtfs.getNbArrets();
+    m_arrivee.reserve(nbArrets);
+    m_station.reserve(nbArrets);
+    m_voyage.reserve(nbArrets);
+    m_depart.reserve(nbArrets);
+    m_sequence.reserve(nbArrets);
+    m_debutVoyage.reserve(p_gtfs.getNbVoyages() + 1);
+    m_idsVoyages.reserve(p_gtfs.getNbVoyages());
+    p_ancienNumero.clear();
+    p_ancienNumero.reserve(nbArrets);
+    vector<size_t> numeroAjout(p_ajoutes.size(), aucunArret);
+    size_t k = 0;
+    for (const auto &voyage : p_gtfs.getVoyages())
+    {
+        unsigned int v = (unsigned int) m_debutVoyage.size();
+        m_debutVoyage.push_back(m_arrivee.size());
+        m_idsVoyages.push_back(voyage.first);
+        //les voyages des deux tables sont en ordre de trip_id interné
+        auto itr = lower_bound(p_ancienne.m_idsVoyages.begin(), p_ancienne.m_idsVoyages.end(), voyage.first);
+        if (itr != p_ancienne.m_idsVoyages.end() && *itr == voyage.first)
+        {
+            unsigned int ancien = (unsigned int) (itr - p_ancienne.m_idsVoyages.begin());
+            for (size_t a = p_ancienne.getDebutVoyage(ancien); a < p_ancienne.getDebutVoyage(ancien + 1); ++a)
+            {
+                if (p_ancienne.m_depart[a] < debut) continue; //parti avant le nouvel intervalle
+                m_arrivee.push_back(p_ancienne.m_arrivee[a]);
+                m_depart.push_back(p_ancienne.m_depart[a]);
+                m_sequence.push_back(p_ancienne.m_sequence[a]);
+                m_station.push_back(getIndiceStation(p_ancienne.getStationId(p_ancienne.m_station[a])));
+                m_voyage.push_back(v);
+                p_ancienNumero.push_back(a);
+            }
+        }
+        for (; k < ordre.size() && p_ajoutes[ordre[k]]->getVoyageId() == voyage.first; ++k)
+        {
+            const Arret &arret = *p_ajoutes[ordre[k]];
+            numeroAjout[ordre[k]] = m_arrivee.size();
+            m_arrivee.push_back(enSecondes(arret.getHeureArrivee()));
+            m_depart.push_back(enSecondes(arret.getHeureDepart()));
+            m_sequence.push_back(arret.getNumeroSequence());
+            m_station.push_back(getIndiceStation(arret.getStationId()));
+            m_voyage.push_back(v);
+            p_ancienNumero.push_back(aucunArret);
+        }
+    }
+    m_debutVoyage.push_back(m_arrivee.size());
+    if (k != ordre.size())
+        throw logic_error("TableArrets::TableArrets(): un arrêt ajouté n'appartient à aucun voyage");
+
+    //arrêts de chaque station: les arrêts conservés dans leur ordre, puis les arrêts ajoutés par heure d'arrivée (dans
+    //l'ordre d'ajout pour une même heure), comme dans Station::getArrets()
+    vector<size_t> nouveauNumero(p_ancienne.getNbArrets(), aucunArret);
+    for (size_t a = 0; a < p_ancienNumero.size(); ++a)
+        if (p_ancienNumero[a] != aucunArret) nouveauNumero[p_ancienNumero[a]] = a;
+    vector<vector<size_t> > ajoutsStation(m_stationIds.size());
+    for (size_t ajout = 0; ajout < p_ajoutes.size(); ++ajout)
+        ajoutsStation[m_station[numeroAjout[ajout]]].push_back(numeroAjout[ajout]);
+
+    m_rang.resize(m_arrivee.size());
+    m_debutStation.reserve(m_stationIds.size() + 1);
+    m_arretsStation.reserve(m_arrivee.size());
+    m_arriveesStation.reserve(m_arrivee.size());
+    for (unsigned int s = 0; s < m_stationIds.size(); ++s)
+    {
+        m_debutStation.push_back(m_arretsStation.size());
+        auto ajouter = [this](size_t p_arret)
+        {
+            m_rang[p_arret] = (unsigned int) (m_arretsStation.size() - m_debutStation.back());
+            m_arretsStation.push_back(p_arret);
+            m_arriveesStation.push_back(m_arrivee[p_arret]);
+        };
+        auto itr = p_ancienne.m_indiceStation.find(m_stationIds[s]);
+        if (itr != p_ancienne.m_indiceStation.end())
+            for (unsigned int rang = 0; rang < p_ancienne.getNbArretsStation(itr->second); ++rang)
+            {
+                size_t arret = nouveauNumero[p_ancienne.getArretStation(itr->second, rang)];
+                if (arret != aucunArret) ajouter(arret);
+            }
+        stable_sort(ajoutsStation[s].begin(), ajoutsStation[s].end(), [this](size_t p_a, size_t p_b)
+        {
+            return m_arrivee[p_a] < m_arrivee[p_b];
+        });
+        for (size_t arret : ajoutsStation[s]) ajouter(arret);
+    }
+    m_debutStation.push_back(m_arretsStation.size());
+
+    construireTransferts(p_gtfs);
+}
+
+//! \brief les stations de p_gtfs, dans l'ordre de DonneesGTFS::getStations(), et leur index spatial
+void TableArrets::construireStations(const DonneesGTFS &p_gtfs)
+{
+    const map<unsigned int, Station> &stations = p_gtfs.getStations();
+    m_stationIds.reserve(stations.size());
+    m_coords.reserve(stations.size());
+    for (const auto &station : stations)
+    {
+        m_indiceStation.insert({station.first, (unsigned int) m_stationIds.size()});
+        m_stationIds.push_back(station.first);
+        m_coords.push_back(station.second.getCoords());
+    }
+    m_grille = GrilleStations(m_coords);
+}
+
+//! \brief les transferts de p_gtfs regroupés par station de départ
+void TableArrets::construireTransferts(const DonneesGTFS &p_gtfs)
+{
+    const auto &transferts = p_gtfs.getTransferts();
+    vector<size_t> nbTransferts(m_stationIds.size() + 1, 0);
+    for (const auto &t : transferts)
+        ++nbTransferts[getIndiceStation(get<0>(t)) + 1];
+    m_debutTransferts.assign(m_stationIds.size() + 1, 0);
+    for (size_t s = 1; s <= m_stationIds.size(); ++s)
+        m_debutTransferts[s] = m_debutTransferts[s - 1] + nbTransferts[s];
+    m_transferts.resize(transferts.size());
+    vector<size_t> prochain(m_debutTransferts.begin(), m_debutTransferts.end() - 1);
+    for (const auto &t : transferts)
+        m_transferts[prochain[getIndiceStation(get<0>(t))]++] = {getIndiceStation(get<1>(t)), get<2>(t)};
+}
+
+size_t TableArrets::getNbArrets() const
+{
+    return m_arrivee.size();
+}
+
+unsigned int TableArrets::getNbStations() const
+{
+    return (unsigned int) m_stationIds.size();
+}
+
+unsigned int TableArrets::getNbVoyages() const
+{
+    return (unsigned int) m_debutVoyage.size() - 1;
+}
+
+//! \brief retourne le stop_id GTFS de la station d'indice p_station
+unsigned int TableArrets::getStationId(unsigned int p_station) const
+{
+    return m_stationIds[p_station];
+}
+
+//! \brief retourne l'indice de la station dont le stop_id GTFS est p_stationId (aucuneStation si elle est absente)
+unsigned int TableArrets::chercherIndiceStation(unsigned int p_stationId) const
+{
+    auto itr = m_indiceStation.find(p_stationId);
+    return itr == m_indiceStation.end() ? aucuneStation : itr->second;
+}
+
+//! \brief retourne l'indice de la station dont le stop_id GTFS est p_stationId
+//! \throws logic_error si la station est absente
+unsigned int TableArrets::getIndiceStation(unsigned int p_stationId) const
+{
+    auto itr = m_indiceStation.find(p_stationId);
+    if (itr == m_indiceStation.end())
+        throw logic_error("TableArrets::getIndiceStation(): station inexistante");
+    return itr->second;
+}
+
+//! \brief retourne l'indice du voyage dont le trip_id interné est p_idVoyage (aucunVoyage s'il est absent)
+unsigned int TableArrets::chercherVoyage(unsigned int p_idVoyage) const
+{
+    auto itr = lower_bound(m_idsVoyages.begin(), m_idsVoyages.end(), p_idVoyage);
+    if (itr == m_idsVoyages.end() || *itr != p_idVoyage) return aucunVoyage;
+    return (unsigned int) (itr - m_idsVoyages.begin());
+}
+
+const Coordonnees &TableArrets::getCoords(unsigned int p_station) const
+{
+    return m_coords[p_station];
+}
+
+//! \brief retourne le rang du premier arrêt de p_station dont l'heure d'arrivée est >= p_heure
+//! \return getNbArretsStation(p_station) si aucun arrêt n'arrive à partir de p_heure
+//! \note même arrêt que Station::getArrets().lower_bound()
+unsigned int TableArrets::premierRangApres(unsigned int p_station, unsigned int p_heure) const
+{
+    auto debut = m_arriveesStation.begin() + m_debutStation[p_station];
+    auto fin = m_arriveesStation.begin() + m_debutStation[p_station + 1];
+    return (unsigned int) (lower_bound(debut, fin, p_heure) - debut);
+}
+
+//! \brief change les heures d'arrivée et de départ de l'arrêt p_arret (par exemple à cause d'un retard)
+//! \note si l'heure d'arrivée change, trierStation() doit ensuite être appelée pour la station de l'arrêt
+void TableArrets::modifierHeures(size_t p_arret, unsigned int p_arrivee, unsigned int p_depart)
+{
+    m_arrivee[p_arret] = p_arrivee;
+    m_depart[p_arret] = p_depart;
+    m_arriveesStation[m_debutStation[m_station[p_arret]] + m_rang[p_arret]] = p_arrivee;
+}
+
+//! \brief remet les arrêts de p_station en ordre d'heure d'arrivée après modifierHeures(); le tri est stable, les
+//! \brief arrêts qui arrivent à la même heure restent donc dans leur ordre précédent
+void TableArrets::trierStation(unsigned int p_station)
+{
+    auto debut = m_arretsStation.begin() + m_debutStation[p_station];
+    auto fin = m_arretsStation.begin() + m_debutStation[p_station + 1];
+    stable_sort(debut, fin, [this](size_t p_a, size_t p_b)
+    {
+        return m_arrivee[p_a] < m_arrivee[p_b];
+    });
+    for (size_t k = m_debutStation[p_station]; k < m_debutStation[p_station + 1]; ++k)
+    {
+        m_rang[m_arretsStation[k]] = (unsigned int) (k - m_debutStation[p_station]);
+        m_arriveesStation[k] = m_arrivee[m_arretsStation[k]];
+    }
+}
+
+//! \brief trouve les stations situées à au plus p_distanceMax km de p_point
+//! \param[out] p_stations: les paires (indice de station, distance en km), en ordre d'indice de station
+void TableArrets::stationsAccessibles(const Coordonnees &p_point, double p_distanceMax,
+                                      vector<pair<unsigned int, double> > &p_stations) const
+{
+    m_grille.stationsAccessibles(p_point, p_distanceMax, p_stations);
+}
+
+//! \brief retourne le nombre de secondes écoulées depuis minuit à l'heure p_heure
+unsigned int TableArrets::enSecondes(const Heure &p_heure)
+{
+    return (unsigned int) (p_heure - Heure(0, 0, 0));
+}
@@ -0,0 +1,123 @@
+//
+//  tablearrets.h
+//  Table des arrêts en colonnes (un arrêt par sommet du graphe de ReseauGTFS)
+//
+
+#ifndef TABLEARRETS_H
+#define TABLEARRETS_H
+
+#include <vector>
+#include <unordered_map>
+#include <utility>
+
+#include "DonneesGTFS.h"
+#include "grillestations.h"
+
+//! \brief  Table des arrêts d'un objet DonneesGTFS, en colonnes et indexée par des entiers denses
+//! \brief  Elle ne conserve aucun Arret::Ptr: chaque attribut d'un arrêt est une colonne et le trip_id est remplacé
+//! \brief  par l'indice du voyage.
+//! \brief  Les arrêts sont numérotés dans le même ordre que les sommets du graphe de ReseauGTFS (voyage par voyage,
+//! \brief  selon le numéro de séquence); les arrêts d'un voyage sont donc contigus. Les stations sont numérotées selon
+//! \brief  l'ordre de DonneesGTFS::getStations() et leurs arrêts sont conservés dans l'ordre de Station::getArrets().
+//! \brief  Les heures sont en secondes depuis minuit.
+class TableArrets
+{
+public:
+
+    static const size_t aucunArret = static_cast<size_t>(-1);
+    static const unsigned int aucuneStation = static_cast<unsigned int>(-1);
+    static const unsigned int aucunVoyage = static_cast<unsigned int>(-1);
+
+    explicit TableArrets(const DonneesGTFS &);
+    TableArrets(const DonneesGTFS &, const TableArrets &, const std::vector<Arret::Ptr> &, std::vector<size_t> &);
+
+    size_t getNbArrets() const;
+    unsigned int getNbStations() const;
+    unsigned int getNbVoyages() const;
+
+    //! \brief heure d'arrivée (en secondes depuis minuit) de l'arrêt p_arret
+    unsigned int getArrivee(size_t p_arret) const { return m_arrivee[p_arret]; }
+    //! \brief indice de la station de l'arrêt p_arret
+    unsigned int getStation(size_t p_arret) const { return m_station[p_arret]; }
+    //! \brief indice du voyage de l'arrêt p_arret
+    unsigned int getVoyage(size_t p_arret) const { return m_voyage[p_arret]; }
+    //! \brief rang de l'arrêt p_arret parmi les arrêts de sa station
+    unsigned int getRang(size_t p_arret) const { return m_rang[p_arret]; }
+    //! \brief heure de départ (en secondes depuis minuit) de l'arrêt p_arret
+    unsigned int getDepart(size_t p_arret) const { return m_depart[p_arret]; }
+    //! \brief numéro de séquence GTFS de l'arrêt p_arret dans son voyage
+    unsigned int getSequence(size_t p_arret) const { return m_sequence[p_arret]; }
+    //! \brief le trip_id interné du voyage p_voyage (clé de DonneesGTFS::getVoyages())
+    unsigned int getIdVoyage(unsigned int p_voyage) const { return m_idsVoyages[p_voyage]; }
+    unsigned int chercherVoyage(unsigned int p_idVoyage) const;
+
+    unsigned int getStationId(unsigned int p_station) const;
+    unsigned int getIndiceStation(unsigned int p_stationId) const;
+    unsigned int chercherIndiceStation(unsigned int p_stationId) const;
+    const Coordonnees &getCoords(unsigned int p_station) const;
+
+    //! \brief nombre d'arrêts de la station p_station
+    unsigned int getNbArretsStation(unsigned int p_station) const
+    {
+        return (unsigned int) (m_debutStation[p_station + 1] - m_debutStation[p_station]);
+    }
+    //! \brief l'arrêt de rang p_rang de la station p_station
+    size_t getArretStation(unsigned int p_station, unsigned int p_rang) const
+    {
+        return m_arretsStation[m_debutStation[p_station] + p_rang];
+    }
+    //! \brief l'heure d'arrivée de l'arrêt de rang p_rang de la station p_station
+    unsigned int getArriveeStation(unsigned int p_station, unsigned int p_rang) const
+    {
+        return m_arriveesStation[m_debutStation[p_station] + p_rang];
+    }
+    unsigned int premierRangApres(unsigned int p_station, unsigned int p_heure) const;
+
+    //! \brief les arrêts du voyage p_voyage sont [getDebutVoyage(p_voyage), getDebutVoyage(p_voyage + 1))
+    size_t getDebutVoyage(unsigned int p_voyage) const { return m_debutVoyage[p_voyage]; }
+
+    //! \brief les transferts de la station p_station sont les paires (station, durée en secondes)
+    //! \brief d'indices [getDebutTransferts(p_station), getDebutTransferts(p_station + 1))
+    size_t getDebutTransferts(unsigned int p_station) const { return m_debutTransferts[p_station]; }
+    const std::pair<unsigned int, unsigned int> &getTransfert(size_t p_indice) const { return m_transferts[p_indice]; }
+
+    void stationsAccessibles(const Coordonnees &p_point, double p_distanceMax,
+                             std::vector<std::pair<unsigned int, double> > &p_stations) const;
+
+    void modifierHeures(size_t p_arret, unsigned int p_arrivee, unsigned int p_depart);
+    void trierStation(unsigned int p_station);
+
+    static unsigned int enSecondes(const Heure &p_heure);
+
+private:
+
+    void construireStations(const DonneesGTFS &);
+    void construireTransferts(const DonneesGTFS &);
+
+    //colonnes indexées par arrêt
+    std::vector<unsigned int> m_arrivee;
+    std::vector<unsigned int> m_station;
+    std::vector<unsigned int> m_voyage;
+    std::vector<unsigned int> m_rang;
+    std::vector<unsigned int> m_depart;
+    std::vector<unsigned int> m_sequence;
+
+    //stations
+    std::vector<unsigned int> m_stationIds; //m_stationIds[s] est le stop_id de la station d'indice s
+    std::unordered_map<unsigned int, unsigned int> m_indiceStation; //le stop_id vers l'indice de station
+    std::vector<Coordonnees> m_coords;
+    std::vector<size_t> m_debutStation; //les arrêts de la station s sont m_arretsStation[m_debutStation[s]..m_debutStation[s+1])
+    std::vector<size_t> m_arretsStation;
+    std::vector<unsigned int> m_arriveesStation; //m_arriveesStation[k] est l'heure d'arrivée de m_arretsStation[k]
+    GrilleStations m_grille; //index spatial sur m_coords
+
+    //voyages
+    std::vector<size_t> m_debutVoyage;
+    std::vector<unsigned int> m_idsVoyages; //le trip_id interné de chaque voyage
+
+    //transferts
+    std::vector<size_t> m_debutTransferts;
+    std::vector<std::pair<unsigned int, unsigned int> > m_transferts;
+};
+
+#endif //TABLEARRETS_H
@@ -0,0 +1,81 @@
+//
+//  tasradix.cpp
+//  File de priorité monotone (radix heap) pour les algorithmes de plus court chemin
+//
+
+#include "tasradix.h"
+
+using namespace std;
+
+//! \brief Constructeur d'un tas vide
+TasRadix::TasRadix() : m_derniereCle(0), m_taille(0)
+{
+}
+
+//! \brief retourne l'indice du seau d'une clé: 0 si elle est égale à m_derniereCle, sinon 1 + le rang du bit le plus significatif qui diffère
+unsigned int TasRadix::indiceSeau(unsigned int p_cle) const
+{
+    if (p_cle == m_derniereCle) return 0;
+    return 32 - __builtin_clz(p_cle ^ m_derniereCle);
+}
+
+//! \brief insère un élément dans le tas
+//! \param[in] p_cle: la priorité de l'élément
+//! \param[in] p_valeur: l'élément
+//! \throws logic_error lorsque p_cle est inférieure à la dernière clé extraite (le tas est monotone)
+void TasRadix::inserer(unsigned int p_cle, size_t p_valeur)
+{
+    if (p_cle < m_derniereCle)
+        throw logic_error("TasRadix::inserer(): la clé est inférieure à la dernière clé extraite");
+    m_seaux[indiceSeau(p_cle)].push_back({p_cle, p_valeur});
+    ++m_taille;
+}
+
+//! \brief extrait un élément de clé minimale
+//! \param[out] p_cle: la clé de l'élément extrait
+//! \return l'élément extrait
+//! \throws logic_error lorsque le tas est vide
+size_t TasRadix::extraireMin(unsigned int &p_cle)
+{
+    if (m_taille == 0) throw logic_error("TasRadix::extraireMin(): le tas est vide");
+
+    if (m_seaux[0].empty())
+    {
+        //le premier seau non vide contient le minimum; on redistribue ses éléments dans les seaux inférieurs
+        unsigned int b = 1;
+        while (m_seaux[b].empty()) ++b;
+
+        unsigned int cleMin = m_seaux[b][0].cle;
+        for (const Element &e : m_seaux[b])
+            if (e.cle < cleMin) cleMin = e.cle;
+
+        m_derniereCle = cleMin;
+        for (const Element &e : m_seaux[b])
+            m_seaux[indiceSeau(e.cle)].push_back(e);
+        m_seaux[b].clear();
+    }
+
+    Element e = m_seaux[0].back();
+    m_seaux[0].pop_back();
+    --m_taille;
+    p_cle = e.cle;
+    return e.valeur;
+}
+
+bool TasRadix::estVide() const
+{
+    return m_taille == 0;
+}
+
+size_t TasRadix::taille() const
+{
+    return m_taille;
+}
+
+//! \brief vide le tas en conservant la mémoire allouée pour les prochaines recherches
+void TasRadix::vider()
+{
+    for (unsigned int b = 0; b < nbSeaux; ++b) m_seaux[b].clear();
+    m_derniereCle = 0;
+    m_taille = 0;
+}
@@ -0,0 +1,44 @@
+//
+//  tasradix.h
+//  File de priorité monotone (radix heap) pour les algorithmes de plus court chemin
+//
+
+#ifndef TASRADIX_H
+#define TASRADIX_H
+
+#include <vector>
+#include <cstddef>
+#include <stdexcept>
+
+//! \brief  File de priorité monotone (radix heap) à clés entières non négatives
+//! \brief  Les clés insérées ne doivent jamais être inférieures à la dernière clé extraite, ce qui est le cas
+//! \brief  des distances de Dijkstra lorsque les poids sont non négatifs. Chaque élément change au plus 32 fois de seau.
+class TasRadix
+{
+public:
+
+    TasRadix();
+    void inserer(unsigned int p_cle, size_t p_valeur);
+    size_t extraireMin(unsigned int &p_cle);
+    bool estVide() const;
+    size_t taille() const;
+    void vider();
+
+private:
+
+    struct Element
+    {
+        unsigned int cle;
+        size_t valeur;
+    };
+
+    static const unsigned int nbSeaux = 33; /*!< un seau pour la clé égale à m_derniereCle, puis un par bit différent */
+
+    std::vector<Element> m_seaux[nbSeaux]; /*!< m_seaux[b] contient les clés dont le bit le plus significatif différent de m_derniereCle est b-1 */
+    unsigned int m_derniereCle; /*!< la dernière clé extraite (borne inférieure de toutes les clés présentes) */
+    size_t m_taille;
+
+    unsigned int indiceSeau(unsigned int p_cle) const;
+};
+
+#endif //TASRADIX_H
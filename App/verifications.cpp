@@ -0,0 +1,469 @@
+//
+//  verifications.cpp
+//  Vérifications croisées des moteurs de recherche et des structures tirées du réseau
+//
+//  Chaque vérification obtient les mêmes durées de trajet de deux façons (graphe et CSA, flux et fichiers, fenêtre
+//  avancée et reconstruite, ...) et lance logic_error au premier écart. Les fichiers produits (instantané, repères,
+//  motifs, matrice, mises à jour en temps réel) sont écrits dans le dossier de sortie, jamais dans celui du flux.
+//  Usage: verifications [--dossier=RTC-8aout-1dec] [--sortie=dossier] [--requetes=500]
+//         sans --sortie, un dossier temporaire est créé. Le code de retour est 1 si une vérification échoue.
+//
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DonneesGTFS.h"
+#include "ReseauGTFS.h"
+#include "routeurcsa.h"
+#include "routeurraptor.h"
+#include "instantanereseau.h"
+#include "reperes.h"
+#include "motifstransferts.h"
+#include "serviceitineraires.h"
+#include "fluxgtfs.h"
+#include "reseautempsreel.h"
+
+using namespace std;
+
+namespace
+{
+    //! \brief les paramètres de la ligne de commande
+    struct Options
+    {
+        string dossier = "RTC-8aout-1dec";
+        string sortie; //vide: un dossier temporaire
+        unsigned int nbRequetes = 500;
+    };
+
+    Options lireOptions(int argc, char *argv[])
+    {
+        Options options;
+        for (int i = 1; i < argc; ++i)
+        {
+            string argument = argv[i];
+            size_t egal = argument.find('=');
+            string cle = argument.substr(0, egal);
+            string valeur = egal == string::npos ? "" : argument.substr(egal + 1);
+            if (cle == "--dossier") options.dossier = valeur;
+            else if (cle == "--sortie") options.sortie = valeur;
+            else if (cle == "--requetes") options.nbRequetes = (unsigned int) stoul(valeur);
+            else throw logic_error("verifications: option inconnue " + argument);
+        }
+        if (options.nbRequetes < 20)
+            throw logic_error("verifications: --requetes doit être d'au moins 20");
+        return options;
+    }
+
+    double secondesDepuis(chrono::steady_clock::time_point p_debut)
+    {
+        return chrono::duration<double>(chrono::steady_clock::now() - p_debut).count();
+    }
+
+    //! \brief la mémoire résidente du processus (VmRSS de /proc/self/status), en Kio; 0 si elle est inconnue
+    size_t memoireResidente()
+    {
+        ifstream status("/proc/self/status");
+        string ligne;
+        while (getline(status, ligne))
+            if (ligne.compare(0, 6, "VmRSS:") == 0) return stoul(ligne.substr(6));
+        return 0;
+    }
+
+    //! \brief ce que partagent les vérifications: le réseau lu des fichiers et les requêtes tirées avec une graine fixe
+    struct Contexte
+    {
+        Options options;
+        string sortie; //le dossier où sont écrits les fichiers produits
+        Date date;
+        Heure now1;
+        Heure now2;
+        DonneesGTFS &donnees;
+        ReseauGTFS &reseau;
+        vector<RequeteItineraire> requetes; //départs dans les quatre heures qui suivent now1
+        vector<ReponseItineraire> reponses; //les réponses du service séquentiel, qui servent de référence
+        EspaceRecherche espace;
+    };
+
+    //! \brief exécute une vérification et rapporte sa durée; l'exception d'un écart est propagée
+    void verifier(const string &p_nom, const function<void()> &p_verification)
+    {
+        auto debut = chrono::steady_clock::now();
+        p_verification();
+        cout << "ok   " << p_nom << " (" << secondesDepuis(debut) << " secondes)" << endl;
+    }
+
+    //! \brief le CSA, RAPTOR et l'instantané rechargé donnent les durées du graphe, au départ de getTempsDebut()
+    //! \pre les objets Arret n'ont pas encore été libérés: les routeurs et l'instantané sont construits à partir d'eux
+    void verifierMoteurs(Contexte &p_contexte)
+    {
+        const DonneesGTFS &donnees = p_contexte.donnees;
+        RouteurCSA routeurCSA(donnees);
+        RouteurRaptor routeurRaptor(donnees);
+        const string fichierInstantane = p_contexte.sortie + "/reseau.instantane";
+        InstantaneReseau::sauvegarder(donnees, p_contexte.reseau, fichierInstantane);
+        InstantaneReseau instantane(fichierInstantane);
+
+        RouteurCSA::Espace espaceCSA;
+        RouteurRaptor::Espace espaceRaptor;
+        EspaceRecherche espaceInstantane;
+        vector<TrajetRaptor> trajets;
+        for (unsigned int i = 0; i < 50; ++i)
+        {
+            const Coordonnees &origine = p_contexte.requetes[i].origine;
+            const Coordonnees &destination = p_contexte.requetes[i].destination;
+            long tempsExecution(0);
+            const unsigned int tempsDuTrajet = p_contexte.reseau.itineraire(donnees, origine, destination, false,
+                                                                            tempsExecution, p_contexte.espace);
+            if (routeurCSA.itineraire(donnees, origine, destination, false, tempsExecution, espaceCSA) != tempsDuTrajet)
+                throw logic_error("verifierMoteurs(): le CSA et le graphe ne donnent pas la même durée de trajet");
+            routeurRaptor.itineraires(donnees, origine, destination, trajets, tempsExecution, espaceRaptor);
+            if ((trajets.empty() ? numeric_limits<unsigned int>::max() : trajets.back().tempsDuTrajet) != tempsDuTrajet)
+                throw logic_error("verifierMoteurs(): RAPTOR et le graphe ne donnent pas la même durée de trajet");
+            if (instantane.itineraire(origine, destination, false, tempsExecution, espaceInstantane) != tempsDuTrajet)
+                throw logic_error("verifierMoteurs(): l'instantané et le graphe ne donnent pas la même durée de trajet");
+        }
+    }
+
+    //! \brief le service à plusieurs threads donne les durées du service séquentiel, gardées comme référence
+    void verifierService(Contexte &p_contexte)
+    {
+        ServiceItineraires serviceSequentiel(p_contexte.donnees, p_contexte.reseau, 1);
+        serviceSequentiel.repondre(p_contexte.requetes, p_contexte.reponses);
+        vector<ReponseItineraire> reponses;
+        ServiceItineraires service(p_contexte.donnees, p_contexte.reseau, max(2u, thread::hardware_concurrency()));
+        service.repondre(p_contexte.requetes, reponses);
+        for (size_t i = 0; i < reponses.size(); ++i)
+            if (reponses[i].tempsDuTrajet != p_contexte.reponses[i].tempsDuTrajet)
+                throw logic_error("verifierService(): le service simultané et le service séquentiel diffèrent");
+    }
+
+    //! \brief les recherches bidirectionnelle, A* et ALT (repères relus du dossier de sortie) donnent les durées de Dijkstra
+    void verifierRecherches(Contexte &p_contexte)
+    {
+        const ReseauGTFS &reseau = p_contexte.reseau;
+        const string fichierReperes = p_contexte.sortie + "/reseau.reperes";
+        Reperes(reseau, 16, max(1u, thread::hardware_concurrency())).ecrire(fichierReperes);
+        const Reperes reperes = Reperes::lire(fichierReperes, reseau);
+
+        EspaceRecherche &espace = p_contexte.espace;
+        EspaceRecherche espaceArriere;
+        Graphe::Surcouche surcouche;
+        vector<size_t> chemin;
+        for (size_t i = 0; i < p_contexte.requetes.size(); ++i)
+        {
+            const RequeteItineraire &requete = p_contexte.requetes[i];
+            const unsigned int tempsDuTrajet = p_contexte.reponses[i].tempsDuTrajet;
+            reseau.construireSurcouche(p_contexte.donnees, requete.origine, requete.destination, requete.heureDepart,
+                                       surcouche);
+            if (reseau.getGraphe().plusCourtCheminBidirectionnel(reseau.getGrapheInverse(), surcouche, chemin, espace,
+                                                                 espaceArriere) != tempsDuTrajet)
+                throw logic_error("verifierRecherches(): les recherches bidirectionnelle et unidirectionnelle diffèrent");
+            if (reseau.plusCourtCheminGeographique(surcouche, requete.destination, chemin, espace) != tempsDuTrajet)
+                throw logic_error("verifierRecherches(): les recherches A* et de Dijkstra diffèrent");
+            if (reseau.plusCourtCheminReperes(reperes, surcouche, chemin, espace) != tempsDuTrajet)
+                throw logic_error("verifierRecherches(): les recherches ALT et de Dijkstra diffèrent");
+        }
+    }
+
+    //! \brief les motifs de trajets de 100 stations origine donnent les durées de la recherche de Dijkstra du premier
+    //! \brief arrêt pris à l'origine vers tous les arrêts de la destination
+    void verifierMotifs(Contexte &p_contexte)
+    {
+        const ReseauGTFS &reseau = p_contexte.reseau;
+        const TableArrets &table = reseau.getTable();
+        mt19937 generateur(2017);
+        uniform_int_distribution<unsigned int> distributionStations(0, table.getNbStations() - 1);
+        uniform_int_distribution<unsigned int> distributionHeures(0, 4 * 3600);
+        vector<unsigned int> origines;
+        for (unsigned int i = 0; i < 100; ++i) origines.push_back(distributionStations(generateur));
+        const string fichierMotifs = p_contexte.sortie + "/reseau.motifs";
+        MotifsTransferts(reseau, origines, max(1u, thread::hardware_concurrency())).ecrire(fichierMotifs);
+        const MotifsTransferts motifs = MotifsTransferts::lire(fichierMotifs, reseau);
+
+        Graphe::Surcouche surcouche;
+        vector<size_t> chemin;
+        for (size_t i = 0; i < p_contexte.requetes.size(); ++i)
+        {
+            const unsigned int origine = origines[i % origines.size()];
+            const unsigned int destination = distributionStations(generateur);
+            const unsigned int heureDepart = TableArrets::enSecondes(p_contexte.now1) + distributionHeures(generateur);
+            surcouche.departs.clear();
+            surcouche.arrivees.clear();
+            const unsigned int rangDepart = table.premierRangApres(origine, heureDepart);
+            if (rangDepart < table.getNbArretsStation(origine))
+                surcouche.departs.push_back(make_pair(table.getArretStation(origine, rangDepart),
+                                                      table.getArriveeStation(origine, rangDepart) - heureDepart));
+            for (unsigned int rang = 0; rang < table.getNbArretsStation(destination); ++rang)
+                surcouche.arrivees.push_back(make_pair(table.getArretStation(destination, rang), 0u));
+            if (reseau.getGraphe().plusCourtChemin(surcouche, chemin, p_contexte.espace) !=
+                motifs.tempsDuTrajet(origine, destination, heureDepart))
+                throw logic_error("verifierMotifs(): les motifs de trajets et la recherche de Dijkstra diffèrent");
+        }
+    }
+
+    //! \brief les profils des 20 premières requêtes donnent, à toutes les 5 minutes des quatre heures qui suivent now1,
+    //! \brief l'heure d'arrivée d'une requête à heure de départ fixe
+    void verifierProfils(Contexte &p_contexte)
+    {
+        const ReseauGTFS &reseau = p_contexte.reseau;
+        const unsigned int debut = TableArrets::enSecondes(p_contexte.now1);
+        vector<DepartProfil> departs;
+        Graphe::Surcouche surcouche;
+        vector<size_t> chemin;
+        for (unsigned int i = 0; i < 20; ++i)
+        {
+            const RequeteItineraire &requete = p_contexte.requetes[i];
+            reseau.profil(p_contexte.donnees, requete.origine, requete.destination, departs, p_contexte.espace);
+            for (unsigned int heure = debut; heure < debut + 4 * 3600; heure += 300)
+            {
+                reseau.construireSurcouche(p_contexte.donnees, requete.origine, requete.destination, heure, surcouche);
+                unsigned int tempsDuTrajet = reseau.getGraphe().plusCourtChemin(surcouche, chemin, p_contexte.espace);
+                auto prochain = find_if(departs.begin(), departs.end(),
+                                        [heure](const DepartProfil &p_depart) { return p_depart.heureDepart >= heure; });
+                unsigned int arrivee = prochain == departs.end() ? numeric_limits<unsigned int>::max()
+                                                                : prochain->heureArrivee;
+                if ((tempsDuTrajet == numeric_limits<unsigned int>::max() ? tempsDuTrajet : heure + tempsDuTrajet) !=
+                    arrivee)
+                    throw logic_error("verifierProfils(): le profil et le graphe ne donnent pas la même heure d'arrivée");
+            }
+        }
+    }
+
+    //! \brief la matrice entre les 200 premières stations donne les durées du graphe et se relit telle qu'écrite
+    void verifierMatrice(Contexte &p_contexte)
+    {
+        vector<Coordonnees> points;
+        for (const auto &station : p_contexte.donnees.getStations())
+        {
+            if (points.size() == 200) break;
+            points.push_back(station.second.getCoords());
+        }
+        ServiceItineraires service(p_contexte.donnees, p_contexte.reseau, max(1u, thread::hardware_concurrency()));
+        MatriceTrajets matrice;
+        service.calculerMatrice(points, points, TableArrets::enSecondes(p_contexte.now1), matrice);
+        for (size_t o = 0; o < 3 && o < points.size(); ++o)
+            for (size_t d = 0; d < points.size(); ++d)
+            {
+                long tempsExecution(0);
+                if (p_contexte.reseau.itineraire(p_contexte.donnees, points[o], points[d], false, tempsExecution,
+                                                 p_contexte.espace) != matrice.getTempsDuTrajet(o, d))
+                    throw logic_error("verifierMatrice(): la matrice et le graphe ne donnent pas la même durée de trajet");
+            }
+        matrice.ecrireCSV(p_contexte.sortie + "/matrice.csv");
+        matrice.ecrireBinaire(p_contexte.sortie + "/matrice.bin");
+        MatriceTrajets relue = MatriceTrajets::lireBinaire(p_contexte.sortie + "/matrice.bin");
+        for (size_t o = 0; o < points.size(); ++o)
+            for (size_t d = 0; d < points.size(); ++d)
+                if (relue.getTempsDuTrajet(o, d) != matrice.getTempsDuTrajet(o, d))
+                    throw logic_error("verifierMatrice(): la matrice relue diffère de la matrice écrite");
+    }
+
+    //! \brief les données et le réseau tirés du flux sont ceux lus des fichiers
+    void verifierFlux(Contexte &p_contexte, const FluxGTFS &p_flux)
+    {
+        const DonneesGTFS &donnees = p_contexte.donnees;
+        DonneesGTFS donneesFlux(p_flux, p_contexte.date, p_contexte.now1, p_contexte.now2);
+        if (donneesFlux.getNbArrets() != donnees.getNbArrets() || donneesFlux.getNbVoyages() != donnees.getNbVoyages() ||
+            donneesFlux.getNbStations() != donnees.getNbStations() ||
+            donneesFlux.getNbTransferts() != donnees.getNbTransferts())
+            throw logic_error("verifierFlux(): les données tirées du flux diffèrent des données lues des fichiers");
+        ReseauGTFS reseauFlux(donneesFlux);
+        for (unsigned int i = 0; i < 20; ++i)
+        {
+            const RequeteItineraire &requete = p_contexte.requetes[i];
+            long tempsExecution(0);
+            if (reseauFlux.itineraire(donneesFlux, requete.origine, requete.destination, false, tempsExecution,
+                                      p_contexte.espace) !=
+                p_contexte.reseau.itineraire(donnees, requete.origine, requete.destination, false, tempsExecution,
+                                             p_contexte.espace))
+                throw logic_error("verifierFlux(): le réseau tiré du flux et le réseau lu des fichiers diffèrent");
+        }
+    }
+
+    //! \brief une fenêtre de trois heures avancée 6 fois de 10 minutes est le réseau reconstruit sur le même intervalle
+    void verifierFenetre(Contexte &p_contexte, const FluxGTFS &p_flux)
+    {
+        Heure debut = p_contexte.now1;
+        DonneesGTFS donneesFenetre(p_flux, p_contexte.date, debut, debut.add_secondes(3 * 3600));
+        ReseauGTFS reseauFenetre(donneesFenetre);
+        vector<Arret::Ptr> ajoutes;
+        for (unsigned int pas = 0; pas < 6; ++pas)
+        {
+            debut = debut.add_secondes(600);
+            donneesFenetre.avancerIntervalle(p_flux, debut, debut.add_secondes(3 * 3600), ajoutes);
+            reseauFenetre.avancerIntervalle(donneesFenetre, ajoutes);
+
+            DonneesGTFS donneesReconstruites(p_flux, p_contexte.date, debut, debut.add_secondes(3 * 3600));
+            ReseauGTFS reseauReconstruit(donneesReconstruites);
+            if (reseauFenetre.getNbSommets() != reseauReconstruit.getNbSommets() ||
+                reseauFenetre.getGraphe().getNbArcs() != reseauReconstruit.getGraphe().getNbArcs())
+                throw logic_error("verifierFenetre(): le réseau avancé et le réseau reconstruit n'ont pas la même taille");
+            for (unsigned int i = 0; i < 20; ++i)
+            {
+                const RequeteItineraire &requete = p_contexte.requetes[i];
+                long tempsExecution(0);
+                if (reseauFenetre.itineraire(donneesFenetre, requete.origine, requete.destination, false,
+                                             tempsExecution, p_contexte.espace) !=
+                    reseauReconstruit.itineraire(donneesReconstruites, requete.origine, requete.destination, false,
+                                                 tempsExecution, p_contexte.espace))
+                    throw logic_error("verifierFenetre(): le réseau avancé et le réseau reconstruit diffèrent");
+            }
+        }
+    }
+
+    //! \brief des retards de 4 minutes déposés dans temps-reel/ pendant que le service répond sont appliqués, et des
+    //! \brief retards nuls redonnent les durées de l'horaire
+    void verifierTempsReel(Contexte &p_contexte)
+    {
+        const string dossier = preparerDossierSortie(p_contexte.sortie + "/temps-reel");
+        const TableArrets &table = p_contexte.reseau.getTable();
+        auto ecrireRetards = [&](const string &p_nomFichier, int p_retard)
+        {
+            ofstream fichier(dossier + "/" + p_nomFichier + ".tmp");
+            fichier << "{\"header\": {\"gtfsRealtimeVersion\": \"2.0\"}, \"entity\": [";
+            const char *separateur = "";
+            for (unsigned int v = 0; v < table.getNbVoyages(); v += 10)
+            {
+                if (table.getDebutVoyage(v + 1) - table.getDebutVoyage(v) < 2) continue;
+                fichier << separateur << "{\"id\": \"" << v << "\", \"tripUpdate\": {\"trip\": {\"tripId\": \""
+                        << p_contexte.donnees.getIdsVoyages().getChaine(table.getIdVoyage(v)) << "\"}, \"stopTimeUpdate\": "
+                        << "[{\"stopSequence\": " << table.getSequence(table.getDebutVoyage(v) + 1)
+                        << ", \"arrival\": {\"delay\": " << p_retard << "}}]}}";
+                separateur = ", ";
+            }
+            fichier << "]}" << endl;
+            fichier.close();
+            rename((dossier + "/" + p_nomFichier + ".tmp").c_str(), (dossier + "/" + p_nomFichier).c_str());
+        };
+        remove((dossier + "/retards-2.json").c_str()); //laissé par une exécution précédente dans le même dossier
+        ecrireRetards("retards-1.json", 240);
+
+        ReseauTempsReel tempsReel(p_contexte.donnees, p_contexte.reseau);
+        ServiceItineraires service(p_contexte.donnees, tempsReel, max(2u, thread::hardware_concurrency()));
+        vector<ReponseItineraire> reponses;
+        unsigned int nbModifies = 0;
+        thread miseAJour([&]() { nbModifies = tempsReel.lireDossier(dossier); });
+        unsigned int nbSeries = 0;
+        do
+        {
+            service.repondre(p_contexte.requetes, reponses);
+            ++nbSeries;
+        } while (tempsReel.getEpoque() == 0 && nbSeries < 1000);
+        miseAJour.join();
+        if (nbModifies == 0 || tempsReel.getEpoque() == 0)
+            throw logic_error("verifierTempsReel(): les retards déposés n'ont pas été appliqués");
+
+        ecrireRetards("retards-2.json", 0);
+        tempsReel.lireDossier(dossier);
+        service.repondre(p_contexte.requetes, reponses);
+        for (size_t i = 0; i < reponses.size(); ++i)
+            if (reponses[i].tempsDuTrajet != p_contexte.reponses[i].tempsDuTrajet)
+                throw logic_error("verifierTempsReel(): le réseau sans retards et le réseau de l'horaire diffèrent");
+    }
+
+    //! \brief un retard donné en heure POSIX donne les mêmes arcs que le même retard donné en secondes, quel que soit le
+    //! \brief fuseau de la machine: le 18 août 2017, l'agence (America/Montreal) est à l'heure avancée de l'Est, UTC-4
+    void verifierHeuresPosix(Contexte &p_contexte)
+    {
+        const TableArrets &table = p_contexte.reseau.getTable();
+        struct tm minuitUTC = {};
+        minuitUTC.tm_year = 2017 - 1900;
+        minuitUTC.tm_mon = 8 - 1;
+        minuitUTC.tm_mday = 18;
+        const int64_t debutJournee = (int64_t) timegm(&minuitUTC) + 4 * 3600;
+        vector<RetardVoyage> enSecondes, enHeuresPosix;
+        for (unsigned int v = 0; v < table.getNbVoyages(); v += 10)
+        {
+            if (table.getDebutVoyage(v + 1) - table.getDebutVoyage(v) < 2) continue;
+            const size_t a = table.getDebutVoyage(v) + 1;
+            RetardArret r = {table.getSequence(a), RetardArret::aucun, true, false, 240, 0, 0, 0};
+            enSecondes.push_back({p_contexte.donnees.getIdsVoyages().getChaine(table.getIdVoyage(v)), {r}});
+            r.retardArrivee = 0;
+            r.heureArrivee = debutJournee + table.getArrivee(a) + 240;
+            enHeuresPosix.push_back({enSecondes.back().tripId, {r}});
+        }
+        ReseauGTFS reseauSecondes(p_contexte.reseau), reseauPosix(p_contexte.reseau);
+        const unsigned int nbRetardes = reseauSecondes.appliquerRetards(p_contexte.donnees, enSecondes);
+        const Graphe &grapheSecondes = reseauSecondes.getGraphe(), &graphePosix = reseauPosix.getGraphe();
+        bool memesArcs = nbRetardes > 0 && reseauPosix.appliquerRetards(p_contexte.donnees, enHeuresPosix) == nbRetardes &&
+                         grapheSecondes.getNbArcs() == graphePosix.getNbArcs();
+        for (size_t a = 0; memesArcs && a <= grapheSecondes.getNbSommets(); ++a)
+            memesArcs = grapheSecondes.getDebutArcsFiges()[a] == graphePosix.getDebutArcsFiges()[a];
+        for (size_t k = 0; memesArcs && k < grapheSecondes.getNbArcs(); ++k)
+            memesArcs = grapheSecondes.getArcsFiges()[k].destination == graphePosix.getArcsFiges()[k].destination &&
+                        grapheSecondes.getArcsFiges()[k].poids == graphePosix.getArcsFiges()[k].poids;
+        if (!memesArcs)
+            throw logic_error("verifierHeuresPosix(): un retard en heure POSIX et en secondes donnent des arcs différents");
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        const Options options = lireOptions(argc, argv);
+        const string sortie = preparerDossierSortie(options.sortie);
+        const string &dossier = options.dossier;
+        const Date date(2017, 8, 18);
+        const Heure now1(8, 30, 0);
+        const Heure now2 = now1.add_secondes(86400);
+
+        DonneesGTFS donnees(date, now1, now2);
+        donnees.ajouterAgences(dossier + "/agency.txt");
+        donnees.ajouterLignes(dossier + "/routes.txt");
+        donnees.ajouterStations(dossier + "/stops.txt");
+        donnees.ajouterServices(dossier + "/calendar_dates.txt");
+        donnees.ajouterVoyagesDeLaDate(dossier + "/trips.txt");
+        donnees.ajouterArretsDesVoyagesDeLaDate(dossier + "/stop_times.txt");
+        donnees.ajouterTransferts(dossier + "/transfers.txt");
+        ReseauGTFS reseau(donnees);
+        cout << "Réseau du " << date << " (" << donnees.getNbArrets() << " arrêts, " << reseau.getNbSommets()
+             << " sommets); fichiers écrits dans " << sortie << endl;
+
+        //requêtes tirées avec une graine fixe, avec des heures de départ dans les quatre heures qui suivent now1
+        Contexte contexte = {options, sortie, date, now1, now2, donnees, reseau, {}, {}, {}};
+        vector<Coordonnees> points;
+        for (const auto &station : donnees.getStations()) points.push_back(station.second.getCoords());
+        mt19937 generateur(42);
+        uniform_int_distribution<size_t> distributionPoints(0, points.size() - 1);
+        uniform_int_distribution<unsigned int> distributionDepart(0, 4 * 3600);
+        for (unsigned int i = 0; i < options.nbRequetes; ++i)
+        {
+            const Coordonnees &origine = points[distributionPoints(generateur)];
+            const Coordonnees &destination = points[distributionPoints(generateur)];
+            contexte.requetes.push_back({origine, destination,
+                                         TableArrets::enSecondes(now1) + distributionDepart(generateur)});
+        }
+
+        verifier("CSA, RAPTOR et instantané contre le graphe", [&]() { verifierMoteurs(contexte); });
+
+        //le réseau garde ses arrêts en colonnes: les vérifications suivantes se font sans les objets Arret
+        const size_t residenteAvant = memoireResidente();
+        donnees.libererArrets();
+        cout << "Objets Arret libérés: mémoire résidente de " << residenteAvant << " Kio à " << memoireResidente()
+             << " Kio" << endl;
+
+        verifier("service simultané contre service séquentiel", [&]() { verifierService(contexte); });
+        verifier("recherches bidirectionnelle, A* et ALT contre Dijkstra", [&]() { verifierRecherches(contexte); });
+        verifier("motifs de trajets contre Dijkstra", [&]() { verifierMotifs(contexte); });
+        verifier("profils contre le graphe", [&]() { verifierProfils(contexte); });
+        verifier("matrice contre le graphe", [&]() { verifierMatrice(contexte); });
+        FluxGTFS flux(dossier);
+        verifier("données tirées du flux contre fichiers", [&]() { verifierFlux(contexte, flux); });
+        verifier("fenêtre avancée contre reconstruite", [&]() { verifierFenetre(contexte, flux); });
+        verifier("retards en temps réel", [&]() { verifierTempsReel(contexte); });
+        verifier("retards en heure POSIX contre retards en secondes", [&]() { verifierHeuresPosix(contexte); });
+    }
+    catch (const exception &e)
+    {
+        cerr << "ÉCHEC: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
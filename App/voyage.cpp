@@ -7,18 +7,18 @@
 
 /*!
  * \brief Constructeur de la classes Voyage
- * \param[in] p_id : identificateur du voyage
+ * \param[in] p_id : numéro interné de l'identificateur du voyage
  * \param[in] p_ligne_id : identificateur de la ligne desservie par le voyage
- * \param[in] p_service_id: identificateur du service auquel ce voyage appartient
+ * \param[in] p_service_id: numéro interné de l'identificateur du service auquel ce voyage appartient
  * \param[in] p_destination: destination du voyage
  */
-Voyage::Voyage(const std::string &p_id, unsigned int p_ligne_id, const std::string &p_service_id,
+Voyage::Voyage(unsigned int p_id, unsigned int p_ligne_id, unsigned int p_service_id,
                const std::string &p_destination) :
         m_id(p_id), m_ligne(p_ligne_id), m_service_id(p_service_id), m_destination(p_destination)
 {
 }
 
-Voyage::Voyage()
+Voyage::Voyage() : m_id(0), m_ligne(0), m_service_id(0)
 {
 }
 
@@ -33,7 +33,7 @@ const std::string &Voyage::getDestination() const
     return m_destination;
 }
 
-std::string Voyage::getId() const
+unsigned int Voyage::getId() const
 {
     return m_id;
 }
@@ -43,7 +43,7 @@ unsigned int Voyage::getLigne() const
     return m_ligne;
 }
 
-std::string Voyage::getServiceId() const
+unsigned int Voyage::getServiceId() const
 {
     return m_service_id;
 }
@@ -77,6 +77,28 @@ void Voyage::ajouterArret(const Arret::Ptr &p_arret)
     m_arrets.insert(p_arret);
 }
 
+//! \brief enlève les arrêts dont l'heure de départ précède p_heure
+//! \return le nombre d'arrêts enlevés
+unsigned int Voyage::enleverArretsPartis(const Heure &p_heure)
+{
+    unsigned int nbEnleves = 0;
+    for (auto itr = m_arrets.begin(); itr != m_arrets.end();)
+    {
+        if ((*itr)->getHeureDepart() < p_heure)
+        {
+            itr = m_arrets.erase(itr);
+            ++nbEnleves;
+        }
+        else ++itr;
+    }
+    return nbEnleves;
+}
+
+//! \brief enlève tous les arrêts du voyage et rend la mémoire de son conteneur
+void Voyage::viderArrets()
+{
+    std::set<Arret::Ptr, compArret>().swap(m_arrets);
+}
 
 /*!
  * \brief Inégalité inférieure entre deux voyages.
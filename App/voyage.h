@@ -26,26 +26,28 @@ public:
         bool operator() (Arret::Ptr i, Arret::Ptr j) const;
     };
 
-    Voyage(const std::string & p_id, unsigned int p_ligne_id, const std::string & p_service_id, const std::string & p_destination);
+    Voyage(unsigned int p_id, unsigned int p_ligne_id, unsigned int p_service_id, const std::string & p_destination);
     Voyage();
 	const std::set<Arret::Ptr, compArret> & getArrets() const;
     unsigned int getNbArrets() const;
 	const std::string& getDestination() const;
-	std::string getId() const;
+	unsigned int getId() const;
 	unsigned int getLigne() const;
-	std::string getServiceId() const;
+	unsigned int getServiceId() const;
 	Heure getHeureDepart() const;
 	Heure getHeureFin() const;
     void ajouterArret(const Arret::Ptr & p_arret);
+    unsigned int enleverArretsPartis(const Heure & p_heure);
+    void viderArrets();
 	bool operator< (const Voyage & p_other) const;
 	bool operator> (const Voyage & p_other) const;
 	friend std::ostream & operator<<(std::ostream & flux, const Voyage & p_voyage);
 
 private:
 
-    std::string m_id;
+    unsigned int m_id; //le trip_id interné (voir DonneesGTFS::getIdsVoyages())
 	unsigned int m_ligne;
-	std::string m_service_id;
+	unsigned int m_service_id; //le service_id interné (voir DonneesGTFS::getIdsServices())
 	std::string m_destination;
 	std::set<Arret::Ptr, compArret> m_arrets;
 